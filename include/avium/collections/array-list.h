@@ -1,6 +1,8 @@
 #ifndef AVIUM_COLLECTIONS_ARRAY_LIST_H
 #define AVIUM_COLLECTIONS_ARRAY_LIST_H
 
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
 #include "avium/types.h"
 
 AVM_CLASS(AvmArrayList, object, {
@@ -12,4 +14,124 @@ AVM_CLASS(AvmArrayList, object, {
 
 AVMAPI AvmArrayList AvmArrayListNew(const AvmType* type, uint length);
 
+/**
+ * @brief Ensures that an AvmArrayList can hold more items without growing.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmArrayList instance.
+ * @param count The number of items to make room for, past the current length.
+ */
+AVMAPI void AvmArrayListReserve(AvmArrayList* self, uint count);
+
+/// Returns the name of the typed list of T, declared with AVM_ARRAY_LIST_OF.
+#define AvmArrayListOf(T) AVM_CONCAT(AvmArrayListOf_, T)
+
+#define AVM_ARRAY_LIST_FN_(T, F) AVM_CONCAT(AvmArrayListOf(T), AVM_CONCAT(_, F))
+
+/**
+ * @brief Declares a typed AvmArrayList of T, named AvmArrayListOf(T).
+ *
+ * The typed list has the same layout as AvmArrayList, which it overlays in a
+ * union, so a pointer to it can be passed to the AvmList functions. Its
+ * accessors are inline and index a T pointer, so loops over the items compile
+ * to plain array code. For a list of int the following are declared:
+ *
+ * - AvmArrayListOf_int_New(capacity)
+ * - AvmArrayListOf_int_AsList(self), returning the AvmList*
+ * - AvmArrayListOf_int_GetLength(self)
+ * - AvmArrayListOf_int_ItemAt(self, index), returning a T*
+ * - AvmArrayListOf_int_Get(self, index) and _Set(self, index, value)
+ * - AvmArrayListOf_int_Push(self, value) and _Pop(self)
+ *
+ * Indices are only checked by preconditions. _Pop returns the item without
+ * calling its finalizer, so ownership passes to the caller.
+ *
+ * T must be a single identifier with type info, that is a primitive type or
+ * a type declared with AVM_CLASS.
+ *
+ * @param T The item type.
+ */
+#define AVM_ARRAY_LIST_OF(T)                                                   \
+    typedef union AvmArrayListOf(T)                                            \
+    {                                                                          \
+        AvmArrayList _list;                                                    \
+        struct                                                                 \
+        {                                                                      \
+            const AvmType* _type;                                              \
+            uint _length;                                                      \
+            uint _capacity;                                                    \
+            const AvmType* _itemType;                                          \
+            T* _items;                                                         \
+        };                                                                     \
+    }                                                                          \
+    AvmArrayListOf(T);                                                         \
+                                                                               \
+    static_assert_s(sizeof(AvmArrayListOf(T)) == sizeof(AvmArrayList));        \
+                                                                               \
+    static inline AvmArrayListOf(T) AVM_ARRAY_LIST_FN_(T, New)(uint capacity) \
+    {                                                                          \
+        AvmArrayListOf(T) self;                                                \
+        self._list = AvmArrayListNew(typeid(T), capacity);                     \
+        return self;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline AvmArrayList* AVM_ARRAY_LIST_FN_(T, AsList)(                 \
+        AvmArrayListOf(T) * self)                                              \
+    {                                                                          \
+        return &self->_list;                                                   \
+    }                                                                          \
+                                                                               \
+    static inline uint AVM_ARRAY_LIST_FN_(T, GetLength)(                       \
+        const AvmArrayListOf(T) * self)                                        \
+    {                                                                          \
+        return self->_length;                                                  \
+    }                                                                          \
+                                                                               \
+    static inline T* AVM_ARRAY_LIST_FN_(T, ItemAt)(                            \
+        const AvmArrayListOf(T) * self, uint index)                            \
+    {                                                                          \
+        pre                                                                    \
+        {                                                                      \
+            assert(index < self->_length);                                     \
+        }                                                                      \
+                                                                               \
+        return &self->_items[index];                                           \
+    }                                                                          \
+                                                                               \
+    static inline T AVM_ARRAY_LIST_FN_(T, Get)(const AvmArrayListOf(T) * self, \
+                                               uint index)                     \
+    {                                                                          \
+        return *AVM_ARRAY_LIST_FN_(T, ItemAt)(self, index);                    \
+    }                                                                          \
+                                                                               \
+    static inline void AVM_ARRAY_LIST_FN_(T, Set)(                             \
+        AvmArrayListOf(T) * self, uint index, T value)                         \
+    {                                                                          \
+        *AVM_ARRAY_LIST_FN_(T, ItemAt)(self, index) = value;                   \
+    }                                                                          \
+                                                                               \
+    static inline void AVM_ARRAY_LIST_FN_(T, Push)(AvmArrayListOf(T) * self,   \
+                                                   T value)                    \
+    {                                                                          \
+        if (self->_length == self->_capacity)                                  \
+        {                                                                      \
+            AvmArrayListReserve(&self->_list, 1);                              \
+        }                                                                      \
+                                                                               \
+        self->_items[self->_length++] = value;                                 \
+    }                                                                          \
+                                                                               \
+    static inline T AVM_ARRAY_LIST_FN_(T, Pop)(AvmArrayListOf(T) * self)       \
+    {                                                                          \
+        pre                                                                    \
+        {                                                                      \
+            assert(self->_length != 0);                                        \
+        }                                                                      \
+                                                                               \
+        return self->_items[--self->_length];                                  \
+    }                                                                          \
+                                                                               \
+    static_assert_s(true)
+
 #endif // AVIUM_COLLECTIONS_ARRAY_LIST_H
@@ -0,0 +1,273 @@
+#ifndef AVIUM_COLLECTIONS_BIT_SET_H
+#define AVIUM_COLLECTIONS_BIT_SET_H
+
+#include "avium/types.h"
+
+struct AvmBitContainer;
+
+/**
+ * @brief A fixed number of bits, packed into 64-bit words.
+ *
+ * The bulk operations combine whole words, several at a time with SIMD
+ * instructions where available, and counting uses the POPCNT instruction when
+ * the CPU has it. Bits past the length are always clear.
+ */
+AVM_CLASS(AvmBitSet, object, {
+    uint _length;
+    uint _capacity; // In words.
+    ulong* _words;
+});
+
+/**
+ * @brief A set of uint values, compressed for sparse sets.
+ *
+ * Values are grouped by their upper 16 bits. Each group that has values is
+ * stored as a sorted array of their lower 16 bits while it has few of them,
+ * and as a bitmap of 65536 bits once the bitmap is smaller, as in Roaring
+ * bitmaps. Group keys are kept sorted in their own array and searched
+ * without touching the groups.
+ */
+AVM_CLASS(AvmSparseBitSet, object, {
+    uint _length;
+    uint _groupCount;
+    uint _groupCapacity;
+    ushort* _keys;
+    struct AvmBitContainer* _groups;
+});
+
+/**
+ * @brief Creates a new AvmBitSet with all bits clear.
+ *
+ * @param length The number of bits.
+ * @return The created instance.
+ */
+AVMAPI AvmBitSet AvmBitSetNew(uint length);
+
+/**
+ * @brief Returns the value of a bit of an AvmBitSet.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmBitSet instance.
+ * @param index The index of the bit.
+ * @return The value of the bit.
+ *
+ * @throws RangeError if the index is out of range.
+ */
+AVMAPI bool AvmBitSetGet(const AvmBitSet* self, uint index);
+
+/**
+ * @brief Sets or clears a bit of an AvmBitSet.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmBitSet instance.
+ * @param index The index of the bit.
+ * @param value The new value of the bit.
+ *
+ * @throws RangeError if the index is out of range.
+ */
+AVMAPI void AvmBitSetSet(AvmBitSet* self, uint index, bool value);
+
+/**
+ * @brief Sets or clears all bits of an AvmBitSet.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmBitSet instance.
+ * @param value The new value of the bits.
+ */
+AVMAPI void AvmBitSetFill(AvmBitSet* self, bool value);
+
+/**
+ * @brief Changes the number of bits of an AvmBitSet.
+ *
+ * Added bits are clear.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmBitSet instance.
+ * @param length The new number of bits.
+ */
+AVMAPI void AvmBitSetResize(AvmBitSet* self, uint length);
+
+/**
+ * @brief Returns the number of set bits of an AvmBitSet.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmBitSet instance.
+ * @return The number of set bits.
+ */
+AVMAPI uint AvmBitSetCount(const AvmBitSet* self);
+
+/**
+ * @brief Returns the index of the first set bit of an AvmBitSet at or after
+ *        an index.
+ *
+ * To visit every set bit, start at 0 and continue after each index returned.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmBitSet instance.
+ * @param index The index to start at, which may be past the end.
+ * @return The index of the set bit, or AvmInvalid if there is none.
+ */
+AVMAPI uint AvmBitSetNextSet(const AvmBitSet* self, uint index);
+
+/**
+ * @brief Keeps the bits of an AvmBitSet that are also set in another.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p other must be not null.
+ *
+ * @param self The AvmBitSet instance.
+ * @param other The AvmBitSet to combine with, of the same length.
+ *
+ * @throws ArgError if the lengths differ.
+ */
+AVMAPI void AvmBitSetAnd(AvmBitSet* self, const AvmBitSet* other);
+
+/**
+ * @brief Sets the bits of an AvmBitSet that are set in another.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p other must be not null.
+ *
+ * @param self The AvmBitSet instance.
+ * @param other The AvmBitSet to combine with, of the same length.
+ *
+ * @throws ArgError if the lengths differ.
+ */
+AVMAPI void AvmBitSetOr(AvmBitSet* self, const AvmBitSet* other);
+
+/**
+ * @brief Flips the bits of an AvmBitSet that are set in another.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p other must be not null.
+ *
+ * @param self The AvmBitSet instance.
+ * @param other The AvmBitSet to combine with, of the same length.
+ *
+ * @throws ArgError if the lengths differ.
+ */
+AVMAPI void AvmBitSetXor(AvmBitSet* self, const AvmBitSet* other);
+
+/**
+ * @brief Clears the bits of an AvmBitSet that are set in another.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p other must be not null.
+ *
+ * @param self The AvmBitSet instance.
+ * @param other The AvmBitSet to combine with, of the same length.
+ *
+ * @throws ArgError if the lengths differ.
+ */
+AVMAPI void AvmBitSetAndNot(AvmBitSet* self, const AvmBitSet* other);
+
+/**
+ * @brief Creates a new, empty AvmSparseBitSet.
+ *
+ * @return The created instance.
+ */
+AVMAPI AvmSparseBitSet AvmSparseBitSetNew(void);
+
+/**
+ * @brief Determines whether an AvmSparseBitSet contains a value.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmSparseBitSet instance.
+ * @param index The value.
+ * @return true if the value is in the set.
+ */
+AVMAPI bool AvmSparseBitSetGet(const AvmSparseBitSet* self, uint index);
+
+/**
+ * @brief Adds a value to or removes a value from an AvmSparseBitSet.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmSparseBitSet instance.
+ * @param index The value.
+ * @param value true to add the value, false to remove it.
+ *
+ * @throws RangeError if the value is AvmInvalid.
+ */
+AVMAPI void AvmSparseBitSetSet(AvmSparseBitSet* self, uint index, bool value);
+
+/**
+ * @brief Returns the number of values in an AvmSparseBitSet.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmSparseBitSet instance.
+ * @return The number of values.
+ */
+AVMAPI uint AvmSparseBitSetCount(const AvmSparseBitSet* self);
+
+/**
+ * @brief Returns the smallest value of an AvmSparseBitSet that is at least a
+ *        given value.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmSparseBitSet instance.
+ * @param index The value to start at.
+ * @return The value found, or AvmInvalid if there is none.
+ */
+AVMAPI uint AvmSparseBitSetNextSet(const AvmSparseBitSet* self, uint index);
+
+/**
+ * @brief Keeps the values of an AvmSparseBitSet that are also in another.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p other must be not null.
+ *
+ * @param self The AvmSparseBitSet instance.
+ * @param other The AvmSparseBitSet to combine with.
+ */
+AVMAPI void AvmSparseBitSetAnd(AvmSparseBitSet* self,
+                               const AvmSparseBitSet* other);
+
+/**
+ * @brief Adds the values of another AvmSparseBitSet to an AvmSparseBitSet.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p other must be not null.
+ *
+ * @param self The AvmSparseBitSet instance.
+ * @param other The AvmSparseBitSet to combine with.
+ */
+AVMAPI void AvmSparseBitSetOr(AvmSparseBitSet* self,
+                              const AvmSparseBitSet* other);
+
+/**
+ * @brief Keeps the values that are in exactly one of two AvmSparseBitSet
+ *        instances.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p other must be not null.
+ *
+ * @param self The AvmSparseBitSet instance.
+ * @param other The AvmSparseBitSet to combine with.
+ */
+AVMAPI void AvmSparseBitSetXor(AvmSparseBitSet* self,
+                               const AvmSparseBitSet* other);
+
+/**
+ * @brief Removes the values of another AvmSparseBitSet from an
+ *        AvmSparseBitSet.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p other must be not null.
+ *
+ * @param self The AvmSparseBitSet instance.
+ * @param other The AvmSparseBitSet to combine with.
+ */
+AVMAPI void AvmSparseBitSetAndNot(AvmSparseBitSet* self,
+                                  const AvmSparseBitSet* other);
+
+#endif // AVIUM_COLLECTIONS_BIT_SET_H
@@ -0,0 +1,105 @@
+#ifndef AVIUM_COLLECTIONS_BLOOM_FILTER_H
+#define AVIUM_COLLECTIONS_BLOOM_FILTER_H
+
+#include "avium/io.h"
+#include "avium/types.h"
+
+/**
+ * @brief A probabilistic set that answers whether an item may have been
+ *        added, as a blocked Bloom filter.
+ *
+ * Lookups never miss an added item, but may report items that were never
+ * added. The bits are split into 64-byte blocks and all the bits of an item
+ * are in one block, chosen by its hash, so an operation touches a single
+ * cache line. Blocks fill unevenly, so the filter is sized with a few more
+ * bits than a classic Bloom filter of the same rate.
+ *
+ * Items are hashed with the FnEntryHash entry of their type, or by their
+ * bytes if the type has no FnEntryEquals entry, and the hashes do not depend
+ * on the process, so a filter can be written to an AvmStream and read back
+ * elsewhere.
+ */
+AVM_CLASS(AvmBloomFilter, object, {
+    uint _length;
+    uint _capacity;
+    uint _hashCount;
+    uint _blockCount;
+    const AvmType* _itemType;
+    ulong* _blocks;
+});
+
+/**
+ * @brief Creates a new AvmBloomFilter.
+ *
+ * @pre Parameter @p type must be not null.
+ * @pre Parameter @p rate must be between 0 and 1, exclusive.
+ *
+ * @param type The type of the items.
+ * @param capacity The number of items expected to be added.
+ * @param rate The rate of false positives expected once @p capacity items
+ *             have been added.
+ * @return The created instance.
+ */
+AVMAPI AvmBloomFilter AvmBloomFilterNew(const AvmType* type,
+                                        uint capacity,
+                                        double rate);
+
+/**
+ * @brief Adds an item to an AvmBloomFilter.
+ *
+ * Only the hash of the item is used, the item itself is not stored.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmBloomFilter instance.
+ * @param value The item.
+ */
+AVMAPI void AvmBloomFilterAdd(AvmBloomFilter* self, object value);
+
+/**
+ * @brief Determines whether an item may have been added to an AvmBloomFilter.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmBloomFilter instance.
+ * @param value The item.
+ * @return false if the item was never added, true if it probably was.
+ */
+AVMAPI bool AvmBloomFilterContains(const AvmBloomFilter* self, object value);
+
+#ifdef AVM_USE_IO
+/**
+ * @brief Writes an AvmBloomFilter to an AvmStream.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p stream must be not null.
+ *
+ * @param self The AvmBloomFilter instance.
+ * @param stream The AvmStream to write to.
+ * @return The result of the IO operation.
+ */
+AVMAPI AvmError* AvmBloomFilterWrite(const AvmBloomFilter* self,
+                                     AvmStream* stream);
+
+/**
+ * @brief Reads an AvmBloomFilter written with AvmBloomFilterWrite from an
+ *        AvmStream, replacing the contents of another.
+ *
+ * The bits are read with a single AvmStreamRead call. The item type of
+ * @p self is kept and must have the size of the one the filter was written
+ * with. If an error occurs, @p self is left unchanged.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p stream must be not null.
+ *
+ * @param self The AvmBloomFilter instance.
+ * @param stream The AvmStream to read from.
+ * @return The result of the IO operation, or an error if the data is not an
+ *         AvmBloomFilter of the item type.
+ */
+AVMAPI AvmError* AvmBloomFilterRead(AvmBloomFilter* self, AvmStream* stream);
+#endif // AVM_USE_IO
+
+#endif // AVIUM_COLLECTIONS_BLOOM_FILTER_H
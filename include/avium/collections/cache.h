@@ -0,0 +1,207 @@
+#ifndef AVIUM_COLLECTIONS_CACHE_H
+#define AVIUM_COLLECTIONS_CACHE_H
+
+#include "avium/types.h"
+
+struct AvmCacheSlot;
+struct AvmCacheShard;
+
+/**
+ * @brief A function that returns the cost of an entry of a weighted AvmCache,
+ *        such as the memory that it uses.
+ */
+typedef ulong (*AvmCacheWeigher)(object key, object value);
+
+/// Counts the lookups and evictions of an AvmCache.
+typedef struct
+{
+    ulong Hits;
+    ulong Misses;
+    ulong Evictions;
+} AvmCacheStatistics;
+
+/**
+ * @brief A map of bounded size implementing AvmMap, which evicts entries
+ *        that were not used recently to make room for new ones.
+ *
+ * Keys and values are stored inline, by value, in a fixed number of slots,
+ * and found through a hash index. Evictions follow the CLOCK policy: a
+ * lookup only marks its entry as used, and a hand sweeps the slots in a
+ * circle, evicting the first entry that was not used since the last sweep
+ * and clearing the marks of the others. Evicted, replaced and removed
+ * entries are finalized with the FnEntryDtor entries of their types.
+ *
+ * Values returned by AvmMapGet are valid until the next insertion or removal.
+ */
+AVM_CLASS(AvmCache, object, {
+    uint _length;
+    uint _capacity;
+    uint _hand;
+    uint _freeCount;
+    uint _indexMask;
+    ulong _weight;
+    ulong _budget;
+    AvmCacheWeigher _weigher;
+    AvmCacheStatistics _statistics;
+    const AvmType* _keyType;
+    const AvmType* _valueType;
+    byte* _entries;
+    struct AvmCacheSlot* _slots;
+    uint* _free;  // Indices of unused slots.
+    uint* _index; // Slot indices, by key hash.
+});
+
+/**
+ * @brief An AvmCache split into shards by key hash, each with its own lock,
+ *        so it can be used from several threads at once.
+ *
+ * Each shard holds an equal part of the entries and evicts its own entries
+ * independently. Of the AvmMap entries only the length and the capacity are
+ * implemented. Entries are accessed with the AvmShardedCache functions, which
+ * copy values while their shard is locked.
+ */
+AVM_CLASS(AvmShardedCache, object, {
+    uint _shardBits;
+    const AvmType* _keyType;
+    const AvmType* _valueType;
+    struct AvmCacheShard* _shards;
+});
+
+/**
+ * @brief Creates a new AvmCache.
+ *
+ * @pre Parameter @p keyType must be not null.
+ * @pre Parameter @p valueType must be not null.
+ * @pre Parameter @p capacity must be greater than 0.
+ *
+ * @param keyType The type of the keys.
+ * @param valueType The type of the values.
+ * @param capacity The most entries to keep.
+ * @return The created instance.
+ */
+AVMAPI AvmCache AvmCacheNew(const AvmType* keyType,
+                            const AvmType* valueType,
+                            uint capacity);
+
+/**
+ * @brief Creates a new AvmCache that also limits the total weight of its
+ *        entries.
+ *
+ * The weigher is called once for each inserted entry. An entry that weighs
+ * more than the whole budget is finalized instead of being inserted.
+ *
+ * @pre Parameter @p keyType must be not null.
+ * @pre Parameter @p valueType must be not null.
+ * @pre Parameter @p capacity must be greater than 0.
+ * @pre Parameter @p weigher must be not null.
+ *
+ * @param keyType The type of the keys.
+ * @param valueType The type of the values.
+ * @param capacity The most entries to keep.
+ * @param budget The most total weight to keep.
+ * @param weigher The function that returns the weight of an entry.
+ * @return The created instance.
+ */
+AVMAPI AvmCache AvmCacheNewWeighted(const AvmType* keyType,
+                                    const AvmType* valueType,
+                                    uint capacity,
+                                    ulong budget,
+                                    AvmCacheWeigher weigher);
+
+/**
+ * @brief Returns the lookup and eviction counts of an AvmCache.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmCache instance.
+ * @return The counts.
+ */
+AVMAPI AvmCacheStatistics AvmCacheGetStatistics(const AvmCache* self);
+
+/**
+ * @brief Creates a new AvmShardedCache.
+ *
+ * @pre Parameter @p keyType must be not null.
+ * @pre Parameter @p valueType must be not null.
+ * @pre Parameter @p capacity must be greater than 0.
+ *
+ * @param keyType The type of the keys.
+ * @param valueType The type of the values.
+ * @param capacity The most entries to keep, split between the shards.
+ * @param shardCount The number of shards, rounded up to a power of two, or 0
+ *                   to use one for each processor.
+ * @return The created instance.
+ */
+AVMAPI AvmShardedCache AvmShardedCacheNew(const AvmType* keyType,
+                                          const AvmType* valueType,
+                                          uint capacity,
+                                          uint shardCount);
+
+/**
+ * @brief Copies the value of a key of an AvmShardedCache.
+ *
+ * The value is copied with the FnEntryClone entry of its type, or by its
+ * bytes if there is no such entry, while its shard is locked. The copy is
+ * owned by the caller and stays valid after the entry is evicted.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p key must be not null.
+ * @pre Parameter @p destination must be not null.
+ *
+ * @param self The AvmShardedCache instance.
+ * @param key The key.
+ * @param destination Receives the value.
+ * @return true if the key was found.
+ */
+AVMAPI bool AvmShardedCacheGet(AvmShardedCache* self,
+                               object key,
+                               object destination);
+
+/**
+ * @brief Inserts or replaces an entry of an AvmShardedCache.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p key must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmShardedCache instance.
+ * @param key The key to copy.
+ * @param value The value to copy.
+ */
+AVMAPI void AvmShardedCacheInsert(AvmShardedCache* self,
+                                  object key,
+                                  object value);
+
+/**
+ * @brief Removes an entry of an AvmShardedCache.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p key must be not null.
+ *
+ * @param self The AvmShardedCache instance.
+ * @param key The key.
+ * @return true if the key was found.
+ */
+AVMAPI bool AvmShardedCacheRemove(AvmShardedCache* self, object key);
+
+/**
+ * @brief Removes all entries of an AvmShardedCache.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmShardedCache instance.
+ */
+AVMAPI void AvmShardedCacheClear(AvmShardedCache* self);
+
+/**
+ * @brief Returns the lookup and eviction counts of an AvmShardedCache, summed
+ *        over its shards.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmShardedCache instance.
+ * @return The counts.
+ */
+AVMAPI AvmCacheStatistics AvmShardedCacheGetStatistics(AvmShardedCache* self);
+
+#endif // AVIUM_COLLECTIONS_CACHE_H
@@ -0,0 +1,222 @@
+#ifndef AVIUM_COLLECTIONS_COLUMN_LIST_H
+#define AVIUM_COLLECTIONS_COLUMN_LIST_H
+
+#include "avium/collections/iterator.h"
+#include "avium/types.h"
+
+#include <stddef.h>
+
+/// Describes a field of the rows of an AvmColumnList.
+typedef struct
+{
+    uint Offset;         ///< The offset of the field in a row.
+    const AvmType* Type; ///< The type of the field.
+} AvmColumnField;
+
+/**
+ * @brief Returns the AvmColumnField of a member of an AVM_CLASS type.
+ *
+ * @param T The row type.
+ * @param M The name of the member.
+ * @param FT The type of the member, which must have type info.
+ */
+#define AvmColumnFieldOf(T, M, FT)                                             \
+    ((AvmColumnField){(uint)offsetof(T, M), typeid(FT)})
+
+/**
+ * @brief A list of rows stored as a struct of arrays, with a contiguous
+ *        column for each field.
+ *
+ * A loop over one field of every row reads only that field's column, so
+ * every byte it loads is used and it can be vectorized, where a list of whole
+ * rows would load the other fields along with it. Rows are copied in and out
+ * of the columns by the fields they are described with; bytes of a row that
+ * belong to no field are not stored.
+ *
+ * Since no row is stored whole, the list is not an AvmList. It implements
+ * the length and capacity entries, and its rows are accessed with the
+ * AvmColumnList functions.
+ */
+AVM_CLASS(AvmColumnList, object, {
+    uint _length;
+    uint _capacity;
+    uint _fieldCount;
+    const AvmType* _rowType;
+    AvmColumnField* _fields;
+    byte** _columns;
+});
+
+/**
+ * @brief Creates a new AvmColumnList.
+ *
+ * @pre Parameter @p rowType must be not null.
+ * @pre Parameter @p fields must be not null.
+ * @pre Parameter @p fieldCount must be greater than 0.
+ *
+ * @param rowType The type of the rows.
+ * @param fieldCount The number of fields.
+ * @param fields The fields of the rows, which are copied. Field i is stored
+ *               in column i.
+ * @param capacity The number of rows to make room for.
+ * @return The created instance.
+ *
+ * @throws ArgError if a field is outside of a row or overlaps another.
+ */
+AVMAPI AvmColumnList AvmColumnListNew(const AvmType* rowType,
+                                      uint fieldCount,
+                                      const AvmColumnField fields[],
+                                      uint capacity);
+
+/**
+ * @brief Ensures that an AvmColumnList can hold more rows without growing.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmColumnList instance.
+ * @param count The number of rows to make room for, past the current length.
+ */
+AVMAPI void AvmColumnListReserve(AvmColumnList* self, uint count);
+
+/**
+ * @brief Returns a column of an AvmColumnList.
+ *
+ * The column is an array of one item per row, of the type of its field, and
+ * is valid until the list grows.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmColumnList instance.
+ * @param field The index of the field.
+ * @return A pointer to the first item of the column.
+ *
+ * @throws RangeError if there is no such field.
+ */
+AVMAPI object AvmColumnListGetColumn(const AvmColumnList* self, uint field);
+
+/**
+ * @brief Returns an AvmIterator over a column of an AvmColumnList, with a
+ *        single span.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmColumnList instance.
+ * @param field The index of the field.
+ * @return The iterator.
+ *
+ * @throws RangeError if there is no such field.
+ */
+AVMAPI AvmIterator AvmColumnListGetColumnIterator(const AvmColumnList* self,
+                                                  uint field);
+
+/**
+ * @brief Adds a row to the end of an AvmColumnList.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p row must be not null.
+ *
+ * @param self The AvmColumnList instance.
+ * @param row The row, whose fields are copied.
+ */
+AVMAPI void AvmColumnListPush(AvmColumnList* self, object row);
+
+/**
+ * @brief Adds an array of rows to the end of an AvmColumnList.
+ *
+ * The rows are scattered one column at a time.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p rows must be not null if @p count is not 0.
+ *
+ * @param self The AvmColumnList instance.
+ * @param count The number of rows.
+ * @param rows The rows, whose fields are copied.
+ */
+AVMAPI void AvmColumnListAddRows(AvmColumnList* self,
+                                 uint count,
+                                 const void* rows);
+
+/**
+ * @brief Copies a row of an AvmColumnList into a destination.
+ *
+ * Bytes of the destination that belong to no field are left unchanged.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p destination must be not null.
+ *
+ * @param self The AvmColumnList instance.
+ * @param index The index of the row.
+ * @param destination The row to copy the fields into.
+ *
+ * @throws RangeError if the index is out of range.
+ */
+AVMAPI void AvmColumnListGetRow(const AvmColumnList* self,
+                                uint index,
+                                object destination);
+
+/**
+ * @brief Copies a range of rows of an AvmColumnList into an array.
+ *
+ * The rows are gathered one column at a time. Bytes of the destination that
+ * belong to no field are left unchanged.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p destination must be not null if @p count is not 0.
+ *
+ * @param self The AvmColumnList instance.
+ * @param index The index of the first row.
+ * @param count The number of rows.
+ * @param destination The array of rows to copy the fields into.
+ *
+ * @throws RangeError if the range is out of range.
+ */
+AVMAPI void AvmColumnListGetRows(const AvmColumnList* self,
+                                 uint index,
+                                 uint count,
+                                 void* destination);
+
+/**
+ * @brief Replaces a row of an AvmColumnList.
+ *
+ * The old fields are finalized with the FnEntryDtor entries of their types.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p row must be not null.
+ *
+ * @param self The AvmColumnList instance.
+ * @param index The index of the row.
+ * @param row The row, whose fields are copied.
+ *
+ * @throws RangeError if the index is out of range.
+ */
+AVMAPI void AvmColumnListSetRow(AvmColumnList* self, uint index, object row);
+
+/**
+ * @brief Removes a row of an AvmColumnList, moving the rows after it.
+ *
+ * The fields of the row are finalized with the FnEntryDtor entries of their
+ * types.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmColumnList instance.
+ * @param index The index of the row.
+ *
+ * @throws RangeError if the index is out of range.
+ */
+AVMAPI void AvmColumnListRemove(AvmColumnList* self, uint index);
+
+/**
+ * @brief Shortens an AvmColumnList.
+ *
+ * The fields of the removed rows are finalized with the FnEntryDtor entries of
+ * their types.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmColumnList instance.
+ * @param length The new length, which is ignored if it is not smaller than
+ *               the current one.
+ */
+AVMAPI void AvmColumnListTruncate(AvmColumnList* self, uint length);
+
+#endif // AVIUM_COLLECTIONS_COLUMN_LIST_H
@@ -0,0 +1,119 @@
+#ifndef AVIUM_COLLECTIONS_CUCKOO_FILTER_H
+#define AVIUM_COLLECTIONS_CUCKOO_FILTER_H
+
+#include "avium/io.h"
+#include "avium/types.h"
+
+/**
+ * @brief A probabilistic set that answers whether an item may have been
+ *        added, and supports removing items, as a cuckoo filter.
+ *
+ * Each item is reduced to a 16-bit fingerprint, stored in one of two buckets
+ * of four fingerprints. The second bucket is computed from the first and the
+ * fingerprint alone, so fingerprints can be moved between their buckets to
+ * make room, as in cuckoo hashing. Lookups check two buckets of 8 bytes and
+ * report items that were never added about once in 8000 times.
+ *
+ * Items are hashed with the FnEntryHash entry of their type, or by their
+ * bytes if the type has no FnEntryEquals entry, and the hashes do not depend
+ * on the process, so a filter can be written to an AvmStream and read back
+ * elsewhere.
+ */
+AVM_CLASS(AvmCuckooFilter, object, {
+    uint _length;
+    uint _bucketCount;
+    uint _victimBucket;
+    ushort _victim; // A fingerprint that did not fit, or 0.
+    ulong _random;
+    const AvmType* _itemType;
+    ulong* _buckets;
+});
+
+/**
+ * @brief Creates a new AvmCuckooFilter.
+ *
+ * @pre Parameter @p type must be not null.
+ *
+ * @param type The type of the items.
+ * @param capacity The number of items to reserve space for.
+ * @return The created instance.
+ */
+AVMAPI AvmCuckooFilter AvmCuckooFilterNew(const AvmType* type, uint capacity);
+
+/**
+ * @brief Adds an item to an AvmCuckooFilter.
+ *
+ * Only the fingerprint of the item is stored. Adding an item more than once
+ * stores it more than once, and it must then be removed as many times.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmCuckooFilter instance.
+ * @param value The item.
+ * @return false if the AvmCuckooFilter is full, in which case nothing is
+ *         added.
+ */
+AVMAPI bool AvmCuckooFilterAdd(AvmCuckooFilter* self, object value);
+
+/**
+ * @brief Removes an item from an AvmCuckooFilter.
+ *
+ * Only items that were added may be removed, or another item with the same
+ * fingerprint is removed instead.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmCuckooFilter instance.
+ * @param value The item.
+ * @return true if the fingerprint of the item was found and removed.
+ */
+AVMAPI bool AvmCuckooFilterRemove(AvmCuckooFilter* self, object value);
+
+/**
+ * @brief Determines whether an item may be in an AvmCuckooFilter.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmCuckooFilter instance.
+ * @param value The item.
+ * @return false if the item is not in the filter, true if it probably is.
+ */
+AVMAPI bool AvmCuckooFilterContains(const AvmCuckooFilter* self, object value);
+
+#ifdef AVM_USE_IO
+/**
+ * @brief Writes an AvmCuckooFilter to an AvmStream.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p stream must be not null.
+ *
+ * @param self The AvmCuckooFilter instance.
+ * @param stream The AvmStream to write to.
+ * @return The result of the IO operation.
+ */
+AVMAPI AvmError* AvmCuckooFilterWrite(const AvmCuckooFilter* self,
+                                      AvmStream* stream);
+
+/**
+ * @brief Reads an AvmCuckooFilter written with AvmCuckooFilterWrite from an
+ *        AvmStream, replacing the contents of another.
+ *
+ * The buckets are read with a single AvmStreamRead call. The item type of
+ * @p self is kept and must have the size of the one the filter was written
+ * with. If an error occurs, @p self is left unchanged.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p stream must be not null.
+ *
+ * @param self The AvmCuckooFilter instance.
+ * @param stream The AvmStream to read from.
+ * @return The result of the IO operation, or an error if the data is not an
+ *         AvmCuckooFilter of the item type.
+ */
+AVMAPI AvmError* AvmCuckooFilterRead(AvmCuckooFilter* self, AvmStream* stream);
+#endif // AVM_USE_IO
+
+#endif // AVIUM_COLLECTIONS_CUCKOO_FILTER_H
@@ -0,0 +1,139 @@
+#ifndef AVIUM_COLLECTIONS_DEQUE_H
+#define AVIUM_COLLECTIONS_DEQUE_H
+
+#include "avium/types.h"
+
+/**
+ * @brief A double-ended queue implementing AvmList.
+ *
+ * Items are stored by value in a ring buffer whose capacity is a power of
+ * two, so they can be added and removed at both ends in constant time. The
+ * items wrap around the end of the buffer, so they are contiguous in at most
+ * two spans. Insertions and removals in the middle shift the items on the
+ * shorter side.
+ */
+AVM_CLASS(AvmDeque, object, {
+    uint _head;
+    uint _length;
+    uint _capacity;
+    const AvmType* _itemType;
+    byte* _items;
+});
+
+/**
+ * @brief Creates a new AvmDeque.
+ *
+ * @pre Parameter @p type must be not null.
+ *
+ * @param type The type of the items.
+ * @param capacity The number of items to reserve space for, rounded up to a
+ *                 power of two.
+ * @return The created instance.
+ */
+AVMAPI AvmDeque AvmDequeNew(const AvmType* type, uint capacity);
+
+/**
+ * @brief Adds an item at the front of an AvmDeque.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmDeque instance.
+ * @param value The item to copy.
+ */
+AVMAPI void AvmDequePushFront(AvmDeque* self, object value);
+
+/**
+ * @brief Adds an item at the back of an AvmDeque.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmDeque instance.
+ * @param value The item to copy.
+ */
+AVMAPI void AvmDequePushBack(AvmDeque* self, object value);
+
+/**
+ * @brief Removes the item at the front of an AvmDeque.
+ *
+ * The item is moved to @p destination, so its finalizer is not called. If
+ * @p destination is NULL, the item is finalized instead. An error is thrown
+ * if the AvmDeque is empty.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmDeque instance.
+ * @param destination Receives the item, or NULL.
+ */
+AVMAPI void AvmDequePopFront(AvmDeque* self, object destination);
+
+/**
+ * @brief Removes the item at the back of an AvmDeque.
+ *
+ * The item is moved to @p destination, so its finalizer is not called. If
+ * @p destination is NULL, the item is finalized instead. An error is thrown
+ * if the AvmDeque is empty.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmDeque instance.
+ * @param destination Receives the item, or NULL.
+ */
+AVMAPI void AvmDequePopBack(AvmDeque* self, object destination);
+
+/**
+ * @brief Returns the item at the front of an AvmDeque.
+ *
+ * An error is thrown if the AvmDeque is empty.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmDeque instance.
+ * @return A pointer to the item.
+ */
+AVMAPI object AvmDequePeekFront(const AvmDeque* self);
+
+/**
+ * @brief Returns the item at the back of an AvmDeque.
+ *
+ * An error is thrown if the AvmDeque is empty.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmDeque instance.
+ * @return A pointer to the item.
+ */
+AVMAPI object AvmDequePeekBack(const AvmDeque* self);
+
+/**
+ * @brief Adds a range of items at the back of an AvmDeque.
+ *
+ * The items are copied with at most two calls to memcpy.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p items must be not null if @p count is not 0.
+ *
+ * @param self The AvmDeque instance.
+ * @param count The number of items.
+ * @param items A contiguous array of items of the AvmDeque item type.
+ */
+AVMAPI void AvmDequePushMany(AvmDeque* self, uint count, const void* items);
+
+/**
+ * @brief Removes up to a number of items from the front of an AvmDeque.
+ *
+ * The items are moved to @p destination with at most two calls to memcpy, so
+ * their finalizers are not called. If @p destination is NULL, the items are
+ * finalized instead.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmDeque instance.
+ * @param count The most items to remove.
+ * @param destination Receives the items, or NULL.
+ * @return The number of items removed.
+ */
+AVMAPI uint AvmDequePopMany(AvmDeque* self, uint count, void* destination);
+
+#endif // AVIUM_COLLECTIONS_DEQUE_H
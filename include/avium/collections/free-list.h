@@ -0,0 +1,87 @@
+#ifndef AVIUM_COLLECTIONS_FREE_LIST_H
+#define AVIUM_COLLECTIONS_FREE_LIST_H
+
+#include "avium/types.h"
+
+/**
+ * @brief A hook that links an object into an AvmFreeList.
+ *
+ * The hook is embedded as a member of the object, and containerof returns
+ * the object from a pointer to it. For slots that are only in the list while
+ * unused, the hook can share their storage, as a member of a union.
+ */
+typedef struct AvmFreeLink
+{
+    struct AvmFreeLink* _next;
+} AvmFreeLink;
+
+/**
+ * @brief An intrusive singly linked list used as a stack, such as the list
+ *        of free slots of a pool.
+ *
+ * The list links AvmFreeLink hooks that are embedded in the objects it holds,
+ * so its operations never allocate and take O(1) time. The most recently
+ * pushed object is popped first, and is the most likely to still be cached.
+ * The list does not own the objects.
+ */
+AVM_CLASS(AvmFreeList, object, {
+    uint _length;
+    AvmFreeLink* _head;
+});
+
+/**
+ * @brief Creates a new, empty AvmFreeList.
+ *
+ * @return The created instance.
+ */
+AVMAPI AvmFreeList AvmFreeListNew(void);
+
+/**
+ * @brief Links a hook at the top of an AvmFreeList.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p link must be not null.
+ *
+ * @param self The AvmFreeList instance.
+ * @param link The hook to link, which must not be in the list.
+ */
+AVMAPI void AvmFreeListPush(AvmFreeList* self, AvmFreeLink* link);
+
+/**
+ * @brief Links the hooks of an array of objects into an AvmFreeList, so that
+ *        the first object is popped first.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p items must be not null if @p count is not 0.
+ *
+ * @param self The AvmFreeList instance.
+ * @param count The number of objects.
+ * @param size The size of an object, which is the distance between hooks.
+ * @param items The hook of the first object.
+ */
+AVMAPI void AvmFreeListPushArray(AvmFreeList* self,
+                                 uint count,
+                                 size_t size,
+                                 AvmFreeLink* items);
+
+/**
+ * @brief Unlinks the top hook of an AvmFreeList.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmFreeList instance.
+ * @return The unlinked hook, or NULL if the list is empty.
+ */
+AVMAPI AvmFreeLink* AvmFreeListPop(AvmFreeList* self);
+
+/**
+ * @brief Returns the top hook of an AvmFreeList without unlinking it.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmFreeList instance.
+ * @return The top hook, or NULL if the list is empty.
+ */
+AVMAPI AvmFreeLink* AvmFreeListPeek(const AvmFreeList* self);
+
+#endif // AVIUM_COLLECTIONS_FREE_LIST_H
@@ -0,0 +1,45 @@
+#ifndef AVIUM_COLLECTIONS_HASH_MAP_H
+#define AVIUM_COLLECTIONS_HASH_MAP_H
+
+#include "avium/types.h"
+
+/**
+ * @brief An open-addressing hash map implementing AvmMap.
+ *
+ * Keys and values are stored inline, by value, like the items of an
+ * AvmArrayList. Keys are compared with the FnEntryEquals and hashed with the
+ * FnEntryHash entries of the key type, falling back to the key bytes when the
+ * type has no FnEntryEquals entry. Primitive and AvmString keys are compared
+ * and hashed directly.
+ *
+ * The table keeps one control byte per slot, which holds 7 bits of the key
+ * hash or marks the slot as empty or deleted. Lookups compare the control
+ * bytes of a whole group of slots at once and only compare keys whose hash
+ * bits match.
+ */
+AVM_CLASS(AvmHashMap, object, {
+    uint _length;
+    uint _capacity;
+    uint _growthLeft;
+    const AvmType* _keyType;
+    const AvmType* _valueType;
+    byte* _control;
+    byte* _items;
+});
+
+/**
+ * @brief Creates a new AvmHashMap.
+ *
+ * @pre Parameter @p keyType must be not null.
+ * @pre Parameter @p valueType must be not null.
+ *
+ * @param keyType The type of the keys.
+ * @param valueType The type of the values.
+ * @param capacity The number of entries to reserve space for.
+ * @return The created instance.
+ */
+AVMAPI AvmHashMap AvmHashMapNew(const AvmType* keyType,
+                                const AvmType* valueType,
+                                uint capacity);
+
+#endif // AVIUM_COLLECTIONS_HASH_MAP_H
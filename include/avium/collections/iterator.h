@@ -0,0 +1,122 @@
+#ifndef AVIUM_COLLECTIONS_ITERATOR_H
+#define AVIUM_COLLECTIONS_ITERATOR_H
+
+#include "avium/types.h"
+
+/**
+ * @brief Returns the contiguous run of items of a collection that starts at
+ *        an index.
+ *
+ * @param source The collection.
+ * @param index The index of the first item of the run, which is in range.
+ * @param length Holds the number of items left to iterate, and receives the
+ *               number of items in the run, which must be at least 1.
+ * @return A pointer to the first item of the run.
+ */
+typedef object (*AvmSpanFunc)(object source, uint index, uint* length);
+
+/**
+ * @brief An iterator over the items of a collection, in contiguous spans.
+ *
+ * Each call to AvmIteratorNext moves to the next span, whose items can then
+ * be accessed as an array. Contiguous collections have a single span, so
+ * algorithms walk their memory directly instead of making a virtual call per
+ * item.
+ *
+ * The iterator covers the items that existed when it was created. The
+ * collection must not be resized while it is iterated.
+ */
+AVM_CLASS(AvmIterator, object, {
+    object _source;
+    const AvmType* _itemType;
+    AvmSpanFunc _span;
+    byte* _items;
+    uint _index;
+    uint _length;
+    uint _end;
+});
+
+/**
+ * @brief Creates an AvmIterator over a collection.
+ *
+ * @pre Parameter @p itemType must be not null.
+ * @pre Parameter @p span must be not null.
+ *
+ * @param source The collection.
+ * @param itemType The type of the items.
+ * @param length The number of items to iterate.
+ * @param span The function that returns the contiguous runs of items.
+ * @return The created instance.
+ */
+AVMAPI AvmIterator AvmIteratorNew(object source,
+                                  const AvmType* itemType,
+                                  uint length,
+                                  AvmSpanFunc span);
+
+/**
+ * @brief Creates an AvmIterator over an array, with a single span.
+ *
+ * @pre Parameter @p itemType must be not null.
+ * @pre Parameter @p items must be not null if @p length is not 0.
+ *
+ * @param itemType The type of the items.
+ * @param length The number of items.
+ * @param items The array.
+ * @return The created instance.
+ */
+AVMAPI AvmIterator AvmIteratorFromArray(const AvmType* itemType,
+                                        uint length,
+                                        object items);
+
+/**
+ * @brief Moves an AvmIterator to the next span of items.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmIterator instance.
+ * @return false if there are no more items, otherwise true.
+ */
+AVMAPI bool AvmIteratorNext(AvmIterator* self);
+
+/**
+ * @brief Returns the items of the current span of an AvmIterator.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmIterator instance.
+ * @return A pointer to the first item of the span.
+ */
+AVMAPI object AvmIteratorGetItems(const AvmIterator* self);
+
+/**
+ * @brief Returns the number of items in the current span of an AvmIterator.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmIterator instance.
+ * @return The number of items in the span.
+ */
+AVMAPI uint AvmIteratorGetLength(const AvmIterator* self);
+
+/**
+ * @brief Returns the index in the collection of the first item of the
+ *        current span of an AvmIterator.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmIterator instance.
+ * @return The index of the first item of the span.
+ */
+AVMAPI uint AvmIteratorGetIndex(const AvmIterator* self);
+
+/**
+ * @brief Returns the item type of an AvmIterator.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmIterator instance.
+ * @return The type of the items.
+ */
+AVMAPI const AvmType* AvmIteratorGetItemType(const AvmIterator* self);
+
+#endif // AVIUM_COLLECTIONS_ITERATOR_H
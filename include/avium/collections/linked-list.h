@@ -0,0 +1,158 @@
+#ifndef AVIUM_COLLECTIONS_LINKED_LIST_H
+#define AVIUM_COLLECTIONS_LINKED_LIST_H
+
+#include "avium/types.h"
+
+/**
+ * @brief A hook that links an object into an AvmLinkedList.
+ *
+ * The hook is embedded as a member of the object, and containerof returns
+ * the object from a pointer to it. An object can be in as many lists at once
+ * as it has hooks.
+ */
+typedef struct AvmLink
+{
+    struct AvmLink* _next;
+    struct AvmLink* _previous;
+} AvmLink;
+
+/**
+ * @brief An intrusive doubly linked list.
+ *
+ * The list links AvmLink hooks that are embedded in the objects it holds, so
+ * its operations never allocate, and an object can be unlinked or moved in
+ * O(1) time given only a pointer to it, as in the chain of an LRU cache. The
+ * list does not own the objects.
+ */
+AVM_CLASS(AvmLinkedList, object, {
+    uint _length;
+    AvmLink* _first;
+    AvmLink* _last;
+});
+
+/**
+ * @brief Creates a new, empty AvmLinkedList.
+ *
+ * @return The created instance.
+ */
+AVMAPI AvmLinkedList AvmLinkedListNew(void);
+
+/**
+ * @brief Returns the first hook of an AvmLinkedList.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmLinkedList instance.
+ * @return The first hook, or NULL if the list is empty.
+ */
+AVMAPI AvmLink* AvmLinkedListGetFirst(const AvmLinkedList* self);
+
+/**
+ * @brief Returns the last hook of an AvmLinkedList.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmLinkedList instance.
+ * @return The last hook, or NULL if the list is empty.
+ */
+AVMAPI AvmLink* AvmLinkedListGetLast(const AvmLinkedList* self);
+
+/**
+ * @brief Links a hook before another in an AvmLinkedList.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p link must be not null.
+ *
+ * @param self The AvmLinkedList instance.
+ * @param position A hook of the list, or NULL to link at the end.
+ * @param link The hook to link, which must not be in the list.
+ */
+AVMAPI void AvmLinkedListInsertBefore(AvmLinkedList* self,
+                                      AvmLink* position,
+                                      AvmLink* link);
+
+/**
+ * @brief Links a hook at the start of an AvmLinkedList.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p link must be not null.
+ *
+ * @param self The AvmLinkedList instance.
+ * @param link The hook to link, which must not be in the list.
+ */
+AVMAPI void AvmLinkedListPushFront(AvmLinkedList* self, AvmLink* link);
+
+/**
+ * @brief Links a hook at the end of an AvmLinkedList.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p link must be not null.
+ *
+ * @param self The AvmLinkedList instance.
+ * @param link The hook to link, which must not be in the list.
+ */
+AVMAPI void AvmLinkedListPushBack(AvmLinkedList* self, AvmLink* link);
+
+/**
+ * @brief Unlinks a hook from an AvmLinkedList.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p link must be not null.
+ *
+ * @param self The AvmLinkedList instance.
+ * @param link A hook of the list.
+ */
+AVMAPI void AvmLinkedListRemove(AvmLinkedList* self, AvmLink* link);
+
+/**
+ * @brief Moves a hook of an AvmLinkedList to its start.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p link must be not null.
+ *
+ * @param self The AvmLinkedList instance.
+ * @param link A hook of the list.
+ */
+AVMAPI void AvmLinkedListMoveToFront(AvmLinkedList* self, AvmLink* link);
+
+/**
+ * @brief Unlinks the first hook of an AvmLinkedList.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmLinkedList instance.
+ * @return The unlinked hook, or NULL if the list is empty.
+ */
+AVMAPI AvmLink* AvmLinkedListPopFront(AvmLinkedList* self);
+
+/**
+ * @brief Unlinks the last hook of an AvmLinkedList.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmLinkedList instance.
+ * @return The unlinked hook, or NULL if the list is empty.
+ */
+AVMAPI AvmLink* AvmLinkedListPopBack(AvmLinkedList* self);
+
+/**
+ * @brief Returns the hook after another in its AvmLinkedList.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmLink instance.
+ * @return The next hook, or NULL if this is the last one.
+ */
+AVMAPI AvmLink* AvmLinkGetNext(const AvmLink* self);
+
+/**
+ * @brief Returns the hook before another in its AvmLinkedList.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmLink instance.
+ * @return The previous hook, or NULL if this is the first one.
+ */
+AVMAPI AvmLink* AvmLinkGetPrevious(const AvmLink* self);
+
+#endif // AVIUM_COLLECTIONS_LINKED_LIST_H
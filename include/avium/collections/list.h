@@ -24,6 +24,7 @@
 #ifndef AVIUM_COLLECTIONS_LIST_H
 #define AVIUM_COLLECTIONS_LIST_H
 
+#include "avium/collections/iterator.h"
 #include "avium/types.h"
 
 /// Interface for list-like collections.
@@ -73,6 +74,20 @@ AVMAPI const AvmType* AvmListGetItemType(const AvmList* self);
  */
 AVMAPI object AvmListItemAt(const AvmList* self, uint index);
 
+/**
+ * @brief Returns an AvmIterator over the items of an AvmList.
+ *
+ * Lists with contiguous storage provide an FnEntryGetIterator entry, which
+ * returns spans of their items. Other lists are iterated one item at a time
+ * with AvmListItemAt.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmList instance.
+ * @return The created iterator.
+ */
+AVMAPI AvmIterator AvmListGetIterator(const AvmList* self);
+
 /**
  * @brief Inserts an object at the specified index in an AvmList.
  *
@@ -100,6 +115,51 @@ AVMAPI void AvmListInsert(AvmList* self, uint index, object value);
  */
 AVMAPI void AvmListRemove(AvmList* self, uint index);
 
+/**
+ * @brief Inserts a range of objects at the specified index in an AvmList.
+ *
+ * The objects are copied from a contiguous array of items of the AvmList item
+ * type. The index must be less or equal to the collection length.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p items must be not null if @p count is not 0.
+ *
+ * @param self The AvmList instance.
+ * @param index The index to insert the objects at.
+ * @param count The number of objects to insert.
+ * @param items The objects to insert.
+ */
+AVMAPI void AvmListInsertRange(AvmList* self,
+                               uint index,
+                               uint count,
+                               const void* items);
+
+/**
+ * @brief Removes a range of objects from an AvmList, calling finalizers.
+ *
+ * The range must lie within the collection.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmList instance.
+ * @param index The index of the first object to remove.
+ * @param count The number of objects to remove.
+ */
+AVMAPI void AvmListRemoveRange(AvmList* self, uint index, uint count);
+
+/**
+ * @brief Removes the objects past the specified length from an AvmList,
+ *        calling finalizers.
+ *
+ * If the AvmList is not longer than @p length then nothing happens.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmList instance.
+ * @param length The length to truncate the AvmList to.
+ */
+AVMAPI void AvmListTruncate(AvmList* self, uint length);
+
 /**
  * @brief Removes all objects from an AvmList, calling finalizers.
  *
@@ -120,6 +180,31 @@ AVMAPI void AvmListClear(AvmList* self);
  */
 AVMAPI void AvmListPush(AvmList* self, object value);
 
+/**
+ * @brief Inserts a range of objects at the end of an AvmList.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p items must be not null if @p count is not 0.
+ *
+ * @param self The AvmList instance.
+ * @param count The number of objects to insert.
+ * @param items The objects to insert.
+ */
+AVMAPI void AvmListAddRange(AvmList* self, uint count, const void* items);
+
+/**
+ * @brief Inserts all objects of another AvmList at the end of an AvmList.
+ *
+ * Both lists must have the same item type.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p other must be not null.
+ *
+ * @param self The AvmList instance.
+ * @param other The AvmList to copy the objects from.
+ */
+AVMAPI void AvmListAddList(AvmList* self, const AvmList* other);
+
 /**
  * @brief Removes a value from the end of an AvmList.
  *
@@ -145,6 +230,10 @@ AVMAPI bool AvmListContains(const AvmList* self, object value);
 /**
  * @brief Returns the index of the first occurrence of a value in an AvmList.
  *
+ * Items are compared with the FnEntryEquals entry of the item type, or by
+ * their bytes if there is no such entry. Primitive items are compared many at
+ * a time with SIMD instructions where available.
+ *
  * @pre Parameter @p self must be not null.
  * @pre Parameter @p value must be not null.
  *
@@ -154,4 +243,55 @@ AVMAPI bool AvmListContains(const AvmList* self, object value);
  */
 AVMAPI uint AvmListIndexOf(const AvmList* self, object value);
 
+/**
+ * @brief Sorts an AvmList in ascending order.
+ *
+ * Items are ordered by the FnEntryCompare entry of the item type, or by
+ * AvmObjectCompare if there is no such entry. Primitive integers and floats
+ * are ordered by value without comparisons: short lists with a sorting
+ * network and long ones with a radix sort. The sort is not stable.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmList instance.
+ */
+AVMAPI void AvmListSort(AvmList* self);
+
+/**
+ * @brief Sorts an AvmList using a comparer.
+ *
+ * Items are moved in place, whatever their size. The sort is not stable.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p comparer must be not null.
+ *
+ * @param self The AvmList instance.
+ * @param comparer The function receiving references to two items.
+ */
+AVMAPI void AvmListSortBy(AvmList* self, AvmComparer comparer);
+
+/**
+ * @brief Sorts an AvmList in ascending order, keeping equal items in their
+ *        original order.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmList instance.
+ */
+AVMAPI void AvmListStableSort(AvmList* self);
+
+/**
+ * @brief Sorts an AvmList using a comparer, keeping equal items in their
+ *        original order.
+ *
+ * This allocates a buffer as large as the AvmList.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p comparer must be not null.
+ *
+ * @param self The AvmList instance.
+ * @param comparer The function receiving references to two items.
+ */
+AVMAPI void AvmListStableSortBy(AvmList* self, AvmComparer comparer);
+
 #endif // AVIUM_COLLECTIONS_LIST_H
@@ -0,0 +1,136 @@
+/**
+ * @file avium/map.h
+ * @author Vasilis Mylonas <vasilismylonas@protonmail.com>
+ * @brief Interface for map-like collections.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021 Vasilis Mylonas
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AVIUM_COLLECTIONS_MAP_H
+#define AVIUM_COLLECTIONS_MAP_H
+
+#include "avium/types.h"
+
+/// Interface for map-like collections.
+AVM_INTERFACE(AvmMap);
+
+/**
+ * @brief Returns the number of entries in an AvmMap.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmMap instance.
+ * @return The number of entries in the AvmMap.
+ */
+AVMAPI uint AvmMapGetLength(const AvmMap* self);
+
+/**
+ * @brief Returns the number of entries an AvmMap can hold without growing.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmMap instance.
+ * @return The capacity of the AvmMap.
+ */
+AVMAPI uint AvmMapGetCapacity(const AvmMap* self);
+
+/**
+ * @brief Returns the type of the keys.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmMap instance.
+ * @return The type of the keys.
+ */
+AVMAPI const AvmType* AvmMapGetKeyType(const AvmMap* self);
+
+/**
+ * @brief Returns the type of the values.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmMap instance.
+ * @return The type of the values.
+ */
+AVMAPI const AvmType* AvmMapGetValueType(const AvmMap* self);
+
+/**
+ * @brief Returns a reference to the value associated with a key in an
+ *        AvmMap.
+ *
+ * The reference is invalidated by the next insertion or removal.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p key must be not null.
+ *
+ * @param self The AvmMap instance.
+ * @param key The key.
+ * @return A reference to the value, or NULL if the key is not present.
+ */
+AVMAPI object AvmMapGet(const AvmMap* self, object key);
+
+/**
+ * @brief Associates a value with a key in an AvmMap.
+ *
+ * If the key is already present, its value is finalized and replaced and the
+ * stored key is kept.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p key must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmMap instance.
+ * @param key The key.
+ * @param value The value.
+ */
+AVMAPI void AvmMapInsert(AvmMap* self, object key, object value);
+
+/**
+ * @brief Removes a key and its value from an AvmMap, calling finalizers.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p key must be not null.
+ *
+ * @param self The AvmMap instance.
+ * @param key The key.
+ * @return true if the key was present, otherwise false.
+ */
+AVMAPI bool AvmMapRemove(AvmMap* self, object key);
+
+/**
+ * @brief Removes all entries from an AvmMap, calling finalizers.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmMap instance.
+ */
+AVMAPI void AvmMapClear(AvmMap* self);
+
+/**
+ * @brief Determines whether an AvmMap contains a key.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p key must be not null.
+ *
+ * @param self The AvmMap instance.
+ * @param key The key.
+ * @return true if the AvmMap contains the key, otherwise false.
+ */
+AVMAPI bool AvmMapContainsKey(const AvmMap* self, object key);
+
+#endif // AVIUM_COLLECTIONS_MAP_H
@@ -0,0 +1,105 @@
+#ifndef AVIUM_COLLECTIONS_MAPPED_ARRAY_LIST_H
+#define AVIUM_COLLECTIONS_MAPPED_ARRAY_LIST_H
+
+#include "avium/types.h"
+
+/**
+ * @brief An array list whose items live in a memory-mapped file,
+ *        implementing AvmList.
+ *
+ * The file starts with a small header that records the name and size of the
+ * item type and the length of the list, followed by the items, stored by
+ * value as in an AvmArrayList. Opening a file maps it, so it takes the same
+ * time for any length, and items are only read from disk when first accessed.
+ * Growing the list extends the file and remaps it, which may move the items.
+ *
+ * The length in the file only covers items that are on disk and unchanged
+ * since they were written. AvmMappedArrayListSync writes the items and then
+ * raises it to the length of the list. Before an item that it covers is
+ * changed in place, by AvmMappedArrayListSet or by inserting, removing or
+ * truncating, it is first lowered to exclude that item. After a crash, a file
+ * therefore holds the list of its last checkpoint, or a prefix of it.
+ * Writing to items through pointers returned by AvmListItemAt bypasses this.
+ *
+ * Items are copied to the file byte for byte and are never finalized, so the
+ * item type must not hold pointers or own resources.
+ */
+AVM_CLASS(AvmMappedArrayList, object, {
+    uint _length;
+    uint _capacity;
+    uint _syncedLength;
+    const AvmType* _itemType;
+    byte* _items;
+    byte* _view;
+    size_t _viewSize;
+    _long _file;
+    object _mapping;
+});
+
+/**
+ * @brief Opens an AvmMappedArrayList stored in a file, creating an empty one
+ *        if the file does not exist or is empty.
+ *
+ * Throws an OS error if the file could not be opened or mapped, and a format
+ * error if the file does not hold a list of the given type.
+ *
+ * @pre Parameter @p path must be not null.
+ * @pre Parameter @p type must be not null.
+ *
+ * @param path The path of the file.
+ * @param type The type of the items.
+ * @return The opened instance.
+ */
+AVMAPI AvmMappedArrayList AvmMappedArrayListOpen(str path,
+                                                 const AvmType* type);
+
+/**
+ * @brief Ensures that an AvmMappedArrayList can hold more items without
+ *        growing its file.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmMappedArrayList instance.
+ * @param count The number of items to make room for, past the current length.
+ */
+AVMAPI void AvmMappedArrayListReserve(AvmMappedArrayList* self, uint count);
+
+/**
+ * @brief Replaces an item of an AvmMappedArrayList.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmMappedArrayList instance.
+ * @param index The index of the item.
+ * @param value The value to copy.
+ *
+ * @throws RangeError if @p index is out of range.
+ */
+AVMAPI void AvmMappedArrayListSet(AvmMappedArrayList* self,
+                                  uint index,
+                                  object value);
+
+/**
+ * @brief Writes the items and then the length of an AvmMappedArrayList to its
+ *        file, waiting until they are on disk.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmMappedArrayList instance.
+ */
+AVMAPI void AvmMappedArrayListSync(AvmMappedArrayList* self);
+
+/**
+ * @brief Syncs an AvmMappedArrayList, shrinks its file to its length and
+ *        closes it.
+ *
+ * The instance is left empty and must not be used afterwards.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmMappedArrayList instance.
+ */
+AVMAPI void AvmMappedArrayListClose(AvmMappedArrayList* self);
+
+#endif // AVIUM_COLLECTIONS_MAPPED_ARRAY_LIST_H
@@ -0,0 +1,136 @@
+#ifndef AVIUM_COLLECTIONS_PARALLEL_H
+#define AVIUM_COLLECTIONS_PARALLEL_H
+
+#include "avium/collections/array-list.h"
+#include "avium/types.h"
+
+/**
+ * @brief Parallel algorithms over AvmArrayList.
+ *
+ * Each function splits the items into contiguous chunks, processes them on
+ * one thread per processor and joins the threads before returning. Lists
+ * shorter than AVM_PARALLEL_CUTOFF items are processed on the calling thread,
+ * where starting threads would cost more than it saves.
+ *
+ * Callbacks may be called from several threads at once, so they must be
+ * thread-safe, and they must not throw, because errors can only be caught on
+ * the thread that threw them.
+ */
+
+/// A function that writes the result of mapping an item to result.
+typedef void (*AvmMapper)(object item, object result);
+
+/// A function that returns whether an item should be kept.
+typedef bool (*AvmPredicate)(object item);
+
+/// A function that combines an item into an accumulator.
+typedef void (*AvmReducer)(object accumulator, object item);
+
+/**
+ * @brief Sorts an AvmArrayList in ascending order, in parallel.
+ *
+ * Items are ordered like in AvmListSort. The sort is not stable.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmArrayList instance.
+ */
+AVMAPI void AvmArrayListParallelSort(AvmArrayList* self);
+
+/**
+ * @brief Sorts an AvmArrayList with a comparer, in parallel.
+ *
+ * The sort is not stable.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p comparer must be not null.
+ *
+ * @param self The AvmArrayList instance.
+ * @param comparer The function that compares two items.
+ */
+AVMAPI void AvmArrayListParallelSortBy(AvmArrayList* self,
+                                       AvmComparer comparer);
+
+/**
+ * @brief Returns the index of the first occurrence of a value, searching in
+ *        parallel.
+ *
+ * Items are compared with the FnEntryEquals entry of the item type, or
+ * byte-by-byte if there is no such entry.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmArrayList instance.
+ * @param value The value.
+ * @return The index of the value, or AvmInvalid.
+ */
+AVMAPI uint AvmArrayListParallelIndexOf(const AvmArrayList* self,
+                                        object value);
+
+/**
+ * @brief Determines whether an AvmArrayList contains a value, searching in
+ *        parallel.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmArrayList instance.
+ * @param value The value.
+ * @return true if the value is found, otherwise false.
+ */
+AVMAPI bool AvmArrayListParallelContains(const AvmArrayList* self,
+                                         object value);
+
+/**
+ * @brief Maps every item of an AvmArrayList to a new list, in parallel.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p resultType must be not null.
+ * @pre Parameter @p mapper must be not null.
+ *
+ * @param self The AvmArrayList instance.
+ * @param resultType The item type of the new list.
+ * @param mapper The function that writes the result for each item.
+ * @return A list with the results, in the order of the items.
+ */
+AVMAPI AvmArrayList AvmArrayListParallelMap(const AvmArrayList* self,
+                                            const AvmType* resultType,
+                                            AvmMapper mapper);
+
+/**
+ * @brief Copies the items that satisfy a predicate to a new list, in
+ *        parallel.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p predicate must be not null.
+ *
+ * @param self The AvmArrayList instance.
+ * @param predicate The function that decides which items are kept.
+ * @return A list with the kept items, in their original order.
+ */
+AVMAPI AvmArrayList AvmArrayListParallelFilter(const AvmArrayList* self,
+                                               AvmPredicate predicate);
+
+/**
+ * @brief Reduces the items of an AvmArrayList, in parallel.
+ *
+ * The accumulator must initially hold the identity of the reduction, for
+ * example 0 for a sum. Each chunk is reduced into a copy of it, and the
+ * partial results are then combined into the accumulator in order, by
+ * calling the reducer with a partial result as the item. The reducer must
+ * therefore be associative and accept accumulators as items.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p accumulator must be not null.
+ * @pre Parameter @p reducer must be not null.
+ *
+ * @param self The AvmArrayList instance.
+ * @param accumulator The accumulator, of the item type.
+ * @param reducer The function that combines an item into an accumulator.
+ */
+AVMAPI void AvmArrayListParallelReduce(const AvmArrayList* self,
+                                       object accumulator,
+                                       AvmReducer reducer);
+
+#endif // AVIUM_COLLECTIONS_PARALLEL_H
@@ -0,0 +1,156 @@
+#ifndef AVIUM_COLLECTIONS_PRIORITY_QUEUE_H
+#define AVIUM_COLLECTIONS_PRIORITY_QUEUE_H
+
+#include "avium/types.h"
+
+/**
+ * @brief A priority queue of items stored inline, as a 4-ary min-heap.
+ *
+ * The item that orders first is at the front. Each node of the heap has four
+ * children stored next to each other, so the heap is half as deep as a binary
+ * one and the children compared at each level share a cache line or two.
+ *
+ * Every item has a handle, which stays valid while the item is in the queue
+ * and is used to find the item again with AvmPriorityQueueDecreaseKey.
+ *
+ * A bounded queue keeps only the largest items pushed to it, up to a limit.
+ * Once full, items that do not order after the front are discarded, and
+ * other items replace the front, so it never allocates after creation.
+ */
+AVM_CLASS(AvmPriorityQueue, object, {
+    uint _length;
+    uint _capacity;
+    bool _bounded;
+    const AvmType* _itemType;
+    AvmComparer _comparer;
+    byte* _items;     // Followed by room for one more item, used as scratch.
+    uint* _handles;   // The handle of each item, then the free handles.
+    uint* _positions; // The index of each handle in _handles.
+});
+
+/**
+ * @brief Creates a new AvmPriorityQueue.
+ *
+ * @pre Parameter @p type must be not null.
+ *
+ * @param type The type of the items.
+ * @param comparer The function that orders the items, or NULL to order them
+ *                 with the FnEntryCompare entry of the item type.
+ * @param capacity The number of items to reserve space for.
+ * @return The created instance.
+ */
+AVMAPI AvmPriorityQueue AvmPriorityQueueNew(const AvmType* type,
+                                            AvmComparer comparer,
+                                            uint capacity);
+
+/**
+ * @brief Creates a new AvmPriorityQueue that keeps the largest items pushed
+ *        to it.
+ *
+ * @pre Parameter @p type must be not null.
+ *
+ * @param type The type of the items.
+ * @param comparer The function that orders the items, or NULL to order them
+ *                 with the FnEntryCompare entry of the item type.
+ * @param limit The most items to keep.
+ * @return The created instance.
+ */
+AVMAPI AvmPriorityQueue AvmPriorityQueueNewBounded(const AvmType* type,
+                                                   AvmComparer comparer,
+                                                   uint limit);
+
+/**
+ * @brief Adds an item to an AvmPriorityQueue.
+ *
+ * If the queue is bounded and full, the item is discarded if it does not
+ * order after the front, and otherwise replaces the front, which is
+ * finalized. A discarded item is left to the caller.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmPriorityQueue instance.
+ * @param value The item to copy.
+ * @return The handle of the item, or AvmInvalid if it was discarded.
+ */
+AVMAPI uint AvmPriorityQueuePush(AvmPriorityQueue* self, object value);
+
+/**
+ * @brief Adds a range of items to an AvmPriorityQueue.
+ *
+ * When the items are many compared to the queue, the items are appended and
+ * the heap is rebuilt bottom-up in O(n) time, instead of being pushed one at a
+ * time. A bounded queue is filled up to its limit this way, and the rest of
+ * the items are pushed as with AvmPriorityQueuePush, with discarded items left
+ * to the caller.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p items must be not null if @p count is not 0.
+ *
+ * @param self The AvmPriorityQueue instance.
+ * @param count The number of items.
+ * @param items A contiguous array of items of the AvmPriorityQueue item type.
+ */
+AVMAPI void AvmPriorityQueuePushMany(AvmPriorityQueue* self,
+                                     uint count,
+                                     const void* items);
+
+/**
+ * @brief Returns the item at the front of an AvmPriorityQueue.
+ *
+ * An error is thrown if the AvmPriorityQueue is empty.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmPriorityQueue instance.
+ * @return A pointer to the item that orders first.
+ */
+AVMAPI object AvmPriorityQueuePeek(const AvmPriorityQueue* self);
+
+/**
+ * @brief Removes the item at the front of an AvmPriorityQueue.
+ *
+ * The item is moved to @p destination, so its finalizer is not called. If
+ * @p destination is NULL, the item is finalized instead. An error is thrown
+ * if the AvmPriorityQueue is empty.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmPriorityQueue instance.
+ * @param destination Receives the item, or NULL.
+ */
+AVMAPI void AvmPriorityQueuePop(AvmPriorityQueue* self, object destination);
+
+/**
+ * @brief Replaces an item of an AvmPriorityQueue with one that orders before
+ *        it or equal to it, moving it towards the front.
+ *
+ * The replaced item is finalized and the handle refers to the new item.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmPriorityQueue instance.
+ * @param handle The handle of the item, returned by AvmPriorityQueuePush.
+ * @param value The item to copy.
+ *
+ * @throws ArgError if the handle does not refer to an item in the queue, or
+ *         if the new item orders after the one it replaces.
+ */
+AVMAPI void AvmPriorityQueueDecreaseKey(AvmPriorityQueue* self,
+                                        uint handle,
+                                        object value);
+
+/**
+ * @brief Returns the item of an AvmPriorityQueue that a handle refers to.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmPriorityQueue instance.
+ * @param handle The handle of the item.
+ * @return A pointer to the item, or NULL if the handle does not refer to an
+ *         item in the queue.
+ */
+AVMAPI object AvmPriorityQueueGet(const AvmPriorityQueue* self, uint handle);
+
+#endif // AVIUM_COLLECTIONS_PRIORITY_QUEUE_H
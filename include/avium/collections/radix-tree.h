@@ -0,0 +1,145 @@
+#ifndef AVIUM_COLLECTIONS_RADIX_TREE_H
+#define AVIUM_COLLECTIONS_RADIX_TREE_H
+
+#include "avium/types.h"
+
+/**
+ * @brief A function called for each entry visited by
+ *        AvmRadixTreeForEachWithPrefix.
+ *
+ * @param length The length of the key.
+ * @param key The bytes of the key, which are not null-terminated.
+ * @param value The value of the entry.
+ * @param context The context passed to AvmRadixTreeForEachWithPrefix.
+ */
+typedef void (*AvmRadixTreeVisitor)(uint length,
+                                    str key,
+                                    object value,
+                                    object context);
+
+/**
+ * @brief A map from byte strings to values implementing AvmMap, built as an
+ *        adaptive radix tree.
+ *
+ * Each inner node branches on one byte of the key and grows through four
+ * layouts as children are added: up to 4, 16 or 48 sorted or indexed
+ * children, or a full table of 256. Chains of nodes with a single child are
+ * collapsed into a prefix of the node below them, so lookups take one step
+ * per distinct byte and small nodes stay within a cache line or two. The
+ * entries of a node are in byte order, so the entries that share a prefix
+ * are found together, in lexicographic order.
+ *
+ * Keys may contain any bytes, and one key may be a prefix of another. Values
+ * are stored by value with a copy of their key, and do not move until their
+ * entry is removed, so their addresses can be kept, as in an interning table.
+ * Through AvmMap, the keys are AvmString instances whose contents are copied.
+ */
+AVM_CLASS(AvmRadixTree, object, {
+    uint _length;
+    const AvmType* _valueType;
+    object _root; // A node, or a leaf with its lowest address bit set.
+});
+
+/**
+ * @brief Creates a new AvmRadixTree.
+ *
+ * @pre Parameter @p valueType must be not null.
+ *
+ * @param valueType The type of the values.
+ * @return The created instance.
+ */
+AVMAPI AvmRadixTree AvmRadixTreeNew(const AvmType* valueType);
+
+/**
+ * @brief Inserts or replaces an entry of an AvmRadixTree.
+ *
+ * A replaced value is finalized with the FnEntryDtor entry of its type.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p key must be not null if @p length is not 0.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmRadixTree instance.
+ * @param length The length of the key.
+ * @param key The bytes of the key, which are copied.
+ * @param value The value to copy.
+ */
+AVMAPI void AvmRadixTreeInsert(AvmRadixTree* self,
+                               uint length,
+                               str key,
+                               object value);
+
+/**
+ * @brief Returns the value of a key of an AvmRadixTree.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p key must be not null if @p length is not 0.
+ *
+ * @param self The AvmRadixTree instance.
+ * @param length The length of the key.
+ * @param key The bytes of the key.
+ * @return The value, or NULL if the key was not found.
+ */
+AVMAPI object AvmRadixTreeGet(const AvmRadixTree* self, uint length, str key);
+
+/**
+ * @brief Removes an entry of an AvmRadixTree.
+ *
+ * The value is finalized with the FnEntryDtor entry of its type.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p key must be not null if @p length is not 0.
+ *
+ * @param self The AvmRadixTree instance.
+ * @param length The length of the key.
+ * @param key The bytes of the key.
+ * @return true if the key was found.
+ */
+AVMAPI bool AvmRadixTreeRemove(AvmRadixTree* self, uint length, str key);
+
+/**
+ * @brief Finds the longest key of an AvmRadixTree that is a prefix of a
+ *        string.
+ *
+ * This answers questions such as which route handles a path, in a single
+ * walk down the tree.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p key must be not null if @p length is not 0.
+ *
+ * @param self The AvmRadixTree instance.
+ * @param length The length of the string.
+ * @param key The bytes of the string.
+ * @param matchLength Receives the length of the key that was found, if not
+ *                    null.
+ * @return The value of the key, or NULL if no key is a prefix of the string.
+ */
+AVMAPI object AvmRadixTreeMatchLongest(const AvmRadixTree* self,
+                                       uint length,
+                                       str key,
+                                       uint* matchLength);
+
+/**
+ * @brief Calls a function for each entry of an AvmRadixTree whose key starts
+ *        with a prefix, in lexicographic order of the keys.
+ *
+ * The tree must not be modified by the function.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p prefix must be not null if @p length is not 0.
+ * @pre Parameter @p visitor must be not null.
+ *
+ * @param self The AvmRadixTree instance.
+ * @param length The length of the prefix, which can be 0 to visit every
+ *               entry.
+ * @param prefix The bytes of the prefix.
+ * @param visitor The function to call.
+ * @param context A value passed to each call.
+ */
+AVMAPI void AvmRadixTreeForEachWithPrefix(const AvmRadixTree* self,
+                                          uint length,
+                                          str prefix,
+                                          AvmRadixTreeVisitor visitor,
+                                          object context);
+
+#endif // AVIUM_COLLECTIONS_RADIX_TREE_H
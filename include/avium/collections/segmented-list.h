@@ -0,0 +1,48 @@
+#ifndef AVIUM_COLLECTIONS_SEGMENTED_LIST_H
+#define AVIUM_COLLECTIONS_SEGMENTED_LIST_H
+
+#include "avium/types.h"
+
+/**
+ * @brief A list with stable item addresses, implementing AvmList.
+ *
+ * Items are stored by value in segments whose sizes are successive powers of
+ * two, so the segment of an item is found from the highest set bit of its
+ * index. Growing the list allocates a new segment and never moves or copies
+ * the existing items. Pointers returned by AvmListItemAt therefore stay valid
+ * until items are inserted or removed before them.
+ */
+AVM_CLASS(AvmSegmentedList, object, {
+    uint _length;
+    uint _capacity;
+    const AvmType* _itemType;
+    uint _segmentCount;
+    byte** _segments;
+});
+
+/**
+ * @brief Creates a new AvmSegmentedList.
+ *
+ * @pre Parameter @p type must be not null.
+ *
+ * @param type The type of the items.
+ * @param capacity The number of items to reserve space for.
+ * @return The created instance.
+ */
+AVMAPI AvmSegmentedList AvmSegmentedListNew(const AvmType* type,
+                                            uint capacity);
+
+/**
+ * @brief Adds an item at the end of an AvmSegmentedList.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p value must be not null.
+ *
+ * @param self The AvmSegmentedList instance.
+ * @param value The item to copy.
+ * @return A pointer to the stored item, which stays valid while the list
+ *         grows.
+ */
+AVMAPI object AvmSegmentedListPush(AvmSegmentedList* self, object value);
+
+#endif // AVIUM_COLLECTIONS_SEGMENTED_LIST_H
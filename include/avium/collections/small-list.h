@@ -0,0 +1,99 @@
+#ifndef AVIUM_COLLECTIONS_SMALL_LIST_H
+#define AVIUM_COLLECTIONS_SMALL_LIST_H
+
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+#include "avium/types.h"
+
+/**
+ * @brief A list that stores its first items inline, implementing AvmList.
+ *
+ * An AvmSmallList is always declared with AVM_SMALL_LIST_OF, which places
+ * room for a fixed number of items right after it. Items are kept there until
+ * that room runs out, and only then moved to a buffer on the heap, which
+ * grows like the buffer of an AvmArrayList. While the items are inline the
+ * list makes no allocations at all.
+ *
+ * An inline list can be copied by value, since its items are found relative
+ * to the list itself.
+ */
+AVM_CLASS(AvmSmallList, object, {
+    uint _length;
+    uint _capacity;
+    const AvmType* _itemType;
+    byte* _items; // NULL while the items are inline.
+});
+
+/**
+ * @brief Creates the header of an AvmSmallList.
+ *
+ * This is used by the functions declared with AVM_SMALL_LIST_OF, which also
+ * provide the inline storage.
+ *
+ * @pre Parameter @p type must be not null.
+ *
+ * @param type The type of the items.
+ * @param inlineCapacity The number of items that fit in the inline storage.
+ * @return The created instance.
+ */
+AVMAPI AvmSmallList AvmSmallListNew(const AvmType* type, uint inlineCapacity);
+
+/**
+ * @brief Determines whether the items of an AvmSmallList are stored inline.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmSmallList instance.
+ * @return true if the list has not moved its items to the heap.
+ */
+AVMAPI bool AvmSmallListIsInline(const AvmSmallList* self);
+
+/// Returns the name of the small list of T with room for N inline items.
+#define AvmSmallListOf(T, N) AVM_CONCAT(AvmSmallListOf_##T##_, N)
+
+#define AVM_SMALL_LIST_FN_(T, N, F)                                            \
+    AVM_CONCAT(AvmSmallListOf(T, N), AVM_CONCAT(_, F))
+
+/**
+ * @brief Declares an AvmSmallList of T with room for N inline items, named
+ *        AvmSmallListOf(T, N).
+ *
+ * For a list of 8 ints the following are declared:
+ *
+ * - AvmSmallListOf_int_8_New(), returning an empty list
+ * - AvmSmallListOf_int_8_AsList(self), returning the AvmList*
+ *
+ * T must be a single identifier with type info, that is a primitive type or
+ * a type declared with AVM_CLASS, whose alignment is at most that of a
+ * pointer.
+ *
+ * @param T The item type.
+ * @param N The number of items stored inline.
+ */
+#define AVM_SMALL_LIST_OF(T, N)                                                \
+    typedef struct AvmSmallListOf(T, N)                                        \
+    {                                                                          \
+        AvmSmallList _list;                                                    \
+        T _inline[N];                                                          \
+    }                                                                          \
+    AvmSmallListOf(T, N);                                                      \
+                                                                               \
+    static_assert_s(offsetof(AvmSmallListOf(T, N), _inline) ==                 \
+                    sizeof(AvmSmallList));                                     \
+                                                                               \
+    static inline AvmSmallListOf(T, N) AVM_SMALL_LIST_FN_(T, N, New)(void)     \
+    {                                                                          \
+        AvmSmallListOf(T, N) self;                                             \
+        self._list = AvmSmallListNew(typeid(T), N);                            \
+        return self;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline AvmSmallList* AVM_SMALL_LIST_FN_(T, N, AsList)(              \
+        AvmSmallListOf(T, N) * self)                                           \
+    {                                                                          \
+        return &self->_list;                                                   \
+    }                                                                          \
+                                                                               \
+    static_assert_s(true)
+
+#endif // AVIUM_COLLECTIONS_SMALL_LIST_H
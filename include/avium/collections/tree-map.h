@@ -0,0 +1,146 @@
+#ifndef AVIUM_COLLECTIONS_TREE_MAP_H
+#define AVIUM_COLLECTIONS_TREE_MAP_H
+
+#include "avium/collections/array-list.h"
+#include "avium/types.h"
+
+struct AvmTreeNode;
+
+/**
+ * @brief An ordered map implementing AvmMap, built as a B+tree.
+ *
+ * Keys and values are stored inline, by value, in the leaves of the tree,
+ * which are linked in key order. The keys of a node are kept together and
+ * take a few cache lines, so each node is searched with few memory accesses
+ * and the tree stays shallow. Keys are ordered by a comparer, or by the
+ * FnEntryCompare entry of the key type. Integer keys in their natural order
+ * are compared directly, without calling a function.
+ */
+AVM_CLASS(AvmTreeMap, object, {
+    uint _length;
+    uint _order; // The most keys a node holds.
+    uint _height;
+    uint _leafCount;
+    const AvmType* _keyType;
+    const AvmType* _valueType;
+    AvmComparer _comparer; // NULL for integer keys in their natural order.
+    struct AvmTreeNode* _root;
+});
+
+/**
+ * @brief A range of entries of an AvmTreeMap, iterated in key order in
+ *        contiguous spans.
+ *
+ * Each call to AvmTreeMapRangeNext moves to the next span, whose keys and
+ * values can then be accessed as two arrays. The map must not be modified
+ * while a range of it is iterated.
+ */
+AVM_CLASS(AvmTreeMapRange, object, {
+    const AvmTreeMap* _map;
+    object _high;
+    const struct AvmTreeNode* _current;
+    const struct AvmTreeNode* _next;
+    uint _nextIndex;
+    uint _index;
+    uint _length;
+});
+
+/**
+ * @brief Creates a new AvmTreeMap.
+ *
+ * @pre Parameter @p keyType must be not null.
+ * @pre Parameter @p valueType must be not null.
+ *
+ * @param keyType The type of the keys.
+ * @param valueType The type of the values.
+ * @param comparer The function that orders the keys, or NULL to order them
+ *                 with the FnEntryCompare entry of the key type.
+ * @return The created instance.
+ */
+AVMAPI AvmTreeMap AvmTreeMapNew(const AvmType* keyType,
+                                const AvmType* valueType,
+                                AvmComparer comparer);
+
+/**
+ * @brief Creates an AvmTreeMap from sorted keys and their values.
+ *
+ * The tree is built bottom-up, one level at a time, in O(n) time. The keys
+ * and values are copied by value, so the map takes over any resources they
+ * own, as with AvmMapInsert.
+ *
+ * @pre Parameter @p keys must be not null.
+ * @pre Parameter @p values must be not null.
+ *
+ * @param keys The keys, in strictly increasing order.
+ * @param values The values, one for each key.
+ * @param comparer The function that orders the keys, or NULL to order them
+ *                 with the FnEntryCompare entry of the key type.
+ * @return The created instance.
+ *
+ * @throws ArgError if the lists have different lengths or the keys are not in
+ *         strictly increasing order.
+ */
+AVMAPI AvmTreeMap AvmTreeMapFromSorted(const AvmArrayList* keys,
+                                       const AvmArrayList* values,
+                                       AvmComparer comparer);
+
+/**
+ * @brief Returns the entries of an AvmTreeMap whose keys are in a range.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmTreeMap instance.
+ * @param low The smallest key of the range, or NULL to start at the first
+ *            entry.
+ * @param high The key that ends the range, which is not included, or NULL to
+ *             end at the last entry. It must stay valid while the range is
+ *             iterated.
+ * @return The range, positioned before its first span.
+ */
+AVMAPI AvmTreeMapRange AvmTreeMapGetRange(const AvmTreeMap* self,
+                                          object low,
+                                          object high);
+
+/**
+ * @brief Moves an AvmTreeMapRange to its next span.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmTreeMapRange instance.
+ * @return true if there is another span, false if the range is exhausted.
+ */
+AVMAPI bool AvmTreeMapRangeNext(AvmTreeMapRange* self);
+
+/**
+ * @brief Returns the keys of the current span of an AvmTreeMapRange.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmTreeMapRange instance.
+ * @return A pointer to the first of AvmTreeMapRangeGetLength keys.
+ */
+AVMAPI object AvmTreeMapRangeGetKeys(const AvmTreeMapRange* self);
+
+/**
+ * @brief Returns the values of the current span of an AvmTreeMapRange.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmTreeMapRange instance.
+ * @return A pointer to the first of AvmTreeMapRangeGetLength values, which
+ *         belong to the keys of the span in the same order.
+ */
+AVMAPI object AvmTreeMapRangeGetValues(const AvmTreeMapRange* self);
+
+/**
+ * @brief Returns the number of entries in the current span of an
+ *        AvmTreeMapRange.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmTreeMapRange instance.
+ * @return The number of entries, which is 0 before the first span.
+ */
+AVMAPI uint AvmTreeMapRangeGetLength(const AvmTreeMapRange* self);
+
+#endif // AVIUM_COLLECTIONS_TREE_MAP_H
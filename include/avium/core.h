@@ -72,6 +72,40 @@ AVMAPI const AvmType* AvmObjectGetType(object self);
  */
 AVMAPI bool AvmObjectEquals(object self, object other);
 
+/**
+ * @brief Computes a hash value for an object.
+ *
+ * This function tries to use the FnEntryHash virtual function entry. If no
+ * such virtual function is available then the object is hashed byte-by-byte.
+ *
+ * Objects that are equal according to AvmObjectEquals must have the same hash
+ * value.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The object instance.
+ * @return The hash value of the object.
+ */
+AVMAPI ulong AvmObjectHash(object self);
+
+/**
+ * @brief Compares two objects for ordering.
+ *
+ * This function tries to use the FnEntryCompare virtual function entry. If no
+ * such virtual function is available then the objects are compared
+ * byte-by-byte, which orders them consistently with AvmObjectEquals but has
+ * no further meaning.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p other must be not null.
+ *
+ * @param self The first object.
+ * @param other The second object.
+ * @return A negative number, 0 or a positive number if the first object is
+ *         less than, equal to or greater than the second.
+ */
+AVMAPI int AvmObjectCompare(object self, object other);
+
 /**
  * @brief Destroys an object.
  *
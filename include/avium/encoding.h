@@ -0,0 +1,121 @@
+/**
+ * @file avium/encoding.h
+ * @author Vasilis Mylonas <vasilismylonas@protonmail.com>
+ * @brief Base64 and hexadecimal encoding.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021 Vasilis Mylonas
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AVIUM_ENCODING_H
+#define AVIUM_ENCODING_H
+
+#include "avium/string.h"
+
+/// Defines the alphabet used for base64 encoding.
+typedef enum
+{
+    /// The standard alphabet (RFC 4648 section 4), with padding.
+    Base64Standard = 0,
+
+    /// The URL and filename safe alphabet (RFC 4648 section 5), without
+    /// padding.
+    Base64UrlSafe,
+} AvmBase64Variant;
+
+/**
+ * @brief Returns the number of characters needed to base64 encode some bytes.
+ *
+ * @param length The number of bytes.
+ * @param variant The base64 variant.
+ * @return The number of characters.
+ */
+AVMAPI uint AvmBase64GetEncodedLength(uint length, AvmBase64Variant variant);
+
+/**
+ * @brief Base64 encodes a sequence of bytes and appends the result to an
+ * AvmString.
+ *
+ * The required capacity is reserved once, before anything is written.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p bytes must be not null if @p length is not 0.
+ *
+ * @param self The AvmString to append the characters to.
+ * @param length The number of bytes.
+ * @param bytes The bytes to encode.
+ * @param variant The base64 variant.
+ */
+AVMAPI void AvmBase64Encode(AvmString* self,
+                            uint length,
+                            const byte bytes[],
+                            AvmBase64Variant variant);
+
+/**
+ * @brief Decodes base64 characters and appends the bytes to an AvmString.
+ *
+ * Padding is optional for both variants, but if present it must complete the
+ * last group of 4 characters. Whitespace is not accepted.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p chars must be not null if @p length is not 0.
+ *
+ * @param self The AvmString to append the bytes to.
+ * @param length The number of characters.
+ * @param chars The characters to decode.
+ * @param variant The base64 variant.
+ * @return true on success, false if @p chars is not valid base64. In that case
+ *         @p self is left unchanged.
+ */
+AVMAPI bool AvmBase64Decode(AvmString* self,
+                            uint length,
+                            str chars,
+                            AvmBase64Variant variant);
+
+/**
+ * @brief Hex encodes a sequence of bytes and appends the result to an
+ * AvmString.
+ *
+ * Two lowercase hexadecimal digits are written for every byte.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p bytes must be not null if @p length is not 0.
+ *
+ * @param self The AvmString to append the characters to.
+ * @param length The number of bytes.
+ * @param bytes The bytes to encode.
+ */
+AVMAPI void AvmHexEncode(AvmString* self, uint length, const byte bytes[]);
+
+/**
+ * @brief Decodes hexadecimal digits and appends the bytes to an AvmString.
+ *
+ * Both uppercase and lowercase digits are accepted.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p chars must be not null if @p length is not 0.
+ *
+ * @param self The AvmString to append the bytes to.
+ * @param length The number of characters.
+ * @param chars The characters to decode.
+ * @return true on success, false if @p length is odd or @p chars contains
+ *         something other than hexadecimal digits. In that case @p self is
+ *         left unchanged.
+ */
+AVMAPI bool AvmHexDecode(AvmString* self, uint length, str chars);
+
+#endif // AVIUM_ENCODING_H
@@ -0,0 +1,87 @@
+/**
+ * @file avium/hash.h
+ * @author Vasilis Mylonas <vasilismylonas@protonmail.com>
+ * @brief Hashing utilities.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021 Vasilis Mylonas
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AVIUM_HASH_H
+#define AVIUM_HASH_H
+
+#include "avium/types.h"
+
+/**
+ * @brief Hashes a sequence of bytes.
+ *
+ * This is a fast non-cryptographic hash (from the wyhash family). It is not
+ * suitable for keys that may be controlled by an attacker, use
+ * AvmHashBytesKeyed for those instead.
+ *
+ * @pre Parameter @p bytes must be not null if @p length is not 0.
+ *
+ * @param length The number of bytes to hash.
+ * @param bytes The bytes to hash.
+ * @return The hash value.
+ */
+AVMAPI ulong AvmHashBytes(size_t length, const void* bytes);
+
+/**
+ * @brief Hashes a sequence of bytes using a seed.
+ *
+ * @pre Parameter @p bytes must be not null if @p length is not 0.
+ *
+ * @param length The number of bytes to hash.
+ * @param bytes The bytes to hash.
+ * @param seed The seed value.
+ * @return The hash value.
+ */
+AVMAPI ulong AvmHashBytesSeeded(size_t length, const void* bytes, ulong seed);
+
+/**
+ * @brief Hashes a sequence of bytes using SipHash-2-4 with a secret key.
+ *
+ * This is slower than AvmHashBytes but resistant to hash flooding, as long as
+ * the key is kept secret.
+ *
+ * @pre Parameter @p bytes must be not null if @p length is not 0.
+ *
+ * @param length The number of bytes to hash.
+ * @param bytes The bytes to hash.
+ * @param key0 The first half of the 128-bit key.
+ * @param key1 The second half of the 128-bit key.
+ * @return The hash value.
+ */
+AVMAPI ulong AvmHashBytesKeyed(size_t length,
+                               const void* bytes,
+                               ulong key0,
+                               ulong key1);
+
+/**
+ * @brief Combines two hash values into one.
+ *
+ * This is useful for implementing FnEntryHash for types with multiple
+ * members.
+ *
+ * @param seed The accumulated hash value.
+ * @param hash The hash value to combine.
+ * @return The combined hash value.
+ */
+AVMAPI ulong AvmHashCombine(ulong seed, ulong hash);
+
+#endif // AVIUM_HASH_H
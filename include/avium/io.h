@@ -28,7 +28,9 @@
 
 #ifdef AVM_USE_IO
 
+#include "avium/collections/list.h"
 #include "avium/core.h"
+#include "avium/encoding.h"
 #include "avium/error.h"
 
 /// Represents a C file handle.
@@ -216,6 +218,101 @@ AVMAPI AvmString AvmStreamReadLine(AvmStream* self, AvmError** error);
  */
 AVMAPI AvmError* AvmStreamWriteLine(AvmStream* self, AvmString* string);
 
+/**
+ * @brief Base64 encodes bytes read from an AvmStream and writes the characters
+ * to another.
+ *
+ * The input is processed in fixed size chunks, so memory use does not depend
+ * on @p length.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p destination must be not null.
+ *
+ * @param self The AvmStream to read from.
+ * @param destination The AvmStream to write to.
+ * @param length The number of bytes to read.
+ * @param variant The base64 variant.
+ * @return The result of the IO operation.
+ */
+AVMAPI AvmError* AvmStreamEncodeBase64(AvmStream* self,
+                                       AvmStream* destination,
+                                       size_t length,
+                                       AvmBase64Variant variant);
+
+/**
+ * @brief Decodes base64 characters read from an AvmStream and writes the bytes
+ * to another.
+ *
+ * The input is processed in fixed size chunks, so memory use does not depend
+ * on @p length. If the input is not valid base64 the chunks before the invalid
+ * one have already been written.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p destination must be not null.
+ *
+ * @param self The AvmStream to read from.
+ * @param destination The AvmStream to write to.
+ * @param length The number of characters to read.
+ * @param variant The base64 variant.
+ * @return The result of the IO operation.
+ */
+AVMAPI AvmError* AvmStreamDecodeBase64(AvmStream* self,
+                                       AvmStream* destination,
+                                       size_t length,
+                                       AvmBase64Variant variant);
+
+/**
+ * @brief Hex encodes bytes read from an AvmStream and writes the characters to
+ * another.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p destination must be not null.
+ *
+ * @param self The AvmStream to read from.
+ * @param destination The AvmStream to write to.
+ * @param length The number of bytes to read.
+ * @return The result of the IO operation.
+ */
+AVMAPI AvmError* AvmStreamEncodeHex(AvmStream* self,
+                                    AvmStream* destination,
+                                    size_t length);
+
+/**
+ * @brief Decodes hexadecimal digits read from an AvmStream and writes the
+ * bytes to another.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p destination must be not null.
+ *
+ * @param self The AvmStream to read from.
+ * @param destination The AvmStream to write to.
+ * @param length The number of characters to read.
+ * @return The result of the IO operation.
+ */
+AVMAPI AvmError* AvmStreamDecodeHex(AvmStream* self,
+                                    AvmStream* destination,
+                                    size_t length);
+
+/**
+ * @brief Reads items from an AvmStream and inserts them at the end of an
+ * AvmList.
+ *
+ * The items are read as raw bytes, in chunks, each of which is inserted with
+ * a single AvmListAddRange call. If an error occurs, the items of the chunks
+ * read before it remain in the AvmList.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p destination must be not null.
+ *
+ * @param self The AvmStream to read from.
+ * @param destination The AvmList to insert the items to.
+ * @param count The number of items to read.
+ * @return The result of the IO operation.
+ */
+AVMAPI AvmError* AvmStreamReadItems(AvmStream* self,
+                                    AvmList* destination,
+                                    uint count);
+
 #endif // AVM_USE_IO
 
 #endif // AVIUM_IO_H
@@ -0,0 +1,46 @@
+#ifndef AVIUM_PRIVATE_COLLECTIONS_H
+#define AVIUM_PRIVATE_COLLECTIONS_H
+
+#include "avium/types.h"
+
+// Pushes the string representation of a collection item, which may be a
+// primitive value without a type header, to an AvmString.
+void __AvmStringPushItem(AvmString* s, const AvmType* type, object item);
+
+// Returns the index of the first of length contiguous items that is equal to
+// value, or AvmInvalid. Items are compared with the FnEntryEquals entry of
+// their type, or by their bytes if there is no such entry.
+uint __AvmFindItem(const AvmType* type,
+                   uint length,
+                   const byte* items,
+                   object value);
+
+// Hashes an item, which may be a primitive value without a type header, with
+// the FnEntryHash entry of its type, or by its bytes if the type has no
+// FnEntryEquals entry.
+ulong __AvmHashItem(const AvmType* type, object item);
+
+// Returns the FnEntryCompare entry of a type, or AvmObjectCompare.
+AvmComparer __AvmGetComparer(const AvmType* type);
+
+// Sorts contiguous items, in their natural order if comparer is NULL.
+void __AvmSortItems(byte* items,
+                    uint count,
+                    const AvmType* type,
+                    AvmComparer comparer,
+                    bool stable);
+
+// Stably merges two sorted ranges of items into destination, taking items
+// from the left range first on ties.
+void __AvmMergeItems(AvmComparer comparer,
+                     uint size,
+                     const byte* left,
+                     uint leftCount,
+                     const byte* right,
+                     uint rightCount,
+                     byte* destination);
+
+// Returns the number of online processors, at least 1.
+uint __AvmGetProcessorCount(void);
+
+#endif // AVIUM_PRIVATE_COLLECTIONS_H
@@ -21,6 +21,9 @@
 #define BACKTRACE_MAX_SYMBOLS 128
 #define AVM_FLOAT_BUFFER_SIZE 128
 #define READ_LINE_CAPACITY    32
+#define ENCODE_CHUNK_SIZE     3072
+#define DECODE_CHUNK_SIZE     4096
+#define READ_ITEMS_CHUNK_SIZE 4096
 
 static const str LongMinRepr = "-9223372036854775808";
 static const str NumericBaseOutOfRangeMsg =
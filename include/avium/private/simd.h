@@ -0,0 +1,80 @@
+#ifndef AVIUM_PRIVATE_SIMD_H
+#define AVIUM_PRIVATE_SIMD_H
+
+#include "avium/types.h"
+
+#if defined __SSE2__ || defined _M_X64 ||                                      \
+    (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define AVM_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+// Functions marked with AVM_SSSE3 may use SSSE3 intrinsics, but must only be
+// called when AvmCpuHasSsse3() is true. If the compiler already targets SSSE3
+// the check is free, otherwise GNU compilers can still emit SSSE3 code for the
+// marked functions and the CPU is checked at runtime. MSVC does not define a
+// macro for SSSE3, but it is implied by AVX.
+#if defined __SSSE3__ || (defined AVM_MSVC && defined __AVX__)
+#define AVM_HAVE_SSSE3
+#define AVM_SSSE3
+#define AvmCpuHasSsse3() true
+#include <tmmintrin.h>
+#elif defined AVM_HAVE_SSE2 && defined AVM_GNU
+#define AVM_HAVE_SSSE3
+#define AVM_SSSE3           __attribute__((target("ssse3")))
+#define AvmCpuHasSsse3()    __builtin_cpu_supports("ssse3")
+#include <tmmintrin.h>
+#endif
+
+// Functions marked with AVM_POPCNT may use the POPCNT instruction through
+// AvmPopCount, but must only be called when AvmCpuHasPopcnt() is true. MSVC
+// always emits POPCNT for AvmPopCount.
+#if defined __POPCNT__ || defined AVM_MSVC
+#define AVM_HAVE_POPCNT
+#define AVM_POPCNT
+#define AvmCpuHasPopcnt() true
+#elif defined AVM_HAVE_SSE2 && defined AVM_GNU
+#define AVM_HAVE_POPCNT
+#define AVM_POPCNT          __attribute__((target("popcnt")))
+#define AvmCpuHasPopcnt()   __builtin_cpu_supports("popcnt")
+#endif
+
+#ifdef AVM_MSVC
+#include <intrin.h>
+#endif
+
+/// Returns the index of the lowest set bit. The value must be not 0.
+static inline uint AvmBitScanForward(ulong value)
+{
+#ifdef AVM_MSVC
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (uint)index;
+#else
+    return (uint)__builtin_ctzll(value);
+#endif
+}
+
+/// Returns the index of the highest set bit. The value must be not 0.
+static inline uint AvmBitScanReverse(ulong value)
+{
+#ifdef AVM_MSVC
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (uint)index;
+#else
+    return 63 - (uint)__builtin_clzll(value);
+#endif
+}
+
+/// Returns the number of set bits.
+static inline uint AvmPopCount(ulong value)
+{
+#ifdef AVM_MSVC
+    return (uint)__popcnt64(value);
+#else
+    return (uint)__builtin_popcountll(value);
+#endif
+}
+
+#endif // AVIUM_PRIVATE_SIMD_H
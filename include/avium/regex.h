@@ -0,0 +1,225 @@
+/**
+ * @file avium/regex.h
+ * @author Vasilis Mylonas <vasilismylonas@protonmail.com>
+ * @brief Linear time regular expressions.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021 Vasilis Mylonas
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AVIUM_REGEX_H
+#define AVIUM_REGEX_H
+
+#include "avium/string.h"
+
+/**
+ * @brief A compiled regular expression.
+ *
+ * Matching takes time linear in the length of the input, whatever the
+ * pattern. The supported syntax is:
+ *
+ * - Literal characters and escapes (`\n`, `\t`, `\xHH`, `\.` ...).
+ * - `.` for any character except a newline.
+ * - Character classes (`[a-z_]`, `[^0-9]`) and `\d`, `\w`, `\s`, `\D`,
+ *   `\W` and `\S`.
+ * - `^` and `$` for the start and end of the input.
+ * - Capturing groups `(...)` and non-capturing groups `(?:...)`.
+ * - Alternation `|`.
+ * - The quantifiers `*`, `+`, `?`, `{n}`, `{n,}` and `{n,m}`, followed by `?`
+ *   to prefer fewer repetitions.
+ *
+ * Characters are matched as bytes. Among the matches starting at the leftmost
+ * position the one preferred by the quantifiers and alternations is chosen, as
+ * with backtracking engines. The exception are repetitions of expressions that
+ * can match the empty string, which never repeat an empty match.
+ *
+ * An AvmRegex caches state between calls, so the same instance must not be
+ * used by multiple threads at once.
+ */
+AVM_CLASS(AvmRegex, object, {
+    uint _groupCount;
+    struct AvmRegexProgram* _program;
+});
+
+/// The span of a match within an AvmString.
+AVM_CLASS(AvmRegexMatch, object, {
+    uint _start;
+    uint _length;
+});
+
+/// An iterator over the non-overlapping matches of an AvmRegex.
+AVM_CLASS(AvmRegexIterator, object, {
+    AvmRegex* _regex;
+    const AvmString* _string;
+    uint _position;
+    uint _previousEnd;
+});
+
+/**
+ * @brief Compiles a regular expression.
+ *
+ * An error is thrown if the pattern is invalid or compiles to a program that
+ * is too large.
+ *
+ * @pre Parameter @p pattern must be not null.
+ *
+ * @param pattern The pattern to compile.
+ * @return The created instance.
+ */
+AVMAPI AvmRegex AvmRegexNew(str pattern);
+
+/**
+ * @brief Returns the number of capturing groups in an AvmRegex.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmRegex instance.
+ * @return The number of capturing groups.
+ */
+AVMAPI uint AvmRegexGetGroupCount(const AvmRegex* self);
+
+/**
+ * @brief Determines whether an AvmRegex matches anywhere in an AvmString.
+ *
+ * This only needs to decide whether there is a match, so it runs on a lazily
+ * built DFA and is faster than the functions reporting the match position.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p string must be not null.
+ *
+ * @param self The AvmRegex instance.
+ * @param string The AvmString to search.
+ * @return true if there is a match, otherwise false.
+ */
+AVMAPI bool AvmRegexIsMatch(AvmRegex* self, const AvmString* string);
+
+/**
+ * @brief Finds the first match of an AvmRegex in an AvmString.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p string must be not null.
+ * @pre Parameter @p match must be not null.
+ *
+ * @param self The AvmRegex instance.
+ * @param string The AvmString to search.
+ * @param start The index to start searching from.
+ * @param[out] match The span of the match.
+ * @return true if there is a match, otherwise false.
+ */
+AVMAPI bool AvmRegexFind(AvmRegex* self,
+                         const AvmString* string,
+                         uint start,
+                         AvmRegexMatch* match);
+
+/**
+ * @brief Finds the first match of an AvmRegex in an AvmString, along with the
+ * spans of its capturing groups.
+ *
+ * The span of the whole match is stored first, followed by one span for each
+ * group. Groups that did not participate in the match have a start of
+ * AvmInvalid.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p string must be not null.
+ * @pre Parameter @p groups must be not null if @p count is not 0.
+ *
+ * @param self The AvmRegex instance.
+ * @param string The AvmString to search.
+ * @param start The index to start searching from.
+ * @param count The number of spans to store.
+ * @param[out] groups The spans of the match and its groups.
+ * @return true if there is a match, otherwise false.
+ */
+AVMAPI bool AvmRegexFindGroups(AvmRegex* self,
+                               const AvmString* string,
+                               uint start,
+                               uint count,
+                               AvmRegexMatch groups[]);
+
+/**
+ * @brief Replaces every match of an AvmRegex in an AvmString.
+ *
+ * The result is appended to @p destination. In @p replacement, `$0` to `$9`
+ * are replaced with the text of the match or of a group and `$$` with a
+ * single `$`.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p string must be not null.
+ * @pre Parameter @p replacement must be not null.
+ * @pre Parameter @p destination must be not null.
+ *
+ * @param self The AvmRegex instance.
+ * @param string The AvmString to search.
+ * @param replacement The replacement template.
+ * @param destination The AvmString to append the result to.
+ * @return The number of replaced matches.
+ */
+AVMAPI uint AvmRegexReplace(AvmRegex* self,
+                            const AvmString* string,
+                            str replacement,
+                            AvmString* destination);
+
+/**
+ * @brief Returns the index where an AvmRegexMatch starts.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmRegexMatch instance.
+ * @return The start index, or AvmInvalid for a group that did not match.
+ */
+AVMAPI uint AvmRegexMatchGetStart(const AvmRegexMatch* self);
+
+/**
+ * @brief Returns the length of an AvmRegexMatch.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmRegexMatch instance.
+ * @return The length of the match.
+ */
+AVMAPI uint AvmRegexMatchGetLength(const AvmRegexMatch* self);
+
+/**
+ * @brief Creates an iterator over the matches of an AvmRegex in an AvmString.
+ *
+ * Matches do not overlap, and an empty match directly after the previous
+ * match is skipped. Neither the AvmRegex nor the AvmString may be modified
+ * while the iterator is in use.
+ *
+ * @pre Parameter @p regex must be not null.
+ * @pre Parameter @p string must be not null.
+ *
+ * @param regex The AvmRegex to match.
+ * @param string The AvmString to search.
+ * @return The created instance.
+ */
+AVMAPI AvmRegexIterator AvmRegexIteratorNew(AvmRegex* regex,
+                                            const AvmString* string);
+
+/**
+ * @brief Finds the next match of an AvmRegexIterator.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p match must be not null.
+ *
+ * @param self The AvmRegexIterator instance.
+ * @param[out] match The span of the match.
+ * @return true if a match was found, false if there are no more matches.
+ */
+AVMAPI bool AvmRegexIteratorNext(AvmRegexIterator* self, AvmRegexMatch* match);
+
+#endif // AVIUM_REGEX_H
@@ -490,6 +490,25 @@ AVMAPI uint AvmStringReplaceLast(const AvmString* self,
  */
 AVMAPI uint AvmStringFind(const AvmString* self, str substring);
 
+/**
+ * @brief Returns the index of the first occurrence of a substring in an
+ * AvmString, starting the search at an index.
+ *
+ * @pre Parameter @p self must be not NULL.
+ * @pre Parameter @p substring must be not NULL if @p length is not 0.
+ *
+ * @param self The AvmString instance.
+ * @param start The index to start searching from.
+ * @param length The length of the substring.
+ * @param substring The substring to find.
+ *
+ * @return The index or AvmInvalid.
+ */
+AVMAPI uint AvmStringFindChars(const AvmString* self,
+                               uint start,
+                               uint length,
+                               str substring);
+
 /**
  * @brief Returns the index of the last occurrence of a substring in an
  * AvmString.
@@ -515,6 +534,9 @@ AVMAPI void AvmStringReverse(const AvmString* self);
 /**
  * @brief Converts all characters in an AvmString to uppercase.
  *
+ * Only ASCII letters are converted. The result does not depend on the current
+ * locale.
+ *
  * @pre Parameter @p self must be not NULL.
  * @param self The AvmString instance.
  */
@@ -523,11 +545,101 @@ AVMAPI void AvmStringToUpper(const AvmString* self);
 /**
  * Converts all characters in an AvmString to lowercase.
  *
+ * Only ASCII letters are converted. The result does not depend on the current
+ * locale.
+ *
  * @pre Parameter @p self must be not NULL.
  * @param self The AvmString instance.
  */
 AVMAPI void AvmStringToLower(const AvmString* self);
 
+/**
+ * @brief Determines whether two AvmStrings are equal, ignoring ASCII case.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p other must be not null.
+ *
+ * @param self The AvmString instance.
+ * @param other The AvmString to compare with.
+ * @return true if the strings are equal, otherwise false.
+ */
+AVMAPI bool AvmStringEqualsIgnoreCase(const AvmString* self,
+                                      const AvmString* other);
+
+/**
+ * @brief Determines whether an AvmString is equal to a raw string provided
+ * with its length, ignoring ASCII case.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p contents must be not null.
+ *
+ * @param self The AvmString instance.
+ * @param length The length of the string.
+ * @param contents The string to compare with.
+ * @return true if the strings are equal, otherwise false.
+ */
+AVMAPI bool AvmStringEqualsCharsIgnoreCase(const AvmString* self,
+                                           uint length,
+                                           str contents);
+
+/**
+ * @brief Determines whether an AvmString is equal to a raw string, ignoring
+ * ASCII case.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p contents must be not null.
+ *
+ * @param self The AvmString instance.
+ * @param contents The string to compare with.
+ * @return true if the strings are equal, otherwise false.
+ */
+AVMAPI bool AvmStringEqualsStrIgnoreCase(const AvmString* self, str contents);
+
+/**
+ * @brief Determines whether an AvmString starts with a raw string provided with
+ * its length, ignoring ASCII case.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p contents must be not null.
+ *
+ * @param self The AvmString instance.
+ * @param length The length of the string.
+ * @param contents The string to find.
+ *
+ * @return true if the AvmString starts with the string, otherwise false.
+ */
+AVMAPI bool AvmStringStartsWithCharsIgnoreCase(const AvmString* self,
+                                               uint length,
+                                               str contents);
+
+/**
+ * @brief Determines whether an AvmString starts with a raw string, ignoring
+ * ASCII case.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p contents must be not null.
+ *
+ * @param self The AvmString instance.
+ * @param contents The string to find.
+ * @return true if the AvmString starts with the string, otherwise false.
+ */
+AVMAPI bool AvmStringStartsWithStrIgnoreCase(const AvmString* self,
+                                             str contents);
+
+/**
+ * @brief Returns the index of the first occurrence of a substring in an
+ * AvmString, ignoring ASCII case.
+ *
+ * @pre Parameter @p self must be not NULL.
+ * @pre Parameter @p substring must be not NULL.
+ *
+ * @param self The AvmString instance.
+ * @param substring The substring to find.
+ *
+ * @return The index or AvmInvalid.
+ */
+AVMAPI uint AvmStringFindIgnoreCase(const AvmString* self, str substring);
+
 /**
  * @brief Clears the contents of an AvmString by setting its length to 0).
  *
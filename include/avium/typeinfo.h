@@ -33,6 +33,8 @@ typedef enum
     FnEntryToString,    ///< The AvmObjectToString entry.
     FnEntryClone,       ///< The AvmObjectClone entry.
     FnEntryEquals,      ///< The AvmObjectEquals entry.
+    FnEntryHash,        ///< The AvmObjectHash entry.
+    FnEntryCompare,     ///< The AvmObjectCompare entry.
     FnEntryRead = 16,   ///< The AvmStreamRead entry.
     FnEntryWrite,       ///< The AvmStreamWrite entry.
     FnEntrySeek,        ///< The AvmStreamSeek entry.
@@ -46,11 +48,21 @@ typedef enum
     FnEntryInsert,
     FnEntryItemAt,
     FnEntryGetItemType,
+    FnEntryGetKeyType,
+    FnEntryClear,
+    FnEntryTruncate,
+    FnEntryInsertRange,
+    FnEntryRemoveRange,
+    FnEntryGetIterator,
 } AvmFnEntry;
 
 /// Returns the base type of an object.
 #define baseof(x) (&(x)->_base)
 
+/// Returns the object of type T that contains a member, from a pointer to the
+/// member. The member may also be reached through a base, as in _base.link.
+#define containerof(p, T, member) ((T*)((byte*)(p) - offsetof(T, member)))
+
 /// Returns a pointer to the type info of type T.
 #define typeid(T) (&AVM_TI_NAME(T))
 
@@ -126,6 +138,20 @@ AVMAPI uint AvmTypeGetSize(const AvmType* self);
  */
 AVMAPI AvmFunction AvmTypeGetFunction(const AvmType* self, uint index);
 
+/**
+ * @brief Returns the specified VFT entry of a type, if present.
+ *
+ * Unlike AvmTypeGetFunction, this function does not throw if the entry is
+ * outside the VFT of the type.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmType instance.
+ * @param index The VFT entry.
+ * @return The function pointer, or NULL if the entry is not present.
+ */
+AVMAPI AvmFunction AvmTypeTryGetFunction(const AvmType* self, uint index);
+
 /**
  * @brief Returns a pointer to the type info for the base type of a type.
  *
@@ -170,17 +196,43 @@ AVMAPI object AvmTypeConstruct(const AvmType* self);
  * @param ... The enum members enclosed in braces ({...})
  */
 #define AVM_ENUM_TYPE(T, ...)                                                  \
+    static AvmEnumIndex AVM_CONCAT(__avmEnumIndex_, T);                        \
     const AvmEnum AVM_TI_NAME(T) = {                                           \
         ._type = typeid(AvmEnum),                                              \
         ._name = #T,                                                           \
         ._size = sizeof(T),                                                    \
+        ._index = &AVM_CONCAT(__avmEnumIndex_, T),                             \
         ._members = __VA_ARGS__,                                               \
     }
 
-/// A type containing information about an enum.
+static_assert_s(AVM_MAX_ENUM_MEMBERS < 256);
+
+#ifndef DOXYGEN
+// Hash tables of the members of an enum, built on first use. Slots hold a
+// member index plus 1, or 0 if they are empty. Tables have a power of two
+// number of slots, at least twice the number of members.
+typedef struct
+{
+    volatile uint _state;
+    uint _length;
+    uint _mask;
+    bool _dense; // Values are looked up by their offset from _minimum.
+    _long _minimum;
+    byte _byName[AVM_MAX_ENUM_MEMBERS * 4];
+    byte _byValue[AVM_MAX_ENUM_MEMBERS * 4];
+} AvmEnumIndex;
+#endif // DOXYGEN
+
+/**
+ * @brief A type containing information about an enum.
+ *
+ * Lookups of constants by name or value use tables that are built the first
+ * time they are needed, and take O(1) time.
+ */
 AVM_CLASS(AvmEnum, object, {
     str _name;
     uint _size;
+    AvmEnumIndex* _index;
     struct
     {
         str _name;
@@ -41,6 +41,11 @@ typedef void (*AvmFunction)(void);    ///< An unknown function type.
 typedef const char* str;              ///< Primitive read-only string.
 #define weakptr(T) T*                 ///< A weak pointer to a type T.
 
+/// A function that compares two objects, returning a negative number, 0 or a
+/// positive number if the first is less than, equal to or greater than the
+/// second.
+typedef int (*AvmComparer)(object, object);
+
 #define main AvmMain
 
 /**
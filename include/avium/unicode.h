@@ -0,0 +1,179 @@
+/**
+ * @file avium/unicode.h
+ * @author Vasilis Mylonas <vasilismylonas@protonmail.com>
+ * @brief UTF-8 validation, decoding and transcoding.
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2021 Vasilis Mylonas
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AVIUM_UNICODE_H
+#define AVIUM_UNICODE_H
+
+#include "avium/string.h"
+
+/// The code point used in place of invalid sequences.
+#define AVM_REPLACEMENT_CHARACTER 0xFFFD
+
+/// An iterator over the code points of a UTF-8 encoded AvmString.
+AVM_CLASS(AvmUtf8Iterator, object, {
+    const AvmString* _string;
+    uint _index;
+});
+
+/**
+ * @brief Determines whether a sequence of bytes is valid UTF-8.
+ *
+ * Overlong encodings, surrogates and code points above U+10FFFF are rejected.
+ *
+ * @pre Parameter @p contents must be not null if @p length is not 0.
+ *
+ * @param length The number of bytes.
+ * @param contents The bytes to validate.
+ * @return true if the bytes are valid UTF-8, otherwise false.
+ */
+AVMAPI bool AvmUtf8IsValid(uint length, str contents);
+
+/**
+ * @brief Determines whether an AvmString contains valid UTF-8.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmString instance.
+ * @return true if the AvmString is valid UTF-8, otherwise false.
+ */
+AVMAPI bool AvmStringIsValidUtf8(const AvmString* self);
+
+/**
+ * @brief Counts the code points in a sequence of UTF-8 bytes.
+ *
+ * The bytes are assumed to be valid UTF-8. For invalid input the result is the
+ * number of bytes that are not continuation bytes.
+ *
+ * @pre Parameter @p contents must be not null if @p length is not 0.
+ *
+ * @param length The number of bytes.
+ * @param contents The UTF-8 bytes.
+ * @return The number of code points.
+ */
+AVMAPI uint AvmUtf8CountCodepoints(uint length, str contents);
+
+/**
+ * @brief Counts the code points in a UTF-8 encoded AvmString.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmString instance.
+ * @return The number of code points.
+ */
+AVMAPI uint AvmStringCountCodepoints(const AvmString* self);
+
+/**
+ * @brief Creates an iterator over the code points of an AvmString.
+ *
+ * The AvmString must not be modified while the iterator is in use.
+ *
+ * @pre Parameter @p string must be not null.
+ *
+ * @param string The AvmString to iterate.
+ * @return The created instance.
+ */
+AVMAPI AvmUtf8Iterator AvmUtf8IteratorNew(const AvmString* string);
+
+/**
+ * @brief Decodes the next code point of an AvmUtf8Iterator.
+ *
+ * Invalid bytes are decoded as AVM_REPLACEMENT_CHARACTER, one byte at a time.
+ *
+ * @pre Parameter @p self must be not null.
+ * @pre Parameter @p codepoint must be not null.
+ *
+ * @param self The AvmUtf8Iterator instance.
+ * @param[out] codepoint The decoded code point.
+ * @return true if a code point was decoded, false at the end of the string.
+ */
+AVMAPI bool AvmUtf8IteratorNext(AvmUtf8Iterator* self, uint* codepoint);
+
+/**
+ * @brief Returns the byte index of the next code point of an AvmUtf8Iterator.
+ *
+ * @pre Parameter @p self must be not null.
+ *
+ * @param self The AvmUtf8Iterator instance.
+ * @return The byte index.
+ */
+AVMAPI uint AvmUtf8IteratorGetIndex(const AvmUtf8Iterator* self);
+
+/**
+ * @brief Transcodes a UTF-8 AvmString to UTF-16.
+ *
+ * The UTF-16 code units are appended to @p destination in native byte order.
+ * The required capacity is reserved once, before anything is written.
+ *
+ * @pre Parameter @p source must be not null.
+ * @pre Parameter @p destination must be not null.
+ *
+ * @param source The UTF-8 AvmString.
+ * @param destination The AvmString to append the code units to.
+ * @return true on success, false if @p source is not valid UTF-8. In that case
+ *         @p destination is left unchanged.
+ */
+AVMAPI bool AvmUtf8ToUtf16(const AvmString* source, AvmString* destination);
+
+/**
+ * @brief Transcodes a UTF-8 AvmString to UTF-32.
+ *
+ * The UTF-32 code units are appended to @p destination in native byte order.
+ * The required capacity is reserved once, before anything is written.
+ *
+ * @pre Parameter @p source must be not null.
+ * @pre Parameter @p destination must be not null.
+ *
+ * @param source The UTF-8 AvmString.
+ * @param destination The AvmString to append the code units to.
+ * @return true on success, false if @p source is not valid UTF-8. In that case
+ *         @p destination is left unchanged.
+ */
+AVMAPI bool AvmUtf8ToUtf32(const AvmString* source, AvmString* destination);
+
+/**
+ * @brief Transcodes UTF-16 code units stored in an AvmString to UTF-8.
+ *
+ * @pre Parameter @p source must be not null.
+ * @pre Parameter @p destination must be not null.
+ *
+ * @param source The AvmString holding UTF-16 code units in native byte order.
+ * @param destination The AvmString to append the UTF-8 bytes to.
+ * @return true on success, false if @p source is not valid UTF-16. In that case
+ *         @p destination is left unchanged.
+ */
+AVMAPI bool AvmUtf16ToUtf8(const AvmString* source, AvmString* destination);
+
+/**
+ * @brief Transcodes UTF-32 code units stored in an AvmString to UTF-8.
+ *
+ * @pre Parameter @p source must be not null.
+ * @pre Parameter @p destination must be not null.
+ *
+ * @param source The AvmString holding UTF-32 code units in native byte order.
+ * @param destination The AvmString to append the UTF-8 bytes to.
+ * @return true on success, false if @p source is not valid UTF-32. In that case
+ *         @p destination is left unchanged.
+ */
+AVMAPI bool AvmUtf32ToUtf8(const AvmString* source, AvmString* destination);
+
+#endif // AVIUM_UNICODE_H
@@ -2,6 +2,7 @@
 
 #include "avium/collections/list.h"
 #include "avium/error.h"
+#include "avium/private/collections.h"
 #include "avium/private/errors.h"
 #include "avium/string.h"
 #include "avium/testing.h"
@@ -54,6 +55,16 @@ static object AvmArrayListItemAt(const AvmArrayList* self, uint index)
     return self->_items + index * self->_itemType->_size;
 }
 
+static AvmIterator AvmArrayListGetIterator(const AvmArrayList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return AvmIteratorFromArray(self->_itemType, self->_length, self->_items);
+}
+
 // The following code is straight up copied from avm.core/string.c with minor
 // modifications.
 static void AvmArrayListEnsureCapacity(AvmArrayList* self, uint capacity)
@@ -112,24 +123,38 @@ static void AvmArrayListInsert(AvmArrayList* self, uint index, object value)
 
     if (index < self->_length)
     {
-        memmove(dest + size, dest, size); // Shift all elements out.
+        // Shift all elements out.
+        memmove(dest + size, dest, (self->_length - index) * size);
     }
 
     memcpy(dest, value, size);
     self->_length++;
 }
 
-static void AvmArrayListDropItem(AvmArrayList* self, uint index)
+// Calls the finalizers of a range of items, looking up the finalizer once.
+static void AvmArrayListDropRange(AvmArrayList* self, uint index, uint count)
 {
     AvmFunction fn = AvmTypeGetFunction(self->_itemType, FnEntryDtor);
-    object item = AvmArrayListItemAt(self, index);
 
-    if (fn != NULL)
+    if (fn == NULL)
+    {
+        return;
+    }
+
+    const size_t size = self->_itemType->_size;
+    byte* item = self->_items + index * size;
+
+    for (uint i = 0; i < count; i++, item += size)
     {
         ((void (*)(object))fn)(item);
     }
 }
 
+static void AvmArrayListDropItem(AvmArrayList* self, uint index)
+{
+    AvmArrayListDropRange(self, index, 1);
+}
+
 static void AvmArrayListRemove(AvmArrayList* self, uint index)
 {
     pre
@@ -158,6 +183,101 @@ static void AvmArrayListRemove(AvmArrayList* self, uint index)
     memmove(objectPtr, objectPtr + itemSize, freeSize); // Shift elements in.
 }
 
+static void AvmArrayListInsertRange(AvmArrayList* self,
+                                    uint index,
+                                    uint count,
+                                    const void* items)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(items != NULL || count == 0);
+    }
+
+    if (index > self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t size = self->_itemType->_size;
+    const byte* source = items;
+    byte* copy = NULL;
+
+    // The items may come from this list, in which case growing or shifting
+    // it would move them.
+    if (source >= self->_items && source < self->_items + self->_length * size)
+    {
+        copy = AvmAlloc(count * size);
+        memcpy(copy, source, count * size);
+        source = copy;
+    }
+
+    AvmArrayListEnsureCapacity(self, count);
+
+    byte* const dest = self->_items + index * size;
+
+    if (index < self->_length)
+    {
+        memmove(dest + count * size, dest, (self->_length - index) * size);
+    }
+
+    memcpy(dest, source, count * size);
+    self->_length += count;
+
+    if (copy != NULL)
+    {
+        AvmDealloc(copy);
+    }
+}
+
+static void AvmArrayListRemoveRange(AvmArrayList* self, uint index, uint count)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index > self->_length || count > self->_length - index)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    AvmArrayListDropRange(self, index, count);
+
+    const size_t size = self->_itemType->_size;
+    const uint end = index + count;
+    byte* const dest = self->_items + index * size;
+
+    memmove(dest, dest + count * size, (self->_length - end) * size);
+    self->_length -= count;
+}
+
+static void AvmArrayListTruncate(AvmArrayList* self, uint length)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (length >= self->_length)
+    {
+        return;
+    }
+
+    AvmArrayListDropRange(self, length, self->_length - length);
+    self->_length = length;
+}
+
 static AvmString AvmArrayListToString(AvmArrayList* self)
 {
     pre
@@ -170,34 +290,7 @@ static AvmString AvmArrayListToString(AvmArrayList* self)
     AvmStringPushStr(&s, "[ ");
     for (uint i = 0; i < self->_length; i++)
     {
-        object item = AvmArrayListItemAt(self, i);
-
-        if (self->_itemType->_size > sizeof(AvmType*)) // Type is not primitive.
-            AvmStringPushValue(&s, AvmArrayListItemAt(self, i));
-        else if (self->_itemType == typeid(float))
-            AvmStringPushFloat(&s, *(float*)item, FloatReprAuto);
-        else if (self->_itemType == typeid(double))
-            AvmStringPushFloat(&s, *(double*)item, FloatReprAuto);
-        else if (self->_itemType == typeid(str))
-            AvmStringPushStr(&s, *(str*)item);
-        else if (self->_itemType == typeid(byte))
-            AvmStringPushUint(&s, *(byte*)item, NumericBaseDecimal);
-        else if (self->_itemType == typeid(ushort))
-            AvmStringPushUint(&s, *(ushort*)item, NumericBaseDecimal);
-        else if (self->_itemType == typeid(uint))
-            AvmStringPushUint(&s, *(uint*)item, NumericBaseDecimal);
-        else if (self->_itemType == typeid(ulong))
-            AvmStringPushUint(&s, *(ulong*)item, NumericBaseDecimal);
-        else if (self->_itemType == typeid(char))
-            AvmStringPushChar(&s, *(char*)item);
-        else if (self->_itemType == typeid(short))
-            AvmStringPushInt(&s, *(short*)item);
-        else if (self->_itemType == typeid(int))
-            AvmStringPushInt(&s, *(int*)item);
-        else if (self->_itemType == typeid(_long))
-            AvmStringPushInt(&s, *(_long*)item);
-        else
-            throw(AvmErrorNew(InternalError));
+        __AvmStringPushItem(&s, self->_itemType, AvmArrayListItemAt(self, i));
 
         if (i < self->_length - 1)
         {
@@ -217,6 +310,10 @@ AVM_TYPE(AvmArrayList,
              [FnEntryInsert] = (AvmFunction)AvmArrayListInsert,
              [FnEntryRemove] = (AvmFunction)AvmArrayListRemove,
              [FnEntryItemAt] = (AvmFunction)AvmArrayListItemAt,
+             [FnEntryInsertRange] = (AvmFunction)AvmArrayListInsertRange,
+             [FnEntryRemoveRange] = (AvmFunction)AvmArrayListRemoveRange,
+             [FnEntryTruncate] = (AvmFunction)AvmArrayListTruncate,
+             [FnEntryGetIterator] = (AvmFunction)AvmArrayListGetIterator,
              [FnEntryToString] = (AvmFunction)AvmArrayListToString,
          });
 
@@ -235,3 +332,13 @@ AvmArrayList AvmArrayListNew(const AvmType* type, uint capacity)
         ._capacity = capacity,
     };
 }
+
+void AvmArrayListReserve(AvmArrayList* self, uint count)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmArrayListEnsureCapacity(self, count);
+}
@@ -0,0 +1,1246 @@
+#include "avium/collections/bit-set.h"
+
+#include "avium/core.h"
+#include "avium/error.h"
+#include "avium/hash.h"
+#include "avium/private/errors.h"
+#include "avium/private/simd.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+#define WORD_BITS 64
+
+// Sparse groups hold the values that share their upper 16 bits. A group is
+// a sorted array exactly when it has at most ARRAY_MAX values, in which case
+// the array is no larger than a bitmap of BITMAP_WORDS words.
+#define GROUP_BITS   16
+#define GROUP_MASK   ((1u << GROUP_BITS) - 1)
+#define BITMAP_WORDS ((1u << GROUP_BITS) / WORD_BITS)
+#define ARRAY_MAX    4096
+
+#define MIN_CAPACITY 4
+
+typedef enum
+{
+    BitOpAnd,
+    BitOpOr,
+    BitOpXor,
+    BitOpAndNot,
+} AvmBitOp;
+
+typedef struct AvmBitContainer
+{
+    uint count;
+    uint capacity; // Of the array, unused for a bitmap.
+    union
+    {
+        ushort* values;
+        ulong* words;
+    };
+} AvmBitContainer;
+
+//
+// Word operations, shared by both kinds of sets.
+//
+
+#ifdef AVM_HAVE_SSE2
+#define AVM_BITS_LOOP(VECTOR, SCALAR)                                          \
+    for (; i + 2 <= count; i += 2)                                             \
+    {                                                                          \
+        const __m128i a = _mm_loadu_si128((const __m128i*)(dest + i));         \
+        const __m128i b = _mm_loadu_si128((const __m128i*)(source + i));       \
+        _mm_storeu_si128((__m128i*)(dest + i), VECTOR);                        \
+    }                                                                          \
+    for (; i < count; i++)                                                     \
+    {                                                                          \
+        const ulong a = dest[i];                                               \
+        const ulong b = source[i];                                             \
+        dest[i] = SCALAR;                                                      \
+    }
+#else
+#define AVM_BITS_LOOP(VECTOR, SCALAR)                                          \
+    for (; i < count; i++)                                                     \
+    {                                                                          \
+        const ulong a = dest[i];                                               \
+        const ulong b = source[i];                                             \
+        dest[i] = SCALAR;                                                      \
+    }
+#endif
+
+static void AvmBitsApply(AvmBitOp op,
+                         ulong* dest,
+                         const ulong* source,
+                         uint count)
+{
+    uint i = 0;
+
+    switch (op)
+    {
+    case BitOpAnd:
+        AVM_BITS_LOOP(_mm_and_si128(a, b), a & b);
+        break;
+    case BitOpOr:
+        AVM_BITS_LOOP(_mm_or_si128(a, b), a | b);
+        break;
+    case BitOpXor:
+        AVM_BITS_LOOP(_mm_xor_si128(a, b), a ^ b);
+        break;
+    case BitOpAndNot:
+        AVM_BITS_LOOP(_mm_andnot_si128(b, a), a & ~b);
+        break;
+    }
+}
+
+static uint AvmBitsCountPortable(const ulong* words, uint count)
+{
+    uint total = 0;
+
+    for (uint i = 0; i < count; i++)
+    {
+        total += AvmPopCount(words[i]);
+    }
+
+    return total;
+}
+
+#ifdef AVM_HAVE_POPCNT
+// The same loop, compiled to use the POPCNT instruction.
+AVM_POPCNT static uint AvmBitsCountPopcnt(const ulong* words, uint count)
+{
+    uint total = 0;
+
+    for (uint i = 0; i < count; i++)
+    {
+        total += AvmPopCount(words[i]);
+    }
+
+    return total;
+}
+#endif
+
+static uint AvmBitsCount(const ulong* words, uint count)
+{
+#ifdef AVM_HAVE_POPCNT
+    if (AvmCpuHasPopcnt())
+    {
+        return AvmBitsCountPopcnt(words, count);
+    }
+#endif
+
+    return AvmBitsCountPortable(words, count);
+}
+
+// Returns the index of the first set bit at or after index, which must be
+// within the words, or AvmInvalid.
+static uint AvmBitsNextSet(const ulong* words, uint count, uint index)
+{
+    uint i = index / WORD_BITS;
+    ulong word = words[i] & (~0ull << (index % WORD_BITS));
+
+    while (word == 0)
+    {
+        if (++i == count)
+        {
+            return AvmInvalid;
+        }
+
+        word = words[i];
+    }
+
+    return i * WORD_BITS + AvmBitScanForward(word);
+}
+
+//
+// AvmBitSet.
+//
+
+static inline uint AvmBitSetWordCount(uint length)
+{
+    return (uint)(((ulong)length + WORD_BITS - 1) / WORD_BITS);
+}
+
+// Clears the bits of the last word that are past the length.
+static void AvmBitSetMaskTail(AvmBitSet* self)
+{
+    const uint bits = self->_length % WORD_BITS;
+
+    if (bits != 0)
+    {
+        self->_words[self->_length / WORD_BITS] &= (1ull << bits) - 1;
+    }
+}
+
+static void AvmBitSetApply(AvmBitSet* self,
+                           const AvmBitSet* other,
+                           AvmBitOp op)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(other != NULL);
+    }
+
+    if (self->_length != other->_length)
+    {
+        throw(AvmErrorNew(ArgError));
+    }
+
+    AvmBitsApply(
+        op, self->_words, other->_words, AvmBitSetWordCount(self->_length));
+}
+
+static uint AvmBitSetGetLength(const AvmBitSet* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static uint AvmBitSetGetCapacity(const AvmBitSet* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const ulong capacity = (ulong)self->_capacity * WORD_BITS;
+    return capacity > (uint)-1 ? (uint)-1 : (uint)capacity;
+}
+
+static bool AvmBitSetEquals(const AvmBitSet* self, const AvmBitSet* other)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(other != NULL);
+    }
+
+    if (self->_length != other->_length)
+    {
+        return false;
+    }
+
+    const uint count = AvmBitSetWordCount(self->_length);
+    return count == 0 ||
+           memcmp(self->_words, other->_words, count * sizeof(ulong)) == 0;
+}
+
+static ulong AvmBitSetHash(const AvmBitSet* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return AvmHashBytes(AvmBitSetWordCount(self->_length) * sizeof(ulong),
+                        self->_words);
+}
+
+static void AvmBitSetClear(AvmBitSet* self)
+{
+    AvmBitSetFill(self, false);
+}
+
+static AvmString AvmBitSetToString(const AvmBitSet* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmString s = AvmStringNew(16);
+    uint index = AvmBitSetNextSet(self, 0);
+
+    AvmStringPushStr(&s, "{ ");
+    while (index != AvmInvalid)
+    {
+        AvmStringPushUint(&s, index, NumericBaseDecimal);
+        index = AvmBitSetNextSet(self, index + 1);
+
+        if (index != AvmInvalid)
+        {
+            AvmStringPushStr(&s, ", ");
+        }
+    }
+    AvmStringPushStr(&s, " }");
+    return s;
+}
+
+AVM_TYPE(AvmBitSet,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmBitSetGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmBitSetGetCapacity,
+             [FnEntryEquals] = (AvmFunction)AvmBitSetEquals,
+             [FnEntryHash] = (AvmFunction)AvmBitSetHash,
+             [FnEntryClear] = (AvmFunction)AvmBitSetClear,
+             [FnEntryToString] = (AvmFunction)AvmBitSetToString,
+         });
+
+AvmBitSet AvmBitSetNew(uint length)
+{
+    AvmBitSet self = {
+        ._type = typeid(AvmBitSet),
+        ._length = 0,
+        ._capacity = 0,
+        ._words = NULL,
+    };
+
+    AvmBitSetResize(&self, length);
+    return self;
+}
+
+bool AvmBitSetGet(const AvmBitSet* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    return (self->_words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+}
+
+void AvmBitSetSet(AvmBitSet* self, uint index, bool value)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    const ulong bit = 1ull << (index % WORD_BITS);
+
+    if (value)
+    {
+        self->_words[index / WORD_BITS] |= bit;
+    }
+    else
+    {
+        self->_words[index / WORD_BITS] &= ~bit;
+    }
+}
+
+void AvmBitSetFill(AvmBitSet* self, bool value)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (self->_length == 0)
+    {
+        return;
+    }
+
+    memset(self->_words,
+           value ? 0xFF : 0,
+           AvmBitSetWordCount(self->_length) * sizeof(ulong));
+    AvmBitSetMaskTail(self);
+}
+
+void AvmBitSetResize(AvmBitSet* self, uint length)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const uint count = AvmBitSetWordCount(self->_length);
+    const uint required = AvmBitSetWordCount(length);
+
+    if (required > self->_capacity)
+    {
+        ulong capacity = (ulong)self->_capacity * AVM_ARRAY_LIST_GROWTH_FACTOR;
+        if (capacity < required)
+        {
+            capacity = required;
+        }
+
+        if (capacity > AvmBitSetWordCount((uint)-1))
+        {
+            capacity = AvmBitSetWordCount((uint)-1);
+        }
+
+        self->_words =
+            AvmRealloc(self->_words, (size_t)capacity * sizeof(ulong));
+        self->_capacity = (uint)capacity;
+    }
+
+    // Words past the old length may hold bits from before a shrink.
+    if (required > count)
+    {
+        memset(self->_words + count, 0, (required - count) * sizeof(ulong));
+    }
+
+    self->_length = length;
+    AvmBitSetMaskTail(self);
+}
+
+uint AvmBitSetCount(const AvmBitSet* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return AvmBitsCount(self->_words, AvmBitSetWordCount(self->_length));
+}
+
+uint AvmBitSetNextSet(const AvmBitSet* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        return AvmInvalid;
+    }
+
+    return AvmBitsNextSet(
+        self->_words, AvmBitSetWordCount(self->_length), index);
+}
+
+void AvmBitSetAnd(AvmBitSet* self, const AvmBitSet* other)
+{
+    AvmBitSetApply(self, other, BitOpAnd);
+}
+
+void AvmBitSetOr(AvmBitSet* self, const AvmBitSet* other)
+{
+    AvmBitSetApply(self, other, BitOpOr);
+}
+
+void AvmBitSetXor(AvmBitSet* self, const AvmBitSet* other)
+{
+    AvmBitSetApply(self, other, BitOpXor);
+}
+
+void AvmBitSetAndNot(AvmBitSet* self, const AvmBitSet* other)
+{
+    AvmBitSetApply(self, other, BitOpAndNot);
+}
+
+//
+// Groups of an AvmSparseBitSet.
+//
+
+static inline bool AvmContainerIsBitmap(const AvmBitContainer* container)
+{
+    return container->count > ARRAY_MAX;
+}
+
+// Returns the index of the first value that is not less than value.
+static uint AvmContainerLowerBound(const AvmBitContainer* container,
+                                   uint value)
+{
+    uint low = 0;
+    uint count = container->count;
+
+    while (count != 0)
+    {
+        const uint half = count / 2;
+
+        if (container->values[low + half] < value)
+        {
+            low += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+
+    return low;
+}
+
+static void AvmContainerFree(AvmBitContainer* container)
+{
+    if (AvmContainerIsBitmap(container))
+    {
+        AvmDealloc(container->words);
+    }
+    else
+    {
+        AvmDealloc(container->values);
+    }
+}
+
+// Fills a bitmap with the values of a group.
+static void AvmContainerToWords(const AvmBitContainer* container,
+                                ulong* words)
+{
+    if (AvmContainerIsBitmap(container))
+    {
+        memcpy(words, container->words, BITMAP_WORDS * sizeof(ulong));
+        return;
+    }
+
+    memset(words, 0, BITMAP_WORDS * sizeof(ulong));
+
+    for (uint i = 0; i < container->count; i++)
+    {
+        const ushort value = container->values[i];
+        words[value / WORD_BITS] |= 1ull << (value % WORD_BITS);
+    }
+}
+
+// Creates a group from a bitmap, which it takes or frees. The group is
+// empty if no bit is set.
+static AvmBitContainer AvmContainerFromWords(ulong* words)
+{
+    AvmBitContainer container = {
+        .count = AvmBitsCount(words, BITMAP_WORDS),
+        .capacity = 0,
+        .words = words,
+    };
+
+    if (container.count == 0)
+    {
+        AvmDealloc(words);
+        container.words = NULL;
+    }
+    else if (container.count <= ARRAY_MAX)
+    {
+        ushort* values = AvmAlloc(container.count * sizeof(ushort));
+
+        uint count = 0;
+
+        for (uint i = 0; i < BITMAP_WORDS; i++)
+        {
+            for (ulong word = words[i]; word != 0; word &= word - 1)
+            {
+                values[count++] = (ushort)(i * WORD_BITS +
+                                           AvmBitScanForward(word));
+            }
+        }
+
+        AvmDealloc(words);
+        container.values = values;
+        container.capacity = container.count;
+    }
+
+    return container;
+}
+
+static AvmBitContainer AvmContainerClone(const AvmBitContainer* container)
+{
+    AvmBitContainer clone = *container;
+
+    if (AvmContainerIsBitmap(container))
+    {
+        clone.words = AvmAlloc(BITMAP_WORDS * sizeof(ulong));
+        memcpy(clone.words, container->words, BITMAP_WORDS * sizeof(ulong));
+    }
+    else
+    {
+        clone.capacity = container->count;
+        clone.values = AvmAlloc(container->count * sizeof(ushort));
+        memcpy(clone.values,
+               container->values,
+               container->count * sizeof(ushort));
+    }
+
+    return clone;
+}
+
+static bool AvmContainerGet(const AvmBitContainer* container, uint value)
+{
+    if (AvmContainerIsBitmap(container))
+    {
+        return (container->words[value / WORD_BITS] >> (value % WORD_BITS)) &
+               1;
+    }
+
+    const uint index = AvmContainerLowerBound(container, value);
+    return index < container->count && container->values[index] == value;
+}
+
+// Returns the first value of a group that is at least value, or AvmInvalid.
+static uint AvmContainerNextSet(const AvmBitContainer* container, uint value)
+{
+    if (AvmContainerIsBitmap(container))
+    {
+        return AvmBitsNextSet(container->words, BITMAP_WORDS, value);
+    }
+
+    const uint index = AvmContainerLowerBound(container, value);
+    return index < container->count ? container->values[index] : AvmInvalid;
+}
+
+// Adds or removes a value, returning whether the group changed. Groups turn
+// into bitmaps when they grow past ARRAY_MAX values, and back into arrays
+// when they shrink to it.
+static bool AvmContainerSet(AvmBitContainer* container, uint value, bool set)
+{
+    if (AvmContainerIsBitmap(container))
+    {
+        ulong* word = &container->words[value / WORD_BITS];
+        const ulong bit = 1ull << (value % WORD_BITS);
+
+        if (((*word & bit) != 0) == set)
+        {
+            return false;
+        }
+
+        *word ^= bit;
+
+        if (set)
+        {
+            container->count++;
+        }
+        else if (--container->count == ARRAY_MAX)
+        {
+            *container = AvmContainerFromWords(container->words);
+        }
+
+        return true;
+    }
+
+    const uint index = AvmContainerLowerBound(container, value);
+
+    if ((index < container->count && container->values[index] == value) ==
+        set)
+    {
+        return false;
+    }
+
+    ushort* slot = container->values + index;
+
+    if (!set)
+    {
+        memmove(slot,
+                slot + 1,
+                (container->count - index - 1) * sizeof(ushort));
+        container->count--;
+        return true;
+    }
+
+    if (container->count == ARRAY_MAX)
+    {
+        ulong* words = AvmAlloc(BITMAP_WORDS * sizeof(ulong));
+
+        AvmContainerToWords(container, words);
+        words[value / WORD_BITS] |= 1ull << (value % WORD_BITS);
+        AvmDealloc(container->values);
+
+        container->words = words;
+        container->count++;
+        return true;
+    }
+
+    if (container->count == container->capacity)
+    {
+        uint capacity = container->capacity * 2;
+        capacity = capacity > ARRAY_MAX ? ARRAY_MAX : capacity;
+
+        container->values =
+            AvmRealloc(container->values, capacity * sizeof(ushort));
+        container->capacity = capacity;
+        slot = container->values + index;
+    }
+
+    memmove(slot + 1, slot, (container->count - index) * sizeof(ushort));
+    *slot = (ushort)value;
+    container->count++;
+    return true;
+}
+
+// Combines two sorted arrays of values, keeping the values that are only in
+// the first, only in the second or in both as the operation requires.
+static AvmBitContainer AvmContainerMergeArrays(const AvmBitContainer* a,
+                                               const AvmBitContainer* b,
+                                               AvmBitOp op)
+{
+    const bool keepA = op != BitOpAnd;
+    const bool keepB = op == BitOpOr || op == BitOpXor;
+    const bool keepBoth = op == BitOpAnd || op == BitOpOr;
+
+    ushort* values = AvmAlloc((a->count + b->count) * sizeof(ushort));
+    uint i = 0, j = 0, count = 0;
+
+    while (i < a->count && j < b->count)
+    {
+        const ushort x = a->values[i];
+        const ushort y = b->values[j];
+
+        if (x < y)
+        {
+            if (keepA)
+            {
+                values[count++] = x;
+            }
+
+            i++;
+        }
+        else if (y < x)
+        {
+            if (keepB)
+            {
+                values[count++] = y;
+            }
+
+            j++;
+        }
+        else
+        {
+            if (keepBoth)
+            {
+                values[count++] = x;
+            }
+
+            i++;
+            j++;
+        }
+    }
+
+    for (; keepA && i < a->count; i++)
+    {
+        values[count++] = a->values[i];
+    }
+
+    for (; keepB && j < b->count; j++)
+    {
+        values[count++] = b->values[j];
+    }
+
+    AvmBitContainer container = {
+        .count = count,
+        .capacity = a->count + b->count,
+        .values = values,
+    };
+
+    if (count == 0)
+    {
+        AvmDealloc(values);
+        container.values = NULL;
+    }
+    else if (count > ARRAY_MAX)
+    {
+        // Read the values as an array before the count marks them a bitmap.
+        ulong* words = AvmAlloc(BITMAP_WORDS * sizeof(ulong));
+
+        container.count = ARRAY_MAX;
+        AvmContainerToWords(&container, words);
+        container.count = count;
+
+        for (uint k = ARRAY_MAX; k < count; k++)
+        {
+            words[values[k] / WORD_BITS] |= 1ull << (values[k] % WORD_BITS);
+        }
+
+        AvmDealloc(values);
+        container.words = words;
+    }
+
+    return container;
+}
+
+// Keeps the values of an array group that are in another group.
+static AvmBitContainer AvmContainerFilter(const AvmBitContainer* array,
+                                          const AvmBitContainer* other)
+{
+    ushort* values = AvmAlloc(array->count * sizeof(ushort));
+    uint count = 0;
+
+    for (uint i = 0; i < array->count; i++)
+    {
+        if (AvmContainerGet(other, array->values[i]))
+        {
+            values[count++] = array->values[i];
+        }
+    }
+
+    if (count == 0)
+    {
+        AvmDealloc(values);
+        values = NULL;
+    }
+
+    return (AvmBitContainer){
+        .count = count,
+        .capacity = array->count,
+        .values = values,
+    };
+}
+
+static AvmBitContainer AvmContainerCombine(const AvmBitContainer* a,
+                                           const AvmBitContainer* b,
+                                           AvmBitOp op)
+{
+    const bool bitmapA = AvmContainerIsBitmap(a);
+    const bool bitmapB = AvmContainerIsBitmap(b);
+
+    if (!bitmapA && !bitmapB)
+    {
+        return AvmContainerMergeArrays(a, b, op);
+    }
+
+    if (op == BitOpAnd && !bitmapA)
+    {
+        return AvmContainerFilter(a, b);
+    }
+
+    if (op == BitOpAnd && !bitmapB)
+    {
+        return AvmContainerFilter(b, a);
+    }
+
+    ulong* words = AvmAlloc(BITMAP_WORDS * sizeof(ulong));
+    AvmContainerToWords(a, words);
+
+    if (bitmapB)
+    {
+        AvmBitsApply(op, words, b->words, BITMAP_WORDS);
+    }
+    else
+    {
+        ulong* other = AvmAlloc(BITMAP_WORDS * sizeof(ulong));
+        AvmContainerToWords(b, other);
+        AvmBitsApply(op, words, other, BITMAP_WORDS);
+        AvmDealloc(other);
+    }
+
+    return AvmContainerFromWords(words);
+}
+
+//
+// AvmSparseBitSet.
+//
+
+// Returns the index of the first group whose key is not less than key.
+static uint AvmSparseBitSetFind(const AvmSparseBitSet* self, uint key)
+{
+    uint low = 0;
+    uint count = self->_groupCount;
+
+    while (count != 0)
+    {
+        const uint half = count / 2;
+
+        if (self->_keys[low + half] < key)
+        {
+            low += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+
+    return low;
+}
+
+static void AvmSparseBitSetReserve(AvmSparseBitSet* self, uint count)
+{
+    if (count <= self->_groupCapacity)
+    {
+        return;
+    }
+
+    uint capacity = self->_groupCapacity * AVM_ARRAY_LIST_GROWTH_FACTOR;
+    if (capacity < count)
+    {
+        capacity = count < MIN_CAPACITY ? MIN_CAPACITY : count;
+    }
+
+    self->_keys = AvmRealloc(self->_keys, capacity * sizeof(ushort));
+    self->_groups =
+        AvmRealloc(self->_groups, capacity * sizeof(AvmBitContainer));
+    self->_groupCapacity = capacity;
+}
+
+static void AvmSparseBitSetClear(AvmSparseBitSet* self);
+
+static void AvmSparseBitSetApply(AvmSparseBitSet* self,
+                                 const AvmSparseBitSet* other,
+                                 AvmBitOp op)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(other != NULL);
+    }
+
+    if (self == other)
+    {
+        if (op == BitOpXor || op == BitOpAndNot)
+        {
+            AvmSparseBitSetClear(self);
+        }
+
+        return;
+    }
+
+    const uint capacity = self->_groupCount + other->_groupCount;
+    ushort* keys = AvmAlloc((capacity + 1) * sizeof(ushort));
+    AvmBitContainer* groups =
+        AvmAlloc((capacity + 1) * sizeof(AvmBitContainer));
+    uint count = 0;
+    uint length = 0;
+    uint i = 0, j = 0;
+
+    while (i < self->_groupCount || j < other->_groupCount)
+    {
+        const uint a = i < self->_groupCount ? self->_keys[i] : (uint)-1;
+        const uint b = j < other->_groupCount ? other->_keys[j] : (uint)-1;
+        AvmBitContainer group;
+
+        if (a < b)
+        {
+            group = self->_groups[i++];
+
+            if (op == BitOpAnd)
+            {
+                AvmContainerFree(&group);
+                continue;
+            }
+        }
+        else if (b < a)
+        {
+            j++;
+
+            if (op == BitOpAnd || op == BitOpAndNot)
+            {
+                continue;
+            }
+
+            group = AvmContainerClone(&other->_groups[j - 1]);
+        }
+        else
+        {
+            group = AvmContainerCombine(
+                &self->_groups[i], &other->_groups[j], op);
+            AvmContainerFree(&self->_groups[i]);
+            i++;
+            j++;
+
+            if (group.count == 0)
+            {
+                continue;
+            }
+        }
+
+        keys[count] = (ushort)(a < b ? a : b);
+        groups[count] = group;
+        length += group.count;
+        count++;
+    }
+
+    AvmDealloc(self->_keys);
+    AvmDealloc(self->_groups);
+
+    self->_keys = keys;
+    self->_groups = groups;
+    self->_groupCount = count;
+    self->_groupCapacity = capacity + 1;
+    self->_length = length;
+}
+
+static uint AvmSparseBitSetGetLength(const AvmSparseBitSet* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static bool AvmSparseBitSetEquals(const AvmSparseBitSet* self,
+                                  const AvmSparseBitSet* other)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(other != NULL);
+    }
+
+    if (self->_length != other->_length ||
+        self->_groupCount != other->_groupCount)
+    {
+        return false;
+    }
+
+    for (uint i = 0; i < self->_groupCount; i++)
+    {
+        const AvmBitContainer* a = &self->_groups[i];
+        const AvmBitContainer* b = &other->_groups[i];
+
+        if (self->_keys[i] != other->_keys[i] || a->count != b->count)
+        {
+            return false;
+        }
+
+        // Groups of the same size have the same representation.
+        const bool equal =
+            AvmContainerIsBitmap(a)
+                ? memcmp(a->words, b->words, BITMAP_WORDS * sizeof(ulong)) == 0
+                : memcmp(a->values, b->values, a->count * sizeof(ushort)) == 0;
+
+        if (!equal)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static ulong AvmSparseBitSetHash(const AvmSparseBitSet* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    ulong hash = AvmHashBytes(self->_groupCount * sizeof(ushort), self->_keys);
+
+    for (uint i = 0; i < self->_groupCount; i++)
+    {
+        const AvmBitContainer* group = &self->_groups[i];
+
+        hash = AvmHashCombine(
+            hash,
+            AvmContainerIsBitmap(group)
+                ? AvmHashBytes(BITMAP_WORDS * sizeof(ulong), group->words)
+                : AvmHashBytes(group->count * sizeof(ushort), group->values));
+    }
+
+    return hash;
+}
+
+static void AvmSparseBitSetClear(AvmSparseBitSet* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    for (uint i = 0; i < self->_groupCount; i++)
+    {
+        AvmContainerFree(&self->_groups[i]);
+    }
+
+    self->_groupCount = 0;
+    self->_length = 0;
+}
+
+static AvmString AvmSparseBitSetToString(const AvmSparseBitSet* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmString s = AvmStringNew(16);
+    uint value = AvmSparseBitSetNextSet(self, 0);
+
+    AvmStringPushStr(&s, "{ ");
+    while (value != AvmInvalid)
+    {
+        AvmStringPushUint(&s, value, NumericBaseDecimal);
+        value = AvmSparseBitSetNextSet(self, value + 1);
+
+        if (value != AvmInvalid)
+        {
+            AvmStringPushStr(&s, ", ");
+        }
+    }
+    AvmStringPushStr(&s, " }");
+    return s;
+}
+
+AVM_TYPE(AvmSparseBitSet,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmSparseBitSetGetLength,
+             [FnEntryEquals] = (AvmFunction)AvmSparseBitSetEquals,
+             [FnEntryHash] = (AvmFunction)AvmSparseBitSetHash,
+             [FnEntryClear] = (AvmFunction)AvmSparseBitSetClear,
+             [FnEntryToString] = (AvmFunction)AvmSparseBitSetToString,
+         });
+
+AvmSparseBitSet AvmSparseBitSetNew(void)
+{
+    return (AvmSparseBitSet){
+        ._type = typeid(AvmSparseBitSet),
+        ._length = 0,
+        ._groupCount = 0,
+        ._groupCapacity = 0,
+        ._keys = NULL,
+        ._groups = NULL,
+    };
+}
+
+bool AvmSparseBitSetGet(const AvmSparseBitSet* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const uint key = index >> GROUP_BITS;
+    const uint group = AvmSparseBitSetFind(self, key);
+
+    return group < self->_groupCount && self->_keys[group] == key &&
+           AvmContainerGet(&self->_groups[group], index & GROUP_MASK);
+}
+
+void AvmSparseBitSetSet(AvmSparseBitSet* self, uint index, bool value)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    // Reserved, so that AvmSparseBitSetNextSet can return it.
+    if (index == AvmInvalid)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    const uint key = index >> GROUP_BITS;
+    const uint low = index & GROUP_MASK;
+    const uint group = AvmSparseBitSetFind(self, key);
+
+    if (group < self->_groupCount && self->_keys[group] == key)
+    {
+        AvmBitContainer* container = &self->_groups[group];
+
+        if (!AvmContainerSet(container, low, value))
+        {
+            return;
+        }
+
+        if (value)
+        {
+            self->_length++;
+            return;
+        }
+
+        self->_length--;
+
+        if (container->count == 0)
+        {
+            AvmContainerFree(container);
+
+            const uint after = self->_groupCount - group - 1;
+            memmove(self->_keys + group,
+                    self->_keys + group + 1,
+                    after * sizeof(ushort));
+            memmove(self->_groups + group,
+                    self->_groups + group + 1,
+                    after * sizeof(AvmBitContainer));
+            self->_groupCount--;
+        }
+
+        return;
+    }
+
+    if (!value)
+    {
+        return;
+    }
+
+    AvmSparseBitSetReserve(self, self->_groupCount + 1);
+
+    const uint after = self->_groupCount - group;
+    memmove(self->_keys + group + 1,
+            self->_keys + group,
+            after * sizeof(ushort));
+    memmove(self->_groups + group + 1,
+            self->_groups + group,
+            after * sizeof(AvmBitContainer));
+
+    AvmBitContainer* container = &self->_groups[group];
+    container->count = 1;
+    container->capacity = MIN_CAPACITY;
+    container->values = AvmAlloc(MIN_CAPACITY * sizeof(ushort));
+    container->values[0] = (ushort)low;
+
+    self->_keys[group] = (ushort)key;
+    self->_groupCount++;
+    self->_length++;
+}
+
+uint AvmSparseBitSetCount(const AvmSparseBitSet* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+uint AvmSparseBitSetNextSet(const AvmSparseBitSet* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const uint key = index >> GROUP_BITS;
+    uint group = AvmSparseBitSetFind(self, key);
+
+    if (group < self->_groupCount && self->_keys[group] == key)
+    {
+        const uint low =
+            AvmContainerNextSet(&self->_groups[group], index & GROUP_MASK);
+
+        if (low != AvmInvalid)
+        {
+            return (key << GROUP_BITS) | low;
+        }
+
+        group++;
+    }
+
+    if (group == self->_groupCount)
+    {
+        return AvmInvalid;
+    }
+
+    // Groups are never empty.
+    return ((uint)self->_keys[group] << GROUP_BITS) |
+           AvmContainerNextSet(&self->_groups[group], 0);
+}
+
+void AvmSparseBitSetAnd(AvmSparseBitSet* self, const AvmSparseBitSet* other)
+{
+    AvmSparseBitSetApply(self, other, BitOpAnd);
+}
+
+void AvmSparseBitSetOr(AvmSparseBitSet* self, const AvmSparseBitSet* other)
+{
+    AvmSparseBitSetApply(self, other, BitOpOr);
+}
+
+void AvmSparseBitSetXor(AvmSparseBitSet* self, const AvmSparseBitSet* other)
+{
+    AvmSparseBitSetApply(self, other, BitOpXor);
+}
+
+void AvmSparseBitSetAndNot(AvmSparseBitSet* self, const AvmSparseBitSet* other)
+{
+    AvmSparseBitSetApply(self, other, BitOpAndNot);
+}
@@ -0,0 +1,372 @@
+#include "avium/collections/bloom-filter.h"
+
+#include "avium/core.h"
+#include "avium/error.h"
+#include "avium/private/collections.h"
+#include "avium/private/errors.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+// A block is a 64-byte cache line.
+#define BLOCK_WORDS 8
+#define BLOCK_BITS  (BLOCK_WORDS * 64)
+
+#define MAX_HASH_COUNT 16
+
+// Identifies serialized filters, and serialized filters of the other
+// endianness.
+#define MAGIC 0x46424D41 // "AMBF"
+
+// Returns the base 2 logarithm of a positive number, accurate to about six
+// decimal places.
+static double AvmLog2(double value)
+{
+    double result = 0;
+
+    while (value >= 2)
+    {
+        value /= 2;
+        result++;
+    }
+
+    while (value < 1)
+    {
+        value *= 2;
+        result--;
+    }
+
+    // Squaring doubles the logarithm, so each step yields one fraction bit.
+    for (double bit = 0.5; bit > 1e-7; bit /= 2)
+    {
+        value *= value;
+
+        if (value >= 2)
+        {
+            value /= 2;
+            result += bit;
+        }
+    }
+
+    return result;
+}
+
+// Returns e to the power of -value, for a non-negative value, from a few
+// terms of its series at value / 1024, squared 10 times.
+static double AvmExpNegative(double value)
+{
+    const double x = value / 1024;
+    double result = 1 - x * (1 - x / 2 * (1 - x / 3 * (1 - x / 4)));
+
+    for (uint i = 0; i < 10; i++)
+    {
+        result *= result;
+    }
+
+    return result;
+}
+
+// Returns the false positive rate of a blocked filter with the given number
+// of items per block on average. The items of a block follow a Poisson
+// distribution, and each block is a classic Bloom filter.
+static double AvmBloomFilterRate(double load, uint hashCount)
+{
+    const double keep = 1 - 1.0 / BLOCK_BITS;
+    double keepPerItem = 1; // The chance that an item leaves a bit clear.
+
+    for (uint i = 0; i < hashCount; i++)
+    {
+        keepPerItem *= keep;
+    }
+
+    double probability = AvmExpNegative(load);
+    double clear = 1; // The chance that a bit is clear.
+    double rate = 0;
+
+    for (uint items = 0; items < 4 * load + 64; items++)
+    {
+        double positive = 1;
+
+        for (uint i = 0; i < hashCount; i++)
+        {
+            positive *= 1 - clear;
+        }
+
+        rate += probability * positive;
+        probability *= load / (items + 1);
+        clear *= keepPerItem;
+    }
+
+    return rate;
+}
+
+// Builds the mask of the bits of a hash within its block and returns the
+// block. The upper half of the hash picks the block, and the bits are taken
+// 9 at a time from a remix of the whole hash, so they do not depend on the
+// block.
+static ulong* AvmBloomFilterProbe(const AvmBloomFilter* self,
+                                  ulong hash,
+                                  ulong mask[BLOCK_WORDS])
+{
+    const uint block = (uint)(((hash >> 32) * self->_blockCount) >> 32);
+    ulong bits = 0;
+
+    memset(mask, 0, BLOCK_WORDS * sizeof(ulong));
+
+    for (uint i = 0; i < self->_hashCount; i++, bits <<= 9)
+    {
+        // A splitmix64 step yields 7 more positions.
+        if (i % 7 == 0)
+        {
+            hash += 0x9E3779B97F4A7C15ull;
+            bits = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+            bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EBull;
+            bits ^= bits >> 31;
+        }
+
+        const uint bit = (uint)(bits >> 55);
+        mask[bit / 64] |= 1ull << (bit % 64);
+    }
+
+    return self->_blocks + (size_t)block * BLOCK_WORDS;
+}
+
+static uint AvmBloomFilterGetLength(const AvmBloomFilter* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static uint AvmBloomFilterGetCapacity(const AvmBloomFilter* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_capacity;
+}
+
+static const AvmType* AvmBloomFilterGetItemType(const AvmBloomFilter* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_itemType;
+}
+
+static void AvmBloomFilterClear(AvmBloomFilter* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    memset(self->_blocks,
+           0,
+           (size_t)self->_blockCount * BLOCK_WORDS * sizeof(ulong));
+    self->_length = 0;
+}
+
+AVM_TYPE(AvmBloomFilter,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmBloomFilterGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmBloomFilterGetCapacity,
+             [FnEntryGetItemType] = (AvmFunction)AvmBloomFilterGetItemType,
+             [FnEntryClear] = (AvmFunction)AvmBloomFilterClear,
+         });
+
+AvmBloomFilter AvmBloomFilterNew(const AvmType* type,
+                                 uint capacity,
+                                 double rate)
+{
+    pre
+    {
+        assert(type != NULL);
+        assert(rate > 0 && rate < 1);
+    }
+
+    // A classic filter needs log2(1 / rate) hashes and log2(e) bits per item
+    // for each of them. Blocking needs a few more bits, so they are added
+    // until the rate of the blocked filter is low enough.
+    double bits = -AvmLog2(rate) * 1.4426950408889634;
+    uint hashCount = 1;
+
+    for (;; bits *= 1.05)
+    {
+        double best = 1;
+
+        for (uint k = 1; k <= MAX_HASH_COUNT; k++)
+        {
+            const double kRate = AvmBloomFilterRate(BLOCK_BITS / bits, k);
+
+            if (kRate < best)
+            {
+                best = kRate;
+                hashCount = k;
+            }
+        }
+
+        if (best <= rate || bits > BLOCK_BITS / 4)
+        {
+            break;
+        }
+    }
+
+    const double blocks = bits * capacity / BLOCK_BITS + 1;
+
+    AvmBloomFilter self = {
+        ._type = typeid(AvmBloomFilter),
+        ._length = 0,
+        ._capacity = capacity,
+        ._hashCount = hashCount,
+        ._blockCount = blocks >= (uint)-1 ? (uint)-1 : (uint)blocks,
+        ._itemType = type,
+    };
+
+    self._blocks =
+        AvmAlloc((size_t)self._blockCount * BLOCK_WORDS * sizeof(ulong));
+    AvmBloomFilterClear(&self);
+    return self;
+}
+
+void AvmBloomFilterAdd(AvmBloomFilter* self, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    ulong mask[BLOCK_WORDS];
+    ulong* block = AvmBloomFilterProbe(
+        self, __AvmHashItem(self->_itemType, value), mask);
+
+    for (uint i = 0; i < BLOCK_WORDS; i++)
+    {
+        block[i] |= mask[i];
+    }
+
+    if (self->_length != (uint)-1)
+    {
+        self->_length++;
+    }
+}
+
+bool AvmBloomFilterContains(const AvmBloomFilter* self, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    ulong mask[BLOCK_WORDS];
+    const ulong* block = AvmBloomFilterProbe(
+        self, __AvmHashItem(self->_itemType, value), mask);
+
+    // Check the whole block, so the loop has no branches to mispredict.
+    ulong missing = 0;
+
+    for (uint i = 0; i < BLOCK_WORDS; i++)
+    {
+        missing |= mask[i] & ~block[i];
+    }
+
+    return missing == 0;
+}
+
+#ifdef AVM_USE_IO
+typedef struct
+{
+    uint magic;
+    uint itemSize;
+    uint length;
+    uint capacity;
+    uint hashCount;
+    uint blockCount;
+} AvmBloomFilterHeader;
+
+AvmError* AvmBloomFilterWrite(const AvmBloomFilter* self, AvmStream* stream)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(stream != NULL);
+    }
+
+    AvmBloomFilterHeader header = {
+        .magic = MAGIC,
+        .itemSize = self->_itemType->_size,
+        .length = self->_length,
+        .capacity = self->_capacity,
+        .hashCount = self->_hashCount,
+        .blockCount = self->_blockCount,
+    };
+
+    AvmError* error =
+        AvmStreamWrite(stream, sizeof(header), (byte*)&header);
+
+    if (error != NULL)
+    {
+        return error;
+    }
+
+    return AvmStreamWrite(stream,
+                          (size_t)self->_blockCount * BLOCK_WORDS *
+                              sizeof(ulong),
+                          (byte*)self->_blocks);
+}
+
+AvmError* AvmBloomFilterRead(AvmBloomFilter* self, AvmStream* stream)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(stream != NULL);
+    }
+
+    AvmBloomFilterHeader header;
+    AvmError* error = AvmStreamRead(stream, sizeof(header), (byte*)&header);
+
+    if (error != NULL)
+    {
+        return error;
+    }
+
+    if (header.magic != MAGIC ||
+        header.itemSize != self->_itemType->_size || header.hashCount == 0 ||
+        header.hashCount > MAX_HASH_COUNT || header.blockCount == 0)
+    {
+        return AvmErrorNew(FormatError);
+    }
+
+    const size_t size =
+        (size_t)header.blockCount * BLOCK_WORDS * sizeof(ulong);
+    ulong* blocks = AvmAlloc(size);
+
+    error = AvmStreamRead(stream, size, (byte*)blocks);
+
+    if (error != NULL)
+    {
+        AvmDealloc(blocks);
+        return error;
+    }
+
+    AvmDealloc(self->_blocks);
+    self->_blocks = blocks;
+    self->_length = header.length;
+    self->_capacity = header.capacity;
+    self->_hashCount = header.hashCount;
+    self->_blockCount = header.blockCount;
+    return NULL;
+}
+#endif // AVM_USE_IO
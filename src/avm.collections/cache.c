@@ -0,0 +1,759 @@
+#include "avium/collections/cache.h"
+
+#include "avium/core.h"
+#include "avium/error.h"
+#include "avium/private/collections.h"
+#include "avium/private/errors.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+#ifdef AVM_WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// The index has at least twice as many positions as there are slots.
+#define MAX_CAPACITY (1u << 30)
+
+// Shards are padded to a cache line, so their locks do not share one.
+#define CACHE_LINE_SIZE 64
+
+typedef bool (*AvmEqualsFunc)(object, object);
+typedef void (*AvmDtorFunc)(object);
+
+typedef struct AvmCacheSlot
+{
+    ulong hash;
+    ulong weight;
+    bool used;
+    bool referenced; // Set by lookups, cleared by the hand.
+} AvmCacheSlot;
+
+typedef struct AvmCacheShard
+{
+    AvmCache cache;
+#ifdef AVM_WIN32
+    SRWLOCK lock;
+#else
+    pthread_mutex_t lock;
+#endif
+    byte padding[CACHE_LINE_SIZE];
+} AvmCacheShard;
+
+//
+// AvmCache.
+//
+
+static inline uint AvmAlignUp8(uint value)
+{
+    return (value + 7) & ~7u;
+}
+
+// Entries hold the key, followed by the value at an 8-byte boundary.
+static inline uint AvmCacheValueOffset(const AvmCache* self)
+{
+    return AvmAlignUp8(self->_keyType->_size);
+}
+
+static inline uint AvmCacheEntrySize(const AvmCache* self)
+{
+    return AvmAlignUp8(AvmCacheValueOffset(self) + self->_valueType->_size);
+}
+
+static inline byte* AvmCacheKeyAt(const AvmCache* self, uint slot)
+{
+    return self->_entries + (size_t)slot * AvmCacheEntrySize(self);
+}
+
+static inline byte* AvmCacheValueAt(const AvmCache* self, uint slot)
+{
+    return AvmCacheKeyAt(self, slot) + AvmCacheValueOffset(self);
+}
+
+// Returns the position in the index of the slot that holds a key, or
+// AvmInvalid. The index is at most half full, so probing ends at an empty
+// position.
+static uint AvmCacheFind(const AvmCache* self, object key, ulong hash)
+{
+    const AvmEqualsFunc equals =
+        (AvmEqualsFunc)AvmTypeTryGetFunction(self->_keyType, FnEntryEquals);
+
+    for (uint i = (uint)hash & self->_indexMask;;
+         i = (i + 1) & self->_indexMask)
+    {
+        const uint slot = self->_index[i];
+
+        if (slot == AvmInvalid)
+        {
+            return AvmInvalid;
+        }
+
+        if (self->_slots[slot].hash != hash)
+        {
+            continue;
+        }
+
+        const byte* other = AvmCacheKeyAt(self, slot);
+        const bool equal =
+            equals != NULL ? equals(key, (object)other)
+                           : memcmp(key, other, self->_keyType->_size) == 0;
+
+        if (equal)
+        {
+            return i;
+        }
+    }
+}
+
+// Returns the position in the index of a used slot.
+static uint AvmCachePositionOf(const AvmCache* self, uint slot)
+{
+    uint i = (uint)self->_slots[slot].hash & self->_indexMask;
+
+    while (self->_index[i] != slot)
+    {
+        i = (i + 1) & self->_indexMask;
+    }
+
+    return i;
+}
+
+// Empties a position of the index. Later positions of the same probe
+// sequence are shifted back, so that lookups need no tombstones.
+static void AvmCacheUnindex(AvmCache* self, uint position)
+{
+    const uint mask = self->_indexMask;
+    uint hole = position;
+
+    for (uint i = (position + 1) & mask; self->_index[i] != AvmInvalid;
+         i = (i + 1) & mask)
+    {
+        const uint home = (uint)self->_slots[self->_index[i]].hash & mask;
+
+        // The slot can move back if the hole is between its home and it.
+        if (((i - home) & mask) >= ((i - hole) & mask))
+        {
+            self->_index[hole] = self->_index[i];
+            hole = i;
+        }
+    }
+
+    self->_index[hole] = AvmInvalid;
+}
+
+static void AvmCacheFinalize(const AvmCache* self, object key, object value)
+{
+    AvmDtorFunc keyDtor =
+        (AvmDtorFunc)AvmTypeTryGetFunction(self->_keyType, FnEntryDtor);
+    AvmDtorFunc valueDtor =
+        (AvmDtorFunc)AvmTypeTryGetFunction(self->_valueType, FnEntryDtor);
+
+    if (keyDtor != NULL)
+    {
+        keyDtor(key);
+    }
+
+    if (valueDtor != NULL)
+    {
+        valueDtor(value);
+    }
+}
+
+// Finalizes the entry at a position of the index and frees its slot.
+static void AvmCacheDrop(AvmCache* self, uint position)
+{
+    const uint slot = self->_index[position];
+
+    AvmCacheUnindex(self, position);
+    AvmCacheFinalize(
+        self, AvmCacheKeyAt(self, slot), AvmCacheValueAt(self, slot));
+
+    self->_weight -= self->_slots[slot].weight;
+    self->_slots[slot].used = false;
+    self->_free[self->_freeCount++] = slot;
+    self->_length--;
+}
+
+// Evicts the first entry after the hand that was not used since the hand
+// last passed it. The cache must not be empty.
+static void AvmCacheEvict(AvmCache* self)
+{
+    while (true)
+    {
+        const uint slot = self->_hand;
+        AvmCacheSlot* s = &self->_slots[slot];
+
+        self->_hand = slot + 1 == self->_capacity ? 0 : slot + 1;
+
+        if (!s->used)
+        {
+            continue;
+        }
+
+        if (s->referenced)
+        {
+            s->referenced = false;
+            continue;
+        }
+
+        AvmCacheDrop(self, AvmCachePositionOf(self, slot));
+        self->_statistics.Evictions++;
+        return;
+    }
+}
+
+static object AvmCacheGetHashed(AvmCache* self, object key, ulong hash)
+{
+    const uint position = AvmCacheFind(self, key, hash);
+
+    if (position == AvmInvalid)
+    {
+        self->_statistics.Misses++;
+        return NULL;
+    }
+
+    const uint slot = self->_index[position];
+
+    self->_statistics.Hits++;
+    self->_slots[slot].referenced = true;
+    return AvmCacheValueAt(self, slot);
+}
+
+static void AvmCacheInsertHashed(AvmCache* self,
+                                 object key,
+                                 object value,
+                                 ulong hash)
+{
+    const ulong weight =
+        self->_weigher == NULL ? 0 : self->_weigher(key, value);
+    const uint position = AvmCacheFind(self, key, hash);
+
+    if (position != AvmInvalid)
+    {
+        const uint slot = self->_index[position];
+        AvmDtorFunc dtor =
+            (AvmDtorFunc)AvmTypeTryGetFunction(self->_valueType, FnEntryDtor);
+
+        if (dtor != NULL)
+        {
+            dtor(AvmCacheValueAt(self, slot));
+        }
+
+        memcpy(AvmCacheValueAt(self, slot), value, self->_valueType->_size);
+        self->_weight += weight - self->_slots[slot].weight;
+        self->_slots[slot].weight = weight;
+        self->_slots[slot].referenced = true;
+
+        if (weight > self->_budget)
+        {
+            AvmCacheDrop(self, position);
+            self->_statistics.Evictions++;
+        }
+
+        while (self->_weight > self->_budget)
+        {
+            AvmCacheEvict(self);
+        }
+
+        return;
+    }
+
+    if (weight > self->_budget)
+    {
+        AvmCacheFinalize(self, key, value);
+        self->_statistics.Evictions++;
+        return;
+    }
+
+    while (self->_freeCount == 0 || self->_weight + weight > self->_budget)
+    {
+        AvmCacheEvict(self);
+    }
+
+    const uint slot = self->_free[--self->_freeCount];
+
+    memcpy(AvmCacheKeyAt(self, slot), key, self->_keyType->_size);
+    memcpy(AvmCacheValueAt(self, slot), value, self->_valueType->_size);
+    self->_slots[slot] = (AvmCacheSlot){
+        .hash = hash,
+        .weight = weight,
+        .used = true,
+        .referenced = false,
+    };
+
+    uint i = (uint)hash & self->_indexMask;
+    while (self->_index[i] != AvmInvalid)
+    {
+        i = (i + 1) & self->_indexMask;
+    }
+
+    self->_index[i] = slot;
+    self->_weight += weight;
+    self->_length++;
+}
+
+static bool AvmCacheRemoveHashed(AvmCache* self, object key, ulong hash)
+{
+    const uint position = AvmCacheFind(self, key, hash);
+
+    if (position == AvmInvalid)
+    {
+        return false;
+    }
+
+    AvmCacheDrop(self, position);
+    return true;
+}
+
+static uint AvmCacheGetLength(const AvmCache* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static uint AvmCacheGetCapacity(const AvmCache* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_capacity;
+}
+
+static const AvmType* AvmCacheGetKeyType(const AvmCache* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_keyType;
+}
+
+static const AvmType* AvmCacheGetValueType(const AvmCache* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_valueType;
+}
+
+// Lookups count towards the statistics and mark the entry as used.
+static object AvmCacheGet(AvmCache* self, object key)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL);
+    }
+
+    return AvmCacheGetHashed(self, key, __AvmHashItem(self->_keyType, key));
+}
+
+static void AvmCacheInsert(AvmCache* self, object key, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL);
+        assert(value != NULL);
+    }
+
+    AvmCacheInsertHashed(
+        self, key, value, __AvmHashItem(self->_keyType, key));
+}
+
+static bool AvmCacheRemove(AvmCache* self, object key)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL);
+    }
+
+    return AvmCacheRemoveHashed(
+        self, key, __AvmHashItem(self->_keyType, key));
+}
+
+static void AvmCacheClear(AvmCache* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    for (uint i = 0; i < self->_capacity; i++)
+    {
+        if (self->_slots[i].used)
+        {
+            AvmCacheFinalize(
+                self, AvmCacheKeyAt(self, i), AvmCacheValueAt(self, i));
+        }
+
+        self->_slots[i].used = false;
+        self->_free[i] = self->_capacity - 1 - i;
+    }
+
+    memset(self->_index, 0xFF, ((size_t)self->_indexMask + 1) * sizeof(uint));
+    self->_length = 0;
+    self->_freeCount = self->_capacity;
+    self->_hand = 0;
+    self->_weight = 0;
+}
+
+static AvmString AvmCacheToString(const AvmCache* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmString s = AvmStringNew(self->_length * 4);
+    uint remaining = self->_length;
+
+    AvmStringPushStr(&s, "{ ");
+    for (uint i = 0; i < self->_capacity && remaining != 0; i++)
+    {
+        if (!self->_slots[i].used)
+        {
+            continue;
+        }
+
+        __AvmStringPushItem(&s, self->_keyType, AvmCacheKeyAt(self, i));
+        AvmStringPushStr(&s, ": ");
+        __AvmStringPushItem(&s, self->_valueType, AvmCacheValueAt(self, i));
+
+        if (--remaining != 0)
+        {
+            AvmStringPushStr(&s, ", ");
+        }
+    }
+    AvmStringPushStr(&s, " }");
+    return s;
+}
+
+AVM_TYPE(AvmCache,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmCacheGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmCacheGetCapacity,
+             [FnEntryGetItemType] = (AvmFunction)AvmCacheGetValueType,
+             [FnEntryGetKeyType] = (AvmFunction)AvmCacheGetKeyType,
+             [FnEntryInsert] = (AvmFunction)AvmCacheInsert,
+             [FnEntryRemove] = (AvmFunction)AvmCacheRemove,
+             [FnEntryItemAt] = (AvmFunction)AvmCacheGet,
+             [FnEntryClear] = (AvmFunction)AvmCacheClear,
+             [FnEntryToString] = (AvmFunction)AvmCacheToString,
+         });
+
+AvmCache AvmCacheNewWeighted(const AvmType* keyType,
+                             const AvmType* valueType,
+                             uint capacity,
+                             ulong budget,
+                             AvmCacheWeigher weigher)
+{
+    pre
+    {
+        assert(keyType != NULL);
+        assert(valueType != NULL);
+        assert(capacity != 0);
+    }
+
+    if (capacity > MAX_CAPACITY)
+    {
+        throw(AvmErrorNew(MemError));
+    }
+
+    uint indexSize = 2;
+    while (indexSize < capacity * 2)
+    {
+        indexSize *= 2;
+    }
+
+    AvmCache self = {
+        ._type = typeid(AvmCache),
+        ._capacity = capacity,
+        ._indexMask = indexSize - 1,
+        ._budget = budget,
+        ._weigher = weigher,
+        ._statistics = {0},
+        ._keyType = keyType,
+        ._valueType = valueType,
+    };
+
+    self._entries = AvmAlloc((size_t)capacity * AvmCacheEntrySize(&self));
+    self._slots = AvmAlloc((size_t)capacity * sizeof(AvmCacheSlot));
+    self._free = AvmAlloc((size_t)capacity * sizeof(uint));
+    self._index = AvmAlloc((size_t)indexSize * sizeof(uint));
+
+    // Clearing also sets up the free slots and the index.
+    for (uint i = 0; i < capacity; i++)
+    {
+        self._slots[i].used = false;
+    }
+
+    AvmCacheClear(&self);
+    return self;
+}
+
+AvmCache AvmCacheNew(const AvmType* keyType,
+                     const AvmType* valueType,
+                     uint capacity)
+{
+    return AvmCacheNewWeighted(keyType, valueType, capacity, (ulong)-1, NULL);
+}
+
+AvmCacheStatistics AvmCacheGetStatistics(const AvmCache* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_statistics;
+}
+
+//
+// AvmShardedCache.
+//
+
+static void AvmCacheShardLock(AvmCacheShard* shard)
+{
+#ifdef AVM_WIN32
+    AcquireSRWLockExclusive(&shard->lock);
+#else
+    pthread_mutex_lock(&shard->lock);
+#endif
+}
+
+static void AvmCacheShardUnlock(AvmCacheShard* shard)
+{
+#ifdef AVM_WIN32
+    ReleaseSRWLockExclusive(&shard->lock);
+#else
+    pthread_mutex_unlock(&shard->lock);
+#endif
+}
+
+// The high bits of the hash pick the shard, and the low bits the position in
+// its index, so that the two are independent.
+static inline AvmCacheShard* AvmShardedCacheShardOf(
+    const AvmShardedCache* self,
+    ulong hash)
+{
+    return &self->_shards[(hash >> 32) >> (32 - self->_shardBits)];
+}
+
+static uint AvmShardedCacheGetLength(AvmShardedCache* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    uint length = 0;
+
+    for (uint i = 0; i < 1u << self->_shardBits; i++)
+    {
+        AvmCacheShard* shard = &self->_shards[i];
+
+        AvmCacheShardLock(shard);
+        length += shard->cache._length;
+        AvmCacheShardUnlock(shard);
+    }
+
+    return length;
+}
+
+static uint AvmShardedCacheGetCapacity(const AvmShardedCache* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_shards[0].cache._capacity << self->_shardBits;
+}
+
+AVM_TYPE(AvmShardedCache,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmShardedCacheGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmShardedCacheGetCapacity,
+         });
+
+AvmShardedCache AvmShardedCacheNew(const AvmType* keyType,
+                                   const AvmType* valueType,
+                                   uint capacity,
+                                   uint shardCount)
+{
+    pre
+    {
+        assert(keyType != NULL);
+        assert(valueType != NULL);
+        assert(capacity != 0);
+    }
+
+    if (shardCount == 0)
+    {
+        shardCount = __AvmGetProcessorCount();
+    }
+
+    // Every shard keeps at least one entry.
+    uint shardBits = 0;
+    while ((1u << shardBits) < shardCount &&
+           (2u << shardBits) <= capacity && shardBits < 16)
+    {
+        shardBits++;
+    }
+
+    const uint count = 1u << shardBits;
+    const uint shardCapacity = (capacity + count - 1) / count;
+
+    AvmShardedCache self = {
+        ._type = typeid(AvmShardedCache),
+        ._shardBits = shardBits,
+        ._keyType = keyType,
+        ._valueType = valueType,
+        ._shards = AvmAlloc(count * sizeof(AvmCacheShard)),
+    };
+
+    for (uint i = 0; i < count; i++)
+    {
+        AvmCacheShard* shard = &self._shards[i];
+
+        shard->cache = AvmCacheNew(keyType, valueType, shardCapacity);
+#ifdef AVM_WIN32
+        InitializeSRWLock(&shard->lock);
+#else
+        pthread_mutex_init(&shard->lock, NULL);
+#endif
+    }
+
+    return self;
+}
+
+bool AvmShardedCacheGet(AvmShardedCache* self, object key, object destination)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL);
+        assert(destination != NULL);
+    }
+
+    const ulong hash = __AvmHashItem(self->_keyType, key);
+    AvmCacheShard* shard = AvmShardedCacheShardOf(self, hash);
+
+    AvmCacheShardLock(shard);
+
+    const object value = AvmCacheGetHashed(&shard->cache, key, hash);
+
+    // The entry may be evicted once the shard is unlocked, so values that
+    // own memory are cloned while it is locked.
+    if (value != NULL)
+    {
+        AvmFunction clone =
+            AvmTypeTryGetFunction(self->_valueType, FnEntryClone);
+
+        if (clone == NULL)
+        {
+            memcpy(destination, value, self->_valueType->_size);
+        }
+        else
+        {
+            object copy = ((object(*)(object))clone)(value);
+            memcpy(destination, copy, self->_valueType->_size);
+            AvmDealloc(copy);
+        }
+    }
+
+    AvmCacheShardUnlock(shard);
+    return value != NULL;
+}
+
+void AvmShardedCacheInsert(AvmShardedCache* self, object key, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL);
+        assert(value != NULL);
+    }
+
+    const ulong hash = __AvmHashItem(self->_keyType, key);
+    AvmCacheShard* shard = AvmShardedCacheShardOf(self, hash);
+
+    AvmCacheShardLock(shard);
+    AvmCacheInsertHashed(&shard->cache, key, value, hash);
+    AvmCacheShardUnlock(shard);
+}
+
+bool AvmShardedCacheRemove(AvmShardedCache* self, object key)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL);
+    }
+
+    const ulong hash = __AvmHashItem(self->_keyType, key);
+    AvmCacheShard* shard = AvmShardedCacheShardOf(self, hash);
+
+    AvmCacheShardLock(shard);
+    const bool removed = AvmCacheRemoveHashed(&shard->cache, key, hash);
+    AvmCacheShardUnlock(shard);
+
+    return removed;
+}
+
+void AvmShardedCacheClear(AvmShardedCache* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    for (uint i = 0; i < 1u << self->_shardBits; i++)
+    {
+        AvmCacheShard* shard = &self->_shards[i];
+
+        AvmCacheShardLock(shard);
+        AvmCacheClear(&shard->cache);
+        AvmCacheShardUnlock(shard);
+    }
+}
+
+AvmCacheStatistics AvmShardedCacheGetStatistics(AvmShardedCache* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmCacheStatistics statistics = {0};
+
+    for (uint i = 0; i < 1u << self->_shardBits; i++)
+    {
+        AvmCacheShard* shard = &self->_shards[i];
+
+        AvmCacheShardLock(shard);
+        statistics.Hits += shard->cache._statistics.Hits;
+        statistics.Misses += shard->cache._statistics.Misses;
+        statistics.Evictions += shard->cache._statistics.Evictions;
+        AvmCacheShardUnlock(shard);
+    }
+
+    return statistics;
+}
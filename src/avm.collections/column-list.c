@@ -0,0 +1,367 @@
+#include "avium/collections/column-list.h"
+
+#include "avium/error.h"
+#include "avium/private/errors.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+typedef void (*AvmDtorFunc)(object);
+
+// Copies items between two strided arrays. Common sizes are copied with
+// constant sizes, which compilers turn into plain loads and stores.
+static void AvmColumnCopy(byte* destination,
+                          size_t destinationStride,
+                          const byte* source,
+                          size_t sourceStride,
+                          size_t size,
+                          uint count)
+{
+#define AVM_COLUMN_COPY(N)                                                     \
+    for (uint i = 0; i < count; i++)                                           \
+    {                                                                          \
+        memcpy(destination + i * destinationStride,                            \
+               source + i * sourceStride,                                      \
+               N);                                                             \
+    }
+
+    switch (size)
+    {
+    case 1:
+        AVM_COLUMN_COPY(1);
+        break;
+    case 2:
+        AVM_COLUMN_COPY(2);
+        break;
+    case 4:
+        AVM_COLUMN_COPY(4);
+        break;
+    case 8:
+        AVM_COLUMN_COPY(8);
+        break;
+    default:
+        AVM_COLUMN_COPY(size);
+        break;
+    }
+
+#undef AVM_COLUMN_COPY
+}
+
+// Finalizes the fields of a range of rows.
+static void AvmColumnListDropRange(AvmColumnList* self, uint index, uint count)
+{
+    for (uint f = 0; f < self->_fieldCount; f++)
+    {
+        const AvmType* type = self->_fields[f].Type;
+        AvmDtorFunc dtor =
+            (AvmDtorFunc)AvmTypeTryGetFunction(type, FnEntryDtor);
+
+        if (dtor == NULL)
+        {
+            continue;
+        }
+
+        for (uint i = index; i < index + count; i++)
+        {
+            dtor(self->_columns[f] + (size_t)i * type->_size);
+        }
+    }
+}
+
+static uint AvmColumnListGetLength(const AvmColumnList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static uint AvmColumnListGetCapacity(const AvmColumnList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_capacity;
+}
+
+AVM_TYPE(AvmColumnList,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmColumnListGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmColumnListGetCapacity,
+         });
+
+AvmColumnList AvmColumnListNew(const AvmType* rowType,
+                               uint fieldCount,
+                               const AvmColumnField fields[],
+                               uint capacity)
+{
+    pre
+    {
+        assert(rowType != NULL);
+        assert(fields != NULL);
+        assert(fieldCount > 0);
+    }
+
+    for (uint i = 0; i < fieldCount; i++)
+    {
+        const size_t end = (size_t)fields[i].Offset + fields[i].Type->_size;
+
+        if (end > rowType->_size)
+        {
+            throw(AvmErrorNew(ArgError));
+        }
+
+        for (uint j = 0; j < i; j++)
+        {
+            if (fields[j].Offset < end &&
+                fields[i].Offset < fields[j].Offset + fields[j].Type->_size)
+            {
+                throw(AvmErrorNew(ArgError));
+            }
+        }
+    }
+
+    AvmColumnList self = {
+        ._type = typeid(AvmColumnList),
+        ._length = 0,
+        ._capacity = capacity,
+        ._fieldCount = fieldCount,
+        ._rowType = rowType,
+        ._fields = AvmAlloc(fieldCount * sizeof(AvmColumnField)),
+        ._columns = AvmAlloc(fieldCount * sizeof(byte*)),
+    };
+
+    memcpy(self._fields, fields, fieldCount * sizeof(AvmColumnField));
+
+    for (uint i = 0; i < fieldCount; i++)
+    {
+        self._columns[i] =
+            capacity == 0
+                ? NULL
+                : AvmAlloc((size_t)capacity * fields[i].Type->_size);
+    }
+
+    return self;
+}
+
+void AvmColumnListReserve(AvmColumnList* self, uint count)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const size_t required = (size_t)self->_length + count;
+
+    if (required <= self->_capacity)
+    {
+        return;
+    }
+
+    if (required > (uint)-1)
+    {
+        throw(AvmErrorNew(MemError));
+    }
+
+    size_t capacity = (size_t)self->_capacity * AVM_ARRAY_LIST_GROWTH_FACTOR;
+
+    if (capacity < required)
+    {
+        capacity = required;
+    }
+
+    if (capacity > (uint)-1)
+    {
+        capacity = (uint)-1;
+    }
+
+    for (uint i = 0; i < self->_fieldCount; i++)
+    {
+        self->_columns[i] = AvmRealloc(self->_columns[i],
+                                       capacity * self->_fields[i].Type->_size);
+    }
+
+    self->_capacity = (uint)capacity;
+}
+
+object AvmColumnListGetColumn(const AvmColumnList* self, uint field)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (field >= self->_fieldCount)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    return self->_columns[field];
+}
+
+AvmIterator AvmColumnListGetColumnIterator(const AvmColumnList* self,
+                                           uint field)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (field >= self->_fieldCount)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    return AvmIteratorFromArray(
+        self->_fields[field].Type, self->_length, self->_columns[field]);
+}
+
+void AvmColumnListPush(AvmColumnList* self, object row)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(row != NULL);
+    }
+
+    AvmColumnListAddRows(self, 1, row);
+}
+
+void AvmColumnListAddRows(AvmColumnList* self, uint count, const void* rows)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(rows != NULL || count == 0);
+    }
+
+    AvmColumnListReserve(self, count);
+
+    for (uint i = 0; i < self->_fieldCount; i++)
+    {
+        const size_t size = self->_fields[i].Type->_size;
+
+        AvmColumnCopy(self->_columns[i] + (size_t)self->_length * size,
+                      size,
+                      (const byte*)rows + self->_fields[i].Offset,
+                      self->_rowType->_size,
+                      size,
+                      count);
+    }
+
+    self->_length += count;
+}
+
+void AvmColumnListGetRow(const AvmColumnList* self,
+                         uint index,
+                         object destination)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(destination != NULL);
+    }
+
+    AvmColumnListGetRows(self, index, 1, destination);
+}
+
+void AvmColumnListGetRows(const AvmColumnList* self,
+                          uint index,
+                          uint count,
+                          void* destination)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(destination != NULL || count == 0);
+    }
+
+    if (index > self->_length || count > self->_length - index)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    for (uint i = 0; i < self->_fieldCount; i++)
+    {
+        const size_t size = self->_fields[i].Type->_size;
+
+        AvmColumnCopy((byte*)destination + self->_fields[i].Offset,
+                      self->_rowType->_size,
+                      self->_columns[i] + (size_t)index * size,
+                      size,
+                      size,
+                      count);
+    }
+}
+
+void AvmColumnListSetRow(AvmColumnList* self, uint index, object row)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(row != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    AvmColumnListDropRange(self, index, 1);
+
+    for (uint i = 0; i < self->_fieldCount; i++)
+    {
+        const size_t size = self->_fields[i].Type->_size;
+
+        memcpy(self->_columns[i] + (size_t)index * size,
+               (const byte*)row + self->_fields[i].Offset,
+               size);
+    }
+}
+
+void AvmColumnListRemove(AvmColumnList* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    AvmColumnListDropRange(self, index, 1);
+
+    for (uint i = 0; i < self->_fieldCount; i++)
+    {
+        const size_t size = self->_fields[i].Type->_size;
+        byte* item = self->_columns[i] + (size_t)index * size;
+
+        memmove(item, item + size, (self->_length - index - 1) * size);
+    }
+
+    self->_length--;
+}
+
+void AvmColumnListTruncate(AvmColumnList* self, uint length)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (length >= self->_length)
+    {
+        return;
+    }
+
+    AvmColumnListDropRange(self, length, self->_length - length);
+    self->_length = length;
+}
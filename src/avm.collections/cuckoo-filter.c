@@ -0,0 +1,389 @@
+#include "avium/collections/cuckoo-filter.h"
+
+#include "avium/core.h"
+#include "avium/error.h"
+#include "avium/private/collections.h"
+#include "avium/private/errors.h"
+#include "avium/private/simd.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+// Buckets are 64-bit words of four 16-bit fingerprints, where 0 marks an
+// empty slot.
+#define SLOT_BITS 16
+#define SLOT_MASK 0xFFFFull
+#define LOW_BITS  0x0001000100010001ull
+#define HIGH_BITS 0x8000800080008000ull
+
+// The number of fingerprints moved before an insertion gives up.
+#define MAX_KICKS 500
+
+// Identifies serialized filters, and serialized filters of the other
+// endianness.
+#define MAGIC 0x46434D41 // "AMCF"
+
+static inline ushort AvmCuckooFingerprint(ulong hash)
+{
+    const ushort fingerprint = (ushort)(hash >> 48);
+    return fingerprint == 0 ? 1 : fingerprint;
+}
+
+// Returns the other bucket of a fingerprint. Applying it twice gives back the
+// first bucket.
+static inline uint AvmCuckooAltBucket(const AvmCuckooFilter* self,
+                                      uint bucket,
+                                      ushort fingerprint)
+{
+    return (bucket ^ (fingerprint * 0x5BD1E995u)) & (self->_bucketCount - 1);
+}
+
+// Returns a mask where the high bit of the lowest slot of a bucket that
+// holds a fingerprint is set, comparing all four slots at once. Higher bits
+// may be set spuriously after a match.
+static inline ulong AvmBucketMatch(ulong bucket, ushort fingerprint)
+{
+    const ulong x = bucket ^ (fingerprint * LOW_BITS);
+    return (x - LOW_BITS) & ~x & HIGH_BITS;
+}
+
+static inline uint AvmBucketSlot(ulong match)
+{
+    return AvmBitScanForward(match) / SLOT_BITS * SLOT_BITS;
+}
+
+static bool AvmCuckooFilterTryInsert(AvmCuckooFilter* self,
+                                     uint bucket,
+                                     ushort fingerprint)
+{
+    const ulong match = AvmBucketMatch(self->_buckets[bucket], 0);
+
+    if (match == 0)
+    {
+        return false;
+    }
+
+    self->_buckets[bucket] |= (ulong)fingerprint << AvmBucketSlot(match);
+    return true;
+}
+
+static bool AvmCuckooFilterTryRemove(AvmCuckooFilter* self,
+                                     uint bucket,
+                                     ushort fingerprint)
+{
+    const ulong match = AvmBucketMatch(self->_buckets[bucket], fingerprint);
+
+    if (match == 0)
+    {
+        return false;
+    }
+
+    self->_buckets[bucket] &= ~(SLOT_MASK << AvmBucketSlot(match));
+    return true;
+}
+
+// A xorshift generator, to pick the fingerprints to move.
+static inline uint AvmCuckooFilterRandom(AvmCuckooFilter* self)
+{
+    ulong x = self->_random;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    self->_random = x;
+    return (uint)(x >> 32);
+}
+
+static uint AvmCuckooFilterGetLength(const AvmCuckooFilter* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static uint AvmCuckooFilterGetCapacity(const AvmCuckooFilter* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_bucketCount * 4;
+}
+
+static const AvmType* AvmCuckooFilterGetItemType(const AvmCuckooFilter* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_itemType;
+}
+
+static void AvmCuckooFilterClear(AvmCuckooFilter* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    memset(self->_buckets, 0, (size_t)self->_bucketCount * sizeof(ulong));
+    self->_length = 0;
+    self->_victim = 0;
+}
+
+AVM_TYPE(AvmCuckooFilter,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmCuckooFilterGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmCuckooFilterGetCapacity,
+             [FnEntryGetItemType] = (AvmFunction)AvmCuckooFilterGetItemType,
+             [FnEntryClear] = (AvmFunction)AvmCuckooFilterClear,
+         });
+
+AvmCuckooFilter AvmCuckooFilterNew(const AvmType* type, uint capacity)
+{
+    pre
+    {
+        assert(type != NULL);
+    }
+
+    // Insertions start failing at about 95% load.
+    const ulong wanted = (ulong)capacity * 5 / 19 + 1;
+    uint bucketCount = 1;
+
+    while (bucketCount < wanted && bucketCount < (1u << 30))
+    {
+        bucketCount *= 2;
+    }
+
+    AvmCuckooFilter self = {
+        ._type = typeid(AvmCuckooFilter),
+        ._length = 0,
+        ._bucketCount = bucketCount,
+        ._victimBucket = 0,
+        ._victim = 0,
+        ._random = 0x2545F4914F6CDD1Dull,
+        ._itemType = type,
+        ._buckets = AvmAlloc((size_t)bucketCount * sizeof(ulong)),
+    };
+
+    AvmCuckooFilterClear(&self);
+    return self;
+}
+
+bool AvmCuckooFilterAdd(AvmCuckooFilter* self, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    // Once a fingerprint did not fit, it is kept aside and the filter is
+    // full, so that no added item is lost.
+    if (self->_victim != 0)
+    {
+        return false;
+    }
+
+    const ulong hash = __AvmHashItem(self->_itemType, value);
+    ushort fingerprint = AvmCuckooFingerprint(hash);
+    uint bucket = (uint)hash & (self->_bucketCount - 1);
+    const uint alt = AvmCuckooAltBucket(self, bucket, fingerprint);
+
+    self->_length++;
+
+    if (AvmCuckooFilterTryInsert(self, bucket, fingerprint) ||
+        AvmCuckooFilterTryInsert(self, alt, fingerprint))
+    {
+        return true;
+    }
+
+    if (AvmCuckooFilterRandom(self) & 1)
+    {
+        bucket = alt;
+    }
+
+    for (uint i = 0; i < MAX_KICKS; i++)
+    {
+        // Swap with a random fingerprint, and move that one to its other
+        // bucket.
+        const uint slot = (AvmCuckooFilterRandom(self) % 4) * SLOT_BITS;
+        const ulong old = self->_buckets[bucket];
+
+        self->_buckets[bucket] =
+            (old & ~(SLOT_MASK << slot)) | ((ulong)fingerprint << slot);
+        fingerprint = (ushort)(old >> slot);
+        bucket = AvmCuckooAltBucket(self, bucket, fingerprint);
+
+        if (AvmCuckooFilterTryInsert(self, bucket, fingerprint))
+        {
+            return true;
+        }
+    }
+
+    self->_victim = fingerprint;
+    self->_victimBucket = bucket;
+    return true;
+}
+
+bool AvmCuckooFilterRemove(AvmCuckooFilter* self, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    const ulong hash = __AvmHashItem(self->_itemType, value);
+    const ushort fingerprint = AvmCuckooFingerprint(hash);
+    const uint bucket = (uint)hash & (self->_bucketCount - 1);
+    const uint alt = AvmCuckooAltBucket(self, bucket, fingerprint);
+
+    if (self->_victim == fingerprint &&
+        (self->_victimBucket == bucket || self->_victimBucket == alt))
+    {
+        self->_victim = 0;
+        self->_length--;
+        return true;
+    }
+
+    if (!AvmCuckooFilterTryRemove(self, bucket, fingerprint) &&
+        !AvmCuckooFilterTryRemove(self, alt, fingerprint))
+    {
+        return false;
+    }
+
+    self->_length--;
+
+    // There may now be room for the fingerprint that did not fit.
+    if (self->_victim != 0)
+    {
+        const uint victimAlt =
+            AvmCuckooAltBucket(self, self->_victimBucket, self->_victim);
+
+        if (AvmCuckooFilterTryInsert(
+                self, self->_victimBucket, self->_victim) ||
+            AvmCuckooFilterTryInsert(self, victimAlt, self->_victim))
+        {
+            self->_victim = 0;
+        }
+    }
+
+    return true;
+}
+
+bool AvmCuckooFilterContains(const AvmCuckooFilter* self, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    const ulong hash = __AvmHashItem(self->_itemType, value);
+    const ushort fingerprint = AvmCuckooFingerprint(hash);
+    const uint bucket = (uint)hash & (self->_bucketCount - 1);
+    const uint alt = AvmCuckooAltBucket(self, bucket, fingerprint);
+
+    if ((AvmBucketMatch(self->_buckets[bucket], fingerprint) |
+         AvmBucketMatch(self->_buckets[alt], fingerprint)) != 0)
+    {
+        return true;
+    }
+
+    return self->_victim == fingerprint &&
+           (self->_victimBucket == bucket || self->_victimBucket == alt);
+}
+
+#ifdef AVM_USE_IO
+typedef struct
+{
+    uint magic;
+    uint itemSize;
+    uint length;
+    uint bucketCount;
+    uint victimBucket;
+    uint victim;
+} AvmCuckooFilterHeader;
+
+AvmError* AvmCuckooFilterWrite(const AvmCuckooFilter* self, AvmStream* stream)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(stream != NULL);
+    }
+
+    AvmCuckooFilterHeader header = {
+        .magic = MAGIC,
+        .itemSize = self->_itemType->_size,
+        .length = self->_length,
+        .bucketCount = self->_bucketCount,
+        .victimBucket = self->_victimBucket,
+        .victim = self->_victim,
+    };
+
+    AvmError* error =
+        AvmStreamWrite(stream, sizeof(header), (byte*)&header);
+
+    if (error != NULL)
+    {
+        return error;
+    }
+
+    return AvmStreamWrite(stream,
+                          (size_t)self->_bucketCount * sizeof(ulong),
+                          (byte*)self->_buckets);
+}
+
+AvmError* AvmCuckooFilterRead(AvmCuckooFilter* self, AvmStream* stream)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(stream != NULL);
+    }
+
+    AvmCuckooFilterHeader header;
+    AvmError* error = AvmStreamRead(stream, sizeof(header), (byte*)&header);
+
+    if (error != NULL)
+    {
+        return error;
+    }
+
+    const uint count = header.bucketCount;
+
+    if (header.magic != MAGIC || header.itemSize != self->_itemType->_size ||
+        count == 0 || (count & (count - 1)) != 0 ||
+        header.victimBucket >= count || header.victim > SLOT_MASK)
+    {
+        return AvmErrorNew(FormatError);
+    }
+
+    const size_t size = (size_t)count * sizeof(ulong);
+    ulong* buckets = AvmAlloc(size);
+
+    error = AvmStreamRead(stream, size, (byte*)buckets);
+
+    if (error != NULL)
+    {
+        AvmDealloc(buckets);
+        return error;
+    }
+
+    AvmDealloc(self->_buckets);
+    self->_buckets = buckets;
+    self->_length = header.length;
+    self->_bucketCount = count;
+    self->_victimBucket = header.victimBucket;
+    self->_victim = (ushort)header.victim;
+    return NULL;
+}
+#endif // AVM_USE_IO
@@ -0,0 +1,560 @@
+#include "avium/collections/deque.h"
+
+#include "avium/collections/list.h"
+#include "avium/core.h"
+#include "avium/error.h"
+#include "avium/private/collections.h"
+#include "avium/private/errors.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+// The smallest capacity of a deque that has items.
+#define MIN_CAPACITY 8
+
+// Returns the address of the item at a logical index, wrapping around the
+// end of the buffer.
+static inline byte* AvmDequeSlot(const AvmDeque* self, uint index)
+{
+    const uint physical = (self->_head + index) & (self->_capacity - 1);
+    return self->_items + (size_t)physical * self->_itemType->_size;
+}
+
+// Returns the number of items from a logical index to the end of the buffer.
+static inline uint AvmDequeContiguous(const AvmDeque* self, uint index)
+{
+    return self->_capacity -
+           ((self->_head + index) & (self->_capacity - 1));
+}
+
+// Copies count items starting at a logical index to an array, in at most two
+// segments.
+static void AvmDequeCopyOut(const AvmDeque* self,
+                            uint index,
+                            uint count,
+                            byte* destination)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t size = self->_itemType->_size;
+    const uint contiguous = AvmDequeContiguous(self, index);
+    const uint first = count < contiguous ? count : contiguous;
+
+    memcpy(destination, AvmDequeSlot(self, index), first * size);
+    memcpy(destination + first * size, self->_items, (count - first) * size);
+}
+
+// Copies count items from an array to the slots starting at a logical index,
+// in at most two segments.
+static void AvmDequeCopyIn(AvmDeque* self,
+                           uint index,
+                           uint count,
+                           const byte* source)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t size = self->_itemType->_size;
+    const uint contiguous = AvmDequeContiguous(self, index);
+    const uint first = count < contiguous ? count : contiguous;
+
+    memcpy(AvmDequeSlot(self, index), source, first * size);
+    memcpy(self->_items, source + first * size, (count - first) * size);
+}
+
+// Makes room for count more items. A grown deque starts at the beginning of
+// its new buffer.
+static void AvmDequeReserve(AvmDeque* self, uint count)
+{
+    const uint required = self->_length + count;
+
+    if (required <= self->_capacity)
+    {
+        return;
+    }
+
+    if (required < count || required > (1u << 31))
+    {
+        throw(AvmErrorNew(MemError));
+    }
+
+    uint capacity = self->_capacity == 0 ? MIN_CAPACITY : self->_capacity;
+    while (capacity < required)
+    {
+        capacity *= 2;
+    }
+
+    byte* items = AvmAlloc((size_t)capacity * self->_itemType->_size);
+
+    if (self->_items != NULL)
+    {
+        AvmDequeCopyOut(self, 0, self->_length, items);
+        AvmDealloc(self->_items);
+    }
+
+    self->_items = items;
+    self->_capacity = capacity;
+    self->_head = 0;
+}
+
+// Calls the finalizers of a range of items, looking up the finalizer once.
+static void AvmDequeDropRange(AvmDeque* self, uint index, uint count)
+{
+    AvmFunction fn = AvmTypeGetFunction(self->_itemType, FnEntryDtor);
+
+    if (fn == NULL)
+    {
+        return;
+    }
+
+    for (uint i = 0; i < count; i++)
+    {
+        ((void (*)(object))fn)(AvmDequeSlot(self, index + i));
+    }
+}
+
+// Moves count items from one logical index to another, one at a time in the
+// direction that does not overwrite items that are still to be moved.
+static void AvmDequeMove(AvmDeque* self, uint from, uint to, uint count)
+{
+    const size_t size = self->_itemType->_size;
+
+    if (to < from)
+    {
+        for (uint i = 0; i < count; i++)
+        {
+            memcpy(AvmDequeSlot(self, to + i),
+                   AvmDequeSlot(self, from + i),
+                   size);
+        }
+    }
+    else
+    {
+        for (uint i = count; i > 0; i--)
+        {
+            memcpy(AvmDequeSlot(self, to + i - 1),
+                   AvmDequeSlot(self, from + i - 1),
+                   size);
+        }
+    }
+}
+
+static uint AvmDequeGetLength(const AvmDeque* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static uint AvmDequeGetCapacity(const AvmDeque* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_capacity;
+}
+
+static const AvmType* AvmDequeGetItemType(const AvmDeque* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_itemType;
+}
+
+static object AvmDequeItemAt(const AvmDeque* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    return AvmDequeSlot(self, index);
+}
+
+static object AvmDequeSpan(object source, uint index, uint* length)
+{
+    const uint contiguous = AvmDequeContiguous(source, index);
+
+    if (contiguous < *length)
+    {
+        *length = contiguous;
+    }
+
+    return AvmDequeSlot(source, index);
+}
+
+static AvmIterator AvmDequeGetIterator(const AvmDeque* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return AvmIteratorNew(
+        (object)self, self->_itemType, self->_length, AvmDequeSpan);
+}
+
+static void AvmDequeInsertRange(AvmDeque* self,
+                                uint index,
+                                uint count,
+                                const void* items)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(items != NULL || count == 0);
+    }
+
+    if (index > self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t size = self->_itemType->_size;
+    const byte* source = items;
+    byte* copy = NULL;
+
+    // The items may come from this deque, in which case growing or shifting
+    // it would move them.
+    if (source >= self->_items &&
+        source < self->_items + (size_t)self->_capacity * size)
+    {
+        copy = AvmAlloc(count * size);
+        memcpy(copy, source, count * size);
+        source = copy;
+    }
+
+    AvmDequeReserve(self, count);
+
+    // Shift the items before or after the index, whichever are fewer.
+    if (index < self->_length - index)
+    {
+        self->_head = (self->_head - count) & (self->_capacity - 1);
+        AvmDequeMove(self, count, 0, index);
+    }
+    else
+    {
+        AvmDequeMove(self, index, index + count, self->_length - index);
+    }
+
+    AvmDequeCopyIn(self, index, count, source);
+    self->_length += count;
+
+    if (copy != NULL)
+    {
+        AvmDealloc(copy);
+    }
+}
+
+static void AvmDequeRemoveRange(AvmDeque* self, uint index, uint count)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index > self->_length || count > self->_length - index)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    AvmDequeDropRange(self, index, count);
+
+    const uint after = self->_length - index - count;
+
+    // Close the gap from the side with fewer items.
+    if (index < after)
+    {
+        AvmDequeMove(self, 0, count, index);
+        self->_head = (self->_head + count) & (self->_capacity - 1);
+    }
+    else
+    {
+        AvmDequeMove(self, index + count, index, after);
+    }
+
+    self->_length -= count;
+}
+
+static void AvmDequeInsert(AvmDeque* self, uint index, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    AvmDequeInsertRange(self, index, 1, value);
+}
+
+static void AvmDequeRemove(AvmDeque* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    AvmDequeRemoveRange(self, index, 1);
+}
+
+static void AvmDequeTruncate(AvmDeque* self, uint length)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (length >= self->_length)
+    {
+        return;
+    }
+
+    AvmDequeDropRange(self, length, self->_length - length);
+    self->_length = length;
+}
+
+static AvmString AvmDequeToString(AvmDeque* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmString s = AvmStringNew(self->_length * 2);
+
+    AvmStringPushStr(&s, "[ ");
+    for (uint i = 0; i < self->_length; i++)
+    {
+        __AvmStringPushItem(&s, self->_itemType, AvmDequeSlot(self, i));
+
+        if (i < self->_length - 1)
+        {
+            AvmStringPushStr(&s, ", ");
+        }
+    }
+    AvmStringPushStr(&s, " ]");
+    return s;
+}
+
+AVM_TYPE(AvmDeque,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmDequeGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmDequeGetCapacity,
+             [FnEntryGetItemType] = (AvmFunction)AvmDequeGetItemType,
+             [FnEntryInsert] = (AvmFunction)AvmDequeInsert,
+             [FnEntryRemove] = (AvmFunction)AvmDequeRemove,
+             [FnEntryItemAt] = (AvmFunction)AvmDequeItemAt,
+             [FnEntryInsertRange] = (AvmFunction)AvmDequeInsertRange,
+             [FnEntryRemoveRange] = (AvmFunction)AvmDequeRemoveRange,
+             [FnEntryTruncate] = (AvmFunction)AvmDequeTruncate,
+             [FnEntryGetIterator] = (AvmFunction)AvmDequeGetIterator,
+             [FnEntryToString] = (AvmFunction)AvmDequeToString,
+         });
+
+AvmDeque AvmDequeNew(const AvmType* type, uint capacity)
+{
+    pre
+    {
+        assert(type != NULL);
+    }
+
+    AvmDeque self = {
+        ._type = typeid(AvmDeque),
+        ._itemType = type,
+        ._head = 0,
+        ._length = 0,
+        ._capacity = 0,
+        ._items = NULL,
+    };
+
+    AvmDequeReserve(&self, capacity);
+    return self;
+}
+
+void AvmDequePushFront(AvmDeque* self, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    AvmDequeReserve(self, 1);
+
+    self->_head = (self->_head - 1) & (self->_capacity - 1);
+    memcpy(AvmDequeSlot(self, 0), value, self->_itemType->_size);
+    self->_length++;
+}
+
+void AvmDequePushBack(AvmDeque* self, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    AvmDequeReserve(self, 1);
+
+    memcpy(AvmDequeSlot(self, self->_length), value, self->_itemType->_size);
+    self->_length++;
+}
+
+void AvmDequePopFront(AvmDeque* self, object destination)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (self->_length == 0)
+    {
+        throw(AvmErrorNew(InvalidOpError));
+    }
+
+    if (destination == NULL)
+    {
+        AvmDequeDropRange(self, 0, 1);
+    }
+    else
+    {
+        memcpy(destination, AvmDequeSlot(self, 0), self->_itemType->_size);
+    }
+
+    self->_head = (self->_head + 1) & (self->_capacity - 1);
+    self->_length--;
+}
+
+void AvmDequePopBack(AvmDeque* self, object destination)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (self->_length == 0)
+    {
+        throw(AvmErrorNew(InvalidOpError));
+    }
+
+    self->_length--;
+
+    if (destination == NULL)
+    {
+        AvmDequeDropRange(self, self->_length, 1);
+    }
+    else
+    {
+        memcpy(destination,
+               AvmDequeSlot(self, self->_length),
+               self->_itemType->_size);
+    }
+}
+
+object AvmDequePeekFront(const AvmDeque* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (self->_length == 0)
+    {
+        throw(AvmErrorNew(InvalidOpError));
+    }
+
+    return AvmDequeSlot(self, 0);
+}
+
+object AvmDequePeekBack(const AvmDeque* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (self->_length == 0)
+    {
+        throw(AvmErrorNew(InvalidOpError));
+    }
+
+    return AvmDequeSlot(self, self->_length - 1);
+}
+
+void AvmDequePushMany(AvmDeque* self, uint count, const void* items)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(items != NULL || count == 0);
+    }
+
+    AvmDequeInsertRange(self, self->_length, count, items);
+}
+
+uint AvmDequePopMany(AvmDeque* self, uint count, void* destination)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (count > self->_length)
+    {
+        count = self->_length;
+    }
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    if (destination == NULL)
+    {
+        AvmDequeDropRange(self, 0, count);
+    }
+    else
+    {
+        AvmDequeCopyOut(self, 0, count, destination);
+    }
+
+    self->_head = (self->_head + count) & (self->_capacity - 1);
+    self->_length -= count;
+    return count;
+}
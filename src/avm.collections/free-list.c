@@ -0,0 +1,92 @@
+#include "avium/collections/free-list.h"
+
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+static uint AvmFreeListGetLength(const AvmFreeList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+AVM_TYPE(AvmFreeList,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmFreeListGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmFreeListGetLength,
+         });
+
+AvmFreeList AvmFreeListNew(void)
+{
+    return (AvmFreeList){
+        ._type = typeid(AvmFreeList),
+        ._length = 0,
+        ._head = NULL,
+    };
+}
+
+void AvmFreeListPush(AvmFreeList* self, AvmFreeLink* link)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(link != NULL);
+    }
+
+    link->_next = self->_head;
+    self->_head = link;
+    self->_length++;
+}
+
+void AvmFreeListPushArray(AvmFreeList* self,
+                          uint count,
+                          size_t size,
+                          AvmFreeLink* items)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(items != NULL || count == 0);
+    }
+
+    // Push from the last object, so the first one ends up on top and the
+    // objects are popped in address order.
+    for (uint i = count; i > 0; i--)
+    {
+        AvmFreeListPush(self,
+                        (AvmFreeLink*)((byte*)items + (size_t)(i - 1) * size));
+    }
+}
+
+AvmFreeLink* AvmFreeListPop(AvmFreeList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmFreeLink* link = self->_head;
+
+    if (link != NULL)
+    {
+        self->_head = link->_next;
+        link->_next = NULL;
+        self->_length--;
+    }
+
+    return link;
+}
+
+AvmFreeLink* AvmFreeListPeek(const AvmFreeList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_head;
+}
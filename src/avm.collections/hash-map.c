@@ -0,0 +1,575 @@
+#include "avium/collections/hash-map.h"
+
+#include "avium/collections/map.h"
+#include "avium/error.h"
+#include "avium/hash.h"
+#include "avium/private/collections.h"
+#include "avium/private/errors.h"
+#include "avium/private/simd.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+// The number of slots whose control bytes are compared at once. Tables always
+// have a power of two number of slots and at least one group.
+#define GROUP_SIZE 16
+
+// Control bytes of free slots have the high bit set. Full slots store the high
+// 7 bits of the key hash instead.
+#define CONTROL_EMPTY   0x80
+#define CONTROL_DELETED 0xFE
+
+// The table grows when it is 7/8 full.
+#define MAX_LOAD(capacity) ((capacity) - (capacity) / 8)
+
+typedef bool (*AvmEqualsFunc)(object, object);
+typedef ulong (*AvmHashFunc)(object);
+typedef void (*AvmDtorFunc)(object);
+
+// Returns a mask with bit i set if control byte i of the group equals value.
+static inline uint AvmGroupMatch(const byte* group, byte value)
+{
+#ifdef AVM_HAVE_SSE2
+    const __m128i bytes = _mm_loadu_si128((const __m128i*)group);
+    const __m128i matches = _mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)value));
+    return (uint)_mm_movemask_epi8(matches);
+#else
+    uint mask = 0;
+    for (uint i = 0; i < GROUP_SIZE; i++)
+    {
+        mask |= (uint)(group[i] == value) << i;
+    }
+    return mask;
+#endif
+}
+
+// Returns a mask with bit i set if slot i of the group is empty or deleted.
+static inline uint AvmGroupMatchFree(const byte* group)
+{
+#ifdef AVM_HAVE_SSE2
+    return (uint)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+    uint mask = 0;
+    for (uint i = 0; i < GROUP_SIZE; i++)
+    {
+        mask |= (uint)(group[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+// Returns the alignment of an item of the given size, at most 8 bytes.
+static inline uint AvmAlignOf(uint size)
+{
+    const uint alignment = size & (~size + 1);
+    return alignment == 0 || alignment > 8 ? 8 : alignment;
+}
+
+static inline uint AvmAlignUp(uint value, uint alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Slots hold the key, followed by the value at its natural alignment.
+static inline uint AvmHashMapValueOffset(const AvmHashMap* self)
+{
+    return AvmAlignUp(self->_keyType->_size,
+                      AvmAlignOf(self->_valueType->_size));
+}
+
+static inline uint AvmHashMapSlotSize(const AvmHashMap* self)
+{
+    const uint keyAlignment = AvmAlignOf(self->_keyType->_size);
+    const uint valueAlignment = AvmAlignOf(self->_valueType->_size);
+
+    return AvmAlignUp(
+        AvmHashMapValueOffset(self) + self->_valueType->_size,
+        keyAlignment > valueAlignment ? keyAlignment : valueAlignment);
+}
+
+static inline byte* AvmHashMapKeyAt(const AvmHashMap* self, uint index)
+{
+    return self->_items + (size_t)index * AvmHashMapSlotSize(self);
+}
+
+static inline byte* AvmHashMapValueAt(const AvmHashMap* self, uint index)
+{
+    return AvmHashMapKeyAt(self, index) + AvmHashMapValueOffset(self);
+}
+
+// Keys without an FnEntryEquals entry are compared byte-by-byte, like in
+// AvmObjectEquals. Any hash of their bytes is then consistent with equality,
+// so small keys use a single multiplication instead of the FnEntryHash entry.
+static ulong AvmHashMapHash(const AvmHashMap* self, object key)
+{
+    const AvmType* type = self->_keyType;
+
+    if (type == typeid(AvmString))
+    {
+        const AvmString* s = key;
+        return AvmHashBytes(s->_length, s->_buffer);
+    }
+
+    if (AvmTypeTryGetFunction(type, FnEntryEquals) == NULL)
+    {
+        if (type->_size > sizeof(ulong))
+        {
+            return AvmHashBytes(type->_size, key);
+        }
+
+        ulong value = 0;
+        memcpy(&value, key, type->_size);
+        value = (value ^ (value >> 33)) * 0xFF51AFD7ED558CCDull;
+        return value ^ (value >> 33);
+    }
+
+    AvmHashFunc fn = (AvmHashFunc)AvmTypeTryGetFunction(type, FnEntryHash);
+
+    if (fn == NULL)
+    {
+        return AvmHashBytes(type->_size, key);
+    }
+
+    return fn(key);
+}
+
+static inline bool AvmHashMapKeyEquals(const AvmHashMap* self,
+                                       AvmEqualsFunc equals,
+                                       object key,
+                                       object other)
+{
+    const uint size = self->_keyType->_size;
+
+    if (self->_keyType == typeid(AvmString))
+    {
+        const AvmString* s = key;
+        const AvmString* o = other;
+        return s->_length == o->_length &&
+               memcmp(s->_buffer, o->_buffer, s->_length) == 0;
+    }
+
+    if (equals != NULL)
+    {
+        return equals(key, other);
+    }
+
+    // Constant sizes let the compiler replace memcmp with a single compare.
+    switch (size)
+    {
+    case 4:
+        return memcmp(key, other, 4) == 0;
+    case 8:
+        return memcmp(key, other, 8) == 0;
+    default:
+        return memcmp(key, other, size) == 0;
+    }
+}
+
+// The low bits of the hash select the first group and the high 7 bits are
+// stored in the control byte, so that the two are independent.
+static inline uint AvmHashMapFirstGroup(const AvmHashMap* self, ulong hash)
+{
+    return (uint)hash & (self->_capacity / GROUP_SIZE - 1);
+}
+
+static inline byte AvmHashMapControlOf(ulong hash)
+{
+    return (byte)(hash >> 57);
+}
+
+// Groups are probed in triangular order, which visits every group of a
+// table with a power of two number of groups.
+static uint AvmHashMapFind(const AvmHashMap* self, object key, ulong hash)
+{
+    if (self->_length == 0)
+    {
+        return AvmInvalid;
+    }
+
+    const AvmEqualsFunc equals =
+        (AvmEqualsFunc)AvmTypeTryGetFunction(self->_keyType, FnEntryEquals);
+    const uint groupMask = self->_capacity / GROUP_SIZE - 1;
+    const byte control = AvmHashMapControlOf(hash);
+
+    uint group = AvmHashMapFirstGroup(self, hash);
+    for (uint stride = 1;; stride++)
+    {
+        const byte* controls = self->_control + group * GROUP_SIZE;
+
+        for (uint match = AvmGroupMatch(controls, control); match != 0;
+             match &= match - 1)
+        {
+            const uint index = group * GROUP_SIZE + AvmBitScanForward(match);
+
+            if (AvmHashMapKeyEquals(
+                    self, equals, AvmHashMapKeyAt(self, index), key))
+            {
+                return index;
+            }
+        }
+
+        // A lookup never continues past a group with an empty slot.
+        if (AvmGroupMatch(controls, CONTROL_EMPTY) != 0)
+        {
+            return AvmInvalid;
+        }
+
+        group = (group + stride) & groupMask;
+    }
+}
+
+// Returns the first empty or deleted slot on the probe sequence of a hash.
+static uint AvmHashMapFindFree(const AvmHashMap* self, ulong hash)
+{
+    const uint groupMask = self->_capacity / GROUP_SIZE - 1;
+
+    uint group = AvmHashMapFirstGroup(self, hash);
+    for (uint stride = 1;; stride++)
+    {
+        const uint match =
+            AvmGroupMatchFree(self->_control + group * GROUP_SIZE);
+
+        if (match != 0)
+        {
+            return group * GROUP_SIZE + AvmBitScanForward(match);
+        }
+
+        group = (group + stride) & groupMask;
+    }
+}
+
+static void AvmHashMapAllocate(AvmHashMap* self, uint capacity)
+{
+    const size_t itemsSize = (size_t)capacity * AvmHashMapSlotSize(self);
+
+    // The items follow the control bytes, which keeps them 16-byte aligned.
+    self->_control = AvmAlloc(capacity + itemsSize);
+    self->_items = self->_control + capacity;
+    self->_capacity = capacity;
+    self->_growthLeft = MAX_LOAD(capacity) - self->_length;
+
+    memset(self->_control, CONTROL_EMPTY, capacity);
+}
+
+// Moves all entries to a table with the specified capacity, which also
+// discards deleted slots.
+static void AvmHashMapRehash(AvmHashMap* self, uint capacity)
+{
+    byte* const oldControl = self->_control;
+    byte* const oldItems = self->_items;
+    const uint oldCapacity = self->_capacity;
+    const uint slotSize = AvmHashMapSlotSize(self);
+
+    AvmHashMapAllocate(self, capacity);
+
+    for (uint i = 0; i < oldCapacity; i++)
+    {
+        if ((oldControl[i] & CONTROL_EMPTY) != 0)
+        {
+            continue;
+        }
+
+        byte* const slot = oldItems + (size_t)i * slotSize;
+        const uint index =
+            AvmHashMapFindFree(self, AvmHashMapHash(self, slot));
+
+        self->_control[index] = oldControl[i];
+        memcpy(AvmHashMapKeyAt(self, index), slot, slotSize);
+    }
+
+    if (oldControl != NULL)
+    {
+        AvmDealloc(oldControl);
+    }
+}
+
+static void AvmHashMapGrow(AvmHashMap* self)
+{
+    if (self->_capacity == 0)
+    {
+        AvmHashMapRehash(self, GROUP_SIZE);
+        return;
+    }
+
+    // If most of the used slots are deleted, reclaim them instead of
+    // doubling the table.
+    if (self->_length < MAX_LOAD(self->_capacity) / 2)
+    {
+        AvmHashMapRehash(self, self->_capacity);
+        return;
+    }
+
+    if (self->_capacity > AvmInvalid / 2)
+    {
+        throw(AvmErrorNew(MemError));
+    }
+
+    AvmHashMapRehash(self, self->_capacity * 2);
+}
+
+static void AvmHashMapDropEntry(AvmHashMap* self, uint index)
+{
+    AvmDtorFunc keyDtor =
+        (AvmDtorFunc)AvmTypeTryGetFunction(self->_keyType, FnEntryDtor);
+    AvmDtorFunc valueDtor =
+        (AvmDtorFunc)AvmTypeTryGetFunction(self->_valueType, FnEntryDtor);
+
+    if (keyDtor != NULL)
+    {
+        keyDtor(AvmHashMapKeyAt(self, index));
+    }
+
+    if (valueDtor != NULL)
+    {
+        valueDtor(AvmHashMapValueAt(self, index));
+    }
+}
+
+static uint AvmHashMapGetLength(const AvmHashMap* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static uint AvmHashMapGetCapacity(const AvmHashMap* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return MAX_LOAD(self->_capacity);
+}
+
+static const AvmType* AvmHashMapGetKeyType(const AvmHashMap* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_keyType;
+}
+
+static const AvmType* AvmHashMapGetValueType(const AvmHashMap* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_valueType;
+}
+
+static object AvmHashMapGet(const AvmHashMap* self, object key)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL);
+    }
+
+    const uint index = AvmHashMapFind(self, key, AvmHashMapHash(self, key));
+
+    if (index == AvmInvalid)
+    {
+        return NULL;
+    }
+
+    return AvmHashMapValueAt(self, index);
+}
+
+static void AvmHashMapInsert(AvmHashMap* self, object key, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL);
+        assert(value != NULL);
+    }
+
+    const ulong hash = AvmHashMapHash(self, key);
+    uint index = AvmHashMapFind(self, key, hash);
+
+    if (index != AvmInvalid)
+    {
+        AvmDtorFunc dtor =
+            (AvmDtorFunc)AvmTypeTryGetFunction(self->_valueType, FnEntryDtor);
+
+        if (dtor != NULL)
+        {
+            dtor(AvmHashMapValueAt(self, index));
+        }
+
+        memcpy(AvmHashMapValueAt(self, index), value, self->_valueType->_size);
+        return;
+    }
+
+    if (self->_growthLeft == 0)
+    {
+        AvmHashMapGrow(self);
+    }
+
+    index = AvmHashMapFindFree(self, hash);
+
+    // Reusing a deleted slot does not bring the table closer to full.
+    if (self->_control[index] == CONTROL_EMPTY)
+    {
+        self->_growthLeft--;
+    }
+
+    self->_control[index] = AvmHashMapControlOf(hash);
+    memcpy(AvmHashMapKeyAt(self, index), key, self->_keyType->_size);
+    memcpy(AvmHashMapValueAt(self, index), value, self->_valueType->_size);
+    self->_length++;
+}
+
+static bool AvmHashMapRemove(AvmHashMap* self, object key)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL);
+    }
+
+    const uint index = AvmHashMapFind(self, key, AvmHashMapHash(self, key));
+
+    if (index == AvmInvalid)
+    {
+        return false;
+    }
+
+    AvmHashMapDropEntry(self, index);
+    self->_length--;
+
+    // If the group still has an empty slot then no lookup has probed past
+    // it, so the slot can become empty instead of leaving a tombstone.
+    const byte* group = self->_control + index / GROUP_SIZE * GROUP_SIZE;
+
+    if (AvmGroupMatch(group, CONTROL_EMPTY) != 0)
+    {
+        self->_control[index] = CONTROL_EMPTY;
+        self->_growthLeft++;
+    }
+    else
+    {
+        self->_control[index] = CONTROL_DELETED;
+    }
+
+    return true;
+}
+
+static void AvmHashMapClear(AvmHashMap* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    for (uint i = 0; i < self->_capacity && self->_length != 0; i++)
+    {
+        if ((self->_control[i] & CONTROL_EMPTY) == 0)
+        {
+            AvmHashMapDropEntry(self, i);
+            self->_length--;
+        }
+    }
+
+    if (self->_capacity != 0)
+    {
+        memset(self->_control, CONTROL_EMPTY, self->_capacity);
+    }
+
+    self->_growthLeft = MAX_LOAD(self->_capacity);
+}
+
+static AvmString AvmHashMapToString(AvmHashMap* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmString s = AvmStringNew(self->_length * 4);
+    uint remaining = self->_length;
+
+    AvmStringPushStr(&s, "{ ");
+    for (uint i = 0; i < self->_capacity && remaining != 0; i++)
+    {
+        if ((self->_control[i] & CONTROL_EMPTY) != 0)
+        {
+            continue;
+        }
+
+        __AvmStringPushItem(&s, self->_keyType, AvmHashMapKeyAt(self, i));
+        AvmStringPushStr(&s, ": ");
+        __AvmStringPushItem(&s, self->_valueType, AvmHashMapValueAt(self, i));
+
+        if (--remaining != 0)
+        {
+            AvmStringPushStr(&s, ", ");
+        }
+    }
+    AvmStringPushStr(&s, " }");
+    return s;
+}
+
+AVM_TYPE(AvmHashMap,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmHashMapGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmHashMapGetCapacity,
+             [FnEntryGetItemType] = (AvmFunction)AvmHashMapGetValueType,
+             [FnEntryGetKeyType] = (AvmFunction)AvmHashMapGetKeyType,
+             [FnEntryInsert] = (AvmFunction)AvmHashMapInsert,
+             [FnEntryRemove] = (AvmFunction)AvmHashMapRemove,
+             [FnEntryItemAt] = (AvmFunction)AvmHashMapGet,
+             [FnEntryClear] = (AvmFunction)AvmHashMapClear,
+             [FnEntryToString] = (AvmFunction)AvmHashMapToString,
+         });
+
+AvmHashMap AvmHashMapNew(const AvmType* keyType,
+                         const AvmType* valueType,
+                         uint capacity)
+{
+    pre
+    {
+        assert(keyType != NULL);
+        assert(valueType != NULL);
+    }
+
+    AvmHashMap self = {
+        ._type = typeid(AvmHashMap),
+        ._keyType = keyType,
+        ._valueType = valueType,
+        ._length = 0,
+        ._capacity = 0,
+        ._growthLeft = 0,
+        ._control = NULL,
+        ._items = NULL,
+    };
+
+    if (capacity != 0)
+    {
+        uint slots = GROUP_SIZE;
+        while (MAX_LOAD(slots) < capacity)
+        {
+            if (slots > AvmInvalid / 2)
+            {
+                throw(AvmErrorNew(MemError));
+            }
+
+            slots *= 2;
+        }
+
+        AvmHashMapAllocate(&self, slots);
+    }
+
+    return self;
+}
@@ -0,0 +1,117 @@
+#include "avium/collections/iterator.h"
+
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+AVM_TYPE(AvmIterator, object, {[FnEntryDtor] = NULL});
+
+AvmIterator AvmIteratorNew(object source,
+                           const AvmType* itemType,
+                           uint length,
+                           AvmSpanFunc span)
+{
+    pre
+    {
+        assert(itemType != NULL);
+        assert(span != NULL);
+    }
+
+    return (AvmIterator){
+        ._type = typeid(AvmIterator),
+        ._source = source,
+        ._itemType = itemType,
+        ._span = span,
+        ._items = NULL,
+        ._index = 0,
+        ._length = 0,
+        ._end = length,
+    };
+}
+
+// The source of an array iterator is the array itself, and its only span
+// starts at index 0 and covers all items.
+static object AvmArraySpan(object source, uint index, uint* length)
+{
+    (void)index;
+    (void)length;
+    return source;
+}
+
+AvmIterator AvmIteratorFromArray(const AvmType* itemType,
+                                 uint length,
+                                 object items)
+{
+    pre
+    {
+        assert(itemType != NULL);
+        assert(length == 0 || items != NULL);
+    }
+
+    return AvmIteratorNew(items, itemType, length, AvmArraySpan);
+}
+
+bool AvmIteratorNext(AvmIterator* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const uint index = self->_index + self->_length;
+
+    if (index >= self->_end)
+    {
+        self->_index = self->_end;
+        self->_length = 0;
+        return false;
+    }
+
+    // Spans that run to the end of the collection can leave the length as it
+    // is. Longer spans are cut at the end of the iterator.
+    uint length = self->_end - index;
+    self->_items = self->_span(self->_source, index, &length);
+    self->_index = index;
+    self->_length = length < self->_end - index ? length : self->_end - index;
+
+    return true;
+}
+
+object AvmIteratorGetItems(const AvmIterator* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_items;
+}
+
+uint AvmIteratorGetLength(const AvmIterator* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+uint AvmIteratorGetIndex(const AvmIterator* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_index;
+}
+
+const AvmType* AvmIteratorGetItemType(const AvmIterator* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_itemType;
+}
@@ -0,0 +1,212 @@
+#include "avium/collections/linked-list.h"
+
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+static uint AvmLinkedListGetLength(const AvmLinkedList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+AVM_TYPE(AvmLinkedList,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmLinkedListGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmLinkedListGetLength,
+         });
+
+AvmLinkedList AvmLinkedListNew(void)
+{
+    return (AvmLinkedList){
+        ._type = typeid(AvmLinkedList),
+        ._length = 0,
+        ._first = NULL,
+        ._last = NULL,
+    };
+}
+
+AvmLink* AvmLinkedListGetFirst(const AvmLinkedList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_first;
+}
+
+AvmLink* AvmLinkedListGetLast(const AvmLinkedList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_last;
+}
+
+void AvmLinkedListInsertBefore(AvmLinkedList* self,
+                               AvmLink* position,
+                               AvmLink* link)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(link != NULL);
+    }
+
+    AvmLink* previous = position == NULL ? self->_last : position->_previous;
+
+    link->_next = position;
+    link->_previous = previous;
+
+    if (previous == NULL)
+    {
+        self->_first = link;
+    }
+    else
+    {
+        previous->_next = link;
+    }
+
+    if (position == NULL)
+    {
+        self->_last = link;
+    }
+    else
+    {
+        position->_previous = link;
+    }
+
+    self->_length++;
+}
+
+void AvmLinkedListPushFront(AvmLinkedList* self, AvmLink* link)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(link != NULL);
+    }
+
+    AvmLinkedListInsertBefore(self, self->_first, link);
+}
+
+void AvmLinkedListPushBack(AvmLinkedList* self, AvmLink* link)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(link != NULL);
+    }
+
+    AvmLinkedListInsertBefore(self, NULL, link);
+}
+
+void AvmLinkedListRemove(AvmLinkedList* self, AvmLink* link)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(link != NULL);
+        assert(self->_length != 0);
+    }
+
+    if (link->_previous == NULL)
+    {
+        self->_first = link->_next;
+    }
+    else
+    {
+        link->_previous->_next = link->_next;
+    }
+
+    if (link->_next == NULL)
+    {
+        self->_last = link->_previous;
+    }
+    else
+    {
+        link->_next->_previous = link->_previous;
+    }
+
+    link->_next = NULL;
+    link->_previous = NULL;
+    self->_length--;
+}
+
+void AvmLinkedListMoveToFront(AvmLinkedList* self, AvmLink* link)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(link != NULL);
+    }
+
+    if (link == self->_first)
+    {
+        return;
+    }
+
+    AvmLinkedListRemove(self, link);
+    AvmLinkedListInsertBefore(self, self->_first, link);
+}
+
+AvmLink* AvmLinkedListPopFront(AvmLinkedList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmLink* link = self->_first;
+
+    if (link != NULL)
+    {
+        AvmLinkedListRemove(self, link);
+    }
+
+    return link;
+}
+
+AvmLink* AvmLinkedListPopBack(AvmLinkedList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmLink* link = self->_last;
+
+    if (link != NULL)
+    {
+        AvmLinkedListRemove(self, link);
+    }
+
+    return link;
+}
+
+AvmLink* AvmLinkGetNext(const AvmLink* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_next;
+}
+
+AvmLink* AvmLinkGetPrevious(const AvmLink* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_previous;
+}
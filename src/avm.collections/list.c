@@ -1,9 +1,20 @@
 #include "avium/collections/list.h"
 
+#include "avium/error.h"
+#include "avium/hash.h"
+#include "avium/private/collections.h"
+#include "avium/private/errors.h"
 #include "avium/private/resources.h"
+#include "avium/private/simd.h"
+#include "avium/string.h"
 #include "avium/testing.h"
 #include "avium/typeinfo.h"
 
+#include <string.h>
+
+typedef bool (*AvmEqualsFunc)(object, object);
+typedef ulong (*AvmHashFunc)(object);
+
 uint AvmListGetLength(const AvmList* self)
 {
     VIRTUAL_CALL(uint, FnEntryGetLength, self);
@@ -24,6 +35,35 @@ object AvmListItemAt(const AvmList* self, uint index)
     VIRTUAL_CALL(object, FnEntryItemAt, self, index);
 }
 
+// Lists without an FnEntryGetIterator entry are iterated one item at a time.
+static object AvmListItemSpan(object source, uint index, uint* length)
+{
+    *length = 1;
+    return AvmListItemAt(source, index);
+}
+
+AvmIterator AvmListGetIterator(const AvmList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmIterator (*getIterator)(const AvmList*) =
+        (AvmIterator(*)(const AvmList*))AvmTypeTryGetFunction(
+            AvmObjectGetType((object)self), FnEntryGetIterator);
+
+    if (getIterator != NULL)
+    {
+        return getIterator(self);
+    }
+
+    return AvmIteratorNew((object)self,
+                          AvmListGetItemType(self),
+                          AvmListGetLength(self),
+                          AvmListItemSpan);
+}
+
 void AvmListInsert(AvmList* self, uint index, object value)
 {
     VIRTUAL_CALL(void, FnEntryInsert, self, index, value);
@@ -34,6 +74,24 @@ void AvmListRemove(AvmList* self, uint index)
     VIRTUAL_CALL(void, FnEntryRemove, self, index);
 }
 
+void AvmListInsertRange(AvmList* self,
+                        uint index,
+                        uint count,
+                        const void* items)
+{
+    VIRTUAL_CALL(void, FnEntryInsertRange, self, index, count, items);
+}
+
+void AvmListRemoveRange(AvmList* self, uint index, uint count)
+{
+    VIRTUAL_CALL(void, FnEntryRemoveRange, self, index, count);
+}
+
+void AvmListTruncate(AvmList* self, uint length)
+{
+    VIRTUAL_CALL(void, FnEntryTruncate, self, length);
+}
+
 void AvmListClear(AvmList* self)
 {
     pre
@@ -41,11 +99,34 @@ void AvmListClear(AvmList* self)
         assert(self != NULL);
     }
 
-    uint length = AvmListGetLength(self);
+    AvmListTruncate(self, 0);
+}
 
-    for (uint i = length; i > 1; i--)
+void AvmListAddRange(AvmList* self, uint count, const void* items)
+{
+    AvmListInsertRange(self, AvmListGetLength(self), count, items);
+}
+
+void AvmListAddList(AvmList* self, const AvmList* other)
+{
+    pre
     {
-        AvmListRemove(self, i - 1);
+        assert(self != NULL);
+        assert(other != NULL);
+    }
+
+    if (AvmListGetItemType(self) != AvmListGetItemType(other))
+    {
+        throw(AvmErrorNew(ArgError));
+    }
+
+    // Contiguous spans are copied in one go.
+    AvmIterator iterator = AvmListGetIterator(other);
+    while (AvmIteratorNext(&iterator))
+    {
+        AvmListAddRange(self,
+                        AvmIteratorGetLength(&iterator),
+                        AvmIteratorGetItems(&iterator));
     }
 }
 
@@ -69,11 +150,171 @@ bool AvmListContains(const AvmList* self, object value)
 
 uint AvmListIndexOf(const AvmList* self, object value)
 {
-    const uint length = AvmListGetLength(self);
-    for (uint i = 0; i < length; i++)
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    AvmIterator iterator = AvmListGetIterator(self);
+    const AvmType* type = AvmIteratorGetItemType(&iterator);
+
+    while (AvmIteratorNext(&iterator))
+    {
+        const uint index = __AvmFindItem(type,
+                                         AvmIteratorGetLength(&iterator),
+                                         AvmIteratorGetItems(&iterator),
+                                         value);
+
+        if (index != AvmInvalid)
+        {
+            return AvmIteratorGetIndex(&iterator) + index;
+        }
+    }
+
+    return AvmInvalid;
+}
+
+//
+// Searching.
+//
+
+#ifdef AVM_HAVE_SSE2
+static inline __m128i AvmEqual8(__m128i a, __m128i b)
+{
+    return _mm_cmpeq_epi8(a, b);
+}
+
+static inline __m128i AvmEqual16(__m128i a, __m128i b)
+{
+    return _mm_cmpeq_epi16(a, b);
+}
+
+static inline __m128i AvmEqual32(__m128i a, __m128i b)
+{
+    return _mm_cmpeq_epi32(a, b);
+}
+
+// SSE2 has no 64-bit compare, so both 32-bit halves of a lane must be equal.
+static inline __m128i AvmEqual64(__m128i a, __m128i b)
+{
+    const __m128i equal = _mm_cmpeq_epi32(a, b);
+    return _mm_and_si128(equal,
+                         _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+#endif
+
+// Items without an FnEntryEquals entry are compared by their bits, so any
+// type of the same size can be searched with the same unsigned integers.
+// Blocks of four vectors are compared before the exact match is located.
+#ifdef AVM_HAVE_SSE2
+#define AVM_FIND_VECTORIZED(BITS)                                              \
+    byte bytes[16];                                                            \
+    for (uint j = 0; j < 16; j += sizeof(needle))                              \
+    {                                                                          \
+        memcpy(bytes + j, &needle, sizeof(needle));                            \
+    }                                                                          \
+                                                                               \
+    const __m128i pattern = _mm_loadu_si128((const __m128i*)bytes);            \
+    const uint lanes = 16 / sizeof(needle);                                    \
+                                                                               \
+    for (; i + 4 * lanes <= length; i += 4 * lanes)                            \
+    {                                                                          \
+        const __m128i* p = (const __m128i*)(items + i);                        \
+        const __m128i a = AvmEqual##BITS(_mm_loadu_si128(p), pattern);         \
+        const __m128i b = AvmEqual##BITS(_mm_loadu_si128(p + 1), pattern);     \
+        const __m128i c = AvmEqual##BITS(_mm_loadu_si128(p + 2), pattern);     \
+        const __m128i d = AvmEqual##BITS(_mm_loadu_si128(p + 3), pattern);     \
+        const __m128i any =                                                    \
+            _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));              \
+                                                                               \
+        if (_mm_movemask_epi8(any) != 0)                                       \
+        {                                                                      \
+            break;                                                             \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    for (; i + lanes <= length; i += lanes)                                    \
+    {                                                                          \
+        const __m128i chunk = _mm_loadu_si128((const __m128i*)(items + i));    \
+        const uint mask =                                                      \
+            (uint)_mm_movemask_epi8(AvmEqual##BITS(chunk, pattern));           \
+                                                                               \
+        if (mask != 0)                                                         \
+        {                                                                      \
+            return i + AvmBitScanForward(mask) / (uint)sizeof(needle);         \
+        }                                                                      \
+    }
+#else
+#define AVM_FIND_VECTORIZED(BITS)
+#endif
+
+#define AVM_FIND_BITS(T, BITS)                                                 \
+    static uint AvmFindBits##BITS(const T* items, uint length, object value)   \
+    {                                                                          \
+        T needle;                                                              \
+        memcpy(&needle, value, sizeof(needle));                                \
+        uint i = 0;                                                            \
+                                                                               \
+        AVM_FIND_VECTORIZED(BITS)                                              \
+                                                                               \
+        for (; i < length; i++)                                                \
+        {                                                                      \
+            if (items[i] == needle)                                            \
+            {                                                                  \
+                return i;                                                      \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        return AvmInvalid;                                                     \
+    }
+
+AVM_FIND_BITS(byte, 8)
+AVM_FIND_BITS(ushort, 16)
+AVM_FIND_BITS(uint, 32)
+AVM_FIND_BITS(ulong, 64)
+
+uint __AvmFindItem(const AvmType* type,
+                   uint length,
+                   const byte* items,
+                   object value)
+{
+    pre
     {
-        object temp = AvmListItemAt(self, i);
-        if (AvmObjectEquals(temp, value))
+        assert(type != NULL);
+        assert(length == 0 || items != NULL);
+        assert(value != NULL);
+    }
+
+    // Primitive items have no type header, so AvmObjectEquals cannot be used
+    // on them. The FnEntryEquals entry of the item type is called instead.
+    const AvmEqualsFunc equals =
+        (AvmEqualsFunc)AvmTypeTryGetFunction(type, FnEntryEquals);
+    const uint size = type->_size;
+
+    if (equals == NULL)
+    {
+        switch (size)
+        {
+        case 1:
+            return AvmFindBits8((const byte*)items, length, value);
+        case 2:
+            return AvmFindBits16((const ushort*)items, length, value);
+        case 4:
+            return AvmFindBits32((const uint*)items, length, value);
+        case 8:
+            return AvmFindBits64((const ulong*)items, length, value);
+        default:
+            break;
+        }
+    }
+
+    for (uint i = 0; i < length; i++, items += size)
+    {
+        const bool equal = equals != NULL ? equals((object)items, value)
+                                          : memcmp(items, value, size) == 0;
+
+        if (equal)
         {
             return i;
         }
@@ -81,3 +322,58 @@ uint AvmListIndexOf(const AvmList* self, object value)
 
     return AvmInvalid;
 }
+
+ulong __AvmHashItem(const AvmType* type, object item)
+{
+    pre
+    {
+        assert(type != NULL);
+        assert(item != NULL);
+    }
+
+    // Like __AvmFindItem, items without an FnEntryEquals entry are equal when
+    // their bytes are, so their bytes are hashed.
+    const AvmHashFunc hash =
+        AvmTypeTryGetFunction(type, FnEntryEquals) == NULL
+            ? NULL
+            : (AvmHashFunc)AvmTypeTryGetFunction(type, FnEntryHash);
+
+    return hash != NULL ? hash(item) : AvmHashBytes(type->_size, item);
+}
+
+void __AvmStringPushItem(AvmString* s, const AvmType* type, object item)
+{
+    pre
+    {
+        assert(s != NULL);
+        assert(type != NULL);
+        assert(item != NULL);
+    }
+
+    if (type->_size > sizeof(AvmType*)) // Type is not primitive.
+        AvmStringPushValue(s, item);
+    else if (type == typeid(float))
+        AvmStringPushFloat(s, *(float*)item, FloatReprAuto);
+    else if (type == typeid(double))
+        AvmStringPushFloat(s, *(double*)item, FloatReprAuto);
+    else if (type == typeid(str))
+        AvmStringPushStr(s, *(str*)item);
+    else if (type == typeid(byte))
+        AvmStringPushUint(s, *(byte*)item, NumericBaseDecimal);
+    else if (type == typeid(ushort))
+        AvmStringPushUint(s, *(ushort*)item, NumericBaseDecimal);
+    else if (type == typeid(uint))
+        AvmStringPushUint(s, *(uint*)item, NumericBaseDecimal);
+    else if (type == typeid(ulong))
+        AvmStringPushUint(s, *(ulong*)item, NumericBaseDecimal);
+    else if (type == typeid(char))
+        AvmStringPushChar(s, *(char*)item);
+    else if (type == typeid(short))
+        AvmStringPushInt(s, *(short*)item);
+    else if (type == typeid(int))
+        AvmStringPushInt(s, *(int*)item);
+    else if (type == typeid(_long))
+        AvmStringPushInt(s, *(_long*)item);
+    else
+        throw(AvmErrorNew(InternalError));
+}
@@ -0,0 +1,50 @@
+#include "avium/collections/map.h"
+
+#include "avium/private/resources.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+uint AvmMapGetLength(const AvmMap* self)
+{
+    VIRTUAL_CALL(uint, FnEntryGetLength, self);
+}
+
+uint AvmMapGetCapacity(const AvmMap* self)
+{
+    VIRTUAL_CALL(uint, FnEntryGetCapacity, self);
+}
+
+const AvmType* AvmMapGetKeyType(const AvmMap* self)
+{
+    VIRTUAL_CALL(const AvmType*, FnEntryGetKeyType, self);
+}
+
+const AvmType* AvmMapGetValueType(const AvmMap* self)
+{
+    VIRTUAL_CALL(const AvmType*, FnEntryGetItemType, self);
+}
+
+object AvmMapGet(const AvmMap* self, object key)
+{
+    VIRTUAL_CALL(object, FnEntryItemAt, self, key);
+}
+
+void AvmMapInsert(AvmMap* self, object key, object value)
+{
+    VIRTUAL_CALL(void, FnEntryInsert, self, key, value);
+}
+
+bool AvmMapRemove(AvmMap* self, object key)
+{
+    VIRTUAL_CALL(bool, FnEntryRemove, self, key);
+}
+
+void AvmMapClear(AvmMap* self)
+{
+    VIRTUAL_CALL(void, FnEntryClear, self);
+}
+
+bool AvmMapContainsKey(const AvmMap* self, object key)
+{
+    return AvmMapGet(self, key) != NULL;
+}
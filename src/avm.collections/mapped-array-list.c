@@ -0,0 +1,672 @@
+#if defined __linux__ && !defined _GNU_SOURCE
+#define _GNU_SOURCE // For mremap.
+#endif
+
+#include "avium/collections/mapped-array-list.h"
+
+#include "avium/collections/list.h"
+#include "avium/error.h"
+#include "avium/private/collections.h"
+#include "avium/private/errors.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+#ifdef AVM_WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define MAGIC "AVMLIST"
+
+// The items start after the header, at a cache line boundary.
+#define HEADER_SIZE 64
+
+typedef struct
+{
+    char magic[8];
+    uint itemSize;
+    uint length;
+    char typeName[HEADER_SIZE - 16];
+} AvmMappedHeader;
+
+static_assert_s(sizeof(AvmMappedHeader) == HEADER_SIZE);
+
+#define HEADER(self) ((AvmMappedHeader*)(self)->_view)
+
+//
+// Platform.
+//
+
+// Returns the error of the last failed system call.
+static AvmError* AvmMappedArrayListLastError(void)
+{
+#ifdef AVM_WIN32
+    return AvmErrorNew(IOError);
+#else
+    return AvmErrorFromOSCode(errno);
+#endif
+}
+
+static void AvmMappedArrayListCloseFile(AvmMappedArrayList* self)
+{
+#ifdef AVM_WIN32
+    CloseHandle((HANDLE)(INT_PTR)self->_file);
+#else
+    close((int)self->_file);
+#endif
+}
+
+static bool AvmMappedArrayListSetFileSize(AvmMappedArrayList* self,
+                                          size_t size)
+{
+#ifdef AVM_WIN32
+    LARGE_INTEGER position;
+    position.QuadPart = (LONGLONG)size;
+
+    return SetFilePointerEx(
+               (HANDLE)(INT_PTR)self->_file, position, NULL, FILE_BEGIN) &&
+           SetEndOfFile((HANDLE)(INT_PTR)self->_file);
+#else
+    return ftruncate((int)self->_file, (off_t)size) == 0;
+#endif
+}
+
+static bool AvmMappedArrayListMap(AvmMappedArrayList* self, size_t size)
+{
+#ifdef AVM_WIN32
+    HANDLE mapping = CreateFileMappingA((HANDLE)(INT_PTR)self->_file,
+                                       NULL,
+                                       PAGE_READWRITE,
+                                       (DWORD)((ulong)size >> 32),
+                                       (DWORD)size,
+                                       NULL);
+
+    if (mapping == NULL)
+    {
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+
+    if (view == NULL)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    self->_mapping = mapping;
+#else
+    void* view = mmap(
+        NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, (int)self->_file, 0);
+
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+#endif
+
+    self->_view = view;
+    self->_viewSize = size;
+    self->_items = self->_view + HEADER_SIZE;
+    return true;
+}
+
+static void AvmMappedArrayListUnmap(AvmMappedArrayList* self)
+{
+#ifdef AVM_WIN32
+    UnmapViewOfFile(self->_view);
+    CloseHandle(self->_mapping);
+    self->_mapping = NULL;
+#else
+    munmap(self->_view, self->_viewSize);
+#endif
+
+    self->_view = NULL;
+    self->_viewSize = 0;
+    self->_items = NULL;
+}
+
+// Writes the first size bytes of the view to disk.
+static bool AvmMappedArrayListFlush(AvmMappedArrayList* self, size_t size)
+{
+#ifdef AVM_WIN32
+    return FlushViewOfFile(self->_view, size) &&
+           FlushFileBuffers((HANDLE)(INT_PTR)self->_file);
+#else
+    return msync(self->_view, size, MS_SYNC) == 0;
+#endif
+}
+
+// Changes the number of items that the file holds, and maps all of it.
+static void AvmMappedArrayListResize(AvmMappedArrayList* self, uint capacity)
+{
+    const size_t size =
+        HEADER_SIZE + (size_t)capacity * self->_itemType->_size;
+
+    if (!AvmMappedArrayListSetFileSize(self, size))
+    {
+        throw(AvmMappedArrayListLastError());
+    }
+
+#ifdef AVM_LINUX
+    // The kernel can move the pages instead of mapping the file again.
+    void* view = mremap(self->_view, self->_viewSize, size, MREMAP_MAYMOVE);
+
+    if (view == MAP_FAILED)
+    {
+        throw(AvmMappedArrayListLastError());
+    }
+
+    self->_view = view;
+    self->_viewSize = size;
+    self->_items = self->_view + HEADER_SIZE;
+#else
+    AvmMappedArrayListUnmap(self);
+
+    if (!AvmMappedArrayListMap(self, size))
+    {
+        throw(AvmMappedArrayListLastError());
+    }
+#endif
+
+    self->_capacity = capacity;
+}
+
+// Lowers the length in the file to exclude the items from index on, before
+// they are changed in place.
+static void AvmMappedArrayListUnsync(AvmMappedArrayList* self, uint index)
+{
+    if (index >= self->_syncedLength)
+    {
+        return;
+    }
+
+    HEADER(self)->length = index;
+
+    if (!AvmMappedArrayListFlush(self, HEADER_SIZE))
+    {
+        throw(AvmMappedArrayListLastError());
+    }
+
+    self->_syncedLength = index;
+}
+
+//
+// List.
+//
+
+static uint AvmMappedArrayListGetLength(const AvmMappedArrayList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static uint AvmMappedArrayListGetCapacity(const AvmMappedArrayList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_capacity;
+}
+
+static const AvmType* AvmMappedArrayListGetItemType(
+    const AvmMappedArrayList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_itemType;
+}
+
+static object AvmMappedArrayListItemAt(const AvmMappedArrayList* self,
+                                       uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    return self->_items + (size_t)index * self->_itemType->_size;
+}
+
+static AvmIterator AvmMappedArrayListGetIterator(
+    const AvmMappedArrayList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return AvmIteratorFromArray(self->_itemType, self->_length, self->_items);
+}
+
+static void AvmMappedArrayListInsertRange(AvmMappedArrayList* self,
+                                          uint index,
+                                          uint count,
+                                          const void* items)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(items != NULL || count == 0);
+    }
+
+    if (index > self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t size = self->_itemType->_size;
+    const byte* source = items;
+    byte* copy = NULL;
+
+    // The items may come from this list, in which case growing or shifting
+    // it would move them.
+    if (source >= self->_items &&
+        source < self->_items + (size_t)self->_length * size)
+    {
+        copy = AvmAlloc(count * size);
+        memcpy(copy, source, count * size);
+        source = copy;
+    }
+
+    AvmMappedArrayListReserve(self, count);
+
+    byte* const dest = self->_items + (size_t)index * size;
+
+    if (index < self->_length)
+    {
+        AvmMappedArrayListUnsync(self, index);
+        memmove(dest + count * size, dest, (self->_length - index) * size);
+    }
+
+    memcpy(dest, source, count * size);
+    self->_length += count;
+
+    if (copy != NULL)
+    {
+        AvmDealloc(copy);
+    }
+}
+
+static void AvmMappedArrayListInsert(AvmMappedArrayList* self,
+                                     uint index,
+                                     object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    AvmMappedArrayListInsertRange(self, index, 1, value);
+}
+
+static void AvmMappedArrayListRemoveRange(AvmMappedArrayList* self,
+                                          uint index,
+                                          uint count)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index > self->_length || count > self->_length - index)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    AvmMappedArrayListUnsync(self, index);
+
+    const size_t size = self->_itemType->_size;
+    byte* const dest = self->_items + (size_t)index * size;
+
+    memmove(dest,
+            dest + (size_t)count * size,
+            (size_t)(self->_length - index - count) * size);
+    self->_length -= count;
+}
+
+static void AvmMappedArrayListRemove(AvmMappedArrayList* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    AvmMappedArrayListRemoveRange(self, index, 1);
+}
+
+static void AvmMappedArrayListTruncate(AvmMappedArrayList* self, uint length)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (length < self->_length)
+    {
+        // Appending would overwrite the truncated items.
+        AvmMappedArrayListUnsync(self, length);
+        self->_length = length;
+    }
+}
+
+static AvmString AvmMappedArrayListToString(AvmMappedArrayList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmString s = AvmStringNew(self->_length * 2);
+
+    AvmStringPushStr(&s, "[ ");
+    for (uint i = 0; i < self->_length; i++)
+    {
+        __AvmStringPushItem(
+            &s, self->_itemType, AvmMappedArrayListItemAt(self, i));
+
+        if (i < self->_length - 1)
+        {
+            AvmStringPushStr(&s, ", ");
+        }
+    }
+    AvmStringPushStr(&s, " ]");
+    return s;
+}
+
+AVM_TYPE(AvmMappedArrayList,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmMappedArrayListGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmMappedArrayListGetCapacity,
+             [FnEntryGetItemType] = (AvmFunction)AvmMappedArrayListGetItemType,
+             [FnEntryInsert] = (AvmFunction)AvmMappedArrayListInsert,
+             [FnEntryRemove] = (AvmFunction)AvmMappedArrayListRemove,
+             [FnEntryItemAt] = (AvmFunction)AvmMappedArrayListItemAt,
+             [FnEntryInsertRange] = (AvmFunction)AvmMappedArrayListInsertRange,
+             [FnEntryRemoveRange] = (AvmFunction)AvmMappedArrayListRemoveRange,
+             [FnEntryTruncate] = (AvmFunction)AvmMappedArrayListTruncate,
+             [FnEntryGetIterator] = (AvmFunction)AvmMappedArrayListGetIterator,
+             [FnEntryToString] = (AvmFunction)AvmMappedArrayListToString,
+         });
+
+// Checks the header of an existing file and takes the length from it.
+static bool AvmMappedArrayListReadHeader(AvmMappedArrayList* self)
+{
+    const AvmMappedHeader* header = HEADER(self);
+    const size_t size = self->_itemType->_size;
+
+    if (memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0 ||
+        header->itemSize != size ||
+        strncmp(header->typeName,
+                AvmTypeGetName(self->_itemType),
+                sizeof(header->typeName) - 1) != 0)
+    {
+        return false;
+    }
+
+    self->_capacity = (uint)((self->_viewSize - HEADER_SIZE) / size);
+    self->_length = header->length;
+    self->_syncedLength = header->length;
+    return self->_length <= self->_capacity;
+}
+
+static void AvmMappedArrayListWriteHeader(AvmMappedArrayList* self)
+{
+    AvmMappedHeader* header = HEADER(self);
+
+    memcpy(header->magic, MAGIC, sizeof(header->magic));
+    header->itemSize = (uint)self->_itemType->_size;
+    header->length = 0;
+    strncpy(header->typeName,
+            AvmTypeGetName(self->_itemType),
+            sizeof(header->typeName) - 1);
+}
+
+AvmMappedArrayList AvmMappedArrayListOpen(str path, const AvmType* type)
+{
+    pre
+    {
+        assert(path != NULL);
+        assert(type != NULL);
+        assert(type->_size != 0);
+    }
+
+    AvmMappedArrayList self = {
+        ._type = typeid(AvmMappedArrayList),
+        ._length = 0,
+        ._capacity = 0,
+        ._syncedLength = 0,
+        ._itemType = type,
+        ._items = NULL,
+        ._view = NULL,
+        ._viewSize = 0,
+        ._mapping = NULL,
+    };
+
+    size_t size = 0;
+
+#ifdef AVM_WIN32
+    HANDLE file = CreateFileA(path,
+                              GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ,
+                              NULL,
+                              OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL,
+                              NULL);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw(AvmMappedArrayListLastError());
+    }
+
+    self._file = (_long)(INT_PTR)file;
+
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        AvmError* error = AvmMappedArrayListLastError();
+        AvmMappedArrayListCloseFile(&self);
+        throw(error);
+    }
+
+    size = (size_t)fileSize.QuadPart;
+#else
+    const int file = open(path, O_RDWR | O_CREAT, 0644);
+
+    if (file < 0)
+    {
+        throw(AvmMappedArrayListLastError());
+    }
+
+    self._file = file;
+
+    struct stat status;
+
+    if (fstat(file, &status) != 0)
+    {
+        AvmError* error = AvmMappedArrayListLastError();
+        AvmMappedArrayListCloseFile(&self);
+        throw(error);
+    }
+
+    size = (size_t)status.st_size;
+#endif
+
+    const bool created = size == 0;
+
+    if (created)
+    {
+        size = HEADER_SIZE;
+
+        if (!AvmMappedArrayListSetFileSize(&self, size))
+        {
+            AvmError* error = AvmMappedArrayListLastError();
+            AvmMappedArrayListCloseFile(&self);
+            throw(error);
+        }
+    }
+    else if (size < HEADER_SIZE)
+    {
+        AvmMappedArrayListCloseFile(&self);
+        throw(AvmErrorNew(FormatError));
+    }
+
+    if (!AvmMappedArrayListMap(&self, size))
+    {
+        AvmError* error = AvmMappedArrayListLastError();
+        AvmMappedArrayListCloseFile(&self);
+        throw(error);
+    }
+
+    if (created)
+    {
+        AvmMappedArrayListWriteHeader(&self);
+    }
+    else if (!AvmMappedArrayListReadHeader(&self))
+    {
+        AvmMappedArrayListUnmap(&self);
+        AvmMappedArrayListCloseFile(&self);
+        throw(AvmErrorNew(FormatError));
+    }
+
+    return self;
+}
+
+void AvmMappedArrayListReserve(AvmMappedArrayList* self, uint count)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const size_t required = (size_t)self->_length + count;
+
+    if (required <= self->_capacity)
+    {
+        return;
+    }
+
+    if (required > AvmInvalid)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    size_t capacity = (size_t)self->_capacity * AVM_ARRAY_LIST_GROWTH_FACTOR;
+
+    if (capacity < required || capacity > AvmInvalid)
+    {
+        capacity = required;
+    }
+
+    AvmMappedArrayListResize(self, (uint)capacity);
+}
+
+void AvmMappedArrayListSet(AvmMappedArrayList* self, uint index, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    AvmMappedArrayListUnsync(self, index);
+
+    const size_t size = self->_itemType->_size;
+    memcpy(self->_items + (size_t)index * size, value, size);
+}
+
+void AvmMappedArrayListSync(AvmMappedArrayList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const size_t used =
+        HEADER_SIZE + (size_t)self->_length * self->_itemType->_size;
+
+    // The items reach the disk before the length that covers them.
+    if (!AvmMappedArrayListFlush(self, used))
+    {
+        throw(AvmMappedArrayListLastError());
+    }
+
+    HEADER(self)->length = self->_length;
+
+    if (!AvmMappedArrayListFlush(self, HEADER_SIZE))
+    {
+        throw(AvmMappedArrayListLastError());
+    }
+
+    self->_syncedLength = self->_length;
+}
+
+void AvmMappedArrayListClose(AvmMappedArrayList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmMappedArrayListSync(self);
+    AvmMappedArrayListUnmap(self);
+
+    const bool shrunk = AvmMappedArrayListSetFileSize(
+        self, HEADER_SIZE + (size_t)self->_length * self->_itemType->_size);
+    AvmError* error = shrunk ? NULL : AvmMappedArrayListLastError();
+
+    AvmMappedArrayListCloseFile(self);
+    self->_length = 0;
+    self->_capacity = 0;
+    self->_syncedLength = 0;
+
+    if (error != NULL)
+    {
+        throw(error);
+    }
+}
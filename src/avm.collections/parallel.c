@@ -0,0 +1,692 @@
+#include "avium/collections/parallel.h"
+
+#include "avium/core.h"
+#include "avium/private/collections.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+#ifdef AVM_USE_GC
+#define GC_THREADS
+#include "gc.h"
+#endif
+
+#ifdef AVM_WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// The most threads that a single call uses.
+#define MAX_THREADS 64
+
+// Searches check whether an earlier match was found once per block of items.
+#define SEARCH_BLOCK_SIZE 4096
+
+// A function that runs one of the tasks of a parallel call.
+typedef void (*AvmTaskFunc)(void* context, uint task);
+
+typedef struct
+{
+    AvmTaskFunc func;
+    void* context;
+    uint taskCount;
+    uint threadCount;
+    uint first;
+#ifdef AVM_WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+} AvmWorker;
+
+//
+// Threads.
+//
+
+uint __AvmGetProcessorCount(void)
+{
+#ifdef AVM_WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (uint)info.dwNumberOfProcessors;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count < 1 ? 1 : (uint)count;
+#endif
+}
+
+// Returns the number of threads to process a number of items with.
+static uint AvmGetThreadCount(uint length)
+{
+    if (length < AVM_PARALLEL_CUTOFF)
+    {
+        return 1;
+    }
+
+    const uint count = __AvmGetProcessorCount();
+    return count > MAX_THREADS ? MAX_THREADS : count;
+}
+
+// Workers take every threadCount-th task, starting from their own index.
+static void AvmWorkerRun(const AvmWorker* worker)
+{
+    for (uint i = worker->first; i < worker->taskCount;
+         i += worker->threadCount)
+    {
+        worker->func(worker->context, i);
+    }
+}
+
+#ifdef AVM_WIN32
+static DWORD WINAPI AvmWorkerMain(LPVOID argument)
+#else
+static void* AvmWorkerMain(void* argument)
+#endif
+{
+#ifdef AVM_USE_GC
+    // Tasks may allocate, so the collector must know about this thread.
+    struct GC_stack_base base;
+    GC_get_stack_base(&base);
+    GC_register_my_thread(&base);
+#endif
+
+    AvmWorkerRun(argument);
+
+#ifdef AVM_USE_GC
+    GC_unregister_my_thread();
+#endif
+
+    return 0;
+}
+
+static bool AvmWorkerStart(AvmWorker* worker)
+{
+#ifdef AVM_WIN32
+    worker->handle = CreateThread(NULL, 0, AvmWorkerMain, worker, 0, NULL);
+    return worker->handle != NULL;
+#else
+    return pthread_create(&worker->handle, NULL, AvmWorkerMain, worker) == 0;
+#endif
+}
+
+static void AvmWorkerJoin(AvmWorker* worker)
+{
+#ifdef AVM_WIN32
+    WaitForSingleObject(worker->handle, INFINITE);
+    CloseHandle(worker->handle);
+#else
+    pthread_join(worker->handle, NULL);
+#endif
+}
+
+// Runs tasks 0 to taskCount - 1 on up to threadCount threads, including the
+// calling one, and returns when all of them are done. Tasks of threads that
+// cannot be started are run on the calling thread instead.
+static void AvmParallelRun(uint threadCount,
+                           uint taskCount,
+                           AvmTaskFunc func,
+                           void* context)
+{
+    if (threadCount > taskCount)
+    {
+        threadCount = taskCount;
+    }
+
+    if (threadCount <= 1)
+    {
+        for (uint i = 0; i < taskCount; i++)
+        {
+            func(context, i);
+        }
+
+        return;
+    }
+
+#ifdef AVM_USE_GC
+    GC_allow_register_threads();
+#endif
+
+    AvmWorker workers[MAX_THREADS];
+    bool started[MAX_THREADS];
+
+    for (uint i = 0; i < threadCount; i++)
+    {
+        workers[i] = (AvmWorker){
+            .func = func,
+            .context = context,
+            .taskCount = taskCount,
+            .threadCount = threadCount,
+            .first = i,
+        };
+
+        started[i] = i != 0 && AvmWorkerStart(&workers[i]);
+    }
+
+    for (uint i = 0; i < threadCount; i++)
+    {
+        if (!started[i])
+        {
+            AvmWorkerRun(&workers[i]);
+        }
+    }
+
+    for (uint i = 1; i < threadCount; i++)
+    {
+        if (started[i])
+        {
+            AvmWorkerJoin(&workers[i]);
+        }
+    }
+}
+
+// Returns the index of the first item of a chunk, when splitting length items
+// into count chunks of nearly equal length.
+static inline uint AvmChunkStart(uint length, uint count, uint chunk)
+{
+    return (uint)((ulong)length * chunk / count);
+}
+
+static inline uint AvmAtomicLoad(volatile uint* value)
+{
+#ifdef AVM_MSVC
+    return (uint)InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+// Lowers a shared value to desired, unless it is already lower.
+static inline void AvmAtomicMin(volatile uint* value, uint desired)
+{
+    uint current = AvmAtomicLoad(value);
+
+    while (desired < current)
+    {
+#ifdef AVM_MSVC
+        const uint previous = (uint)InterlockedCompareExchange(
+            (volatile LONG*)value, (LONG)desired, (LONG)current);
+
+        if (previous == current)
+        {
+            return;
+        }
+
+        current = previous;
+#else
+        if (__atomic_compare_exchange_n(value,
+                                        &current,
+                                        desired,
+                                        true,
+                                        __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE))
+        {
+            return;
+        }
+#endif
+    }
+}
+
+//
+// Sorting.
+//
+
+typedef struct
+{
+    const AvmArrayList* list;
+    AvmComparer comparer;
+    uint chunkCount;
+} AvmSortChunksContext;
+
+static void AvmSortChunk(void* context, uint task)
+{
+    const AvmSortChunksContext* c = context;
+    const AvmArrayList* list = c->list;
+    const uint size = list->_itemType->_size;
+    const uint start = AvmChunkStart(list->_length, c->chunkCount, task);
+    const uint end = AvmChunkStart(list->_length, c->chunkCount, task + 1);
+
+    __AvmSortItems(list->_items + (size_t)start * size,
+                   end - start,
+                   list->_itemType,
+                   c->comparer,
+                   false);
+}
+
+typedef struct
+{
+    AvmComparer comparer;
+    uint size;
+    const byte* source;
+    byte* destination;
+    const uint* bounds; // Run i spans [bounds[i], bounds[i + 1]).
+    uint runCount;
+    uint pieceCount; // The number of tasks that merge each pair of runs.
+} AvmMergeRunsContext;
+
+// Returns how many of the first k items of the merge of left and right come
+// from left, taking items from left first on ties.
+static uint AvmCoRank(const AvmMergeRunsContext* c,
+                      const byte* left,
+                      uint leftCount,
+                      const byte* right,
+                      uint rightCount,
+                      uint k)
+{
+    uint low = k > rightCount ? k - rightCount : 0;
+    uint high = k < leftCount ? k : leftCount;
+
+    while (low < high)
+    {
+        const uint middle = low + (high - low) / 2;
+        const byte* a = left + (size_t)middle * c->size;
+        const byte* b = right + (size_t)(k - middle - 1) * c->size;
+
+        // Item a comes before item b, so more than middle items are taken
+        // from left.
+        if (c->comparer((object)a, (object)b) <= 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+// Merges one piece of a pair of adjacent runs. The last run is paired with an
+// empty one when the number of runs is odd.
+static void AvmMergeRunPiece(void* context, uint task)
+{
+    const AvmMergeRunsContext* c = context;
+    const uint pair = task / c->pieceCount;
+    const uint piece = task % c->pieceCount;
+
+    const uint start = c->bounds[2 * pair];
+    const uint middle = c->bounds[2 * pair + 1];
+    const uint end =
+        2 * pair + 2 <= c->runCount ? c->bounds[2 * pair + 2] : middle;
+
+    const byte* left = c->source + (size_t)start * c->size;
+    const byte* right = c->source + (size_t)middle * c->size;
+    const uint leftCount = middle - start;
+    const uint rightCount = end - middle;
+
+    const uint k0 = AvmChunkStart(end - start, c->pieceCount, piece);
+    const uint k1 = AvmChunkStart(end - start, c->pieceCount, piece + 1);
+    const uint i0 = AvmCoRank(c, left, leftCount, right, rightCount, k0);
+    const uint i1 = AvmCoRank(c, left, leftCount, right, rightCount, k1);
+
+    __AvmMergeItems(c->comparer,
+                    c->size,
+                    left + (size_t)i0 * c->size,
+                    i1 - i0,
+                    right + (size_t)(k0 - i0) * c->size,
+                    (k1 - i1) - (k0 - i0),
+                    c->destination + (size_t)(start + k0) * c->size);
+}
+
+// Sorts one chunk per thread, then merges pairs of runs until one is left.
+// Every merge round is split into pieces of equal length with merge path
+// partitioning, so that all threads take part until the last round.
+static void AvmParallelSortWith(AvmArrayList* self, AvmComparer comparer)
+{
+    const uint length = self->_length;
+    const uint threadCount = AvmGetThreadCount(length);
+    const uint size = self->_itemType->_size;
+
+    if (length < 2)
+    {
+        return;
+    }
+
+    if (threadCount == 1)
+    {
+        __AvmSortItems(self->_items, length, self->_itemType, comparer, false);
+        return;
+    }
+
+    AvmSortChunksContext chunks = {
+        .list = self,
+        .comparer = comparer,
+        .chunkCount = threadCount,
+    };
+
+    AvmParallelRun(threadCount, threadCount, AvmSortChunk, &chunks);
+
+    uint bounds[MAX_THREADS + 1];
+    for (uint i = 0; i <= threadCount; i++)
+    {
+        bounds[i] = AvmChunkStart(length, threadCount, i);
+    }
+
+    byte* const buffer = AvmAlloc((size_t)length * size);
+
+    AvmMergeRunsContext runs = {
+        .comparer = comparer == NULL ? __AvmGetComparer(self->_itemType)
+                                     : comparer,
+        .size = size,
+        .source = self->_items,
+        .destination = buffer,
+        .bounds = bounds,
+        .runCount = threadCount,
+    };
+
+    while (runs.runCount > 1)
+    {
+        const uint pairCount = (runs.runCount + 1) / 2;
+        runs.pieceCount = (threadCount + pairCount - 1) / pairCount;
+
+        AvmParallelRun(threadCount,
+                       pairCount * runs.pieceCount,
+                       AvmMergeRunPiece,
+                       &runs);
+
+        // Each merged pair starts where its left run started.
+        for (uint i = 0; i < pairCount; i++)
+        {
+            bounds[i] = bounds[2 * i];
+        }
+
+        bounds[pairCount] = length;
+        runs.runCount = pairCount;
+
+        byte* const temp = (byte*)runs.source;
+        runs.source = runs.destination;
+        runs.destination = temp;
+    }
+
+    if (runs.source != self->_items)
+    {
+        memcpy(self->_items, runs.source, (size_t)length * size);
+    }
+
+    AvmDealloc(buffer);
+}
+
+void AvmArrayListParallelSort(AvmArrayList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmParallelSortWith(self, NULL);
+}
+
+void AvmArrayListParallelSortBy(AvmArrayList* self, AvmComparer comparer)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(comparer != NULL);
+    }
+
+    AvmParallelSortWith(self, comparer);
+}
+
+//
+// Searching.
+//
+
+typedef struct
+{
+    const AvmArrayList* list;
+    object value;
+    volatile uint found;
+} AvmSearchContext;
+
+static void AvmSearchBlock(void* context, uint task)
+{
+    AvmSearchContext* c = context;
+    const AvmArrayList* list = c->list;
+    const uint size = list->_itemType->_size;
+    const uint start = task * SEARCH_BLOCK_SIZE;
+    const uint end = list->_length - start < SEARCH_BLOCK_SIZE
+                         ? list->_length
+                         : start + SEARCH_BLOCK_SIZE;
+
+    // Blocks are taken in order, so a match in an earlier block makes the
+    // rest of the search unnecessary.
+    if (AvmAtomicLoad(&c->found) < start)
+    {
+        return;
+    }
+
+    const uint index = __AvmFindItem(list->_itemType,
+                                     end - start,
+                                     list->_items + (size_t)start * size,
+                                     c->value);
+
+    if (index != AvmInvalid)
+    {
+        AvmAtomicMin(&c->found, start + index);
+    }
+}
+
+uint AvmArrayListParallelIndexOf(const AvmArrayList* self, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    AvmSearchContext context = {
+        .list = self,
+        .value = value,
+        .found = AvmInvalid,
+    };
+
+    const uint blockCount =
+        (uint)(((ulong)self->_length + SEARCH_BLOCK_SIZE - 1) /
+               SEARCH_BLOCK_SIZE);
+
+    AvmParallelRun(AvmGetThreadCount(self->_length),
+                   blockCount,
+                   AvmSearchBlock,
+                   &context);
+
+    return context.found;
+}
+
+bool AvmArrayListParallelContains(const AvmArrayList* self, object value)
+{
+    return AvmArrayListParallelIndexOf(self, value) != AvmInvalid;
+}
+
+//
+// Map, filter and reduce.
+//
+
+typedef struct
+{
+    const AvmArrayList* list;
+    uint chunkCount;
+    union
+    {
+        AvmMapper mapper;
+        AvmPredicate predicate;
+        AvmReducer reducer;
+    };
+    byte* results;
+    uint resultSize;
+    uint* counts;
+} AvmChunkContext;
+
+static void AvmMapChunk(void* context, uint task)
+{
+    const AvmChunkContext* c = context;
+    const AvmArrayList* list = c->list;
+    const uint size = list->_itemType->_size;
+    const uint start = AvmChunkStart(list->_length, c->chunkCount, task);
+    const uint end = AvmChunkStart(list->_length, c->chunkCount, task + 1);
+
+    byte* result = c->results + (size_t)start * c->resultSize;
+    for (uint i = start; i < end; i++, result += c->resultSize)
+    {
+        c->mapper(list->_items + (size_t)i * size, result);
+    }
+}
+
+AvmArrayList AvmArrayListParallelMap(const AvmArrayList* self,
+                                     const AvmType* resultType,
+                                     AvmMapper mapper)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(resultType != NULL);
+        assert(mapper != NULL);
+    }
+
+    AvmArrayList results = AvmArrayListNew(resultType, self->_length);
+    const uint threadCount = AvmGetThreadCount(self->_length);
+
+    AvmChunkContext context = {
+        .list = self,
+        .chunkCount = threadCount,
+        .mapper = mapper,
+        .results = results._items,
+        .resultSize = resultType->_size,
+    };
+
+    AvmParallelRun(threadCount, threadCount, AvmMapChunk, &context);
+    results._length = self->_length;
+    return results;
+}
+
+// Copies the kept items of a chunk to the start of the same chunk in the
+// results.
+static void AvmFilterChunk(void* context, uint task)
+{
+    const AvmChunkContext* c = context;
+    const AvmArrayList* list = c->list;
+    const uint size = list->_itemType->_size;
+    const uint start = AvmChunkStart(list->_length, c->chunkCount, task);
+    const uint end = AvmChunkStart(list->_length, c->chunkCount, task + 1);
+
+    byte* result = c->results + (size_t)start * size;
+    const byte* item = list->_items + (size_t)start * size;
+    uint count = 0;
+
+    for (uint i = start; i < end; i++, item += size)
+    {
+        if (c->predicate((object)item))
+        {
+            memcpy(result + (size_t)count * size, item, size);
+            count++;
+        }
+    }
+
+    c->counts[task] = count;
+}
+
+AvmArrayList AvmArrayListParallelFilter(const AvmArrayList* self,
+                                        AvmPredicate predicate)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(predicate != NULL);
+    }
+
+    AvmArrayList results = AvmArrayListNew(self->_itemType, self->_length);
+    const uint threadCount = AvmGetThreadCount(self->_length);
+    const uint size = self->_itemType->_size;
+    uint counts[MAX_THREADS];
+
+    AvmChunkContext context = {
+        .list = self,
+        .chunkCount = threadCount,
+        .predicate = predicate,
+        .results = results._items,
+        .counts = counts,
+    };
+
+    AvmParallelRun(threadCount, threadCount, AvmFilterChunk, &context);
+
+    // Close the gaps between the kept items of each chunk.
+    for (uint i = 0; i < threadCount; i++)
+    {
+        const uint start = AvmChunkStart(self->_length, threadCount, i);
+
+        memmove(results._items + (size_t)results._length * size,
+                results._items + (size_t)start * size,
+                (size_t)counts[i] * size);
+
+        results._length += counts[i];
+    }
+
+    return results;
+}
+
+static void AvmReduceChunk(void* context, uint task)
+{
+    const AvmChunkContext* c = context;
+    const AvmArrayList* list = c->list;
+    const uint size = list->_itemType->_size;
+    const uint start = AvmChunkStart(list->_length, c->chunkCount, task);
+    const uint end = AvmChunkStart(list->_length, c->chunkCount, task + 1);
+
+    byte* accumulator = c->results + (size_t)task * size;
+    const byte* item = list->_items + (size_t)start * size;
+
+    for (uint i = start; i < end; i++, item += size)
+    {
+        c->reducer(accumulator, (object)item);
+    }
+}
+
+void AvmArrayListParallelReduce(const AvmArrayList* self,
+                                object accumulator,
+                                AvmReducer reducer)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(accumulator != NULL);
+        assert(reducer != NULL);
+    }
+
+    const uint threadCount = AvmGetThreadCount(self->_length);
+    const uint size = self->_itemType->_size;
+
+    if (threadCount == 1)
+    {
+        for (uint i = 0; i < self->_length; i++)
+        {
+            reducer(accumulator, self->_items + (size_t)i * size);
+        }
+
+        return;
+    }
+
+    // Every chunk starts from the identity.
+    byte* const partials = AvmAlloc((size_t)threadCount * size);
+    for (uint i = 0; i < threadCount; i++)
+    {
+        memcpy(partials + (size_t)i * size, accumulator, size);
+    }
+
+    AvmChunkContext context = {
+        .list = self,
+        .chunkCount = threadCount,
+        .reducer = reducer,
+        .results = partials,
+    };
+
+    AvmParallelRun(threadCount, threadCount, AvmReduceChunk, &context);
+
+    for (uint i = 0; i < threadCount; i++)
+    {
+        reducer(accumulator, partials + (size_t)i * size);
+    }
+
+    AvmDealloc(partials);
+}
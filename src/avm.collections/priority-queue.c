@@ -0,0 +1,559 @@
+#include "avium/collections/priority-queue.h"
+
+#include "avium/collections/iterator.h"
+#include "avium/core.h"
+#include "avium/error.h"
+#include "avium/private/collections.h"
+#include "avium/private/errors.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+// The number of children of each node.
+#define ARITY 4
+
+#define MIN_CAPACITY 8
+
+// The largest capacity, which leaves room for the scratch item and its handle.
+#define MAX_CAPACITY ((uint)-2)
+
+typedef void (*AvmDtorFunc)(object);
+
+// The items form a heap in which no item orders before its parent. Handles
+// are a permutation of 0 to the capacity. The first _length are those of the
+// items, in the same order, and the rest are free, so an item that is added
+// takes the handle right after the last one and gives it back when removed.
+// _positions is the inverse of _handles, so a handle refers to an item if its
+// position is less than the length.
+
+static inline byte* AvmPriorityQueueSlot(const AvmPriorityQueue* self,
+                                         uint index)
+{
+    return self->_items + (size_t)index * self->_itemType->_size;
+}
+
+static inline byte* AvmPriorityQueueScratch(const AvmPriorityQueue* self)
+{
+    return AvmPriorityQueueSlot(self, self->_capacity);
+}
+
+static inline int AvmPriorityQueueCompare(const AvmPriorityQueue* self,
+                                          const byte* a,
+                                          const byte* b)
+{
+    return self->_comparer((object)a, (object)b);
+}
+
+static void AvmPriorityQueueAllocate(AvmPriorityQueue* self, uint capacity)
+{
+    const uint old = self->_items == NULL ? 0 : self->_capacity + 1;
+    const size_t size = self->_itemType->_size;
+
+    self->_items = AvmRealloc(self->_items, ((size_t)capacity + 1) * size);
+    self->_handles =
+        AvmRealloc(self->_handles, ((size_t)capacity + 1) * sizeof(uint));
+    self->_positions =
+        AvmRealloc(self->_positions, ((size_t)capacity + 1) * sizeof(uint));
+
+    for (uint i = old; i <= capacity; i++)
+    {
+        self->_handles[i] = i;
+        self->_positions[i] = i;
+    }
+
+    self->_capacity = capacity;
+}
+
+static void AvmPriorityQueueReserve(AvmPriorityQueue* self, uint count)
+{
+    const ulong required = (ulong)self->_length + count;
+
+    if (required <= self->_capacity)
+    {
+        return;
+    }
+
+    if (required > MAX_CAPACITY)
+    {
+        throw(AvmErrorNew(MemError));
+    }
+
+    ulong capacity = (ulong)self->_capacity * AVM_ARRAY_LIST_GROWTH_FACTOR;
+    if (capacity < required)
+    {
+        capacity = required;
+    }
+
+    if (capacity > MAX_CAPACITY)
+    {
+        capacity = MAX_CAPACITY;
+    }
+
+    AvmPriorityQueueAllocate(self, (uint)capacity);
+}
+
+// Puts the item held in the scratch slot, whose handle is given, at an index
+// and moves it towards the front until its parent does not order after it.
+static void AvmPriorityQueueSiftUp(AvmPriorityQueue* self,
+                                   uint index,
+                                   uint handle)
+{
+    const size_t size = self->_itemType->_size;
+    const byte* item = AvmPriorityQueueScratch(self);
+
+    while (index != 0)
+    {
+        const uint parent = (index - 1) / ARITY;
+
+        if (AvmPriorityQueueCompare(
+                self, item, AvmPriorityQueueSlot(self, parent)) >= 0)
+        {
+            break;
+        }
+
+        memcpy(AvmPriorityQueueSlot(self, index),
+               AvmPriorityQueueSlot(self, parent),
+               size);
+        self->_handles[index] = self->_handles[parent];
+        self->_positions[self->_handles[index]] = index;
+        index = parent;
+    }
+
+    memcpy(AvmPriorityQueueSlot(self, index), item, size);
+    self->_handles[index] = handle;
+    self->_positions[handle] = index;
+}
+
+// Puts the item held in the scratch slot, whose handle is given, at an index
+// and moves it away from the front until none of its children order before
+// it.
+static void AvmPriorityQueueSiftDown(AvmPriorityQueue* self,
+                                     uint index,
+                                     uint handle)
+{
+    const size_t size = self->_itemType->_size;
+    const byte* item = AvmPriorityQueueScratch(self);
+
+    while (true)
+    {
+        const ulong first = (ulong)index * ARITY + 1;
+
+        if (first >= self->_length)
+        {
+            break;
+        }
+
+        const uint end = first + ARITY < self->_length ? (uint)first + ARITY
+                                                        : self->_length;
+        uint least = (uint)first;
+
+        for (uint child = least + 1; child < end; child++)
+        {
+            if (AvmPriorityQueueCompare(self,
+                                        AvmPriorityQueueSlot(self, child),
+                                        AvmPriorityQueueSlot(self, least)) < 0)
+            {
+                least = child;
+            }
+        }
+
+        if (AvmPriorityQueueCompare(
+                self, AvmPriorityQueueSlot(self, least), item) >= 0)
+        {
+            break;
+        }
+
+        memcpy(AvmPriorityQueueSlot(self, index),
+               AvmPriorityQueueSlot(self, least),
+               size);
+        self->_handles[index] = self->_handles[least];
+        self->_positions[self->_handles[index]] = index;
+        index = least;
+    }
+
+    memcpy(AvmPriorityQueueSlot(self, index), item, size);
+    self->_handles[index] = handle;
+    self->_positions[handle] = index;
+}
+
+// Sifts down the item at an index, which keeps its handle.
+static void AvmPriorityQueueFix(AvmPriorityQueue* self, uint index)
+{
+    memcpy(AvmPriorityQueueScratch(self),
+           AvmPriorityQueueSlot(self, index),
+           self->_itemType->_size);
+    AvmPriorityQueueSiftDown(self, index, self->_handles[index]);
+}
+
+// Replaces the front of a full bounded queue with an item that orders after
+// it, finalizing the front.
+static uint AvmPriorityQueueReplaceFront(AvmPriorityQueue* self,
+                                         object value)
+{
+    AvmDtorFunc dtor =
+        (AvmDtorFunc)AvmTypeTryGetFunction(self->_itemType, FnEntryDtor);
+
+    if (dtor != NULL)
+    {
+        dtor(AvmPriorityQueueSlot(self, 0));
+    }
+
+    // The new item takes the free handle after the last item, and the handle
+    // of the front becomes free in its place.
+    const uint handle = self->_handles[self->_length];
+    const uint front = self->_handles[0];
+
+    self->_handles[self->_length] = front;
+    self->_positions[front] = self->_length;
+
+    memcpy(AvmPriorityQueueScratch(self), value, self->_itemType->_size);
+    AvmPriorityQueueSiftDown(self, 0, handle);
+    return handle;
+}
+
+static uint AvmPriorityQueueGetLength(const AvmPriorityQueue* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static uint AvmPriorityQueueGetCapacity(const AvmPriorityQueue* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_capacity;
+}
+
+static const AvmType* AvmPriorityQueueGetItemType(const AvmPriorityQueue* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_itemType;
+}
+
+static AvmIterator AvmPriorityQueueGetIterator(const AvmPriorityQueue* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return AvmIteratorFromArray(self->_itemType, self->_length, self->_items);
+}
+
+static void AvmPriorityQueueClear(AvmPriorityQueue* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmDtorFunc dtor =
+        (AvmDtorFunc)AvmTypeTryGetFunction(self->_itemType, FnEntryDtor);
+
+    if (dtor != NULL)
+    {
+        for (uint i = 0; i < self->_length; i++)
+        {
+            dtor(AvmPriorityQueueSlot(self, i));
+        }
+    }
+
+    // The handles stay a permutation, now of free handles only.
+    self->_length = 0;
+}
+
+static AvmString AvmPriorityQueueToString(AvmPriorityQueue* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmString s = AvmStringNew(self->_length * 2);
+
+    AvmStringPushStr(&s, "[ ");
+    for (uint i = 0; i < self->_length; i++)
+    {
+        __AvmStringPushItem(
+            &s, self->_itemType, AvmPriorityQueueSlot(self, i));
+
+        if (i < self->_length - 1)
+        {
+            AvmStringPushStr(&s, ", ");
+        }
+    }
+    AvmStringPushStr(&s, " ]");
+    return s;
+}
+
+AVM_TYPE(AvmPriorityQueue,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmPriorityQueueGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmPriorityQueueGetCapacity,
+             [FnEntryGetItemType] = (AvmFunction)AvmPriorityQueueGetItemType,
+             [FnEntryGetIterator] = (AvmFunction)AvmPriorityQueueGetIterator,
+             [FnEntryClear] = (AvmFunction)AvmPriorityQueueClear,
+             [FnEntryToString] = (AvmFunction)AvmPriorityQueueToString,
+         });
+
+static AvmPriorityQueue AvmPriorityQueueCreate(const AvmType* type,
+                                               AvmComparer comparer,
+                                               uint capacity,
+                                               bool bounded)
+{
+    if (capacity > MAX_CAPACITY)
+    {
+        throw(AvmErrorNew(MemError));
+    }
+
+    AvmPriorityQueue self = {
+        ._type = typeid(AvmPriorityQueue),
+        ._itemType = type,
+        ._comparer = comparer != NULL ? comparer : __AvmGetComparer(type),
+        ._length = 0,
+        ._capacity = 0,
+        ._bounded = bounded,
+        ._items = NULL,
+        ._handles = NULL,
+        ._positions = NULL,
+    };
+
+    AvmPriorityQueueAllocate(&self, capacity);
+    return self;
+}
+
+AvmPriorityQueue AvmPriorityQueueNew(const AvmType* type,
+                                     AvmComparer comparer,
+                                     uint capacity)
+{
+    pre
+    {
+        assert(type != NULL);
+    }
+
+    if (capacity < MIN_CAPACITY)
+    {
+        capacity = MIN_CAPACITY;
+    }
+
+    return AvmPriorityQueueCreate(type, comparer, capacity, false);
+}
+
+AvmPriorityQueue AvmPriorityQueueNewBounded(const AvmType* type,
+                                            AvmComparer comparer,
+                                            uint limit)
+{
+    pre
+    {
+        assert(type != NULL);
+    }
+
+    // A bounded queue never grows, so its capacity is the limit.
+    return AvmPriorityQueueCreate(type, comparer, limit, true);
+}
+
+uint AvmPriorityQueuePush(AvmPriorityQueue* self, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    if (self->_bounded && self->_length == self->_capacity)
+    {
+        if (self->_length == 0 ||
+            AvmPriorityQueueCompare(
+                self, value, AvmPriorityQueueSlot(self, 0)) <= 0)
+        {
+            return AvmInvalid;
+        }
+
+        return AvmPriorityQueueReplaceFront(self, value);
+    }
+
+    AvmPriorityQueueReserve(self, 1);
+
+    const uint handle = self->_handles[self->_length];
+
+    memcpy(AvmPriorityQueueScratch(self), value, self->_itemType->_size);
+    self->_length++;
+    AvmPriorityQueueSiftUp(self, self->_length - 1, handle);
+    return handle;
+}
+
+void AvmPriorityQueuePushMany(AvmPriorityQueue* self,
+                              uint count,
+                              const void* items)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(items != NULL || count == 0);
+    }
+
+    const size_t size = self->_itemType->_size;
+    const byte* source = items;
+    uint appended = count;
+
+    if (self->_bounded && appended > self->_capacity - self->_length)
+    {
+        appended = self->_capacity - self->_length;
+    }
+
+    AvmPriorityQueueReserve(self, appended);
+
+    // The appended items take the free handles after the last item, which
+    // already point at their slots.
+    const uint start = self->_length;
+    memcpy(AvmPriorityQueueSlot(self, start), source, appended * size);
+    self->_length += appended;
+
+    if (appended >= start)
+    {
+        // Every node with children is sifted down, from the last one up.
+        const uint parents =
+            self->_length > 1 ? (self->_length - 2) / ARITY + 1 : 0;
+
+        for (uint i = parents; i-- != 0;)
+        {
+            AvmPriorityQueueFix(self, i);
+        }
+    }
+    else
+    {
+        for (uint i = start; i < self->_length; i++)
+        {
+            memcpy(AvmPriorityQueueScratch(self),
+                   AvmPriorityQueueSlot(self, i),
+                   size);
+            AvmPriorityQueueSiftUp(self, i, self->_handles[i]);
+        }
+    }
+
+    for (uint i = appended; i < count; i++)
+    {
+        AvmPriorityQueuePush(self, (object)(source + i * size));
+    }
+}
+
+object AvmPriorityQueuePeek(const AvmPriorityQueue* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (self->_length == 0)
+    {
+        throw(AvmErrorNew(InvalidOpError));
+    }
+
+    return AvmPriorityQueueSlot(self, 0);
+}
+
+void AvmPriorityQueuePop(AvmPriorityQueue* self, object destination)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (self->_length == 0)
+    {
+        throw(AvmErrorNew(InvalidOpError));
+    }
+
+    const size_t size = self->_itemType->_size;
+
+    if (destination == NULL)
+    {
+        AvmDtorFunc dtor =
+            (AvmDtorFunc)AvmTypeTryGetFunction(self->_itemType, FnEntryDtor);
+
+        if (dtor != NULL)
+        {
+            dtor(AvmPriorityQueueSlot(self, 0));
+        }
+    }
+    else
+    {
+        memcpy(destination, AvmPriorityQueueSlot(self, 0), size);
+    }
+
+    self->_length--;
+
+    const uint front = self->_handles[0];
+    const uint last = self->_handles[self->_length];
+
+    // The handle of the front becomes free in place of that of the last
+    // item, which moves to the front and is sifted down.
+    self->_handles[self->_length] = front;
+    self->_positions[front] = self->_length;
+
+    if (self->_length != 0)
+    {
+        memcpy(AvmPriorityQueueScratch(self),
+               AvmPriorityQueueSlot(self, self->_length),
+               size);
+        AvmPriorityQueueSiftDown(self, 0, last);
+    }
+}
+
+void AvmPriorityQueueDecreaseKey(AvmPriorityQueue* self,
+                                 uint handle,
+                                 object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    byte* item = AvmPriorityQueueGet(self, handle);
+
+    if (item == NULL || AvmPriorityQueueCompare(self, value, item) > 0)
+    {
+        throw(AvmErrorNew(ArgError));
+    }
+
+    AvmDtorFunc dtor =
+        (AvmDtorFunc)AvmTypeTryGetFunction(self->_itemType, FnEntryDtor);
+
+    if (dtor != NULL)
+    {
+        dtor(item);
+    }
+
+    memcpy(AvmPriorityQueueScratch(self), value, self->_itemType->_size);
+    AvmPriorityQueueSiftUp(self, self->_positions[handle], handle);
+}
+
+object AvmPriorityQueueGet(const AvmPriorityQueue* self, uint handle)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (handle > self->_capacity || self->_positions[handle] >= self->_length)
+    {
+        return NULL;
+    }
+
+    return AvmPriorityQueueSlot(self, self->_positions[handle]);
+}
@@ -0,0 +1,1281 @@
+#include "avium/collections/radix-tree.h"
+
+#include "avium/collections/map.h"
+#include "avium/core.h"
+#include "avium/private/collections.h"
+#include "avium/private/simd.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define NODE4   0
+#define NODE16  1
+#define NODE48  2
+#define NODE256 3
+
+// The number of prefix bytes stored in a node. Longer prefixes are only
+// counted, and their other bytes are read from a leaf below the node.
+#define MAX_PREFIX 8
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+typedef void (*AvmDtorFunc)(object);
+
+// Leaves hold the value, followed by the bytes of the key.
+typedef struct AvmRadixLeaf
+{
+    ulong length;
+    ulong value[];
+} AvmRadixLeaf;
+
+typedef struct
+{
+    byte kind;
+    ushort count;
+    uint prefixLength;
+    byte prefix[MAX_PREFIX];
+    AvmRadixLeaf* leaf; // The leaf whose key ends at the node, if any.
+} AvmRadixNode;
+
+// Nodes of 4 and 16 children keep their keys sorted. Nodes of 48 children map
+// each byte to a child slot plus 1, or to 0 if it has no child.
+typedef struct
+{
+    AvmRadixNode header;
+    byte keys[4];
+    object children[4];
+} AvmRadixNode4;
+
+typedef struct
+{
+    AvmRadixNode header;
+    byte keys[16];
+    object children[16];
+} AvmRadixNode16;
+
+typedef struct
+{
+    AvmRadixNode header;
+    byte index[256];
+    object children[48];
+} AvmRadixNode48;
+
+typedef struct
+{
+    AvmRadixNode header;
+    object children[256];
+} AvmRadixNode256;
+
+static inline bool AvmRadixIsLeaf(object node)
+{
+    return ((uintptr_t)node & 1) != 0;
+}
+
+static inline AvmRadixLeaf* AvmRadixToLeaf(object node)
+{
+    return (AvmRadixLeaf*)((uintptr_t)node & ~(uintptr_t)1);
+}
+
+static inline object AvmRadixFromLeaf(AvmRadixLeaf* leaf)
+{
+    return (object)((uintptr_t)leaf | 1);
+}
+
+static inline const byte* AvmRadixLeafKey(const AvmRadixTree* self,
+                                          const AvmRadixLeaf* leaf)
+{
+    return (const byte*)leaf->value + self->_valueType->_size;
+}
+
+static inline bool AvmRadixLeafMatches(const AvmRadixTree* self,
+                                       const AvmRadixLeaf* leaf,
+                                       uint length,
+                                       const byte* key)
+{
+    return leaf->length == length &&
+           memcmp(AvmRadixLeafKey(self, leaf), key, length) == 0;
+}
+
+static AvmRadixLeaf* AvmRadixLeafNew(AvmRadixTree* self,
+                                     uint length,
+                                     const byte* key,
+                                     object value)
+{
+    const size_t size = self->_valueType->_size;
+    AvmRadixLeaf* leaf = AvmAlloc(sizeof(AvmRadixLeaf) + size + length);
+
+    leaf->length = length;
+    memcpy(leaf->value, value, size);
+    memcpy((byte*)leaf->value + size, key, length);
+    self->_length++;
+    return leaf;
+}
+
+static void AvmRadixLeafSetValue(const AvmRadixTree* self,
+                                 AvmRadixLeaf* leaf,
+                                 object value)
+{
+    AvmDtorFunc dtor =
+        (AvmDtorFunc)AvmTypeTryGetFunction(self->_valueType, FnEntryDtor);
+
+    if (dtor != NULL)
+    {
+        dtor(leaf->value);
+    }
+
+    memcpy(leaf->value, value, self->_valueType->_size);
+}
+
+static void AvmRadixLeafDrop(AvmRadixTree* self, AvmRadixLeaf* leaf)
+{
+    AvmDtorFunc dtor =
+        (AvmDtorFunc)AvmTypeTryGetFunction(self->_valueType, FnEntryDtor);
+
+    if (dtor != NULL)
+    {
+        dtor(leaf->value);
+    }
+
+    AvmDealloc(leaf);
+    self->_length--;
+}
+
+static AvmRadixNode* AvmRadixNodeNew(byte kind)
+{
+    static const size_t sizes[] = {
+        [NODE4] = sizeof(AvmRadixNode4),
+        [NODE16] = sizeof(AvmRadixNode16),
+        [NODE48] = sizeof(AvmRadixNode48),
+        [NODE256] = sizeof(AvmRadixNode256),
+    };
+
+    AvmRadixNode* node = AvmAlloc(sizes[kind]);
+    memset(node, 0, sizes[kind]);
+    node->kind = kind;
+    return node;
+}
+
+// Creates a node of another kind with the prefix and leaf of a node.
+static AvmRadixNode* AvmRadixNodeConvert(const AvmRadixNode* node, byte kind)
+{
+    AvmRadixNode* result = AvmRadixNodeNew(kind);
+
+    memcpy(result, node, sizeof(AvmRadixNode));
+    result->kind = kind;
+    return result;
+}
+
+// Returns the slot of the child of a node for a byte, or NULL.
+static object* AvmRadixNodeFind(AvmRadixNode* node, byte key)
+{
+    switch (node->kind)
+    {
+    case NODE4: {
+        AvmRadixNode4* n = (AvmRadixNode4*)node;
+
+        for (uint i = 0; i < node->count; i++)
+        {
+            if (n->keys[i] == key)
+            {
+                return &n->children[i];
+            }
+        }
+
+        return NULL;
+    }
+    case NODE16: {
+        AvmRadixNode16* n = (AvmRadixNode16*)node;
+
+#ifdef AVM_HAVE_SSE2
+        const __m128i keys = _mm_loadu_si128((const __m128i*)n->keys);
+        const __m128i matches = _mm_cmpeq_epi8(keys, _mm_set1_epi8((char)key));
+        const uint mask = (uint)_mm_movemask_epi8(matches) &
+                          ((1u << node->count) - 1);
+
+        return mask == 0 ? NULL : &n->children[AvmBitScanForward(mask)];
+#else
+        for (uint i = 0; i < node->count; i++)
+        {
+            if (n->keys[i] == key)
+            {
+                return &n->children[i];
+            }
+        }
+
+        return NULL;
+#endif
+    }
+    case NODE48: {
+        AvmRadixNode48* n = (AvmRadixNode48*)node;
+        return n->index[key] == 0 ? NULL : &n->children[n->index[key] - 1];
+    }
+    default: {
+        AvmRadixNode256* n = (AvmRadixNode256*)node;
+        return n->children[key] == NULL ? NULL : &n->children[key];
+    }
+    }
+}
+
+// Inserts a key into the sorted keys of a node of 4 or 16 children.
+static void AvmRadixNodeInsertSorted(AvmRadixNode* node,
+                                     byte* keys,
+                                     object* children,
+                                     byte key,
+                                     object child)
+{
+    uint i = 0;
+
+    while (i < node->count && keys[i] < key)
+    {
+        i++;
+    }
+
+    memmove(keys + i + 1, keys + i, node->count - i);
+    memmove(children + i + 1, children + i, (node->count - i) * sizeof(object));
+    keys[i] = key;
+    children[i] = child;
+    node->count++;
+}
+
+// Adds a child to the node at a slot, which is replaced by a larger node if
+// the node is full. The node must not have a child for the byte.
+static void AvmRadixNodeAdd(object* ref, byte key, object child)
+{
+    AvmRadixNode* node = *ref;
+
+    switch (node->kind)
+    {
+    case NODE4: {
+        AvmRadixNode4* n = (AvmRadixNode4*)node;
+
+        if (node->count < 4)
+        {
+            AvmRadixNodeInsertSorted(node, n->keys, n->children, key, child);
+            return;
+        }
+
+        AvmRadixNode16* larger =
+            (AvmRadixNode16*)AvmRadixNodeConvert(node, NODE16);
+        memcpy(larger->keys, n->keys, sizeof(n->keys));
+        memcpy(larger->children, n->children, sizeof(n->children));
+
+        *ref = larger;
+        AvmDealloc(node);
+        AvmRadixNodeAdd(ref, key, child);
+        return;
+    }
+    case NODE16: {
+        AvmRadixNode16* n = (AvmRadixNode16*)node;
+
+        if (node->count < 16)
+        {
+            AvmRadixNodeInsertSorted(node, n->keys, n->children, key, child);
+            return;
+        }
+
+        AvmRadixNode48* larger =
+            (AvmRadixNode48*)AvmRadixNodeConvert(node, NODE48);
+        memcpy(larger->children, n->children, sizeof(n->children));
+
+        for (uint i = 0; i < 16; i++)
+        {
+            larger->index[n->keys[i]] = (byte)(i + 1);
+        }
+
+        *ref = larger;
+        AvmDealloc(node);
+        AvmRadixNodeAdd(ref, key, child);
+        return;
+    }
+    case NODE48: {
+        AvmRadixNode48* n = (AvmRadixNode48*)node;
+
+        if (node->count < 48)
+        {
+            uint slot = 0;
+
+            while (n->children[slot] != NULL)
+            {
+                slot++;
+            }
+
+            n->index[key] = (byte)(slot + 1);
+            n->children[slot] = child;
+            node->count++;
+            return;
+        }
+
+        AvmRadixNode256* larger =
+            (AvmRadixNode256*)AvmRadixNodeConvert(node, NODE256);
+
+        for (uint i = 0; i < 256; i++)
+        {
+            if (n->index[i] != 0)
+            {
+                larger->children[i] = n->children[n->index[i] - 1];
+            }
+        }
+
+        *ref = larger;
+        AvmDealloc(node);
+        AvmRadixNodeAdd(ref, key, child);
+        return;
+    }
+    default: {
+        AvmRadixNode256* n = (AvmRadixNode256*)node;
+        n->children[key] = child;
+        node->count++;
+        return;
+    }
+    }
+}
+
+// Returns the leaf of the smallest key below a node.
+static AvmRadixLeaf* AvmRadixNodeMinimum(object node)
+{
+    while (!AvmRadixIsLeaf(node))
+    {
+        AvmRadixNode* n = node;
+
+        if (n->leaf != NULL)
+        {
+            return n->leaf;
+        }
+
+        switch (n->kind)
+        {
+        case NODE4:
+            node = ((AvmRadixNode4*)n)->children[0];
+            break;
+        case NODE16:
+            node = ((AvmRadixNode16*)n)->children[0];
+            break;
+        case NODE48: {
+            const AvmRadixNode48* n48 = (AvmRadixNode48*)n;
+            uint i = 0;
+
+            while (n48->index[i] == 0)
+            {
+                i++;
+            }
+
+            node = n48->children[n48->index[i] - 1];
+            break;
+        }
+        default: {
+            const AvmRadixNode256* n256 = (AvmRadixNode256*)n;
+            uint i = 0;
+
+            while (n256->children[i] == NULL)
+            {
+                i++;
+            }
+
+            node = n256->children[i];
+            break;
+        }
+        }
+    }
+
+    return AvmRadixToLeaf(node);
+}
+
+// Returns the number of stored prefix bytes of a node that match a key at a
+// depth. The prefix matches as far as it is stored if this is
+// MIN(prefixLength, MAX_PREFIX).
+static uint AvmRadixNodeCheckPrefix(const AvmRadixNode* node,
+                                    uint length,
+                                    const byte* key,
+                                    uint depth)
+{
+    const uint max = MIN(MIN(node->prefixLength, MAX_PREFIX), length - depth);
+    uint i = 0;
+
+    while (i < max && node->prefix[i] == key[depth + i])
+    {
+        i++;
+    }
+
+    return i;
+}
+
+// Returns the number of bytes of the whole prefix of a node that match a key
+// at a depth, reading the bytes that are not stored from a leaf.
+static uint AvmRadixNodeMismatch(const AvmRadixTree* self,
+                                 AvmRadixNode* node,
+                                 uint length,
+                                 const byte* key,
+                                 uint depth)
+{
+    uint i = AvmRadixNodeCheckPrefix(node, length, key, depth);
+
+    if (i < MAX_PREFIX || node->prefixLength <= MAX_PREFIX)
+    {
+        return i;
+    }
+
+    const byte* leafKey = AvmRadixLeafKey(self, AvmRadixNodeMinimum(node));
+    const uint max = MIN(node->prefixLength, length - depth);
+
+    while (i < max && leafKey[depth + i] == key[depth + i])
+    {
+        i++;
+    }
+
+    return i;
+}
+
+// Places a leaf below a new node whose prefix ends at a depth.
+static void AvmRadixNodeAttach(const AvmRadixTree* self,
+                               object* ref,
+                               uint depth,
+                               AvmRadixLeaf* leaf)
+{
+    AvmRadixNode* node = *ref;
+
+    if (leaf->length == depth)
+    {
+        node->leaf = leaf;
+        return;
+    }
+
+    AvmRadixNodeAdd(
+        ref, AvmRadixLeafKey(self, leaf)[depth], AvmRadixFromLeaf(leaf));
+}
+
+static void AvmRadixTreeInsertAt(AvmRadixTree* self,
+                                 object* ref,
+                                 uint length,
+                                 const byte* key,
+                                 object value,
+                                 uint depth)
+{
+    object node = *ref;
+
+    if (node == NULL)
+    {
+        *ref = AvmRadixFromLeaf(AvmRadixLeafNew(self, length, key, value));
+        return;
+    }
+
+    if (AvmRadixIsLeaf(node))
+    {
+        AvmRadixLeaf* existing = AvmRadixToLeaf(node);
+
+        if (AvmRadixLeafMatches(self, existing, length, key))
+        {
+            AvmRadixLeafSetValue(self, existing, value);
+            return;
+        }
+
+        // Both keys go below a new node, after the bytes they share.
+        const byte* existingKey = AvmRadixLeafKey(self, existing);
+        const uint limit = MIN((uint)existing->length, length);
+        uint common = depth;
+
+        while (common < limit && existingKey[common] == key[common])
+        {
+            common++;
+        }
+
+        AvmRadixNode* parent = AvmRadixNodeNew(NODE4);
+        parent->prefixLength = common - depth;
+        memcpy(parent->prefix, key + depth, MIN(common - depth, MAX_PREFIX));
+
+        *ref = parent;
+        AvmRadixNodeAttach(self, ref, common, existing);
+        AvmRadixNodeAttach(
+            self, ref, common, AvmRadixLeafNew(self, length, key, value));
+        return;
+    }
+
+    AvmRadixNode* n = node;
+
+    if (n->prefixLength != 0)
+    {
+        const uint diff = AvmRadixNodeMismatch(self, n, length, key, depth);
+
+        if (diff < n->prefixLength)
+        {
+            // The key leaves the prefix, so the node is split where it does.
+            object parent = AvmRadixNodeNew(NODE4);
+            AvmRadixNode* p = parent;
+
+            p->prefixLength = diff;
+            memcpy(p->prefix, n->prefix, MIN(diff, MAX_PREFIX));
+
+            if (n->prefixLength <= MAX_PREFIX)
+            {
+                AvmRadixNodeAdd(&parent, n->prefix[diff], n);
+                n->prefixLength -= diff + 1;
+                memmove(n->prefix,
+                        n->prefix + diff + 1,
+                        MIN(n->prefixLength, MAX_PREFIX));
+            }
+            else
+            {
+                const byte* leafKey =
+                    AvmRadixLeafKey(self, AvmRadixNodeMinimum(n));
+
+                AvmRadixNodeAdd(&parent, leafKey[depth + diff], n);
+                n->prefixLength -= diff + 1;
+                memcpy(n->prefix,
+                       leafKey + depth + diff + 1,
+                       MIN(n->prefixLength, MAX_PREFIX));
+            }
+
+            *ref = parent;
+            AvmRadixNodeAttach(self,
+                               ref,
+                               depth + diff,
+                               AvmRadixLeafNew(self, length, key, value));
+            return;
+        }
+
+        depth += n->prefixLength;
+    }
+
+    if (depth == length)
+    {
+        if (n->leaf != NULL)
+        {
+            AvmRadixLeafSetValue(self, n->leaf, value);
+        }
+        else
+        {
+            n->leaf = AvmRadixLeafNew(self, length, key, value);
+        }
+
+        return;
+    }
+
+    object* child = AvmRadixNodeFind(n, key[depth]);
+
+    if (child != NULL)
+    {
+        AvmRadixTreeInsertAt(self, child, length, key, value, depth + 1);
+        return;
+    }
+
+    AvmRadixLeaf* leaf = AvmRadixLeafNew(self, length, key, value);
+    AvmRadixNodeAdd(ref, key[depth], AvmRadixFromLeaf(leaf));
+}
+
+// Replaces a node that lost children with a smaller one, or with its only
+// child or leaf.
+static void AvmRadixNodeShrink(object* ref)
+{
+    AvmRadixNode* node = *ref;
+
+    switch (node->kind)
+    {
+    case NODE4: {
+        AvmRadixNode4* n = (AvmRadixNode4*)node;
+
+        if (node->count == 0)
+        {
+            *ref = node->leaf == NULL ? NULL : AvmRadixFromLeaf(node->leaf);
+            AvmDealloc(node);
+            return;
+        }
+
+        if (node->count != 1 || node->leaf != NULL)
+        {
+            return;
+        }
+
+        object child = n->children[0];
+
+        // Leaves hold their whole key, so they can be at any depth.
+        if (!AvmRadixIsLeaf(child))
+        {
+            AvmRadixNode* c = child;
+            byte prefix[MAX_PREFIX];
+            uint stored = MIN(node->prefixLength, MAX_PREFIX);
+
+            memcpy(prefix, node->prefix, stored);
+
+            if (stored < MAX_PREFIX)
+            {
+                prefix[stored++] = n->keys[0];
+
+                const uint more =
+                    MIN(MIN(c->prefixLength, MAX_PREFIX), MAX_PREFIX - stored);
+                memcpy(prefix + stored, c->prefix, more);
+                stored += more;
+            }
+
+            memcpy(c->prefix, prefix, stored);
+            c->prefixLength += node->prefixLength + 1;
+        }
+
+        *ref = child;
+        AvmDealloc(node);
+        return;
+    }
+    case NODE16: {
+        AvmRadixNode16* n = (AvmRadixNode16*)node;
+
+        if (node->count > 3)
+        {
+            return;
+        }
+
+        AvmRadixNode4* smaller =
+            (AvmRadixNode4*)AvmRadixNodeConvert(node, NODE4);
+        memcpy(smaller->keys, n->keys, node->count);
+        memcpy(smaller->children, n->children, node->count * sizeof(object));
+        *ref = smaller;
+        break;
+    }
+    case NODE48: {
+        AvmRadixNode48* n = (AvmRadixNode48*)node;
+
+        if (node->count > 12)
+        {
+            return;
+        }
+
+        AvmRadixNode16* smaller =
+            (AvmRadixNode16*)AvmRadixNodeConvert(node, NODE16);
+        uint count = 0;
+
+        for (uint i = 0; i < 256; i++)
+        {
+            if (n->index[i] != 0)
+            {
+                smaller->keys[count] = (byte)i;
+                smaller->children[count++] = n->children[n->index[i] - 1];
+            }
+        }
+
+        *ref = smaller;
+        break;
+    }
+    default: {
+        AvmRadixNode256* n = (AvmRadixNode256*)node;
+
+        if (node->count > 37)
+        {
+            return;
+        }
+
+        AvmRadixNode48* smaller =
+            (AvmRadixNode48*)AvmRadixNodeConvert(node, NODE48);
+        uint count = 0;
+
+        for (uint i = 0; i < 256; i++)
+        {
+            if (n->children[i] != NULL)
+            {
+                smaller->index[i] = (byte)(count + 1);
+                smaller->children[count++] = n->children[i];
+            }
+        }
+
+        *ref = smaller;
+        break;
+    }
+    }
+
+    AvmDealloc(node);
+    AvmRadixNodeShrink(ref);
+}
+
+// Removes the child of a node for a byte.
+static void AvmRadixNodeRemove(object* ref, byte key, object* child)
+{
+    AvmRadixNode* node = *ref;
+
+    switch (node->kind)
+    {
+    case NODE4:
+    case NODE16: {
+        byte* keys = node->kind == NODE4 ? ((AvmRadixNode4*)node)->keys
+                                         : ((AvmRadixNode16*)node)->keys;
+        object* children = node->kind == NODE4
+                               ? ((AvmRadixNode4*)node)->children
+                               : ((AvmRadixNode16*)node)->children;
+        const uint i = (uint)(child - children);
+
+        memmove(keys + i, keys + i + 1, node->count - i - 1);
+        memmove(children + i,
+                children + i + 1,
+                (node->count - i - 1) * sizeof(object));
+        break;
+    }
+    case NODE48: {
+        AvmRadixNode48* n = (AvmRadixNode48*)node;
+        n->index[key] = 0;
+        *child = NULL;
+        break;
+    }
+    default:
+        *child = NULL;
+        break;
+    }
+
+    node->count--;
+    AvmRadixNodeShrink(ref);
+}
+
+// Unlinks the leaf of a key and returns it, or returns NULL.
+static AvmRadixLeaf* AvmRadixTreeDetach(AvmRadixTree* self,
+                                        object* ref,
+                                        uint length,
+                                        const byte* key,
+                                        uint depth)
+{
+    object node = *ref;
+
+    if (node == NULL)
+    {
+        return NULL;
+    }
+
+    if (AvmRadixIsLeaf(node))
+    {
+        AvmRadixLeaf* leaf = AvmRadixToLeaf(node);
+
+        if (!AvmRadixLeafMatches(self, leaf, length, key))
+        {
+            return NULL;
+        }
+
+        *ref = NULL;
+        return leaf;
+    }
+
+    AvmRadixNode* n = node;
+
+    if (AvmRadixNodeCheckPrefix(n, length, key, depth) !=
+        MIN(n->prefixLength, MAX_PREFIX))
+    {
+        return NULL;
+    }
+
+    depth += n->prefixLength;
+
+    if (depth > length)
+    {
+        return NULL;
+    }
+
+    if (depth == length)
+    {
+        AvmRadixLeaf* leaf = n->leaf;
+
+        if (leaf == NULL || !AvmRadixLeafMatches(self, leaf, length, key))
+        {
+            return NULL;
+        }
+
+        n->leaf = NULL;
+        AvmRadixNodeShrink(ref);
+        return leaf;
+    }
+
+    object* child = AvmRadixNodeFind(n, key[depth]);
+
+    if (child == NULL)
+    {
+        return NULL;
+    }
+
+    if (AvmRadixIsLeaf(*child))
+    {
+        AvmRadixLeaf* leaf = AvmRadixToLeaf(*child);
+
+        if (!AvmRadixLeafMatches(self, leaf, length, key))
+        {
+            return NULL;
+        }
+
+        AvmRadixNodeRemove(ref, key[depth], child);
+        return leaf;
+    }
+
+    return AvmRadixTreeDetach(self, child, length, key, depth + 1);
+}
+
+static void AvmRadixTreeVisit(const AvmRadixTree* self,
+                              object node,
+                              AvmRadixTreeVisitor visitor,
+                              object context)
+{
+    if (AvmRadixIsLeaf(node))
+    {
+        AvmRadixLeaf* leaf = AvmRadixToLeaf(node);
+        visitor((uint)leaf->length,
+                (str)AvmRadixLeafKey(self, leaf),
+                leaf->value,
+                context);
+        return;
+    }
+
+    AvmRadixNode* n = node;
+
+    if (n->leaf != NULL)
+    {
+        AvmRadixTreeVisit(self, AvmRadixFromLeaf(n->leaf), visitor, context);
+    }
+
+    switch (n->kind)
+    {
+    case NODE4:
+    case NODE16: {
+        object* children = n->kind == NODE4 ? ((AvmRadixNode4*)n)->children
+                                            : ((AvmRadixNode16*)n)->children;
+
+        for (uint i = 0; i < n->count; i++)
+        {
+            AvmRadixTreeVisit(self, children[i], visitor, context);
+        }
+
+        break;
+    }
+    case NODE48: {
+        const AvmRadixNode48* n48 = (AvmRadixNode48*)n;
+
+        for (uint i = 0; i < 256; i++)
+        {
+            if (n48->index[i] != 0)
+            {
+                AvmRadixTreeVisit(
+                    self, n48->children[n48->index[i] - 1], visitor, context);
+            }
+        }
+
+        break;
+    }
+    default: {
+        const AvmRadixNode256* n256 = (AvmRadixNode256*)n;
+
+        for (uint i = 0; i < 256; i++)
+        {
+            if (n256->children[i] != NULL)
+            {
+                AvmRadixTreeVisit(self, n256->children[i], visitor, context);
+            }
+        }
+
+        break;
+    }
+    }
+}
+
+static void AvmRadixTreeDrop(AvmRadixTree* self, object node)
+{
+    if (AvmRadixIsLeaf(node))
+    {
+        AvmRadixLeafDrop(self, AvmRadixToLeaf(node));
+        return;
+    }
+
+    AvmRadixNode* n = node;
+
+    if (n->leaf != NULL)
+    {
+        AvmRadixLeafDrop(self, n->leaf);
+    }
+
+    switch (n->kind)
+    {
+    case NODE4:
+        for (uint i = 0; i < n->count; i++)
+        {
+            AvmRadixTreeDrop(self, ((AvmRadixNode4*)n)->children[i]);
+        }
+        break;
+    case NODE16:
+        for (uint i = 0; i < n->count; i++)
+        {
+            AvmRadixTreeDrop(self, ((AvmRadixNode16*)n)->children[i]);
+        }
+        break;
+    case NODE48:
+        for (uint i = 0; i < 48; i++)
+        {
+            if (((AvmRadixNode48*)n)->children[i] != NULL)
+            {
+                AvmRadixTreeDrop(self, ((AvmRadixNode48*)n)->children[i]);
+            }
+        }
+        break;
+    default:
+        for (uint i = 0; i < 256; i++)
+        {
+            if (((AvmRadixNode256*)n)->children[i] != NULL)
+            {
+                AvmRadixTreeDrop(self, ((AvmRadixNode256*)n)->children[i]);
+            }
+        }
+        break;
+    }
+
+    AvmDealloc(n);
+}
+
+static uint AvmRadixTreeGetLength(const AvmRadixTree* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static const AvmType* AvmRadixTreeGetKeyType(const AvmRadixTree* self)
+{
+    (void)self;
+    return typeid(AvmString);
+}
+
+static const AvmType* AvmRadixTreeGetValueType(const AvmRadixTree* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_valueType;
+}
+
+static object AvmRadixTreeGetString(const AvmRadixTree* self,
+                                    const AvmString* key)
+{
+    pre
+    {
+        assert(key != NULL);
+    }
+
+    return AvmRadixTreeGet(
+        self, AvmStringGetLength(key), AvmStringGetBuffer(key));
+}
+
+static void AvmRadixTreeInsertString(AvmRadixTree* self,
+                                     const AvmString* key,
+                                     object value)
+{
+    pre
+    {
+        assert(key != NULL);
+    }
+
+    AvmRadixTreeInsert(
+        self, AvmStringGetLength(key), AvmStringGetBuffer(key), value);
+}
+
+static bool AvmRadixTreeRemoveString(AvmRadixTree* self, const AvmString* key)
+{
+    pre
+    {
+        assert(key != NULL);
+    }
+
+    return AvmRadixTreeRemove(
+        self, AvmStringGetLength(key), AvmStringGetBuffer(key));
+}
+
+static void AvmRadixTreeClear(AvmRadixTree* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (self->_root != NULL)
+    {
+        AvmRadixTreeDrop(self, self->_root);
+        self->_root = NULL;
+    }
+}
+
+typedef struct
+{
+    AvmString* s;
+    const AvmType* valueType;
+} AvmRadixTreePrinter;
+
+static void AvmRadixTreePushEntry(uint length,
+                                  str key,
+                                  object value,
+                                  object context)
+{
+    AvmRadixTreePrinter* printer = context;
+
+    if (AvmStringGetLength(printer->s) != 2)
+    {
+        AvmStringPushStr(printer->s, ", ");
+    }
+
+    AvmStringPushChars(printer->s, length, key);
+    AvmStringPushStr(printer->s, ": ");
+    __AvmStringPushItem(printer->s, printer->valueType, value);
+}
+
+static AvmString AvmRadixTreeToString(const AvmRadixTree* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmString s = AvmStringNew(self->_length * 4);
+    AvmRadixTreePrinter printer = {.s = &s, .valueType = self->_valueType};
+
+    AvmStringPushStr(&s, "{ ");
+    AvmRadixTreeForEachWithPrefix(
+        self, 0, "", AvmRadixTreePushEntry, &printer);
+    AvmStringPushStr(&s, " }");
+    return s;
+}
+
+AVM_TYPE(AvmRadixTree,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmRadixTreeGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmRadixTreeGetLength,
+             [FnEntryGetItemType] = (AvmFunction)AvmRadixTreeGetValueType,
+             [FnEntryGetKeyType] = (AvmFunction)AvmRadixTreeGetKeyType,
+             [FnEntryInsert] = (AvmFunction)AvmRadixTreeInsertString,
+             [FnEntryRemove] = (AvmFunction)AvmRadixTreeRemoveString,
+             [FnEntryItemAt] = (AvmFunction)AvmRadixTreeGetString,
+             [FnEntryClear] = (AvmFunction)AvmRadixTreeClear,
+             [FnEntryToString] = (AvmFunction)AvmRadixTreeToString,
+         });
+
+AvmRadixTree AvmRadixTreeNew(const AvmType* valueType)
+{
+    pre
+    {
+        assert(valueType != NULL);
+    }
+
+    return (AvmRadixTree){
+        ._type = typeid(AvmRadixTree),
+        ._length = 0,
+        ._valueType = valueType,
+        ._root = NULL,
+    };
+}
+
+void AvmRadixTreeInsert(AvmRadixTree* self,
+                        uint length,
+                        str key,
+                        object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL || length == 0);
+        assert(value != NULL);
+    }
+
+    AvmRadixTreeInsertAt(
+        self, &self->_root, length, (const byte*)key, value, 0);
+}
+
+object AvmRadixTreeGet(const AvmRadixTree* self, uint length, str key)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL || length == 0);
+    }
+
+    const byte* bytes = (const byte*)key;
+    object node = self->_root;
+    uint depth = 0;
+
+    while (node != NULL && !AvmRadixIsLeaf(node))
+    {
+        AvmRadixNode* n = node;
+
+        // Prefix bytes that are not stored are checked against the leaf.
+        if (AvmRadixNodeCheckPrefix(n, length, bytes, depth) !=
+            MIN(n->prefixLength, MAX_PREFIX))
+        {
+            return NULL;
+        }
+
+        depth += n->prefixLength;
+
+        if (depth >= length)
+        {
+            if (depth > length || n->leaf == NULL)
+            {
+                return NULL;
+            }
+
+            node = AvmRadixFromLeaf(n->leaf);
+            break;
+        }
+
+        object* child = AvmRadixNodeFind(n, bytes[depth++]);
+        node = child == NULL ? NULL : *child;
+    }
+
+    if (node == NULL)
+    {
+        return NULL;
+    }
+
+    AvmRadixLeaf* leaf = AvmRadixToLeaf(node);
+    return AvmRadixLeafMatches(self, leaf, length, bytes) ? leaf->value : NULL;
+}
+
+bool AvmRadixTreeRemove(AvmRadixTree* self, uint length, str key)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL || length == 0);
+    }
+
+    AvmRadixLeaf* leaf = AvmRadixTreeDetach(
+        self, &self->_root, length, (const byte*)key, 0);
+
+    if (leaf == NULL)
+    {
+        return false;
+    }
+
+    AvmRadixLeafDrop(self, leaf);
+    return true;
+}
+
+object AvmRadixTreeMatchLongest(const AvmRadixTree* self,
+                                uint length,
+                                str key,
+                                uint* matchLength)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL || length == 0);
+    }
+
+    const byte* bytes = (const byte*)key;
+    AvmRadixLeaf* best = NULL;
+    object node = self->_root;
+    uint depth = 0;
+
+    // Leaves are found in order of increasing length, so the last one whose
+    // key is a prefix of the string is the longest.
+    while (node != NULL)
+    {
+        AvmRadixLeaf* leaf = NULL;
+
+        if (AvmRadixIsLeaf(node))
+        {
+            leaf = AvmRadixToLeaf(node);
+            node = NULL;
+        }
+        else
+        {
+            AvmRadixNode* n = node;
+
+            if (AvmRadixNodeCheckPrefix(n, length, bytes, depth) !=
+                MIN(n->prefixLength, MAX_PREFIX))
+            {
+                break;
+            }
+
+            depth += n->prefixLength;
+
+            if (depth > length)
+            {
+                break;
+            }
+
+            leaf = n->leaf;
+
+            if (depth == length)
+            {
+                node = NULL;
+            }
+            else
+            {
+                object* child = AvmRadixNodeFind(n, bytes[depth++]);
+                node = child == NULL ? NULL : *child;
+            }
+        }
+
+        if (leaf != NULL && leaf->length <= length &&
+            memcmp(AvmRadixLeafKey(self, leaf), bytes, leaf->length) == 0)
+        {
+            best = leaf;
+        }
+    }
+
+    if (best == NULL)
+    {
+        return NULL;
+    }
+
+    if (matchLength != NULL)
+    {
+        *matchLength = (uint)best->length;
+    }
+
+    return best->value;
+}
+
+void AvmRadixTreeForEachWithPrefix(const AvmRadixTree* self,
+                                   uint length,
+                                   str prefix,
+                                   AvmRadixTreeVisitor visitor,
+                                   object context)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(prefix != NULL || length == 0);
+        assert(visitor != NULL);
+    }
+
+    const byte* bytes = (const byte*)prefix;
+    object node = self->_root;
+    uint depth = 0;
+
+    // Find the highest node whose keys are all at least as long as the
+    // prefix. All its keys start with the prefix if any of them does.
+    while (node != NULL && !AvmRadixIsLeaf(node))
+    {
+        AvmRadixNode* n = node;
+
+        if (depth + n->prefixLength >= length)
+        {
+            break;
+        }
+
+        if (AvmRadixNodeCheckPrefix(n, length, bytes, depth) !=
+            MIN(n->prefixLength, MAX_PREFIX))
+        {
+            return;
+        }
+
+        depth += n->prefixLength;
+
+        object* child = AvmRadixNodeFind(n, bytes[depth++]);
+        node = child == NULL ? NULL : *child;
+    }
+
+    if (node == NULL)
+    {
+        return;
+    }
+
+    const AvmRadixLeaf* leaf = AvmRadixNodeMinimum(node);
+
+    if (leaf->length >= length &&
+        memcmp(AvmRadixLeafKey(self, leaf), bytes, length) == 0)
+    {
+        AvmRadixTreeVisit(self, node, visitor, context);
+    }
+}
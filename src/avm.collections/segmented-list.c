@@ -0,0 +1,432 @@
+#include "avium/collections/segmented-list.h"
+
+#include "avium/collections/list.h"
+#include "avium/core.h"
+#include "avium/error.h"
+#include "avium/private/collections.h"
+#include "avium/private/errors.h"
+#include "avium/private/simd.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+// Segment k holds 2^(FIRST_SEGMENT_BITS + k) items, so the first k segments
+// hold 2^(FIRST_SEGMENT_BITS + k) - FIRST_SEGMENT_SIZE items. Adding
+// FIRST_SEGMENT_SIZE to an index therefore puts its segment in the highest
+// set bit and its offset in the bits below.
+#define FIRST_SEGMENT_BITS 4
+#define FIRST_SEGMENT_SIZE (1u << FIRST_SEGMENT_BITS)
+
+// Enough segments for every uint index.
+#define MAX_SEGMENTS (32 - FIRST_SEGMENT_BITS + 1)
+
+typedef struct
+{
+    uint segment;
+    uint offset;
+} AvmSegmentPosition;
+
+static inline AvmSegmentPosition AvmSegmentedListLocate(uint index)
+{
+    const ulong biased = (ulong)index + FIRST_SEGMENT_SIZE;
+    const uint bit = AvmBitScanReverse(biased);
+
+    return (AvmSegmentPosition){
+        .segment = bit - FIRST_SEGMENT_BITS,
+        .offset = (uint)(biased - (1ull << bit)),
+    };
+}
+
+static inline ulong AvmSegmentSize(uint segment)
+{
+    return 1ull << (FIRST_SEGMENT_BITS + segment);
+}
+
+static inline byte* AvmSegmentedListSlot(const AvmSegmentedList* self,
+                                         uint index)
+{
+    const AvmSegmentPosition position = AvmSegmentedListLocate(index);
+    return self->_segments[position.segment] +
+           (size_t)position.offset * self->_itemType->_size;
+}
+
+// Returns the number of items from an index to the end of its segment.
+static inline uint AvmSegmentedListContiguous(uint index)
+{
+    const AvmSegmentPosition position = AvmSegmentedListLocate(index);
+    return (uint)(AvmSegmentSize(position.segment) - position.offset);
+}
+
+static void AvmSegmentedListReserve(AvmSegmentedList* self, uint count)
+{
+    const ulong required = (ulong)self->_length + count;
+
+    if (required <= self->_capacity)
+    {
+        return;
+    }
+
+    if (required > (uint)-1)
+    {
+        throw(AvmErrorNew(MemError));
+    }
+
+    if (self->_segments == NULL)
+    {
+        self->_segments = AvmAlloc(MAX_SEGMENTS * sizeof(byte*));
+    }
+
+    ulong capacity = self->_capacity;
+    while (capacity < required)
+    {
+        const ulong size = AvmSegmentSize(self->_segmentCount);
+
+        self->_segments[self->_segmentCount++] =
+            AvmAlloc((size_t)size * self->_itemType->_size);
+        capacity += size;
+    }
+
+    // The last segment can hold more items than a uint can count.
+    self->_capacity = capacity > (uint)-1 ? (uint)-1 : (uint)capacity;
+}
+
+// Calls the finalizers of a range of items, looking up the finalizer once.
+static void AvmSegmentedListDropRange(AvmSegmentedList* self,
+                                      uint index,
+                                      uint count)
+{
+    AvmFunction fn = AvmTypeGetFunction(self->_itemType, FnEntryDtor);
+
+    if (fn == NULL)
+    {
+        return;
+    }
+
+    for (uint i = 0; i < count; i++)
+    {
+        ((void (*)(object))fn)(AvmSegmentedListSlot(self, index + i));
+    }
+}
+
+// Moves count items from one index to another, in runs that do not cross
+// segment boundaries. Overlapping ranges are moved from the end that does not
+// overwrite items that are still to be moved.
+static void AvmSegmentedListMove(AvmSegmentedList* self,
+                                 uint from,
+                                 uint to,
+                                 uint count)
+{
+    const size_t size = self->_itemType->_size;
+
+    if (to < from)
+    {
+        while (count != 0)
+        {
+            uint run = AvmSegmentedListContiguous(from);
+            const uint other = AvmSegmentedListContiguous(to);
+            run = run < other ? run : other;
+            run = run < count ? run : count;
+
+            memmove(AvmSegmentedListSlot(self, to),
+                    AvmSegmentedListSlot(self, from),
+                    run * size);
+
+            from += run;
+            to += run;
+            count -= run;
+        }
+
+        return;
+    }
+
+    while (count != 0)
+    {
+        // Runs end at the last item of a range and extend back to the start
+        // of its segment.
+        uint run = AvmSegmentedListLocate(from + count - 1).offset + 1;
+        const uint other = AvmSegmentedListLocate(to + count - 1).offset + 1;
+        run = run < other ? run : other;
+        run = run < count ? run : count;
+
+        count -= run;
+        memmove(AvmSegmentedListSlot(self, to + count),
+                AvmSegmentedListSlot(self, from + count),
+                run * size);
+    }
+}
+
+static uint AvmSegmentedListGetLength(const AvmSegmentedList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static uint AvmSegmentedListGetCapacity(const AvmSegmentedList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_capacity;
+}
+
+static const AvmType* AvmSegmentedListGetItemType(const AvmSegmentedList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_itemType;
+}
+
+static object AvmSegmentedListItemAt(const AvmSegmentedList* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    return AvmSegmentedListSlot(self, index);
+}
+
+static object AvmSegmentedListSpan(object source, uint index, uint* length)
+{
+    const uint contiguous = AvmSegmentedListContiguous(index);
+
+    if (contiguous < *length)
+    {
+        *length = contiguous;
+    }
+
+    return AvmSegmentedListSlot(source, index);
+}
+
+static AvmIterator AvmSegmentedListGetIterator(const AvmSegmentedList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return AvmIteratorNew(
+        (object)self, self->_itemType, self->_length, AvmSegmentedListSpan);
+}
+
+static void AvmSegmentedListInsertRange(AvmSegmentedList* self,
+                                        uint index,
+                                        uint count,
+                                        const void* items)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(items != NULL || count == 0);
+    }
+
+    if (index > self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t size = self->_itemType->_size;
+    const byte* source = items;
+    byte* copy = NULL;
+
+    // The items may come from this list, in which case shifting it would
+    // move them. Growing never does.
+    for (uint i = 0; i < self->_segmentCount; i++)
+    {
+        const byte* segment = self->_segments[i];
+
+        if (source >= segment && source < segment + AvmSegmentSize(i) * size)
+        {
+            copy = AvmAlloc(count * size);
+            memcpy(copy, source, count * size);
+            source = copy;
+            break;
+        }
+    }
+
+    AvmSegmentedListReserve(self, count);
+    AvmSegmentedListMove(self, index, index + count, self->_length - index);
+
+    for (uint i = index, end = index + count; i < end;)
+    {
+        uint run = AvmSegmentedListContiguous(i);
+        run = run < end - i ? run : end - i;
+
+        memcpy(AvmSegmentedListSlot(self, i), source, run * size);
+        source += run * size;
+        i += run;
+    }
+
+    self->_length += count;
+
+    if (copy != NULL)
+    {
+        AvmDealloc(copy);
+    }
+}
+
+static void AvmSegmentedListRemoveRange(AvmSegmentedList* self,
+                                        uint index,
+                                        uint count)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index > self->_length || count > self->_length - index)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    AvmSegmentedListDropRange(self, index, count);
+    AvmSegmentedListMove(
+        self, index + count, index, self->_length - index - count);
+    self->_length -= count;
+}
+
+static void AvmSegmentedListInsert(AvmSegmentedList* self,
+                                   uint index,
+                                   object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    AvmSegmentedListInsertRange(self, index, 1, value);
+}
+
+static void AvmSegmentedListRemove(AvmSegmentedList* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    AvmSegmentedListRemoveRange(self, index, 1);
+}
+
+static void AvmSegmentedListTruncate(AvmSegmentedList* self, uint length)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (length >= self->_length)
+    {
+        return;
+    }
+
+    AvmSegmentedListDropRange(self, length, self->_length - length);
+    self->_length = length;
+}
+
+static AvmString AvmSegmentedListToString(AvmSegmentedList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmString s = AvmStringNew(self->_length * 2);
+
+    AvmStringPushStr(&s, "[ ");
+    for (uint i = 0; i < self->_length; i++)
+    {
+        __AvmStringPushItem(
+            &s, self->_itemType, AvmSegmentedListSlot(self, i));
+
+        if (i < self->_length - 1)
+        {
+            AvmStringPushStr(&s, ", ");
+        }
+    }
+    AvmStringPushStr(&s, " ]");
+    return s;
+}
+
+AVM_TYPE(AvmSegmentedList,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmSegmentedListGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmSegmentedListGetCapacity,
+             [FnEntryGetItemType] = (AvmFunction)AvmSegmentedListGetItemType,
+             [FnEntryInsert] = (AvmFunction)AvmSegmentedListInsert,
+             [FnEntryRemove] = (AvmFunction)AvmSegmentedListRemove,
+             [FnEntryItemAt] = (AvmFunction)AvmSegmentedListItemAt,
+             [FnEntryInsertRange] = (AvmFunction)AvmSegmentedListInsertRange,
+             [FnEntryRemoveRange] = (AvmFunction)AvmSegmentedListRemoveRange,
+             [FnEntryTruncate] = (AvmFunction)AvmSegmentedListTruncate,
+             [FnEntryGetIterator] = (AvmFunction)AvmSegmentedListGetIterator,
+             [FnEntryToString] = (AvmFunction)AvmSegmentedListToString,
+         });
+
+AvmSegmentedList AvmSegmentedListNew(const AvmType* type, uint capacity)
+{
+    pre
+    {
+        assert(type != NULL);
+    }
+
+    AvmSegmentedList self = {
+        ._type = typeid(AvmSegmentedList),
+        ._itemType = type,
+        ._length = 0,
+        ._capacity = 0,
+        ._segmentCount = 0,
+        ._segments = NULL,
+    };
+
+    AvmSegmentedListReserve(&self, capacity);
+    return self;
+}
+
+object AvmSegmentedListPush(AvmSegmentedList* self, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    AvmSegmentedListReserve(self, 1);
+
+    byte* const slot = AvmSegmentedListSlot(self, self->_length);
+    memcpy(slot, value, self->_itemType->_size);
+    self->_length++;
+    return slot;
+}
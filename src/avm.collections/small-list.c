@@ -0,0 +1,327 @@
+#include "avium/collections/small-list.h"
+
+#include "avium/collections/list.h"
+#include "avium/core.h"
+#include "avium/error.h"
+#include "avium/private/collections.h"
+#include "avium/private/errors.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+// The inline storage follows the list, see AVM_SMALL_LIST_OF.
+static inline byte* AvmSmallListItems(const AvmSmallList* self)
+{
+    return self->_items != NULL ? self->_items : (byte*)(self + 1);
+}
+
+static inline byte* AvmSmallListSlot(const AvmSmallList* self, uint index)
+{
+    return AvmSmallListItems(self) + (size_t)index * self->_itemType->_size;
+}
+
+// Moves the items to the heap once the inline storage is full, and grows the
+// heap buffer after that.
+static void AvmSmallListEnsureCapacity(AvmSmallList* self, uint count)
+{
+    const ulong required = (ulong)self->_length + count;
+
+    if (required <= self->_capacity)
+    {
+        return;
+    }
+
+    if (required > (uint)-1)
+    {
+        throw(AvmErrorNew(MemError));
+    }
+
+    ulong capacity = (ulong)self->_capacity * AVM_ARRAY_LIST_GROWTH_FACTOR;
+    if (capacity < required)
+    {
+        capacity = required;
+    }
+
+    if (capacity > (uint)-1)
+    {
+        capacity = (uint)-1;
+    }
+
+    const size_t size = self->_itemType->_size;
+
+    if (self->_items == NULL)
+    {
+        byte* items = AvmAlloc((size_t)capacity * size);
+        memcpy(items, AvmSmallListItems(self), self->_length * size);
+        self->_items = items;
+    }
+    else
+    {
+        self->_items = AvmRealloc(self->_items, (size_t)capacity * size);
+    }
+
+    self->_capacity = (uint)capacity;
+}
+
+// Calls the finalizers of a range of items, looking up the finalizer once.
+static void AvmSmallListDropRange(AvmSmallList* self, uint index, uint count)
+{
+    AvmFunction fn = AvmTypeGetFunction(self->_itemType, FnEntryDtor);
+
+    if (fn == NULL)
+    {
+        return;
+    }
+
+    const size_t size = self->_itemType->_size;
+    byte* item = AvmSmallListSlot(self, index);
+
+    for (uint i = 0; i < count; i++, item += size)
+    {
+        ((void (*)(object))fn)(item);
+    }
+}
+
+static uint AvmSmallListGetLength(const AvmSmallList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static uint AvmSmallListGetCapacity(const AvmSmallList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_capacity;
+}
+
+static const AvmType* AvmSmallListGetItemType(const AvmSmallList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_itemType;
+}
+
+static object AvmSmallListItemAt(const AvmSmallList* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    return AvmSmallListSlot(self, index);
+}
+
+static AvmIterator AvmSmallListGetIterator(const AvmSmallList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return AvmIteratorFromArray(
+        self->_itemType, self->_length, AvmSmallListItems(self));
+}
+
+static void AvmSmallListInsertRange(AvmSmallList* self,
+                                    uint index,
+                                    uint count,
+                                    const void* items)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(items != NULL || count == 0);
+    }
+
+    if (index > self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    const size_t size = self->_itemType->_size;
+    const byte* source = items;
+    const byte* current = AvmSmallListItems(self);
+    byte* copy = NULL;
+
+    // The items may come from this list, in which case growing or shifting
+    // it would move them.
+    if (source >= current && source < current + self->_length * size)
+    {
+        copy = AvmAlloc(count * size);
+        memcpy(copy, source, count * size);
+        source = copy;
+    }
+
+    AvmSmallListEnsureCapacity(self, count);
+
+    byte* const dest = AvmSmallListSlot(self, index);
+
+    if (index < self->_length)
+    {
+        memmove(dest + count * size, dest, (self->_length - index) * size);
+    }
+
+    memcpy(dest, source, count * size);
+    self->_length += count;
+
+    if (copy != NULL)
+    {
+        AvmDealloc(copy);
+    }
+}
+
+static void AvmSmallListRemoveRange(AvmSmallList* self, uint index, uint count)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index > self->_length || count > self->_length - index)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    AvmSmallListDropRange(self, index, count);
+
+    const size_t size = self->_itemType->_size;
+    byte* const dest = AvmSmallListSlot(self, index);
+
+    memmove(dest, dest + count * size, (self->_length - index - count) * size);
+    self->_length -= count;
+}
+
+static void AvmSmallListInsert(AvmSmallList* self, uint index, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(value != NULL);
+    }
+
+    AvmSmallListInsertRange(self, index, 1, value);
+}
+
+static void AvmSmallListRemove(AvmSmallList* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index >= self->_length)
+    {
+        throw(AvmErrorNew(RangeError));
+    }
+
+    AvmSmallListRemoveRange(self, index, 1);
+}
+
+static void AvmSmallListTruncate(AvmSmallList* self, uint length)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (length >= self->_length)
+    {
+        return;
+    }
+
+    AvmSmallListDropRange(self, length, self->_length - length);
+    self->_length = length;
+}
+
+static AvmString AvmSmallListToString(AvmSmallList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmString s = AvmStringNew(self->_length * 2);
+
+    AvmStringPushStr(&s, "[ ");
+    for (uint i = 0; i < self->_length; i++)
+    {
+        __AvmStringPushItem(&s, self->_itemType, AvmSmallListSlot(self, i));
+
+        if (i < self->_length - 1)
+        {
+            AvmStringPushStr(&s, ", ");
+        }
+    }
+    AvmStringPushStr(&s, " ]");
+    return s;
+}
+
+AVM_TYPE(AvmSmallList,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmSmallListGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmSmallListGetCapacity,
+             [FnEntryGetItemType] = (AvmFunction)AvmSmallListGetItemType,
+             [FnEntryInsert] = (AvmFunction)AvmSmallListInsert,
+             [FnEntryRemove] = (AvmFunction)AvmSmallListRemove,
+             [FnEntryItemAt] = (AvmFunction)AvmSmallListItemAt,
+             [FnEntryInsertRange] = (AvmFunction)AvmSmallListInsertRange,
+             [FnEntryRemoveRange] = (AvmFunction)AvmSmallListRemoveRange,
+             [FnEntryTruncate] = (AvmFunction)AvmSmallListTruncate,
+             [FnEntryGetIterator] = (AvmFunction)AvmSmallListGetIterator,
+             [FnEntryToString] = (AvmFunction)AvmSmallListToString,
+         });
+
+AvmSmallList AvmSmallListNew(const AvmType* type, uint inlineCapacity)
+{
+    pre
+    {
+        assert(type != NULL);
+    }
+
+    return (AvmSmallList){
+        ._type = typeid(AvmSmallList),
+        ._itemType = type,
+        ._length = 0,
+        ._capacity = inlineCapacity,
+        ._items = NULL,
+    };
+}
+
+bool AvmSmallListIsInline(const AvmSmallList* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_items == NULL;
+}
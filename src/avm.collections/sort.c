@@ -0,0 +1,717 @@
+#include "avium/collections/list.h"
+
+#include "avium/collections/array-list.h"
+#include "avium/private/collections.h"
+#include "avium/private/simd.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+// Ranges of up to this many items are finished with insertion sort.
+#define INSERTION_SORT_THRESHOLD 16
+
+// Primitive ranges of up to this many items go through the sorting network.
+#define NETWORK_SIZE 16
+
+// Primitive ranges of at least this many items are radix sorted, since the
+// digit histograms cost more than they save on smaller ones.
+#define RADIX_SORT_THRESHOLD 256
+
+// Items up to this size are moved through a stack buffer.
+#define STACK_ITEM_SIZE 256
+
+typedef struct
+{
+    AvmComparer compare;
+    uint size;
+    byte* temp; // Room for one item.
+} AvmSortContext;
+
+typedef enum
+{
+    KeyKindUnsigned,
+    KeyKindSigned,
+    KeyKindFloat,
+} AvmKeyKind;
+
+//
+// Comparison sorts, which move whole items of any size.
+//
+
+static inline byte* AvmSortItemAt(const AvmSortContext* context,
+                                  byte* items,
+                                  uint index)
+{
+    return items + (size_t)index * context->size;
+}
+
+static inline void AvmSortSwap(byte* a, byte* b, uint size)
+{
+    for (; size >= sizeof(ulong); size -= sizeof(ulong))
+    {
+        ulong x, y;
+        memcpy(&x, a, sizeof(ulong));
+        memcpy(&y, b, sizeof(ulong));
+        memcpy(a, &y, sizeof(ulong));
+        memcpy(b, &x, sizeof(ulong));
+        a += sizeof(ulong);
+        b += sizeof(ulong);
+    }
+
+    for (; size != 0; size--, a++, b++)
+    {
+        const byte temp = *a;
+        *a = *b;
+        *b = temp;
+    }
+}
+
+// Stable, so it also sorts the runs of the merge sort.
+static void AvmInsertionSort(const AvmSortContext* context,
+                             byte* items,
+                             uint count)
+{
+    const uint size = context->size;
+
+    for (uint i = 1; i < count; i++)
+    {
+        byte* hole = AvmSortItemAt(context, items, i);
+
+        if (context->compare(hole - size, hole) <= 0)
+        {
+            continue;
+        }
+
+        memcpy(context->temp, hole, size);
+
+        do
+        {
+            memcpy(hole, hole - size, size);
+            hole -= size;
+        } while (hole != items &&
+                 context->compare(hole - size, context->temp) > 0);
+
+        memcpy(hole, context->temp, size);
+    }
+}
+
+static void AvmSiftDown(const AvmSortContext* context,
+                        byte* items,
+                        uint root,
+                        uint count)
+{
+    for (uint child = 2 * root + 1; child < count; child = 2 * root + 1)
+    {
+        byte* larger = AvmSortItemAt(context, items, child);
+
+        if (child + 1 < count &&
+            context->compare(larger, larger + context->size) < 0)
+        {
+            larger += context->size;
+            child++;
+        }
+
+        byte* parent = AvmSortItemAt(context, items, root);
+
+        if (context->compare(parent, larger) >= 0)
+        {
+            return;
+        }
+
+        AvmSortSwap(parent, larger, context->size);
+        root = child;
+    }
+}
+
+static void AvmHeapSort(const AvmSortContext* context, byte* items, uint count)
+{
+    for (uint i = count / 2; i > 0; i--)
+    {
+        AvmSiftDown(context, items, i - 1, count);
+    }
+
+    for (uint end = count - 1; end > 0; end--)
+    {
+        AvmSortSwap(items, AvmSortItemAt(context, items, end), context->size);
+        AvmSiftDown(context, items, 0, end);
+    }
+}
+
+// Orders three items so that *a <= *b <= *c.
+static void AvmSortThree(const AvmSortContext* context,
+                         byte* a,
+                         byte* b,
+                         byte* c)
+{
+    if (context->compare(b, a) < 0)
+    {
+        AvmSortSwap(a, b, context->size);
+    }
+
+    if (context->compare(c, b) < 0)
+    {
+        AvmSortSwap(b, c, context->size);
+
+        if (context->compare(b, a) < 0)
+        {
+            AvmSortSwap(a, b, context->size);
+        }
+    }
+}
+
+// Introsort: quicksort with a median-of-three pivot (a pseudo-median of nine
+// for large ranges), falling back to heapsort when the recursion gets too deep
+// and to insertion sort for small ranges. Equal items stop both scans, so
+// ranges with many duplicates still split evenly.
+static void AvmIntroSort(const AvmSortContext* context,
+                         byte* items,
+                         uint count,
+                         uint depth)
+{
+    const uint size = context->size;
+
+    while (count > INSERTION_SORT_THRESHOLD)
+    {
+        if (depth == 0)
+        {
+            AvmHeapSort(context, items, count);
+            return;
+        }
+
+        depth--;
+
+        byte* first = items;
+        byte* middle = AvmSortItemAt(context, items, count / 2);
+        byte* last = AvmSortItemAt(context, items, count - 1);
+
+        AvmSortThree(context, first, middle, last);
+
+        if (count > 128)
+        {
+            AvmSortThree(context, first + size, middle - size, last - size);
+            AvmSortThree(
+                context, first + 2 * size, middle + size, last - 2 * size);
+            AvmSortThree(context, middle - size, middle, middle + size);
+        }
+
+        // The pivot moves to the front, where it stops the backward scan.
+        AvmSortSwap(first, middle, size);
+
+        uint i = 0;
+        uint j = count;
+        for (;;)
+        {
+            do
+            {
+                i++;
+            } while (i < count - 1 &&
+                     context->compare(AvmSortItemAt(context, items, i), items) <
+                         0);
+
+            do
+            {
+                j--;
+            } while (context->compare(AvmSortItemAt(context, items, j), items) >
+                     0);
+
+            if (i >= j)
+            {
+                break;
+            }
+
+            AvmSortSwap(AvmSortItemAt(context, items, i),
+                        AvmSortItemAt(context, items, j),
+                        size);
+        }
+
+        AvmSortSwap(items, AvmSortItemAt(context, items, j), size);
+
+        // Recurse into the smaller side to bound the stack depth.
+        byte* right = AvmSortItemAt(context, items, j + 1);
+        const uint rightCount = count - j - 1;
+
+        if (j < rightCount)
+        {
+            AvmIntroSort(context, items, j, depth);
+            items = right;
+            count = rightCount;
+        }
+        else
+        {
+            AvmIntroSort(context, right, rightCount, depth);
+            count = j;
+        }
+    }
+
+    AvmInsertionSort(context, items, count);
+}
+
+static void AvmMerge(const AvmSortContext* context,
+                     const byte* left,
+                     const byte* leftEnd,
+                     const byte* right,
+                     const byte* rightEnd,
+                     byte* destination)
+{
+    const uint size = context->size;
+    const byte* i = left;
+    const byte* j = right;
+
+    while (i != leftEnd && j != rightEnd)
+    {
+        // Taking from the left on ties keeps the sort stable.
+        if (context->compare((object)j, (object)i) < 0)
+        {
+            memcpy(destination, j, size);
+            j += size;
+        }
+        else
+        {
+            memcpy(destination, i, size);
+            i += size;
+        }
+
+        destination += size;
+    }
+
+    memcpy(destination, i, (size_t)(leftEnd - i));
+    memcpy(destination + (leftEnd - i), j, (size_t)(rightEnd - j));
+}
+
+// Bottom-up merge sort over insertion sorted runs, which alternates between
+// the items and a buffer of the same size.
+static void AvmMergeSort(const AvmSortContext* context, byte* items, uint count)
+{
+    const uint size = context->size;
+
+    for (uint i = 0; i < count; i += INSERTION_SORT_THRESHOLD)
+    {
+        const uint runCount = count - i < INSERTION_SORT_THRESHOLD
+                                  ? count - i
+                                  : INSERTION_SORT_THRESHOLD;
+
+        AvmInsertionSort(context, AvmSortItemAt(context, items, i), runCount);
+    }
+
+    if (count <= INSERTION_SORT_THRESHOLD)
+    {
+        return;
+    }
+
+    byte* const buffer = AvmAlloc((size_t)count * size);
+    byte* source = items;
+    byte* destination = buffer;
+
+    for (uint width = INSERTION_SORT_THRESHOLD; width < count; width *= 2)
+    {
+        for (uint low = 0; low < count; low += 2 * width)
+        {
+            const uint middle = count - low < width ? count : low + width;
+            const uint high = count - middle < width ? count : middle + width;
+
+            byte* left = AvmSortItemAt(context, source, low);
+            byte* mid = AvmSortItemAt(context, source, middle);
+            byte* right = AvmSortItemAt(context, source, high);
+
+            // Runs that are already in order are copied as they are.
+            if (middle == high || context->compare(mid - size, mid) <= 0)
+            {
+                memcpy(AvmSortItemAt(context, destination, low),
+                       left,
+                       (size_t)(right - left));
+                continue;
+            }
+
+            AvmMerge(context,
+                     left,
+                     mid,
+                     mid,
+                     right,
+                     AvmSortItemAt(context, destination, low));
+        }
+
+        byte* const temp = source;
+        source = destination;
+        destination = temp;
+    }
+
+    if (source != items)
+    {
+        memcpy(items, source, (size_t)count * size);
+    }
+
+    AvmDealloc(buffer);
+}
+
+//
+// Primitive sorts. The items are first mapped in place to unsigned integers
+// with the same order, sorted as such, and then mapped back.
+//
+
+static bool AvmSortGetKeyKind(const AvmType* type, AvmKeyKind* kind)
+{
+    if (type == typeid(byte) || type == typeid(ushort) ||
+        type == typeid(uint) || type == typeid(ulong))
+    {
+        *kind = KeyKindUnsigned;
+    }
+    else if (type == typeid(char) || type == typeid(short) ||
+             type == typeid(int) || type == typeid(_long))
+    {
+        // char may be unsigned, in which case flipping the top bit would
+        // break the order.
+        *kind = type == typeid(char) && (char)-1 > 0 ? KeyKindUnsigned
+                                                      : KeyKindSigned;
+    }
+    else if (type == typeid(float) || type == typeid(double))
+    {
+        *kind = KeyKindFloat;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+static inline void AvmCompareExchange(ulong* a, ulong* b)
+{
+    const ulong x = *a;
+    const ulong y = *b;
+    *a = x < y ? x : y;
+    *b = x < y ? y : x;
+}
+
+// Batcher's odd-even merge sort network for 16 inputs. The compare-exchange
+// steps have no data dependent branches.
+static void AvmSortNetwork(ulong keys[NETWORK_SIZE])
+{
+    static const byte pairs[][2] = {
+        {0, 1},   {2, 3},   {0, 2},   {1, 3},   {1, 2},   {4, 5},   {6, 7},
+        {4, 6},   {5, 7},   {5, 6},   {0, 4},   {2, 6},   {2, 4},   {1, 5},
+        {3, 7},   {3, 5},   {1, 2},   {3, 4},   {5, 6},   {8, 9},   {10, 11},
+        {8, 10},  {9, 11},  {9, 10},  {12, 13}, {14, 15}, {12, 14}, {13, 15},
+        {13, 14}, {8, 12},  {10, 14}, {10, 12}, {9, 13},  {11, 15}, {11, 13},
+        {9, 10},  {11, 12}, {13, 14}, {0, 8},   {4, 12},  {4, 8},   {2, 10},
+        {6, 14},  {6, 10},  {2, 4},   {6, 8},   {10, 12}, {1, 9},   {5, 13},
+        {5, 9},   {3, 11},  {7, 15},  {7, 11},  {3, 5},   {7, 9},   {11, 13},
+        {1, 2},   {3, 4},   {5, 6},   {7, 8},   {9, 10},  {11, 12}, {13, 14},
+    };
+
+    for (uint i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++)
+    {
+        AvmCompareExchange(&keys[pairs[i][0]], &keys[pairs[i][1]]);
+    }
+}
+
+// Generates the key mapping, the sorting network entry and the LSD radix
+// sort for unsigned integers of type T, which is BITS bits wide.
+#define AVM_PRIMITIVE_SORT(T, BITS)                                            \
+    static void AVM_CONCAT(AvmMapKeys, BITS)(                                  \
+        T* items, uint count, AvmKeyKind kind, bool inverse)                   \
+    {                                                                          \
+        const T sign = (T)((T)1 << (BITS - 1));                                \
+                                                                               \
+        if (kind == KeyKindSigned)                                             \
+        {                                                                      \
+            for (uint i = 0; i < count; i++)                                   \
+            {                                                                  \
+                items[i] ^= sign;                                              \
+            }                                                                  \
+        }                                                                      \
+        else if (kind == KeyKindFloat && !inverse)                             \
+        {                                                                      \
+            for (uint i = 0; i < count; i++)                                   \
+            {                                                                  \
+                const T x = items[i];                                          \
+                items[i] = (T)((x & sign) ? ~x : x | sign);                    \
+            }                                                                  \
+        }                                                                      \
+        else if (kind == KeyKindFloat)                                         \
+        {                                                                      \
+            for (uint i = 0; i < count; i++)                                   \
+            {                                                                  \
+                const T x = items[i];                                          \
+                items[i] = (T)((x & sign) ? x ^ sign : ~x);                    \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static void AVM_CONCAT(AvmNetworkSort, BITS)(T * items, uint count)        \
+    {                                                                          \
+        ulong keys[NETWORK_SIZE];                                              \
+                                                                               \
+        for (uint i = 0; i < NETWORK_SIZE; i++)                                \
+        {                                                                      \
+            keys[i] = i < count ? items[i] : (ulong)-1;                        \
+        }                                                                      \
+                                                                               \
+        AvmSortNetwork(keys);                                                  \
+                                                                               \
+        for (uint i = 0; i < count; i++)                                       \
+        {                                                                      \
+            items[i] = (T)keys[i];                                             \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static void AVM_CONCAT(AvmRadixSort, BITS)(T * items, uint count)          \
+    {                                                                          \
+        uint histograms[sizeof(T)][256];                                       \
+        memset(histograms, 0, sizeof(histograms));                             \
+                                                                               \
+        for (uint i = 0; i < count; i++)                                       \
+        {                                                                      \
+            for (uint digit = 0; digit < sizeof(T); digit++)                   \
+            {                                                                  \
+                histograms[digit][(items[i] >> (digit * 8)) & 0xFF]++;         \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        T* const buffer = AvmAlloc((size_t)count * sizeof(T));                 \
+        T* source = items;                                                     \
+        T* destination = buffer;                                               \
+                                                                               \
+        for (uint digit = 0; digit < sizeof(T); digit++)                       \
+        {                                                                      \
+            uint* const histogram = histograms[digit];                         \
+            const uint shift = digit * 8;                                      \
+                                                                               \
+            /* A digit shared by every key does not change the order. */      \
+            if (histogram[(source[0] >> shift) & 0xFF] == count)               \
+            {                                                                  \
+                continue;                                                      \
+            }                                                                  \
+                                                                               \
+            for (uint i = 0, offset = 0; i < 256; i++)                         \
+            {                                                                  \
+                const uint bucketCount = histogram[i];                         \
+                histogram[i] = offset;                                         \
+                offset += bucketCount;                                         \
+            }                                                                  \
+                                                                               \
+            for (uint i = 0; i < count; i++)                                   \
+            {                                                                  \
+                destination[histogram[(source[i] >> shift) & 0xFF]++] =        \
+                    source[i];                                                 \
+            }                                                                  \
+                                                                               \
+            T* const temp = source;                                            \
+            source = destination;                                              \
+            destination = temp;                                                \
+        }                                                                      \
+                                                                               \
+        if (source != items)                                                   \
+        {                                                                      \
+            memcpy(items, source, (size_t)count * sizeof(T));                  \
+        }                                                                      \
+                                                                               \
+        AvmDealloc(buffer);                                                    \
+    }                                                                          \
+                                                                               \
+    static void AVM_CONCAT(AvmPrimitiveSort, BITS)(                            \
+        T * items, uint count, AvmKeyKind kind)                                \
+    {                                                                          \
+        AVM_CONCAT(AvmMapKeys, BITS)(items, count, kind, false);               \
+                                                                               \
+        if (count <= NETWORK_SIZE)                                             \
+        {                                                                      \
+            AVM_CONCAT(AvmNetworkSort, BITS)(items, count);                    \
+        }                                                                      \
+        else                                                                   \
+        {                                                                      \
+            AVM_CONCAT(AvmRadixSort, BITS)(items, count);                      \
+        }                                                                      \
+                                                                               \
+        AVM_CONCAT(AvmMapKeys, BITS)(items, count, kind, true);                \
+    }
+
+AVM_PRIMITIVE_SORT(byte, 8)
+AVM_PRIMITIVE_SORT(ushort, 16)
+AVM_PRIMITIVE_SORT(uint, 32)
+AVM_PRIMITIVE_SORT(ulong, 64)
+
+static void AvmPrimitiveSort(byte* items,
+                             uint count,
+                             uint size,
+                             AvmKeyKind kind)
+{
+    switch (size)
+    {
+    case 1:
+        AvmPrimitiveSort8(items, count, kind);
+        break;
+    case 2:
+        AvmPrimitiveSort16((ushort*)items, count, kind);
+        break;
+    case 4:
+        AvmPrimitiveSort32((uint*)items, count, kind);
+        break;
+    default:
+        AvmPrimitiveSort64((ulong*)items, count, kind);
+        break;
+    }
+}
+
+//
+// List entry points.
+//
+
+AvmComparer __AvmGetComparer(const AvmType* type)
+{
+    AvmComparer comparer =
+        (AvmComparer)AvmTypeTryGetFunction(type, FnEntryCompare);
+
+    return comparer == NULL ? AvmObjectCompare : comparer;
+}
+
+void __AvmMergeItems(AvmComparer comparer,
+                     uint size,
+                     const byte* left,
+                     uint leftCount,
+                     const byte* right,
+                     uint rightCount,
+                     byte* destination)
+{
+    const AvmSortContext context = {
+        .compare = comparer,
+        .size = size,
+        .temp = NULL,
+    };
+
+    AvmMerge(&context,
+             left,
+             left + (size_t)leftCount * size,
+             right,
+             right + (size_t)rightCount * size,
+             destination);
+}
+
+void __AvmSortItems(byte* items,
+                    uint count,
+                    const AvmType* type,
+                    AvmComparer comparer,
+                    bool stable)
+{
+    AvmKeyKind kind;
+
+    // The natural order of primitives does not need comparisons. Radix sort
+    // is stable, and equal primitives cannot be told apart anyway.
+    if (comparer == NULL && AvmSortGetKeyKind(type, &kind) &&
+        (count <= NETWORK_SIZE || count >= RADIX_SORT_THRESHOLD || stable))
+    {
+        AvmPrimitiveSort(items, count, type->_size, kind);
+        return;
+    }
+
+    if (comparer == NULL)
+    {
+        comparer = __AvmGetComparer(type);
+    }
+
+    union
+    {
+        ulong align;
+        byte bytes[STACK_ITEM_SIZE];
+    } stackItem;
+
+    const AvmSortContext context = {
+        .compare = comparer,
+        .size = type->_size,
+        .temp = type->_size <= STACK_ITEM_SIZE ? stackItem.bytes
+                                               : AvmAlloc(type->_size),
+    };
+
+    if (stable)
+    {
+        AvmMergeSort(&context, items, count);
+    }
+    else
+    {
+        AvmIntroSort(&context, items, count, 2 * AvmBitScanReverse(count));
+    }
+
+    if (context.temp != stackItem.bytes)
+    {
+        AvmDealloc(context.temp);
+    }
+}
+
+// Lists that do not store their items contiguously are sorted in a copy,
+// which is then moved back through the item references.
+static void AvmListSortWith(AvmList* self, AvmComparer comparer, bool stable)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const uint length = AvmListGetLength(self);
+    const AvmType* type = AvmListGetItemType(self);
+
+    if (length < 2)
+    {
+        return;
+    }
+
+    if (AvmObjectGetType(self) == typeid(AvmArrayList))
+    {
+        AvmArrayList* list = self;
+        __AvmSortItems(list->_items, length, type, comparer, stable);
+        return;
+    }
+
+    const uint size = type->_size;
+    byte* const items = AvmAlloc((size_t)length * size);
+
+    AvmIterator iterator = AvmListGetIterator(self);
+    while (AvmIteratorNext(&iterator))
+    {
+        memcpy(items + (size_t)AvmIteratorGetIndex(&iterator) * size,
+               AvmIteratorGetItems(&iterator),
+               (size_t)AvmIteratorGetLength(&iterator) * size);
+    }
+
+    __AvmSortItems(items, length, type, comparer, stable);
+
+    iterator = AvmListGetIterator(self);
+    while (AvmIteratorNext(&iterator))
+    {
+        memcpy(AvmIteratorGetItems(&iterator),
+               items + (size_t)AvmIteratorGetIndex(&iterator) * size,
+               (size_t)AvmIteratorGetLength(&iterator) * size);
+    }
+
+    AvmDealloc(items);
+}
+
+void AvmListSort(AvmList* self)
+{
+    AvmListSortWith(self, NULL, false);
+}
+
+void AvmListSortBy(AvmList* self, AvmComparer comparer)
+{
+    pre
+    {
+        assert(comparer != NULL);
+    }
+
+    AvmListSortWith(self, comparer, false);
+}
+
+void AvmListStableSort(AvmList* self)
+{
+    AvmListSortWith(self, NULL, true);
+}
+
+void AvmListStableSortBy(AvmList* self, AvmComparer comparer)
+{
+    pre
+    {
+        assert(comparer != NULL);
+    }
+
+    AvmListSortWith(self, comparer, true);
+}
@@ -0,0 +1,1154 @@
+#include "avium/collections/tree-map.h"
+
+#include "avium/collections/map.h"
+#include "avium/core.h"
+#include "avium/error.h"
+#include "avium/private/collections.h"
+#include "avium/private/errors.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+// The keys of a node take about this many bytes.
+#define CACHE_LINE_SIZE 64
+#define NODE_KEY_BYTES  (4 * CACHE_LINE_SIZE)
+
+// Nodes hold at least this many keys, however large the keys are.
+#define MIN_ORDER 4
+
+// Every inner node but the root has at least MIN_ORDER / 2 + 1 children, so
+// no tree of uint entries is deeper than this.
+#define MAX_HEIGHT 32
+
+typedef void (*AvmDtorFunc)(object);
+
+// Nodes are followed by room for one key more than the order of the tree,
+// then by the values of a leaf or the children of an inner node. An insertion
+// therefore always fits, and a node that overflows is split afterwards.
+//
+// Each key of an inner node is a copy of the first key in the subtree to its
+// right. Keys are only finalized in the leaves.
+typedef struct AvmTreeNode
+{
+    uint count;
+    bool leaf;
+    struct AvmTreeNode* next; // The next leaf in key order.
+} AvmTreeNode;
+
+// An inner node on the path to a leaf, and the index of the child taken.
+typedef struct
+{
+    AvmTreeNode* node;
+    uint index;
+} AvmTreeStep;
+
+static inline size_t AvmTreeMapKeysSize(const AvmTreeMap* self)
+{
+    const size_t size = (size_t)(self->_order + 1) * self->_keyType->_size;
+    return (size + sizeof(ulong) - 1) & ~(sizeof(ulong) - 1);
+}
+
+static inline byte* AvmTreeMapKeyAt(const AvmTreeMap* self,
+                                    const AvmTreeNode* node,
+                                    uint index)
+{
+    return (byte*)(node + 1) + (size_t)index * self->_keyType->_size;
+}
+
+static inline byte* AvmTreeMapValueAt(const AvmTreeMap* self,
+                                      const AvmTreeNode* node,
+                                      uint index)
+{
+    return (byte*)(node + 1) + AvmTreeMapKeysSize(self) +
+           (size_t)index * self->_valueType->_size;
+}
+
+static inline AvmTreeNode** AvmTreeMapChildren(const AvmTreeMap* self,
+                                               const AvmTreeNode* node)
+{
+    return (AvmTreeNode**)((byte*)(node + 1) + AvmTreeMapKeysSize(self));
+}
+
+static AvmTreeNode* AvmTreeMapNewNode(AvmTreeMap* self, bool leaf)
+{
+    const size_t extra =
+        leaf ? (size_t)(self->_order + 1) * self->_valueType->_size
+             : (size_t)(self->_order + 2) * sizeof(AvmTreeNode*);
+
+    AvmTreeNode* node =
+        AvmAlloc(sizeof(AvmTreeNode) + AvmTreeMapKeysSize(self) + extra);
+
+    node->count = 0;
+    node->leaf = leaf;
+    node->next = NULL;
+
+    if (leaf)
+    {
+        self->_leafCount++;
+    }
+
+    return node;
+}
+
+static void AvmTreeMapFreeNode(AvmTreeMap* self, AvmTreeNode* node)
+{
+    if (node->leaf)
+    {
+        self->_leafCount--;
+    }
+
+    AvmDealloc(node);
+}
+
+//
+// Searching nodes. Integer keys in their natural order are compared inline,
+// other keys through the comparer.
+//
+
+#define AVM_TREE_SEARCH(T)                                                     \
+    static uint AvmTreeSearch_##T(                                             \
+        const byte* keys, uint count, object key, bool upper)                  \
+    {                                                                          \
+        const T* items = (const T*)keys;                                       \
+        const T value = *(const T*)key;                                        \
+        uint low = 0;                                                          \
+                                                                               \
+        while (count != 0)                                                     \
+        {                                                                      \
+            const uint half = count / 2;                                       \
+            const T item = items[low + half];                                  \
+                                                                               \
+            if (upper ? item <= value : item < value)                          \
+            {                                                                  \
+                low += half + 1;                                               \
+                count -= half + 1;                                             \
+            }                                                                  \
+            else                                                               \
+            {                                                                  \
+                count = half;                                                  \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        return low;                                                            \
+    }
+
+AVM_TREE_SEARCH(byte)
+AVM_TREE_SEARCH(char)
+AVM_TREE_SEARCH(short)
+AVM_TREE_SEARCH(ushort)
+AVM_TREE_SEARCH(int)
+AVM_TREE_SEARCH(uint)
+AVM_TREE_SEARCH(_long)
+AVM_TREE_SEARCH(ulong)
+
+static bool AvmTreeMapIsIntegerKey(const AvmType* type)
+{
+    return type == typeid(byte) || type == typeid(char) ||
+           type == typeid(short) || type == typeid(ushort) ||
+           type == typeid(int) || type == typeid(uint) ||
+           type == typeid(_long) || type == typeid(ulong);
+}
+
+static uint AvmTreeSearchWith(AvmComparer compare,
+                              uint size,
+                              const byte* keys,
+                              uint count,
+                              object key,
+                              bool upper)
+{
+    uint low = 0;
+
+    while (count != 0)
+    {
+        const uint half = count / 2;
+        const int order = compare((object)(keys + (size_t)(low + half) * size),
+                                  key);
+
+        if (upper ? order <= 0 : order < 0)
+        {
+            low += half + 1;
+            count -= half + 1;
+        }
+        else
+        {
+            count = half;
+        }
+    }
+
+    return low;
+}
+
+// Returns the number of keys of a node that are less than key, or that are
+// less than or equal to it if upper is set.
+static uint AvmTreeMapSearch(const AvmTreeMap* self,
+                             const AvmTreeNode* node,
+                             object key,
+                             bool upper)
+{
+    const byte* keys = AvmTreeMapKeyAt(self, node, 0);
+    const AvmType* type = self->_keyType;
+
+    if (self->_comparer != NULL)
+    {
+        return AvmTreeSearchWith(
+            self->_comparer, type->_size, keys, node->count, key, upper);
+    }
+
+    if (type == typeid(int))
+    {
+        return AvmTreeSearch_int(keys, node->count, key, upper);
+    }
+    else if (type == typeid(uint))
+    {
+        return AvmTreeSearch_uint(keys, node->count, key, upper);
+    }
+    else if (type == typeid(_long))
+    {
+        return AvmTreeSearch__long(keys, node->count, key, upper);
+    }
+    else if (type == typeid(ulong))
+    {
+        return AvmTreeSearch_ulong(keys, node->count, key, upper);
+    }
+    else if (type == typeid(short))
+    {
+        return AvmTreeSearch_short(keys, node->count, key, upper);
+    }
+    else if (type == typeid(ushort))
+    {
+        return AvmTreeSearch_ushort(keys, node->count, key, upper);
+    }
+    else if (type == typeid(char))
+    {
+        return AvmTreeSearch_char(keys, node->count, key, upper);
+    }
+
+    return AvmTreeSearch_byte(keys, node->count, key, upper);
+}
+
+static bool AvmTreeMapKeyEquals(const AvmTreeMap* self, object a, object b)
+{
+    if (self->_comparer == NULL)
+    {
+        return memcmp(a, b, self->_keyType->_size) == 0;
+    }
+
+    return self->_comparer(a, b) == 0;
+}
+
+// Walks from the root to the leaf where key belongs, recording the inner nodes
+// on the way in path, if it is not NULL.
+static AvmTreeNode* AvmTreeMapDescend(const AvmTreeMap* self,
+                                      object key,
+                                      AvmTreeStep* path)
+{
+    AvmTreeNode* node = self->_root;
+
+    for (uint depth = 0; !node->leaf; depth++)
+    {
+        const uint index = AvmTreeMapSearch(self, node, key, true);
+
+        if (path != NULL)
+        {
+            path[depth] = (AvmTreeStep){.node = node, .index = index};
+        }
+
+        node = AvmTreeMapChildren(self, node)[index];
+    }
+
+    return node;
+}
+
+static AvmTreeNode* AvmTreeMapFirstLeaf(const AvmTreeMap* self,
+                                        AvmTreeNode* node)
+{
+    while (!node->leaf)
+    {
+        node = AvmTreeMapChildren(self, node)[0];
+    }
+
+    return node;
+}
+
+//
+// Restructuring. Nodes other than the root hold between order / 2 and order
+// keys, and the order is even, so a split node and a merged node fit.
+//
+
+// Inserts a key and the child to its right into an inner node.
+static void AvmTreeMapInsertChild(AvmTreeMap* self,
+                                  AvmTreeNode* node,
+                                  uint index,
+                                  const byte* key,
+                                  AvmTreeNode* child)
+{
+    const size_t keySize = self->_keyType->_size;
+    AvmTreeNode** children = AvmTreeMapChildren(self, node);
+    byte* slot = AvmTreeMapKeyAt(self, node, index);
+
+    memmove(slot + keySize, slot, (node->count - index) * keySize);
+    memmove(children + index + 2,
+            children + index + 1,
+            (node->count - index) * sizeof(AvmTreeNode*));
+
+    memcpy(slot, key, keySize);
+    children[index + 1] = child;
+    node->count++;
+}
+
+// Removes a key and the child to its right from an inner node.
+static void AvmTreeMapRemoveChild(AvmTreeMap* self,
+                                  AvmTreeNode* node,
+                                  uint index)
+{
+    const size_t keySize = self->_keyType->_size;
+    AvmTreeNode** children = AvmTreeMapChildren(self, node);
+    byte* slot = AvmTreeMapKeyAt(self, node, index);
+
+    memmove(slot, slot + keySize, (node->count - index - 1) * keySize);
+    memmove(children + index + 1,
+            children + index + 2,
+            (node->count - index - 1) * sizeof(AvmTreeNode*));
+
+    node->count--;
+}
+
+// Splits a node that overflowed, then the ancestors that overflow in turn by
+// taking the new nodes. The node is at the given depth below the root.
+static void AvmTreeMapSplit(AvmTreeMap* self,
+                            AvmTreeNode* node,
+                            const AvmTreeStep* path,
+                            uint depth)
+{
+    const size_t keySize = self->_keyType->_size;
+    const uint half = self->_order / 2;
+
+    while (node->count > self->_order)
+    {
+        AvmTreeNode* right = AvmTreeMapNewNode(self, node->leaf);
+        const byte* separator;
+
+        if (node->leaf)
+        {
+            right->count = node->count - half - 1;
+            node->count = half + 1;
+
+            memcpy(AvmTreeMapKeyAt(self, right, 0),
+                   AvmTreeMapKeyAt(self, node, half + 1),
+                   right->count * keySize);
+            memcpy(AvmTreeMapValueAt(self, right, 0),
+                   AvmTreeMapValueAt(self, node, half + 1),
+                   (size_t)right->count * self->_valueType->_size);
+
+            right->next = node->next;
+            node->next = right;
+            separator = AvmTreeMapKeyAt(self, right, 0);
+        }
+        else
+        {
+            // The middle key moves up to the parent.
+            right->count = node->count - half - 1;
+            node->count = half;
+
+            memcpy(AvmTreeMapKeyAt(self, right, 0),
+                   AvmTreeMapKeyAt(self, node, half + 1),
+                   right->count * keySize);
+            memcpy(AvmTreeMapChildren(self, right),
+                   AvmTreeMapChildren(self, node) + half + 1,
+                   (right->count + 1) * sizeof(AvmTreeNode*));
+
+            separator = AvmTreeMapKeyAt(self, node, half);
+        }
+
+        if (depth == 0)
+        {
+            AvmTreeNode* root = AvmTreeMapNewNode(self, false);
+            AvmTreeMapChildren(self, root)[0] = node;
+            AvmTreeMapInsertChild(self, root, 0, separator, right);
+
+            self->_root = root;
+            self->_height++;
+            return;
+        }
+
+        depth--;
+        AvmTreeMapInsertChild(
+            self, path[depth].node, path[depth].index, separator, right);
+        node = path[depth].node;
+    }
+}
+
+// Moves the last entry of the left sibling of a node to its front.
+static void AvmTreeMapBorrowLeft(AvmTreeMap* self,
+                                 AvmTreeNode* parent,
+                                 uint index,
+                                 AvmTreeNode* node,
+                                 AvmTreeNode* left)
+{
+    const size_t keySize = self->_keyType->_size;
+    byte* separator = AvmTreeMapKeyAt(self, parent, index - 1);
+    byte* keys = AvmTreeMapKeyAt(self, node, 0);
+
+    memmove(keys + keySize, keys, node->count * keySize);
+
+    if (node->leaf)
+    {
+        const size_t valueSize = self->_valueType->_size;
+        byte* values = AvmTreeMapValueAt(self, node, 0);
+
+        memmove(values + valueSize, values, node->count * valueSize);
+        memcpy(keys, AvmTreeMapKeyAt(self, left, left->count - 1), keySize);
+        memcpy(values,
+               AvmTreeMapValueAt(self, left, left->count - 1),
+               valueSize);
+        memcpy(separator, keys, keySize);
+    }
+    else
+    {
+        AvmTreeNode** children = AvmTreeMapChildren(self, node);
+
+        memmove(children + 1,
+                children,
+                (node->count + 1) * sizeof(AvmTreeNode*));
+        memcpy(keys, separator, keySize);
+        children[0] = AvmTreeMapChildren(self, left)[left->count];
+        memcpy(separator,
+               AvmTreeMapKeyAt(self, left, left->count - 1),
+               keySize);
+    }
+
+    left->count--;
+    node->count++;
+}
+
+// Moves the first entry of the right sibling of a node to its back.
+static void AvmTreeMapBorrowRight(AvmTreeMap* self,
+                                  AvmTreeNode* parent,
+                                  uint index,
+                                  AvmTreeNode* node,
+                                  AvmTreeNode* right)
+{
+    const size_t keySize = self->_keyType->_size;
+    byte* separator = AvmTreeMapKeyAt(self, parent, index);
+    byte* keys = AvmTreeMapKeyAt(self, right, 0);
+
+    if (node->leaf)
+    {
+        const size_t valueSize = self->_valueType->_size;
+        byte* values = AvmTreeMapValueAt(self, right, 0);
+
+        memcpy(AvmTreeMapKeyAt(self, node, node->count), keys, keySize);
+        memcpy(AvmTreeMapValueAt(self, node, node->count), values, valueSize);
+        memmove(values, values + valueSize, (right->count - 1) * valueSize);
+        memmove(keys, keys + keySize, (right->count - 1) * keySize);
+        memcpy(separator, keys, keySize);
+    }
+    else
+    {
+        AvmTreeNode** children = AvmTreeMapChildren(self, right);
+
+        memcpy(AvmTreeMapKeyAt(self, node, node->count), separator, keySize);
+        AvmTreeMapChildren(self, node)[node->count + 1] = children[0];
+        memcpy(separator, keys, keySize);
+        memmove(keys, keys + keySize, (right->count - 1) * keySize);
+        memmove(children,
+                children + 1,
+                right->count * sizeof(AvmTreeNode*));
+    }
+
+    right->count--;
+    node->count++;
+}
+
+// Moves the entries of a node into its left sibling and frees it.
+static void AvmTreeMapMerge(AvmTreeMap* self,
+                            AvmTreeNode* parent,
+                            uint index,
+                            AvmTreeNode* left,
+                            AvmTreeNode* right)
+{
+    const size_t keySize = self->_keyType->_size;
+
+    if (left->leaf)
+    {
+        const size_t valueSize = self->_valueType->_size;
+
+        memcpy(AvmTreeMapKeyAt(self, left, left->count),
+               AvmTreeMapKeyAt(self, right, 0),
+               right->count * keySize);
+        memcpy(AvmTreeMapValueAt(self, left, left->count),
+               AvmTreeMapValueAt(self, right, 0),
+               right->count * valueSize);
+
+        left->count += right->count;
+        left->next = right->next;
+    }
+    else
+    {
+        memcpy(AvmTreeMapKeyAt(self, left, left->count),
+               AvmTreeMapKeyAt(self, parent, index),
+               keySize);
+        memcpy(AvmTreeMapKeyAt(self, left, left->count + 1),
+               AvmTreeMapKeyAt(self, right, 0),
+               right->count * keySize);
+        memcpy(AvmTreeMapChildren(self, left) + left->count + 1,
+               AvmTreeMapChildren(self, right),
+               (right->count + 1) * sizeof(AvmTreeNode*));
+
+        left->count += right->count + 1;
+    }
+
+    AvmTreeMapRemoveChild(self, parent, index);
+    AvmTreeMapFreeNode(self, right);
+}
+
+// Refills a node that underflowed from its siblings, merging it with one of
+// them if they have no entries to spare, then the ancestors that underflow in
+// turn. The node is at the given depth below the root.
+static void AvmTreeMapRebalance(AvmTreeMap* self,
+                                AvmTreeNode* node,
+                                const AvmTreeStep* path,
+                                uint depth)
+{
+    const uint half = self->_order / 2;
+
+    while (depth != 0 && node->count < half)
+    {
+        depth--;
+
+        AvmTreeNode* parent = path[depth].node;
+        const uint index = path[depth].index;
+        AvmTreeNode** children = AvmTreeMapChildren(self, parent);
+        AvmTreeNode* left = index != 0 ? children[index - 1] : NULL;
+        AvmTreeNode* right = index < parent->count ? children[index + 1] : NULL;
+
+        if (left != NULL && left->count > half)
+        {
+            AvmTreeMapBorrowLeft(self, parent, index, node, left);
+            return;
+        }
+
+        if (right != NULL && right->count > half)
+        {
+            AvmTreeMapBorrowRight(self, parent, index, node, right);
+            return;
+        }
+
+        if (left != NULL)
+        {
+            AvmTreeMapMerge(self, parent, index - 1, left, node);
+        }
+        else
+        {
+            AvmTreeMapMerge(self, parent, index, node, right);
+        }
+
+        node = parent;
+    }
+
+    AvmTreeNode* root = self->_root;
+
+    if (root->count != 0)
+    {
+        return;
+    }
+
+    if (root->leaf)
+    {
+        self->_root = NULL;
+        self->_height = 0;
+    }
+    else
+    {
+        self->_root = AvmTreeMapChildren(self, root)[0];
+        self->_height--;
+    }
+
+    AvmTreeMapFreeNode(self, root);
+}
+
+// Updates the inner key that is a copy of the first key of a leaf. It is in
+// the deepest ancestor that the leaf is not the first descendant of.
+static void AvmTreeMapUpdateSeparator(AvmTreeMap* self,
+                                      const AvmTreeNode* leaf,
+                                      const AvmTreeStep* path,
+                                      uint depth)
+{
+    while (depth-- != 0)
+    {
+        if (path[depth].index != 0)
+        {
+            const AvmTreeStep step = path[depth];
+
+            memcpy(AvmTreeMapKeyAt(self, step.node, step.index - 1),
+                   AvmTreeMapKeyAt(self, leaf, 0),
+                   self->_keyType->_size);
+            return;
+        }
+    }
+}
+
+static void AvmTreeMapFreeTree(AvmTreeMap* self, AvmTreeNode* node)
+{
+    if (node->leaf)
+    {
+        AvmDtorFunc keyDtor =
+            (AvmDtorFunc)AvmTypeTryGetFunction(self->_keyType, FnEntryDtor);
+        AvmDtorFunc valueDtor =
+            (AvmDtorFunc)AvmTypeTryGetFunction(self->_valueType, FnEntryDtor);
+
+        for (uint i = 0; i < node->count; i++)
+        {
+            if (keyDtor != NULL)
+            {
+                keyDtor(AvmTreeMapKeyAt(self, node, i));
+            }
+
+            if (valueDtor != NULL)
+            {
+                valueDtor(AvmTreeMapValueAt(self, node, i));
+            }
+        }
+    }
+    else
+    {
+        for (uint i = 0; i <= node->count; i++)
+        {
+            AvmTreeMapFreeTree(self, AvmTreeMapChildren(self, node)[i]);
+        }
+    }
+
+    AvmTreeMapFreeNode(self, node);
+}
+
+static uint AvmTreeMapGetLength(const AvmTreeMap* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+static uint AvmTreeMapGetCapacity(const AvmTreeMap* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const ulong capacity = (ulong)self->_leafCount * self->_order;
+    return capacity > (uint)-1 ? (uint)-1 : (uint)capacity;
+}
+
+static const AvmType* AvmTreeMapGetKeyType(const AvmTreeMap* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_keyType;
+}
+
+static const AvmType* AvmTreeMapGetValueType(const AvmTreeMap* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_valueType;
+}
+
+static object AvmTreeMapGet(const AvmTreeMap* self, object key)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL);
+    }
+
+    if (self->_root == NULL)
+    {
+        return NULL;
+    }
+
+    const AvmTreeNode* leaf = AvmTreeMapDescend(self, key, NULL);
+    const uint index = AvmTreeMapSearch(self, leaf, key, false);
+
+    if (index == leaf->count ||
+        !AvmTreeMapKeyEquals(self, AvmTreeMapKeyAt(self, leaf, index), key))
+    {
+        return NULL;
+    }
+
+    return AvmTreeMapValueAt(self, leaf, index);
+}
+
+static void AvmTreeMapInsert(AvmTreeMap* self, object key, object value)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL);
+        assert(value != NULL);
+    }
+
+    const size_t keySize = self->_keyType->_size;
+    const size_t valueSize = self->_valueType->_size;
+
+    if (self->_root == NULL)
+    {
+        self->_root = AvmTreeMapNewNode(self, true);
+        self->_height = 1;
+    }
+
+    AvmTreeStep path[MAX_HEIGHT];
+    AvmTreeNode* leaf = AvmTreeMapDescend(self, key, path);
+    const uint index = AvmTreeMapSearch(self, leaf, key, false);
+
+    if (index != leaf->count &&
+        AvmTreeMapKeyEquals(self, AvmTreeMapKeyAt(self, leaf, index), key))
+    {
+        AvmDtorFunc dtor =
+            (AvmDtorFunc)AvmTypeTryGetFunction(self->_valueType, FnEntryDtor);
+
+        if (dtor != NULL)
+        {
+            dtor(AvmTreeMapValueAt(self, leaf, index));
+        }
+
+        memcpy(AvmTreeMapValueAt(self, leaf, index), value, valueSize);
+        return;
+    }
+
+    if (self->_length == (uint)-1)
+    {
+        throw(AvmErrorNew(MemError));
+    }
+
+    byte* keySlot = AvmTreeMapKeyAt(self, leaf, index);
+    byte* valueSlot = AvmTreeMapValueAt(self, leaf, index);
+
+    memmove(keySlot + keySize, keySlot, (leaf->count - index) * keySize);
+    memmove(valueSlot + valueSize,
+            valueSlot,
+            (leaf->count - index) * valueSize);
+    memcpy(keySlot, key, keySize);
+    memcpy(valueSlot, value, valueSize);
+
+    leaf->count++;
+    self->_length++;
+
+    AvmTreeMapSplit(self, leaf, path, self->_height - 1);
+}
+
+static bool AvmTreeMapRemove(AvmTreeMap* self, object key)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(key != NULL);
+    }
+
+    if (self->_root == NULL)
+    {
+        return false;
+    }
+
+    const size_t keySize = self->_keyType->_size;
+    const size_t valueSize = self->_valueType->_size;
+
+    AvmTreeStep path[MAX_HEIGHT];
+    AvmTreeNode* leaf = AvmTreeMapDescend(self, key, path);
+    const uint index = AvmTreeMapSearch(self, leaf, key, false);
+
+    if (index == leaf->count ||
+        !AvmTreeMapKeyEquals(self, AvmTreeMapKeyAt(self, leaf, index), key))
+    {
+        return false;
+    }
+
+    AvmDtorFunc keyDtor =
+        (AvmDtorFunc)AvmTypeTryGetFunction(self->_keyType, FnEntryDtor);
+    AvmDtorFunc valueDtor =
+        (AvmDtorFunc)AvmTypeTryGetFunction(self->_valueType, FnEntryDtor);
+
+    byte* keySlot = AvmTreeMapKeyAt(self, leaf, index);
+    byte* valueSlot = AvmTreeMapValueAt(self, leaf, index);
+
+    if (keyDtor != NULL)
+    {
+        keyDtor(keySlot);
+    }
+
+    if (valueDtor != NULL)
+    {
+        valueDtor(valueSlot);
+    }
+
+    memmove(keySlot, keySlot + keySize, (leaf->count - index - 1) * keySize);
+    memmove(valueSlot,
+            valueSlot + valueSize,
+            (leaf->count - index - 1) * valueSize);
+
+    leaf->count--;
+    self->_length--;
+
+    // The inner copy of a removed first key would refer to finalized memory.
+    if (index == 0 && leaf->count != 0)
+    {
+        AvmTreeMapUpdateSeparator(self, leaf, path, self->_height - 1);
+    }
+
+    AvmTreeMapRebalance(self, leaf, path, self->_height - 1);
+    return true;
+}
+
+static void AvmTreeMapClear(AvmTreeMap* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (self->_root != NULL)
+    {
+        AvmTreeMapFreeTree(self, self->_root);
+    }
+
+    self->_root = NULL;
+    self->_height = 0;
+    self->_length = 0;
+}
+
+static AvmString AvmTreeMapToString(AvmTreeMap* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmString s = AvmStringNew(self->_length * 4);
+    uint remaining = self->_length;
+
+    AvmStringPushStr(&s, "{ ");
+    if (self->_root != NULL)
+    {
+        for (const AvmTreeNode* leaf = AvmTreeMapFirstLeaf(self, self->_root);
+             leaf != NULL;
+             leaf = leaf->next)
+        {
+            for (uint i = 0; i < leaf->count; i++)
+            {
+                __AvmStringPushItem(
+                    &s, self->_keyType, AvmTreeMapKeyAt(self, leaf, i));
+                AvmStringPushStr(&s, ": ");
+                __AvmStringPushItem(
+                    &s, self->_valueType, AvmTreeMapValueAt(self, leaf, i));
+
+                if (--remaining != 0)
+                {
+                    AvmStringPushStr(&s, ", ");
+                }
+            }
+        }
+    }
+    AvmStringPushStr(&s, " }");
+    return s;
+}
+
+AVM_TYPE(AvmTreeMap,
+         object,
+         {
+             [FnEntryGetLength] = (AvmFunction)AvmTreeMapGetLength,
+             [FnEntryGetCapacity] = (AvmFunction)AvmTreeMapGetCapacity,
+             [FnEntryGetItemType] = (AvmFunction)AvmTreeMapGetValueType,
+             [FnEntryGetKeyType] = (AvmFunction)AvmTreeMapGetKeyType,
+             [FnEntryInsert] = (AvmFunction)AvmTreeMapInsert,
+             [FnEntryRemove] = (AvmFunction)AvmTreeMapRemove,
+             [FnEntryItemAt] = (AvmFunction)AvmTreeMapGet,
+             [FnEntryClear] = (AvmFunction)AvmTreeMapClear,
+             [FnEntryToString] = (AvmFunction)AvmTreeMapToString,
+         });
+
+AVM_TYPE(AvmTreeMapRange, object, {[FnEntryDtor] = NULL});
+
+AvmTreeMap AvmTreeMapNew(const AvmType* keyType,
+                         const AvmType* valueType,
+                         AvmComparer comparer)
+{
+    pre
+    {
+        assert(keyType != NULL);
+        assert(valueType != NULL);
+        assert(keyType->_size != 0);
+    }
+
+    // Nodes have room for an extra key, and are split in halves so the order
+    // is kept even.
+    const uint fit = NODE_KEY_BYTES / keyType->_size;
+    const uint order = fit > MIN_ORDER + 1 ? (fit - 1) & ~1u : MIN_ORDER;
+
+    if (comparer == NULL && !AvmTreeMapIsIntegerKey(keyType))
+    {
+        comparer = __AvmGetComparer(keyType);
+    }
+
+    return (AvmTreeMap){
+        ._type = typeid(AvmTreeMap),
+        ._keyType = keyType,
+        ._valueType = valueType,
+        ._comparer = comparer,
+        ._length = 0,
+        ._order = order,
+        ._height = 0,
+        ._leafCount = 0,
+        ._root = NULL,
+    };
+}
+
+AvmTreeMap AvmTreeMapFromSorted(const AvmArrayList* keys,
+                                const AvmArrayList* values,
+                                AvmComparer comparer)
+{
+    pre
+    {
+        assert(keys != NULL);
+        assert(values != NULL);
+    }
+
+    if (keys->_length != values->_length)
+    {
+        throw(AvmErrorNew(ArgError));
+    }
+
+    AvmTreeMap self =
+        AvmTreeMapNew(keys->_itemType, values->_itemType, comparer);
+
+    const uint length = keys->_length;
+    const size_t keySize = self._keyType->_size;
+    const size_t valueSize = self._valueType->_size;
+    const AvmComparer compare = self._comparer != NULL
+                                    ? self._comparer
+                                    : __AvmGetComparer(self._keyType);
+
+    for (uint i = 1; i < length; i++)
+    {
+        if (compare(keys->_items + (i - 1) * keySize,
+                    keys->_items + i * keySize) >= 0)
+        {
+            throw(AvmErrorNew(ArgError));
+        }
+    }
+
+    if (length == 0)
+    {
+        return self;
+    }
+
+    // Entries are spread evenly over as few leaves as will hold them, which
+    // leaves every leaf at least half full.
+    uint count = (length - 1) / self._order + 1;
+    AvmTreeNode** nodes = AvmAlloc(count * sizeof(AvmTreeNode*));
+    AvmTreeNode* previous = NULL;
+
+    for (uint i = 0, start = 0; i < count; i++)
+    {
+        AvmTreeNode* leaf = AvmTreeMapNewNode(&self, true);
+        leaf->count = length / count + (i < length % count);
+
+        memcpy(AvmTreeMapKeyAt(&self, leaf, 0),
+               keys->_items + start * keySize,
+               leaf->count * keySize);
+        memcpy(AvmTreeMapValueAt(&self, leaf, 0),
+               values->_items + start * valueSize,
+               leaf->count * valueSize);
+
+        if (previous != NULL)
+        {
+            previous->next = leaf;
+        }
+
+        nodes[i] = leaf;
+        previous = leaf;
+        start += leaf->count;
+    }
+
+    self._height = 1;
+
+    // Each level spreads the nodes of the level below over its own nodes in
+    // the same way.
+    while (count > 1)
+    {
+        const uint parents = (count - 1) / (self._order + 1) + 1;
+
+        for (uint i = 0, start = 0; i < parents; i++)
+        {
+            AvmTreeNode* parent = AvmTreeMapNewNode(&self, false);
+            AvmTreeNode** children = AvmTreeMapChildren(&self, parent);
+            const uint take = count / parents + (i < count % parents);
+
+            for (uint j = 0; j < take; j++)
+            {
+                children[j] = nodes[start + j];
+
+                if (j != 0)
+                {
+                    const AvmTreeNode* first =
+                        AvmTreeMapFirstLeaf(&self, children[j]);
+
+                    memcpy(AvmTreeMapKeyAt(&self, parent, j - 1),
+                           AvmTreeMapKeyAt(&self, first, 0),
+                           keySize);
+                }
+            }
+
+            parent->count = take - 1;
+            start += take;
+            nodes[i] = parent;
+        }
+
+        count = parents;
+        self._height++;
+    }
+
+    self._root = nodes[0];
+    self._length = length;
+    AvmDealloc(nodes);
+    return self;
+}
+
+AvmTreeMapRange AvmTreeMapGetRange(const AvmTreeMap* self,
+                                   object low,
+                                   object high)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmTreeMapRange range = {
+        ._type = typeid(AvmTreeMapRange),
+        ._map = self,
+        ._high = high,
+        ._current = NULL,
+        ._next = NULL,
+        ._nextIndex = 0,
+        ._index = 0,
+        ._length = 0,
+    };
+
+    if (self->_root == NULL)
+    {
+        return range;
+    }
+
+    if (low == NULL)
+    {
+        range._next = AvmTreeMapFirstLeaf(self, self->_root);
+    }
+    else
+    {
+        range._next = AvmTreeMapDescend(self, low, NULL);
+        range._nextIndex = AvmTreeMapSearch(self, range._next, low, false);
+    }
+
+    return range;
+}
+
+bool AvmTreeMapRangeNext(AvmTreeMapRange* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const AvmTreeNode* leaf = self->_next;
+    uint index = self->_nextIndex;
+
+    // The first key of the range may be past the end of its leaf.
+    if (leaf != NULL && index == leaf->count)
+    {
+        leaf = leaf->next;
+        index = 0;
+    }
+
+    self->_current = NULL;
+    self->_next = NULL;
+    self->_nextIndex = 0;
+    self->_index = 0;
+    self->_length = 0;
+
+    if (leaf == NULL)
+    {
+        return false;
+    }
+
+    uint end = leaf->count;
+
+    if (self->_high != NULL)
+    {
+        end = AvmTreeMapSearch(self->_map, leaf, self->_high, false);
+    }
+
+    if (end <= index)
+    {
+        return false;
+    }
+
+    self->_current = leaf;
+    self->_index = index;
+    self->_length = end - index;
+
+    if (end == leaf->count)
+    {
+        self->_next = leaf->next;
+    }
+
+    return true;
+}
+
+object AvmTreeMapRangeGetKeys(const AvmTreeMapRange* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (self->_current == NULL)
+    {
+        return NULL;
+    }
+
+    return AvmTreeMapKeyAt(self->_map, self->_current, self->_index);
+}
+
+object AvmTreeMapRangeGetValues(const AvmTreeMapRange* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (self->_current == NULL)
+    {
+        return NULL;
+    }
+
+    return AvmTreeMapValueAt(self->_map, self->_current, self->_index);
+}
+
+uint AvmTreeMapRangeGetLength(const AvmTreeMapRange* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
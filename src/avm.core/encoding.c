@@ -0,0 +1,508 @@
+#include "avium/encoding.h"
+
+#include "avium/private/simd.h"
+#include "avium/testing.h"
+
+// The alphabets indexed by AvmBase64Variant.
+static const char AvmBase64Alphabet[2][65] = {
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_",
+};
+
+static const char AvmHexDigits[] = "0123456789abcdef";
+
+//
+// Scalar helpers.
+//
+
+// Returns the value of a base64 character, or -1 if it is not part of the
+// alphabet.
+static int AvmBase64DecodeChar(byte c, AvmBase64Variant variant)
+{
+    if (c >= 'A' && c <= 'Z')
+    {
+        return c - 'A';
+    }
+
+    if (c >= 'a' && c <= 'z')
+    {
+        return c - 'a' + 26;
+    }
+
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0' + 52;
+    }
+
+    if (c == (byte)AvmBase64Alphabet[variant][62])
+    {
+        return 62;
+    }
+
+    if (c == (byte)AvmBase64Alphabet[variant][63])
+    {
+        return 63;
+    }
+
+    return -1;
+}
+
+// Returns the value of a hexadecimal digit, or -1 if it is not one.
+static int AvmHexDecodeChar(byte c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+
+    c |= 0x20;
+
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+
+    return -1;
+}
+
+//
+// Vector kernels.
+//
+// The base64 kernels are from "Faster Base64 Encoding and Decoding Using AVX2
+// Instructions" by Wojciech Muła and Daniel Lemire, narrowed to 16 bytes.
+//
+
+#ifdef AVM_HAVE_SSSE3
+
+// Encodes the first 12 of 16 input bytes into 16 characters.
+AVM_SSSE3 static __m128i AvmBase64EncodeBlock(__m128i input, __m128i shifts)
+{
+    // Move each group of 3 bytes into a 32-bit lane as [b1, b0, b2, b1].
+    input = _mm_shuffle_epi8(
+        input,
+        _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+
+    // Extract the four 6-bit indices of every lane into separate bytes.
+    const __m128i t0 = _mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(input, _mm_set1_epi32(0x003F03F0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(t1, t3);
+
+    // Map every index range to an entry of the shift table: 0 for a-z, 1 to 10
+    // for 0-9, 11 and 12 for the last two characters and 13 for A-Z.
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+
+    return _mm_add_epi8(indices, _mm_shuffle_epi8(shifts, range));
+}
+
+AVM_SSSE3 static uint AvmBase64EncodeSsse3(const byte* p,
+                                           uint length,
+                                           char* out,
+                                           AvmBase64Variant variant)
+{
+    const str alphabet = AvmBase64Alphabet[variant];
+    const __m128i shifts = _mm_setr_epi8('a' - 26,
+                                         '0' - 52,
+                                         '0' - 52,
+                                         '0' - 52,
+                                         '0' - 52,
+                                         '0' - 52,
+                                         '0' - 52,
+                                         '0' - 52,
+                                         '0' - 52,
+                                         '0' - 52,
+                                         '0' - 52,
+                                         (char)(alphabet[62] - 62),
+                                         (char)(alphabet[63] - 63),
+                                         'A',
+                                         0,
+                                         0);
+
+    uint i = 0;
+
+    // Every block reads 16 bytes but only consumes 12.
+    for (; i + 16 <= length; i += 12)
+    {
+        const __m128i input = _mm_loadu_si128((const __m128i*)(p + i));
+        _mm_storeu_si128((__m128i*)out, AvmBase64EncodeBlock(input, shifts));
+        out += 16;
+    }
+
+    return i;
+}
+
+// Decodes 16 characters into the first 12 bytes of the result. Returns false
+// if a character is not part of the alphabet.
+AVM_SSSE3 static bool AvmBase64DecodeBlock(const byte* p,
+                                           byte* out,
+                                           char c62,
+                                           char c63)
+{
+    const __m128i input = _mm_loadu_si128((const __m128i*)p);
+
+    // Bytes above 0x7F are negative, so they fall outside every range.
+    const __m128i upper =
+        _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('A' - 1)),
+                      _mm_cmplt_epi8(input, _mm_set1_epi8('Z' + 1)));
+    const __m128i lower =
+        _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('a' - 1)),
+                      _mm_cmplt_epi8(input, _mm_set1_epi8('z' + 1)));
+    const __m128i digit =
+        _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('0' - 1)),
+                      _mm_cmplt_epi8(input, _mm_set1_epi8('9' + 1)));
+    const __m128i is62 = _mm_cmpeq_epi8(input, _mm_set1_epi8(c62));
+    const __m128i is63 = _mm_cmpeq_epi8(input, _mm_set1_epi8(c63));
+
+    const __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                                       _mm_or_si128(_mm_or_si128(digit, is62),
+                                                    is63));
+
+    if (_mm_movemask_epi8(valid) != 0xFFFF)
+    {
+        return false;
+    }
+
+    __m128i offsets = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+    offsets = _mm_or_si128(offsets,
+                           _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+    offsets = _mm_or_si128(offsets,
+                           _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+    offsets = _mm_or_si128(
+        offsets, _mm_and_si128(is62, _mm_set1_epi8((char)(62 - c62))));
+    offsets = _mm_or_si128(
+        offsets, _mm_and_si128(is63, _mm_set1_epi8((char)(63 - c63))));
+
+    const __m128i sextets = _mm_add_epi8(input, offsets);
+
+    // Merge pairs of 6-bit values into 12-bit ones, and those into 24-bit ones,
+    // then drop the unused top byte of every lane and fix the byte order.
+    const __m128i pairs =
+        _mm_maddubs_epi16(sextets, _mm_set1_epi32(0x01400140));
+    const __m128i lanes = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    const __m128i bytes = _mm_shuffle_epi8(
+        lanes,
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+    _mm_storeu_si128((__m128i*)out, bytes);
+    return true;
+}
+
+#endif // AVM_HAVE_SSSE3
+
+#ifdef AVM_HAVE_SSE2
+
+// Converts 16 values between 0 and 15 to lowercase hexadecimal digits.
+static __m128i AvmHexEncodeNibbles(__m128i nibbles)
+{
+    const __m128i letters = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+    const __m128i offset =
+        _mm_add_epi8(_mm_set1_epi8('0'),
+                     _mm_and_si128(letters, _mm_set1_epi8('a' - '0' - 10)));
+    return _mm_add_epi8(nibbles, offset);
+}
+
+// Converts 16 hexadecimal digits to their values. Sets @p valid to false if one
+// of the characters is not a hexadecimal digit.
+static __m128i AvmHexDecodeDigits(__m128i input, bool* valid)
+{
+    const __m128i digit =
+        _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('0' - 1)),
+                      _mm_cmplt_epi8(input, _mm_set1_epi8('9' + 1)));
+
+    const __m128i folded = _mm_or_si128(input, _mm_set1_epi8(0x20));
+    const __m128i letter =
+        _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)),
+                      _mm_cmplt_epi8(folded, _mm_set1_epi8('f' + 1)));
+
+    if (_mm_movemask_epi8(_mm_or_si128(digit, letter)) != 0xFFFF)
+    {
+        *valid = false;
+    }
+
+    const __m128i digits =
+        _mm_and_si128(digit, _mm_sub_epi8(input, _mm_set1_epi8('0')));
+    const __m128i letters = _mm_and_si128(
+        letter, _mm_sub_epi8(folded, _mm_set1_epi8('a' - 10)));
+
+    return _mm_or_si128(digits, letters);
+}
+
+#endif // AVM_HAVE_SSE2
+
+//
+// Base64.
+//
+
+uint AvmBase64GetEncodedLength(uint length, AvmBase64Variant variant)
+{
+    if (variant == Base64UrlSafe)
+    {
+        // Without padding 1 leftover byte needs 2 characters and 2 need 3.
+        const uint remainder = length % 3;
+        return length / 3 * 4 + (remainder == 0 ? 0 : remainder + 1);
+    }
+
+    return (length + 2) / 3 * 4;
+}
+
+void AvmBase64Encode(AvmString* self,
+                     uint length,
+                     const byte bytes[],
+                     AvmBase64Variant variant)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(bytes != NULL || length == 0);
+        assert(variant == Base64Standard || variant == Base64UrlSafe);
+    }
+
+    const uint encodedLength = AvmBase64GetEncodedLength(length, variant);
+    AvmStringEnsureCapacity(self, encodedLength);
+
+    const str alphabet = AvmBase64Alphabet[variant];
+    char* out = self->_buffer + self->_length;
+    uint i = 0;
+
+#ifdef AVM_HAVE_SSSE3
+    if (AvmCpuHasSsse3())
+    {
+        i = AvmBase64EncodeSsse3(bytes, length, out, variant);
+        out += i / 3 * 4;
+    }
+#endif
+
+    for (; i + 3 <= length; i += 3)
+    {
+        const uint group = ((uint)bytes[i] << 16) | ((uint)bytes[i + 1] << 8) |
+                           bytes[i + 2];
+
+        out[0] = alphabet[group >> 18];
+        out[1] = alphabet[(group >> 12) & 0x3F];
+        out[2] = alphabet[(group >> 6) & 0x3F];
+        out[3] = alphabet[group & 0x3F];
+        out += 4;
+    }
+
+    if (i < length)
+    {
+        const bool two = i + 2 == length;
+        const uint group =
+            ((uint)bytes[i] << 16) | (two ? (uint)bytes[i + 1] << 8 : 0);
+
+        *out++ = alphabet[group >> 18];
+        *out++ = alphabet[(group >> 12) & 0x3F];
+
+        if (two)
+        {
+            *out++ = alphabet[(group >> 6) & 0x3F];
+        }
+
+        if (variant == Base64Standard)
+        {
+            if (!two)
+            {
+                *out++ = '=';
+            }
+
+            *out++ = '=';
+        }
+    }
+
+    self->_length += encodedLength;
+}
+
+bool AvmBase64Decode(AvmString* self,
+                     uint length,
+                     str chars,
+                     AvmBase64Variant variant)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(chars != NULL || length == 0);
+        assert(variant == Base64Standard || variant == Base64UrlSafe);
+    }
+
+    const byte* const p = (const byte*)chars;
+
+    // Padding may only complete the last group.
+    if (length % 4 == 0 && length != 0 && p[length - 1] == '=')
+    {
+        length -= p[length - 2] == '=' ? 2 : 1;
+    }
+
+    if (length % 4 == 1)
+    {
+        return false;
+    }
+
+    const uint remainder = length % 4;
+    const uint decodedLength =
+        length / 4 * 3 + (remainder == 0 ? 0 : remainder - 1);
+
+    // The vector kernel writes 16 bytes for every 12, so reserve some slack.
+    AvmStringEnsureCapacity(self, decodedLength + 4);
+
+    byte* out = (byte*)self->_buffer + self->_length;
+    uint i = 0;
+
+#ifdef AVM_HAVE_SSSE3
+    if (AvmCpuHasSsse3())
+    {
+        const str alphabet = AvmBase64Alphabet[variant];
+
+        for (; i + 16 <= length; i += 16)
+        {
+            if (!AvmBase64DecodeBlock(p + i, out, alphabet[62], alphabet[63]))
+            {
+                return false;
+            }
+
+            out += 12;
+        }
+    }
+#endif
+
+    for (; i < length; i += 4)
+    {
+        const uint count = length - i < 4 ? length - i : 4;
+        uint group = 0;
+
+        for (uint j = 0; j < count; j++)
+        {
+            const int value = AvmBase64DecodeChar(p[i + j], variant);
+
+            if (value < 0)
+            {
+                return false;
+            }
+
+            group |= (uint)value << (18 - 6 * j);
+        }
+
+        *out++ = (byte)(group >> 16);
+
+        if (count > 2)
+        {
+            *out++ = (byte)(group >> 8);
+        }
+
+        if (count > 3)
+        {
+            *out++ = (byte)group;
+        }
+    }
+
+    self->_length += decodedLength;
+    return true;
+}
+
+//
+// Hexadecimal.
+//
+
+void AvmHexEncode(AvmString* self, uint length, const byte bytes[])
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(bytes != NULL || length == 0);
+    }
+
+    AvmStringEnsureCapacity(self, length * 2);
+
+    char* out = self->_buffer + self->_length;
+    uint i = 0;
+
+#ifdef AVM_HAVE_SSE2
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+
+    for (; i + 16 <= length; i += 16)
+    {
+        const __m128i input = _mm_loadu_si128((const __m128i*)(bytes + i));
+        const __m128i high = _mm_and_si128(_mm_srli_epi16(input, 4), nibble);
+        const __m128i low = _mm_and_si128(input, nibble);
+
+        _mm_storeu_si128((__m128i*)out,
+                         AvmHexEncodeNibbles(_mm_unpacklo_epi8(high, low)));
+        _mm_storeu_si128((__m128i*)(out + 16),
+                         AvmHexEncodeNibbles(_mm_unpackhi_epi8(high, low)));
+        out += 32;
+    }
+#endif
+
+    for (; i < length; i++)
+    {
+        *out++ = AvmHexDigits[bytes[i] >> 4];
+        *out++ = AvmHexDigits[bytes[i] & 0x0F];
+    }
+
+    self->_length += length * 2;
+}
+
+bool AvmHexDecode(AvmString* self, uint length, str chars)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(chars != NULL || length == 0);
+    }
+
+    if (length % 2 != 0)
+    {
+        return false;
+    }
+
+    AvmStringEnsureCapacity(self, length / 2);
+
+    const byte* const p = (const byte*)chars;
+    byte* out = (byte*)self->_buffer + self->_length;
+    uint i = 0;
+
+#ifdef AVM_HAVE_SSE2
+    const __m128i lowByte = _mm_set1_epi16(0x00FF);
+    bool valid = true;
+
+    for (; i + 32 <= length; i += 32)
+    {
+        const __m128i a = AvmHexDecodeDigits(
+            _mm_loadu_si128((const __m128i*)(p + i)), &valid);
+        const __m128i b = AvmHexDecodeDigits(
+            _mm_loadu_si128((const __m128i*)(p + i + 16)), &valid);
+
+        // Every 16-bit lane holds the high digit in its low byte.
+        const __m128i x = _mm_or_si128(
+            _mm_slli_epi16(_mm_and_si128(a, lowByte), 4), _mm_srli_epi16(a, 8));
+        const __m128i y = _mm_or_si128(
+            _mm_slli_epi16(_mm_and_si128(b, lowByte), 4), _mm_srli_epi16(b, 8));
+
+        _mm_storeu_si128((__m128i*)out, _mm_packus_epi16(x, y));
+        out += 16;
+    }
+
+    if (!valid)
+    {
+        return false;
+    }
+#endif
+
+    for (; i < length; i += 2)
+    {
+        const int high = AvmHexDecodeChar(p[i]);
+        const int low = AvmHexDecodeChar(p[i + 1]);
+
+        if (high < 0 || low < 0)
+        {
+            return false;
+        }
+
+        *out++ = (byte)((high << 4) | low);
+    }
+
+    self->_length += length / 2;
+    return true;
+}
@@ -0,0 +1,215 @@
+#include "avium/hash.h"
+
+#include "avium/testing.h"
+
+#include <string.h>
+
+#ifdef AVM_MSVC
+#include <intrin.h>
+#endif
+
+// The secret constants used by wyhash.
+static const ulong AvmHashSecret[4] = {
+    0x2d358dccaa6c78a5ull,
+    0x8bb84b93962eacc9ull,
+    0x4b33a62ed433d4a3ull,
+    0x4d5a2da51de1aa47ull,
+};
+
+// Multiplies two 64-bit numbers and stores the 128-bit result in the two.
+static void AvmHashMultiply(ulong* a, ulong* b)
+{
+#if defined __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 r = (uint128)*a * *b;
+    *a = (ulong)r;
+    *b = (ulong)(r >> 64);
+#elif defined AVM_MSVC && defined _M_X64
+    *a = _umul128(*a, *b, b);
+#else
+    const ulong ha = *a >> 32, hb = *b >> 32;
+    const ulong la = (uint)*a, lb = (uint)*b;
+    const ulong rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const ulong t = rl + (rm0 << 32);
+    ulong c = t < rl;
+    const ulong lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static ulong AvmHashMix(ulong a, ulong b)
+{
+    AvmHashMultiply(&a, &b);
+    return a ^ b;
+}
+
+static ulong AvmHashRead8(const byte* p)
+{
+    ulong value;
+    memcpy(&value, p, sizeof(ulong));
+    return value;
+}
+
+static ulong AvmHashRead4(const byte* p)
+{
+    uint value;
+    memcpy(&value, p, sizeof(uint));
+    return value;
+}
+
+// Reads 1 to 3 bytes.
+static ulong AvmHashRead3(const byte* p, size_t length)
+{
+    return ((ulong)p[0] << 16) | ((ulong)p[length >> 1] << 8) | p[length - 1];
+}
+
+ulong AvmHashBytesSeeded(size_t length, const void* bytes, ulong seed)
+{
+    pre
+    {
+        assert(bytes != NULL || length == 0);
+    }
+
+    const byte* p = bytes;
+    const ulong* const s = AvmHashSecret;
+    ulong a = 0;
+    ulong b = 0;
+
+    seed ^= AvmHashMix(seed ^ s[0], s[1]);
+
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            const size_t offset = (length >> 3) << 2;
+            a = (AvmHashRead4(p) << 32) | AvmHashRead4(p + offset);
+            b = (AvmHashRead4(p + length - 4) << 32) |
+                AvmHashRead4(p + length - 4 - offset);
+        }
+        else if (length > 0)
+        {
+            a = AvmHashRead3(p, length);
+        }
+    }
+    else
+    {
+        size_t i = length;
+
+        if (i > 48)
+        {
+            ulong seed1 = seed;
+            ulong seed2 = seed;
+
+            do
+            {
+                seed = AvmHashMix(AvmHashRead8(p) ^ s[1],
+                                  AvmHashRead8(p + 8) ^ seed);
+                seed1 = AvmHashMix(AvmHashRead8(p + 16) ^ s[2],
+                                   AvmHashRead8(p + 24) ^ seed1);
+                seed2 = AvmHashMix(AvmHashRead8(p + 32) ^ s[3],
+                                   AvmHashRead8(p + 40) ^ seed2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (i > 16)
+        {
+            seed =
+                AvmHashMix(AvmHashRead8(p) ^ s[1], AvmHashRead8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = AvmHashRead8(p + i - 16);
+        b = AvmHashRead8(p + i - 8);
+    }
+
+    a ^= s[1];
+    b ^= seed;
+    AvmHashMultiply(&a, &b);
+    return AvmHashMix(a ^ s[0] ^ length, b ^ s[1]);
+}
+
+ulong AvmHashBytes(size_t length, const void* bytes)
+{
+    return AvmHashBytesSeeded(length, bytes, 0);
+}
+
+#define SIP_ROTATE(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+#define SIP_ROUND(v0, v1, v2, v3)                                              \
+    do                                                                         \
+    {                                                                          \
+        v0 += v1;                                                              \
+        v1 = SIP_ROTATE(v1, 13);                                               \
+        v1 ^= v0;                                                              \
+        v0 = SIP_ROTATE(v0, 32);                                               \
+        v2 += v3;                                                              \
+        v3 = SIP_ROTATE(v3, 16);                                               \
+        v3 ^= v2;                                                              \
+        v0 += v3;                                                              \
+        v3 = SIP_ROTATE(v3, 21);                                               \
+        v3 ^= v0;                                                              \
+        v2 += v1;                                                              \
+        v1 = SIP_ROTATE(v1, 17);                                               \
+        v1 ^= v2;                                                              \
+        v2 = SIP_ROTATE(v2, 32);                                               \
+    } while (0)
+
+ulong AvmHashBytesKeyed(size_t length,
+                        const void* bytes,
+                        ulong key0,
+                        ulong key1)
+{
+    pre
+    {
+        assert(bytes != NULL || length == 0);
+    }
+
+    const byte* p = bytes;
+    const byte* const end = p + (length & ~(size_t)7);
+
+    ulong v0 = 0x736f6d6570736575ull ^ key0;
+    ulong v1 = 0x646f72616e646f6dull ^ key1;
+    ulong v2 = 0x6c7967656e657261ull ^ key0;
+    ulong v3 = 0x7465646279746573ull ^ key1;
+
+    for (; p != end; p += 8)
+    {
+        const ulong m = AvmHashRead8(p);
+        v3 ^= m;
+        SIP_ROUND(v0, v1, v2, v3);
+        SIP_ROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    // The last block contains the remaining bytes and the length.
+    ulong last = (ulong)length << 56;
+    for (size_t i = 0; i < (length & 7); i++)
+    {
+        last |= (ulong)p[i] << (8 * i);
+    }
+
+    v3 ^= last;
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    v0 ^= last;
+
+    v2 ^= 0xff;
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+    SIP_ROUND(v0, v1, v2, v3);
+
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+ulong AvmHashCombine(ulong seed, ulong hash)
+{
+    return AvmHashMix(seed ^ AvmHashSecret[0], hash ^ AvmHashSecret[1]);
+}
@@ -0,0 +1,1742 @@
+#include "avium/regex.h"
+
+#include "avium/error.h"
+#include "avium/hash.h"
+#include "avium/private/errors.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// The largest count allowed in a {n,m} quantifier.
+#define AVM_REGEX_MAX_REPEAT 1000
+
+// The largest number of instructions in a compiled program.
+#define AVM_REGEX_MAX_PROGRAM 65536
+
+// The number of DFA states cached before the cache is flushed.
+#define AVM_REGEX_MAX_DFA_STATES 1024
+
+typedef enum
+{
+    NodeEmpty,
+    NodeClass,
+    NodeBegin,
+    NodeEnd,
+    NodeConcat,
+    NodeAlternate,
+    NodeRepeat,
+    NodeGroup,
+} AvmRegexNodeKind;
+
+typedef enum
+{
+    OpClass,
+    OpMatch,
+    OpJump,
+    OpSplit,
+    OpSave,
+    OpBegin,
+    OpEnd,
+} AvmRegexOp;
+
+// A set of bytes.
+typedef struct
+{
+    uint bits[8];
+} AvmRegexClass;
+
+// A node of the syntax tree. Class nodes store the class index in left, group
+// nodes store the group index in min.
+typedef struct
+{
+    AvmRegexNodeKind kind;
+    bool greedy;
+    uint left;
+    uint right;
+    uint min;
+    uint max;
+} AvmRegexNode;
+
+// An instruction. Class instructions store the class index in x, jumps and
+// saves their target in x, and splits their preferred target in x.
+typedef struct
+{
+    AvmRegexOp op;
+    uint x;
+    uint y;
+} AvmRegexInst;
+
+// A sparse set of program counters, which keeps insertion order. This is the
+// priority order of the threads of the Pike VM.
+typedef struct
+{
+    uint count;
+    uint* dense;
+    uint* sparse;
+    uint* slots;
+} AvmRegexThreadList;
+
+// An entry of the Pike VM stack, which either continues at a program counter
+// or restores a capture slot.
+typedef struct
+{
+    uint pc;
+    uint slot;
+    uint value;
+} AvmRegexStackEntry;
+
+typedef struct
+{
+    uint start;
+    uint count;
+    bool match;
+} AvmRegexDfaState;
+
+typedef struct
+{
+    AvmRegexDfaState* states;
+    uint stateCount;
+    uint stateCapacity;
+
+    // The program counters of all states.
+    uint* pcs;
+    uint pcCount;
+    uint pcCapacity;
+
+    // stateCount * byteClassCount transitions, AvmInvalid if not computed.
+    uint* transitions;
+
+    // Open addressing table of state indices, AvmInvalid if empty.
+    uint* table;
+    uint tableCapacity;
+
+    // Start states for the middle and the beginning of the input.
+    uint startStates[2];
+
+    // Incremented whenever the cache is flushed.
+    uint generation;
+} AvmRegexDfa;
+
+struct AvmRegexProgram
+{
+    AvmRegexInst* instructions;
+    uint instructionCount;
+    AvmRegexClass* classes;
+    uint classCount;
+    uint slotCount;
+
+    // Whether every match must begin at the start of the input.
+    bool anchored;
+
+    // A literal every match begins with.
+    char* prefix;
+    uint prefixLength;
+
+    // Bytes that no class tells apart share a byte class.
+    byte byteClasses[256];
+    byte representatives[256];
+    uint byteClassCount;
+
+    // Scratch space for the Pike VM.
+    AvmRegexThreadList lists[2];
+    AvmRegexStackEntry* stack;
+    uint* slots;
+    uint* matchSlots;
+
+    // Scratch space for the DFA, which also uses the thread lists as sets.
+    uint* pcStack;
+    uint* pcs;
+    AvmRegexDfa* dfa;
+};
+
+typedef struct AvmRegexProgram AvmRegexProgram;
+
+typedef struct
+{
+    str pattern;
+    uint length;
+    uint position;
+    uint groupCount;
+
+    AvmRegexNode* nodes;
+    uint nodeCount;
+    uint nodeCapacity;
+
+    AvmRegexClass* classes;
+    uint classCount;
+    uint classCapacity;
+
+    AvmRegexInst* instructions;
+    uint instructionCount;
+    uint instructionCapacity;
+} AvmRegexCompiler;
+
+static const str RegexSyntaxError = "The regular expression was invalid.";
+static const str RegexTooLargeError = "The regular expression was too large.";
+
+AVM_TYPE(AvmRegexMatch, object, {[FnEntryDtor] = NULL});
+AVM_TYPE(AvmRegexIterator, object, {[FnEntryDtor] = NULL});
+
+//
+// Helpers.
+//
+
+static void* AvmRegexGrow(void* array, uint* capacity, uint count, size_t size)
+{
+    if (count < *capacity)
+    {
+        return array;
+    }
+
+    *capacity = *capacity == 0 ? 16 : *capacity * 2;
+    return AvmRealloc(array, *capacity * size);
+}
+
+static bool AvmRegexClassTest(const AvmRegexClass* self, byte value)
+{
+    return (self->bits[value >> 5] >> (value & 31)) & 1;
+}
+
+static void AvmRegexClassAdd(AvmRegexClass* self, byte value)
+{
+    self->bits[value >> 5] |= 1u << (value & 31);
+}
+
+static void AvmRegexClassAddRange(AvmRegexClass* self, byte low, byte high)
+{
+    for (uint i = low; i <= high; i++)
+    {
+        AvmRegexClassAdd(self, (byte)i);
+    }
+}
+
+static void AvmRegexClassNegate(AvmRegexClass* self)
+{
+    for (uint i = 0; i < 8; i++)
+    {
+        self->bits[i] = ~self->bits[i];
+    }
+}
+
+// Returns the only byte of a class, or AvmInvalid if there is not exactly one.
+static uint AvmRegexClassGetSingle(const AvmRegexClass* self)
+{
+    uint value = AvmInvalid;
+
+    for (uint i = 0; i < 256; i++)
+    {
+        if (AvmRegexClassTest(self, (byte)i))
+        {
+            if (value != AvmInvalid)
+            {
+                return AvmInvalid;
+            }
+
+            value = i;
+        }
+    }
+
+    return value;
+}
+
+static void AvmRegexCompilerFree(AvmRegexCompiler* c)
+{
+    AvmDealloc(c->nodes);
+    AvmDealloc(c->classes);
+    AvmDealloc(c->instructions);
+}
+
+static never AvmRegexFail(AvmRegexCompiler* c, str message)
+{
+    AvmRegexCompilerFree(c);
+    throw(AvmErrorNew(message));
+}
+
+//
+// Parsing.
+//
+
+static uint AvmRegexNewNode(AvmRegexCompiler* c,
+                            AvmRegexNodeKind kind,
+                            uint left,
+                            uint right)
+{
+    c->nodes = AvmRegexGrow(
+        c->nodes, &c->nodeCapacity, c->nodeCount, sizeof(AvmRegexNode));
+
+    AvmRegexNode* node = &c->nodes[c->nodeCount];
+    node->kind = kind;
+    node->greedy = true;
+    node->left = left;
+    node->right = right;
+    node->min = 0;
+    node->max = 0;
+    return c->nodeCount++;
+}
+
+// Adds a class, reusing an identical one if it exists.
+static uint AvmRegexNewClass(AvmRegexCompiler* c, const AvmRegexClass* class)
+{
+    for (uint i = 0; i < c->classCount; i++)
+    {
+        if (memcmp(&c->classes[i], class, sizeof(AvmRegexClass)) == 0)
+        {
+            return i;
+        }
+    }
+
+    c->classes = AvmRegexGrow(
+        c->classes, &c->classCapacity, c->classCount, sizeof(AvmRegexClass));
+
+    c->classes[c->classCount] = *class;
+    return c->classCount++;
+}
+
+static uint AvmRegexNewClassNode(AvmRegexCompiler* c,
+                                 const AvmRegexClass* class)
+{
+    return AvmRegexNewNode(c, NodeClass, AvmRegexNewClass(c, class), 0);
+}
+
+static bool AvmRegexAtEnd(const AvmRegexCompiler* c)
+{
+    return c->position >= c->length;
+}
+
+static char AvmRegexPeek(const AvmRegexCompiler* c)
+{
+    return AvmRegexAtEnd(c) ? '\0' : c->pattern[c->position];
+}
+
+static int AvmRegexHexDigit(char value)
+{
+    if (value >= '0' && value <= '9')
+    {
+        return value - '0';
+    }
+
+    value |= 0x20;
+
+    if (value >= 'a' && value <= 'f')
+    {
+        return value - 'a' + 10;
+    }
+
+    return -1;
+}
+
+// Parses an escape sequence after the backslash and adds its bytes to a class.
+// Returns the byte for a single character escape, otherwise AvmInvalid.
+static uint AvmRegexParseEscape(AvmRegexCompiler* c, AvmRegexClass* class)
+{
+    if (AvmRegexAtEnd(c))
+    {
+        AvmRegexFail(c, RegexSyntaxError);
+    }
+
+    const char e = c->pattern[c->position++];
+    AvmRegexClass set = {{0}};
+    uint single = AvmInvalid;
+
+    switch (e)
+    {
+    case 'd':
+    case 'D':
+        AvmRegexClassAddRange(&set, '0', '9');
+        break;
+    case 'w':
+    case 'W':
+        AvmRegexClassAddRange(&set, '0', '9');
+        AvmRegexClassAddRange(&set, 'A', 'Z');
+        AvmRegexClassAddRange(&set, 'a', 'z');
+        AvmRegexClassAdd(&set, '_');
+        break;
+    case 's':
+    case 'S':
+        AvmRegexClassAddRange(&set, '\t', '\r');
+        AvmRegexClassAdd(&set, ' ');
+        break;
+    case 'n':
+        single = '\n';
+        break;
+    case 'r':
+        single = '\r';
+        break;
+    case 't':
+        single = '\t';
+        break;
+    case 'f':
+        single = '\f';
+        break;
+    case 'v':
+        single = '\v';
+        break;
+    case '0':
+        single = '\0';
+        break;
+    case 'x': {
+        const int high = AvmRegexHexDigit(AvmRegexPeek(c));
+        c->position++;
+        const int low = AvmRegexHexDigit(AvmRegexPeek(c));
+        c->position++;
+
+        if (high < 0 || low < 0)
+        {
+            AvmRegexFail(c, RegexSyntaxError);
+        }
+
+        single = (uint)(high << 4 | low);
+        break;
+    }
+    default:
+        // Other letters and digits are reserved.
+        if ((e >= 'a' && e <= 'z') || (e >= 'A' && e <= 'Z') ||
+            (e >= '0' && e <= '9'))
+        {
+            AvmRegexFail(c, RegexSyntaxError);
+        }
+
+        single = (byte)e;
+        break;
+    }
+
+    if (single != AvmInvalid)
+    {
+        AvmRegexClassAdd(class, (byte)single);
+        return single;
+    }
+
+    if (e >= 'A' && e <= 'Z')
+    {
+        AvmRegexClassNegate(&set);
+    }
+
+    for (uint i = 0; i < 8; i++)
+    {
+        class->bits[i] |= set.bits[i];
+    }
+
+    return AvmInvalid;
+}
+
+// Parses a bracketed class after the opening bracket.
+static uint AvmRegexParseClass(AvmRegexCompiler* c)
+{
+    AvmRegexClass class = {{0}};
+    const bool negate = AvmRegexPeek(c) == '^';
+    bool first = true;
+
+    if (negate)
+    {
+        c->position++;
+    }
+
+    while (first || AvmRegexPeek(c) != ']')
+    {
+        if (AvmRegexAtEnd(c))
+        {
+            AvmRegexFail(c, RegexSyntaxError);
+        }
+
+        first = false;
+        uint low = (byte)c->pattern[c->position++];
+
+        if (low == '\\')
+        {
+            low = AvmRegexParseEscape(c, &class);
+
+            if (low == AvmInvalid)
+            {
+                continue;
+            }
+        }
+
+        if (AvmRegexPeek(c) != '-' || c->position + 1 >= c->length ||
+            c->pattern[c->position + 1] == ']')
+        {
+            AvmRegexClassAdd(&class, (byte)low);
+            continue;
+        }
+
+        c->position++;
+        uint high = (byte)c->pattern[c->position++];
+
+        if (high == '\\')
+        {
+            AvmRegexClass ignored = {{0}};
+            high = AvmRegexParseEscape(c, &ignored);
+        }
+
+        if (high == AvmInvalid || low > high)
+        {
+            AvmRegexFail(c, RegexSyntaxError);
+        }
+
+        AvmRegexClassAddRange(&class, (byte)low, (byte)high);
+    }
+
+    c->position++;
+
+    if (negate)
+    {
+        AvmRegexClassNegate(&class);
+    }
+
+    return AvmRegexNewClassNode(c, &class);
+}
+
+static uint AvmRegexParseAlternate(AvmRegexCompiler* c);
+
+static uint AvmRegexParseAtom(AvmRegexCompiler* c)
+{
+    const char value = c->pattern[c->position++];
+    AvmRegexClass class = {{0}};
+
+    switch (value)
+    {
+    case '(': {
+        uint index = AvmInvalid;
+
+        if (AvmRegexPeek(c) == '?')
+        {
+            if (c->position + 1 >= c->length ||
+                c->pattern[c->position + 1] != ':')
+            {
+                AvmRegexFail(c, RegexSyntaxError);
+            }
+
+            c->position += 2;
+        }
+        else
+        {
+            index = ++c->groupCount;
+        }
+
+        const uint child = AvmRegexParseAlternate(c);
+
+        if (AvmRegexPeek(c) != ')')
+        {
+            AvmRegexFail(c, RegexSyntaxError);
+        }
+
+        c->position++;
+
+        if (index == AvmInvalid)
+        {
+            return child;
+        }
+
+        const uint node = AvmRegexNewNode(c, NodeGroup, child, 0);
+        c->nodes[node].min = index;
+        return node;
+    }
+    case '[':
+        return AvmRegexParseClass(c);
+    case '.':
+        AvmRegexClassAdd(&class, '\n');
+        AvmRegexClassNegate(&class);
+        return AvmRegexNewClassNode(c, &class);
+    case '^':
+        return AvmRegexNewNode(c, NodeBegin, 0, 0);
+    case '$':
+        return AvmRegexNewNode(c, NodeEnd, 0, 0);
+    case '\\':
+        AvmRegexParseEscape(c, &class);
+        return AvmRegexNewClassNode(c, &class);
+    case '*':
+    case '+':
+    case '?':
+        AvmRegexFail(c, RegexSyntaxError);
+    default:
+        AvmRegexClassAdd(&class, (byte)value);
+        return AvmRegexNewClassNode(c, &class);
+    }
+}
+
+// Parses a decimal number, returns AvmInvalid if there is none.
+static uint AvmRegexParseNumber(AvmRegexCompiler* c)
+{
+    uint value = AvmInvalid;
+
+    while (AvmRegexPeek(c) >= '0' && AvmRegexPeek(c) <= '9')
+    {
+        const uint digit = (uint)(c->pattern[c->position++] - '0');
+        value = value == AvmInvalid ? digit : value * 10 + digit;
+
+        if (value > AVM_REGEX_MAX_REPEAT)
+        {
+            AvmRegexFail(c, RegexTooLargeError);
+        }
+    }
+
+    return value;
+}
+
+// Parses a {n}, {n,} or {n,m} quantifier. If what follows the brace is not a
+// valid quantifier, the brace is a literal and false is returned.
+static bool AvmRegexParseCount(AvmRegexCompiler* c, uint* min, uint* max)
+{
+    const uint start = c->position;
+    c->position++;
+
+    *min = AvmRegexParseNumber(c);
+    *max = *min;
+
+    if (*min != AvmInvalid && AvmRegexPeek(c) == ',')
+    {
+        c->position++;
+        *max = AvmRegexParseNumber(c);
+    }
+
+    if (*min == AvmInvalid || AvmRegexPeek(c) != '}')
+    {
+        c->position = start;
+        return false;
+    }
+
+    c->position++;
+
+    if (*max != AvmInvalid && *max < *min)
+    {
+        AvmRegexFail(c, RegexSyntaxError);
+    }
+
+    return true;
+}
+
+static uint AvmRegexParseRepeat(AvmRegexCompiler* c)
+{
+    uint node = AvmRegexParseAtom(c);
+
+    while (!AvmRegexAtEnd(c))
+    {
+        uint min = 0;
+        uint max = AvmInvalid;
+
+        switch (AvmRegexPeek(c))
+        {
+        case '*':
+            c->position++;
+            break;
+        case '+':
+            min = 1;
+            c->position++;
+            break;
+        case '?':
+            max = 1;
+            c->position++;
+            break;
+        case '{':
+            if (!AvmRegexParseCount(c, &min, &max))
+            {
+                return node;
+            }
+            break;
+        default:
+            return node;
+        }
+
+        const bool greedy = AvmRegexPeek(c) != '?';
+
+        if (!greedy)
+        {
+            c->position++;
+        }
+
+        node = AvmRegexNewNode(c, NodeRepeat, node, 0);
+        c->nodes[node].min = min;
+        c->nodes[node].max = max;
+        c->nodes[node].greedy = greedy;
+    }
+
+    return node;
+}
+
+static uint AvmRegexParseConcat(AvmRegexCompiler* c)
+{
+    uint node = AvmInvalid;
+
+    while (!AvmRegexAtEnd(c) && AvmRegexPeek(c) != '|' &&
+           AvmRegexPeek(c) != ')')
+    {
+        const uint next = AvmRegexParseRepeat(c);
+        node = node == AvmInvalid ? next
+                                  : AvmRegexNewNode(c, NodeConcat, node, next);
+    }
+
+    return node == AvmInvalid ? AvmRegexNewNode(c, NodeEmpty, 0, 0) : node;
+}
+
+static uint AvmRegexParseAlternate(AvmRegexCompiler* c)
+{
+    uint node = AvmRegexParseConcat(c);
+
+    while (AvmRegexPeek(c) == '|')
+    {
+        c->position++;
+        node = AvmRegexNewNode(
+            c, NodeAlternate, node, AvmRegexParseConcat(c));
+    }
+
+    return node;
+}
+
+//
+// Compilation.
+//
+
+static uint AvmRegexEmit(AvmRegexCompiler* c, AvmRegexOp op, uint x, uint y)
+{
+    if (c->instructionCount >= AVM_REGEX_MAX_PROGRAM)
+    {
+        AvmRegexFail(c, RegexTooLargeError);
+    }
+
+    c->instructions = AvmRegexGrow(c->instructions,
+                                   &c->instructionCapacity,
+                                   c->instructionCount,
+                                   sizeof(AvmRegexInst));
+
+    c->instructions[c->instructionCount].op = op;
+    c->instructions[c->instructionCount].x = x;
+    c->instructions[c->instructionCount].y = y;
+    return c->instructionCount++;
+}
+
+// Emits a split that prefers x if greedy, otherwise y.
+static uint AvmRegexEmitSplit(AvmRegexCompiler* c, bool greedy, uint x, uint y)
+{
+    return greedy ? AvmRegexEmit(c, OpSplit, x, y)
+                  : AvmRegexEmit(c, OpSplit, y, x);
+}
+
+// Sets the branch of a split that is not the loop body.
+static void AvmRegexPatchSplit(AvmRegexCompiler* c,
+                               uint split,
+                               bool greedy,
+                               uint target)
+{
+    if (greedy)
+    {
+        c->instructions[split].y = target;
+    }
+    else
+    {
+        c->instructions[split].x = target;
+    }
+}
+
+static void AvmRegexCompileNode(AvmRegexCompiler* c, uint index)
+{
+    const AvmRegexNode node = c->nodes[index];
+
+    switch (node.kind)
+    {
+    case NodeEmpty:
+        break;
+    case NodeClass:
+        AvmRegexEmit(c, OpClass, node.left, 0);
+        break;
+    case NodeBegin:
+        AvmRegexEmit(c, OpBegin, 0, 0);
+        break;
+    case NodeEnd:
+        AvmRegexEmit(c, OpEnd, 0, 0);
+        break;
+    case NodeConcat:
+        AvmRegexCompileNode(c, node.left);
+        AvmRegexCompileNode(c, node.right);
+        break;
+    case NodeAlternate: {
+        const uint split = AvmRegexEmit(c, OpSplit, c->instructionCount + 1, 0);
+        AvmRegexCompileNode(c, node.left);
+        const uint jump = AvmRegexEmit(c, OpJump, 0, 0);
+        c->instructions[split].y = c->instructionCount;
+        AvmRegexCompileNode(c, node.right);
+        c->instructions[jump].x = c->instructionCount;
+        break;
+    }
+    case NodeGroup:
+        AvmRegexEmit(c, OpSave, node.min * 2, 0);
+        AvmRegexCompileNode(c, node.left);
+        AvmRegexEmit(c, OpSave, node.min * 2 + 1, 0);
+        break;
+    case NodeRepeat: {
+        const bool unbounded = node.max == AvmInvalid;
+        const uint copies = unbounded && node.min > 0 ? node.min - 1 : node.min;
+
+        for (uint i = 0; i < copies; i++)
+        {
+            AvmRegexCompileNode(c, node.left);
+        }
+
+        if (unbounded && node.min > 0)
+        {
+            // x+ is x followed by a loop back to it.
+            const uint body = c->instructionCount;
+            AvmRegexCompileNode(c, node.left);
+            AvmRegexEmitSplit(
+                c, node.greedy, body, c->instructionCount + 1);
+        }
+        else if (unbounded)
+        {
+            const uint split = AvmRegexEmitSplit(
+                c, node.greedy, c->instructionCount + 1, 0);
+            AvmRegexCompileNode(c, node.left);
+            AvmRegexEmit(c, OpJump, split, 0);
+            AvmRegexPatchSplit(c, split, node.greedy, c->instructionCount);
+        }
+        else
+        {
+            // Every optional copy may skip to the end.
+            const uint first = c->instructionCount;
+
+            for (uint i = node.min; i < node.max; i++)
+            {
+                AvmRegexEmitSplit(c, node.greedy, c->instructionCount + 1, 0);
+                AvmRegexCompileNode(c, node.left);
+            }
+
+            for (uint pc = first; pc < c->instructionCount; pc++)
+            {
+                const AvmRegexInst* inst = &c->instructions[pc];
+
+                // Only the splits emitted above have an unset branch.
+                if (inst->op == OpSplit &&
+                    (node.greedy ? inst->y : inst->x) == 0)
+                {
+                    AvmRegexPatchSplit(
+                        c, pc, node.greedy, c->instructionCount);
+                }
+            }
+        }
+        break;
+    }
+    }
+}
+
+// Appends the literal bytes a node starts with to the prefix. Returns true if
+// the whole node is literal, so that what follows may extend the prefix.
+static bool AvmRegexAppendPrefix(const AvmRegexCompiler* c,
+                                 uint index,
+                                 char* prefix,
+                                 uint* length)
+{
+    const AvmRegexNode* node = &c->nodes[index];
+
+    switch (node->kind)
+    {
+    case NodeEmpty:
+        return true;
+    case NodeClass: {
+        const uint single = AvmRegexClassGetSingle(&c->classes[node->left]);
+
+        if (single == AvmInvalid)
+        {
+            return false;
+        }
+
+        prefix[(*length)++] = (char)single;
+        return true;
+    }
+    case NodeConcat:
+        return AvmRegexAppendPrefix(c, node->left, prefix, length) &&
+               AvmRegexAppendPrefix(c, node->right, prefix, length);
+    case NodeGroup:
+        return AvmRegexAppendPrefix(c, node->left, prefix, length);
+    default:
+        return false;
+    }
+}
+
+static bool AvmRegexIsAnchored(const AvmRegexCompiler* c, uint index)
+{
+    const AvmRegexNode* node = &c->nodes[index];
+
+    switch (node->kind)
+    {
+    case NodeBegin:
+        return true;
+    case NodeConcat:
+    case NodeGroup:
+        return AvmRegexIsAnchored(c, node->left);
+    default:
+        return false;
+    }
+}
+
+static void AvmRegexComputeByteClasses(AvmRegexProgram* p)
+{
+    bool boundary[256] = {false};
+
+    for (uint i = 0; i < p->classCount; i++)
+    {
+        for (uint b = 1; b < 256; b++)
+        {
+            if (AvmRegexClassTest(&p->classes[i], (byte)b) !=
+                AvmRegexClassTest(&p->classes[i], (byte)(b - 1)))
+            {
+                boundary[b] = true;
+            }
+        }
+    }
+
+    uint current = 0;
+    p->representatives[0] = 0;
+
+    for (uint b = 0; b < 256; b++)
+    {
+        if (boundary[b])
+        {
+            current++;
+            p->representatives[current] = (byte)b;
+        }
+
+        p->byteClasses[b] = (byte)current;
+    }
+
+    p->byteClassCount = current + 1;
+}
+
+static void AvmRegexThreadListInit(AvmRegexThreadList* self,
+                                   uint count,
+                                   uint slotCount)
+{
+    self->count = 0;
+    self->dense = AvmAlloc(count * sizeof(uint));
+    self->sparse = AvmAlloc(count * sizeof(uint));
+    self->slots = AvmAlloc(count * slotCount * sizeof(uint));
+}
+
+static void AvmRegexThreadListFree(AvmRegexThreadList* self)
+{
+    AvmDealloc(self->dense);
+    AvmDealloc(self->sparse);
+    AvmDealloc(self->slots);
+}
+
+static bool AvmRegexThreadListContains(const AvmRegexThreadList* self,
+                                       uint pc)
+{
+    const uint index = self->sparse[pc];
+    return index < self->count && self->dense[index] == pc;
+}
+
+static void AvmRegexThreadListInsert(AvmRegexThreadList* self, uint pc)
+{
+    self->sparse[pc] = self->count;
+    self->dense[self->count++] = pc;
+}
+
+static void AvmRegexDestroy(AvmRegex* self);
+
+AVM_TYPE(AvmRegex, object, {[FnEntryDtor] = (AvmFunction)AvmRegexDestroy});
+
+AvmRegex AvmRegexNew(str pattern)
+{
+    pre
+    {
+        assert(pattern != NULL);
+    }
+
+    AvmRegexCompiler c = {
+        .pattern = pattern,
+        .length = (uint)strlen(pattern),
+    };
+
+    const uint root = AvmRegexParseAlternate(&c);
+
+    if (!AvmRegexAtEnd(&c))
+    {
+        // Only an unbalanced parenthesis stops the parser early.
+        AvmRegexFail(&c, RegexSyntaxError);
+    }
+
+    AvmRegexEmit(&c, OpSave, 0, 0);
+    AvmRegexCompileNode(&c, root);
+    AvmRegexEmit(&c, OpSave, 1, 0);
+    AvmRegexEmit(&c, OpMatch, 0, 0);
+
+    AvmRegexProgram* p = AvmAlloc(sizeof(AvmRegexProgram));
+    memset(p, 0, sizeof(AvmRegexProgram));
+
+    p->instructions = c.instructions;
+    p->instructionCount = c.instructionCount;
+    p->classes = c.classes;
+    p->classCount = c.classCount;
+    p->slotCount = (c.groupCount + 1) * 2;
+    p->anchored = AvmRegexIsAnchored(&c, root);
+
+    if (!p->anchored)
+    {
+        // A prefix can not be longer than the pattern.
+        p->prefix = AvmAlloc(c.length + 1);
+        AvmRegexAppendPrefix(&c, root, p->prefix, &p->prefixLength);
+    }
+
+    AvmRegexComputeByteClasses(p);
+
+    const uint n = p->instructionCount;
+    AvmRegexThreadListInit(&p->lists[0], n, p->slotCount);
+    AvmRegexThreadListInit(&p->lists[1], n, p->slotCount);
+    p->stack = AvmAlloc((n + 1) * sizeof(AvmRegexStackEntry));
+    p->slots = AvmAlloc(p->slotCount * sizeof(uint));
+    p->matchSlots = AvmAlloc(p->slotCount * sizeof(uint));
+    p->pcStack = AvmAlloc((n + 1) * sizeof(uint));
+    p->pcs = AvmAlloc(n * sizeof(uint));
+
+    AvmDealloc(c.nodes);
+
+    AvmRegex regex = {
+        ._type = typeid(AvmRegex),
+        ._groupCount = c.groupCount,
+        ._program = p,
+    };
+
+    return regex;
+}
+
+static void AvmRegexDestroy(AvmRegex* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmRegexProgram* p = self->_program;
+
+    if (p->dfa != NULL)
+    {
+        AvmDealloc(p->dfa->states);
+        AvmDealloc(p->dfa->pcs);
+        AvmDealloc(p->dfa->transitions);
+        AvmDealloc(p->dfa->table);
+        AvmDealloc(p->dfa);
+    }
+
+    AvmRegexThreadListFree(&p->lists[0]);
+    AvmRegexThreadListFree(&p->lists[1]);
+    AvmDealloc(p->stack);
+    AvmDealloc(p->slots);
+    AvmDealloc(p->matchSlots);
+    AvmDealloc(p->pcStack);
+    AvmDealloc(p->pcs);
+    AvmDealloc(p->prefix);
+    AvmDealloc(p->classes);
+    AvmDealloc(p->instructions);
+    AvmDealloc(p);
+}
+
+uint AvmRegexGetGroupCount(const AvmRegex* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_groupCount;
+}
+
+//
+// Pike VM.
+//
+// Runs all threads of the NFA in lock step, so every instruction is visited at
+// most once per input byte. Threads are kept in priority order, which gives
+// the same results as a backtracking engine.
+//
+
+// Adds a thread and all threads reachable from it without consuming input.
+// The slots are restored before returning.
+static void AvmRegexAddThread(AvmRegexProgram* p,
+                              AvmRegexThreadList* list,
+                              uint pc,
+                              uint position,
+                              uint length)
+{
+    uint* const slots = p->slots;
+    AvmRegexStackEntry* const stack = p->stack;
+    uint top = 0;
+
+    stack[top++] = (AvmRegexStackEntry){pc, AvmInvalid, 0};
+
+    while (top != 0)
+    {
+        const AvmRegexStackEntry entry = stack[--top];
+
+        if (entry.slot != AvmInvalid)
+        {
+            slots[entry.slot] = entry.value;
+            continue;
+        }
+
+        pc = entry.pc;
+
+        while (!AvmRegexThreadListContains(list, pc))
+        {
+            AvmRegexThreadListInsert(list, pc);
+            const AvmRegexInst* inst = &p->instructions[pc];
+
+            if (inst->op == OpJump)
+            {
+                pc = inst->x;
+            }
+            else if (inst->op == OpSplit)
+            {
+                stack[top++] = (AvmRegexStackEntry){inst->y, AvmInvalid, 0};
+                pc = inst->x;
+            }
+            else if (inst->op == OpSave)
+            {
+                stack[top++] =
+                    (AvmRegexStackEntry){0, inst->x, slots[inst->x]};
+                slots[inst->x] = position;
+                pc++;
+            }
+            else if ((inst->op == OpBegin && position == 0) ||
+                     (inst->op == OpEnd && position == length))
+            {
+                pc++;
+            }
+            else
+            {
+                if (inst->op == OpClass || inst->op == OpMatch)
+                {
+                    memcpy(list->slots + pc * p->slotCount,
+                           slots,
+                           p->slotCount * sizeof(uint));
+                }
+
+                break;
+            }
+        }
+    }
+}
+
+// Runs the Pike VM from a position. On success the slots of the match are
+// left in matchSlots.
+static bool AvmRegexExecute(AvmRegexProgram* p,
+                            const AvmString* string,
+                            uint start)
+{
+    const byte* const text = (const byte*)string->_buffer;
+    const uint length = string->_length;
+    AvmRegexThreadList* current = &p->lists[0];
+    AvmRegexThreadList* next = &p->lists[1];
+    bool matched = false;
+
+    current->count = 0;
+
+    for (uint position = start;; position++)
+    {
+        if (!matched && (!p->anchored || position == 0))
+        {
+            // With no thread alive, skip to where the literal prefix occurs.
+            if (current->count == 0 && p->prefixLength != 0)
+            {
+                position = AvmStringFindChars(
+                    string, position, p->prefixLength, p->prefix);
+
+                if (position == AvmInvalid)
+                {
+                    break;
+                }
+            }
+
+            for (uint i = 0; i < p->slotCount; i++)
+            {
+                p->slots[i] = AvmInvalid;
+            }
+
+            AvmRegexAddThread(p, current, 0, position, length);
+        }
+
+        if (current->count == 0)
+        {
+            break;
+        }
+
+        next->count = 0;
+
+        for (uint i = 0; i < current->count; i++)
+        {
+            const uint pc = current->dense[i];
+            const AvmRegexInst* inst = &p->instructions[pc];
+            const uint* slots = current->slots + pc * p->slotCount;
+
+            if (inst->op == OpMatch)
+            {
+                // Threads after this one have lower priority.
+                memcpy(p->matchSlots, slots, p->slotCount * sizeof(uint));
+                matched = true;
+                break;
+            }
+
+            if (inst->op == OpClass && position < length &&
+                AvmRegexClassTest(&p->classes[inst->x], text[position]))
+            {
+                memcpy(p->slots, slots, p->slotCount * sizeof(uint));
+                AvmRegexAddThread(p, next, pc + 1, position + 1, length);
+            }
+        }
+
+        AvmRegexThreadList* temp = current;
+        current = next;
+        next = temp;
+
+        if (position >= length)
+        {
+            break;
+        }
+    }
+
+    return matched;
+}
+
+//
+// Lazy DFA.
+//
+// A DFA state is the set of NFA instructions the Pike VM would have threads
+// on, without the priorities and captures. States and transitions are built
+// the first time they are needed, so this answers whether there is a match in
+// one table lookup per byte.
+//
+
+// Adds the instructions reachable without consuming input to a set.
+static void AvmRegexDfaClosure(AvmRegexProgram* p,
+                               AvmRegexThreadList* set,
+                               uint pc,
+                               bool atStart,
+                               bool atEnd)
+{
+    uint* const stack = p->pcStack;
+    uint top = 0;
+
+    stack[top++] = pc;
+
+    while (top != 0)
+    {
+        pc = stack[--top];
+
+        while (!AvmRegexThreadListContains(set, pc))
+        {
+            AvmRegexThreadListInsert(set, pc);
+            const AvmRegexInst* inst = &p->instructions[pc];
+
+            if (inst->op == OpJump)
+            {
+                pc = inst->x;
+            }
+            else if (inst->op == OpSplit)
+            {
+                stack[top++] = inst->y;
+                pc = inst->x;
+            }
+            else if (inst->op == OpSave || (inst->op == OpBegin && atStart) ||
+                     (inst->op == OpEnd && atEnd))
+            {
+                pc++;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+}
+
+static int AvmRegexComparePcs(const void* a, const void* b)
+{
+    const uint x = *(const uint*)a;
+    const uint y = *(const uint*)b;
+    return (x > y) - (x < y);
+}
+
+static void AvmRegexDfaFlush(AvmRegexDfa* dfa)
+{
+    dfa->generation++;
+    dfa->stateCount = 0;
+    dfa->pcCount = 0;
+    dfa->startStates[0] = AvmInvalid;
+    dfa->startStates[1] = AvmInvalid;
+
+    for (uint i = 0; i < dfa->tableCapacity; i++)
+    {
+        dfa->table[i] = AvmInvalid;
+    }
+}
+
+static AvmRegexDfa* AvmRegexDfaNew(const AvmRegexProgram* p)
+{
+    AvmRegexDfa* dfa = AvmAlloc(sizeof(AvmRegexDfa));
+    dfa->generation = 0;
+    dfa->stateCapacity = 16;
+    dfa->states = AvmAlloc(dfa->stateCapacity * sizeof(AvmRegexDfaState));
+    dfa->transitions =
+        AvmAlloc(dfa->stateCapacity * p->byteClassCount * sizeof(uint));
+    dfa->pcCapacity = 256;
+    dfa->pcs = AvmAlloc(dfa->pcCapacity * sizeof(uint));
+    dfa->tableCapacity = AVM_REGEX_MAX_DFA_STATES * 2;
+    dfa->table = AvmAlloc(dfa->tableCapacity * sizeof(uint));
+    AvmRegexDfaFlush(dfa);
+    return dfa;
+}
+
+// Turns the set into a state, reusing an existing one if possible.
+static uint AvmRegexDfaIntern(AvmRegexProgram* p, AvmRegexThreadList* set)
+{
+    AvmRegexDfa* dfa = p->dfa;
+    uint* const pcs = p->pcs;
+
+    // Only instructions that consume input or end the match are relevant.
+    uint count = 0;
+    bool match = false;
+
+    for (uint i = 0; i < set->count; i++)
+    {
+        const AvmRegexOp op = p->instructions[set->dense[i]].op;
+
+        if (op == OpClass || op == OpEnd)
+        {
+            pcs[count++] = set->dense[i];
+        }
+        else if (op == OpMatch)
+        {
+            match = true;
+        }
+    }
+
+    // A matching state is final, so its instructions do not matter.
+    if (match)
+    {
+        count = 0;
+    }
+
+    qsort(pcs, count, sizeof(uint), AvmRegexComparePcs);
+
+    const ulong hash = AvmHashBytesSeeded(count * sizeof(uint), pcs, match);
+    const uint mask = dfa->tableCapacity - 1;
+
+    for (uint i = (uint)hash & mask;; i = (i + 1) & mask)
+    {
+        const uint index = dfa->table[i];
+
+        if (index == AvmInvalid)
+        {
+            break;
+        }
+
+        const AvmRegexDfaState* state = &dfa->states[index];
+
+        if (state->match == match && state->count == count &&
+            memcmp(dfa->pcs + state->start, pcs, count * sizeof(uint)) == 0)
+        {
+            return index;
+        }
+    }
+
+    if (dfa->stateCount == AVM_REGEX_MAX_DFA_STATES)
+    {
+        AvmRegexDfaFlush(dfa);
+    }
+
+    if (dfa->stateCount == dfa->stateCapacity)
+    {
+        dfa->stateCapacity *= 2;
+        dfa->states = AvmRealloc(dfa->states,
+                                 dfa->stateCapacity * sizeof(AvmRegexDfaState));
+        dfa->transitions =
+            AvmRealloc(dfa->transitions,
+                       dfa->stateCapacity * p->byteClassCount * sizeof(uint));
+    }
+
+    while (dfa->pcCount + count > dfa->pcCapacity)
+    {
+        dfa->pcCapacity *= 2;
+        dfa->pcs = AvmRealloc(dfa->pcs, dfa->pcCapacity * sizeof(uint));
+    }
+
+    const uint index = dfa->stateCount++;
+    AvmRegexDfaState* state = &dfa->states[index];
+    state->start = dfa->pcCount;
+    state->count = count;
+    state->match = match;
+
+    memcpy(dfa->pcs + dfa->pcCount, pcs, count * sizeof(uint));
+    dfa->pcCount += count;
+
+    for (uint i = 0; i < p->byteClassCount; i++)
+    {
+        dfa->transitions[index * p->byteClassCount + i] = AvmInvalid;
+    }
+
+    uint slot = (uint)hash & mask;
+    while (dfa->table[slot] != AvmInvalid)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    dfa->table[slot] = index;
+    return index;
+}
+
+static uint AvmRegexDfaStart(AvmRegexProgram* p, bool atStart)
+{
+    AvmRegexDfa* dfa = p->dfa;
+
+    if (dfa->startStates[atStart] == AvmInvalid)
+    {
+        AvmRegexThreadList* set = &p->lists[0];
+        set->count = 0;
+        AvmRegexDfaClosure(p, set, 0, atStart, false);
+        const uint state = AvmRegexDfaIntern(p, set);
+
+        // Interning may have flushed the cache.
+        dfa->startStates[atStart] = state;
+    }
+
+    return dfa->startStates[atStart];
+}
+
+static uint AvmRegexDfaNext(AvmRegexProgram* p, uint state, uint byteClass)
+{
+    AvmRegexDfa* dfa = p->dfa;
+    const uint cached = dfa->transitions[state * p->byteClassCount + byteClass];
+
+    if (cached != AvmInvalid)
+    {
+        return cached;
+    }
+
+    const byte value = p->representatives[byteClass];
+    AvmRegexThreadList* set = &p->lists[0];
+    set->count = 0;
+
+    const AvmRegexDfaState* s = &dfa->states[state];
+
+    for (uint i = 0; i < s->count; i++)
+    {
+        const uint pc = dfa->pcs[s->start + i];
+        const AvmRegexInst* inst = &p->instructions[pc];
+
+        if (inst->op == OpClass &&
+            AvmRegexClassTest(&p->classes[inst->x], value))
+        {
+            AvmRegexDfaClosure(p, set, pc + 1, false, false);
+        }
+    }
+
+    // Unanchored searches may start a match at every position.
+    if (!p->anchored)
+    {
+        AvmRegexDfaClosure(p, set, 0, false, false);
+    }
+
+    const uint generation = dfa->generation;
+    const uint next = AvmRegexDfaIntern(p, set);
+
+    // If the cache was flushed the current state no longer exists.
+    if (dfa->generation == generation)
+    {
+        dfa->transitions[state * p->byteClassCount + byteClass] = next;
+    }
+
+    return next;
+}
+
+// Determines whether a state matches once the end of the input is reached.
+static bool AvmRegexDfaMatchesAtEnd(AvmRegexProgram* p,
+                                    uint state,
+                                    bool atStart)
+{
+    const AvmRegexDfa* dfa = p->dfa;
+    const AvmRegexDfaState* s = &dfa->states[state];
+    AvmRegexThreadList* set = &p->lists[1];
+    set->count = 0;
+
+    if (s->match)
+    {
+        return true;
+    }
+
+    for (uint i = 0; i < s->count; i++)
+    {
+        const uint pc = dfa->pcs[s->start + i];
+
+        if (p->instructions[pc].op == OpEnd)
+        {
+            AvmRegexDfaClosure(p, set, pc, atStart, true);
+        }
+    }
+
+    for (uint i = 0; i < set->count; i++)
+    {
+        if (p->instructions[set->dense[i]].op == OpMatch)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool AvmRegexDfaIsMatch(AvmRegexProgram* p,
+                               const AvmString* string,
+                               uint start)
+{
+    const byte* const text = (const byte*)string->_buffer;
+    const uint length = string->_length;
+
+    if (p->prefixLength != 0)
+    {
+        start = AvmStringFindChars(string, start, p->prefixLength, p->prefix);
+
+        if (start == AvmInvalid)
+        {
+            return false;
+        }
+    }
+
+    if (p->dfa == NULL)
+    {
+        p->dfa = AvmRegexDfaNew(p);
+    }
+
+    uint state = AvmRegexDfaStart(p, start == 0);
+
+    for (uint i = start; i < length; i++)
+    {
+        if (p->dfa->states[state].match)
+        {
+            return true;
+        }
+
+        // An anchored search fails once no thread is left.
+        if (p->anchored && p->dfa->states[state].count == 0)
+        {
+            return false;
+        }
+
+        state = AvmRegexDfaNext(p, state, p->byteClasses[text[i]]);
+    }
+
+    return AvmRegexDfaMatchesAtEnd(p, state, start == length && start == 0);
+}
+
+//
+// Matching.
+//
+
+bool AvmRegexIsMatch(AvmRegex* self, const AvmString* string)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(string != NULL);
+    }
+
+    return AvmRegexDfaIsMatch(self->_program, string, 0);
+}
+
+bool AvmRegexFindGroups(AvmRegex* self,
+                        const AvmString* string,
+                        uint start,
+                        uint count,
+                        AvmRegexMatch groups[])
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(string != NULL);
+        assert(groups != NULL || count == 0);
+    }
+
+    AvmRegexProgram* p = self->_program;
+
+    if (start > string->_length || !AvmRegexDfaIsMatch(p, string, start) ||
+        !AvmRegexExecute(p, string, start))
+    {
+        return false;
+    }
+
+    for (uint i = 0; i < count; i++)
+    {
+        groups[i]._type = typeid(AvmRegexMatch);
+        groups[i]._start = AvmInvalid;
+        groups[i]._length = 0;
+
+        if (i * 2 < p->slotCount && p->matchSlots[i * 2] != AvmInvalid &&
+            p->matchSlots[i * 2 + 1] != AvmInvalid)
+        {
+            groups[i]._start = p->matchSlots[i * 2];
+            groups[i]._length = p->matchSlots[i * 2 + 1] - groups[i]._start;
+        }
+    }
+
+    return true;
+}
+
+bool AvmRegexFind(AvmRegex* self,
+                  const AvmString* string,
+                  uint start,
+                  AvmRegexMatch* match)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(string != NULL);
+        assert(match != NULL);
+    }
+
+    return AvmRegexFindGroups(self, string, start, 1, match);
+}
+
+uint AvmRegexMatchGetStart(const AvmRegexMatch* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_start;
+}
+
+uint AvmRegexMatchGetLength(const AvmRegexMatch* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_length;
+}
+
+AvmRegexIterator AvmRegexIteratorNew(AvmRegex* regex, const AvmString* string)
+{
+    pre
+    {
+        assert(regex != NULL);
+        assert(string != NULL);
+    }
+
+    AvmRegexIterator iterator = {
+        ._type = typeid(AvmRegexIterator),
+        ._regex = regex,
+        ._string = string,
+        ._position = 0,
+        ._previousEnd = AvmInvalid,
+    };
+
+    return iterator;
+}
+
+// Finds the next match and fills all group spans.
+static bool AvmRegexIteratorNextGroups(AvmRegexIterator* self,
+                                       uint count,
+                                       AvmRegexMatch groups[])
+{
+    while (self->_position <= self->_string->_length)
+    {
+        if (!AvmRegexFindGroups(
+                self->_regex, self->_string, self->_position, count, groups))
+        {
+            self->_position = self->_string->_length + 1;
+            return false;
+        }
+
+        const uint start = groups[0]._start;
+        const uint end = start + groups[0]._length;
+        const bool accept =
+            groups[0]._length != 0 || start != self->_previousEnd;
+
+        // Advance past empty matches so the iteration makes progress.
+        self->_position = groups[0]._length == 0 ? end + 1 : end;
+        self->_previousEnd = end;
+
+        if (accept)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool AvmRegexIteratorNext(AvmRegexIterator* self, AvmRegexMatch* match)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(match != NULL);
+    }
+
+    return AvmRegexIteratorNextGroups(self, 1, match);
+}
+
+// Appends the replacement template for a match.
+static void AvmRegexExpand(AvmString* destination,
+                           const AvmString* string,
+                           str replacement,
+                           uint count,
+                           const AvmRegexMatch groups[])
+{
+    for (str c = replacement; *c != '\0'; c++)
+    {
+        if (*c != '$' || (c[1] != '$' && (c[1] < '0' || c[1] > '9')))
+        {
+            AvmStringPushChar(destination, *c);
+            continue;
+        }
+
+        c++;
+
+        if (*c == '$')
+        {
+            AvmStringPushChar(destination, '$');
+            continue;
+        }
+
+        const uint group = (uint)(*c - '0');
+
+        if (group < count && groups[group]._start != AvmInvalid)
+        {
+            AvmStringPushChars(destination,
+                               groups[group]._length,
+                               string->_buffer + groups[group]._start);
+        }
+    }
+}
+
+uint AvmRegexReplace(AvmRegex* self,
+                     const AvmString* string,
+                     str replacement,
+                     AvmString* destination)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(string != NULL);
+        assert(replacement != NULL);
+        assert(destination != NULL);
+    }
+
+    AvmRegexMatch groups[10];
+    const uint count = self->_groupCount + 1 < 10 ? self->_groupCount + 1 : 10;
+    AvmRegexIterator iterator = AvmRegexIteratorNew(self, string);
+    uint copied = 0;
+    uint replaced = 0;
+
+    while (AvmRegexIteratorNextGroups(&iterator, count, groups))
+    {
+        AvmStringPushChars(
+            destination, groups[0]._start - copied, string->_buffer + copied);
+        AvmRegexExpand(destination, string, replacement, count, groups);
+        copied = groups[0]._start + groups[0]._length;
+        replaced++;
+    }
+
+    AvmStringPushChars(
+        destination, string->_length - copied, string->_buffer + copied);
+    return replaced;
+}
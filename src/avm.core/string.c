@@ -1,6 +1,5 @@
 #include "avium/string.h"
 
-#include <ctype.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -8,8 +7,10 @@
 
 #include "avium/core.h"
 #include "avium/error.h"
+#include "avium/hash.h"
 #include "avium/private/errors.h"
 #include "avium/private/resources.h"
+#include "avium/private/simd.h"
 #include "avium/testing.h"
 #include "avium/typeinfo.h"
 
@@ -33,6 +34,42 @@ static bool AvmStringEquals(AvmString* self, AvmString* other)
     return memcmp(self->_buffer, other->_buffer, self->_length) == 0;
 }
 
+static ulong AvmStringHash(AvmString* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    // Must agree with AvmStringEquals, so only the contents are hashed.
+    return AvmHashBytes(self->_length, self->_buffer);
+}
+
+// Strings are ordered by their bytes, and a prefix orders before the string.
+static int AvmStringCompare(AvmString* self, AvmString* other)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(other != NULL);
+    }
+
+    const uint length =
+        self->_length < other->_length ? self->_length : other->_length;
+
+    if (length != 0)
+    {
+        const int result = memcmp(self->_buffer, other->_buffer, length);
+
+        if (result != 0)
+        {
+            return result;
+        }
+    }
+
+    return (self->_length > other->_length) - (self->_length < other->_length);
+}
+
 static AvmString AvmStringToString(AvmString* self)
 {
     pre
@@ -57,7 +94,10 @@ static object AvmStringClone(AvmString* self)
         assert(self != NULL);
     }
 
-    AvmString s = AvmStringFrom(self->_buffer);
+    // The buffer is not null terminated, and is NULL when the string is empty.
+    AvmString s = self->_length == 0
+                      ? AvmStringNew(0)
+                      : AvmStringFromChars(self->_length, self->_buffer);
     AvmString* ret = AvmAlloc(sizeof(AvmString));
     AvmCopy(&s, sizeof(AvmString), (byte*)ret);
     return ret;
@@ -82,6 +122,8 @@ AVM_TYPE(AvmString,
              [FnEntryGetLength] = (AvmFunction)AvmStringGetLength,
              [FnEntryGetCapacity] = (AvmFunction)AvmStringGetCapacity,
              [FnEntryEquals] = (AvmFunction)AvmStringEquals,
+             [FnEntryHash] = (AvmFunction)AvmStringHash,
+             [FnEntryCompare] = (AvmFunction)AvmStringCompare,
          });
 
 void AvmStringEnsureCapacity(AvmString* self, uint capacity)
@@ -733,6 +775,144 @@ uint AvmStringLastIndexOf(const AvmString* self, char character)
 
 // TODO: Implement Find for AvmString and Chars.
 
+static inline char AvmAsciiToLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c | 0x20) : c;
+}
+
+#ifdef AVM_HAVE_SSE2
+// Returns a mask of the bytes that are in the range [low, high]. Bytes above
+// 0x7F are negative and therefore never in range.
+static inline __m128i AvmSimdInRange(__m128i v, char low, char high)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8((char)(low - 1))),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8((char)(high + 1))));
+}
+
+static inline __m128i AvmSimdToLower(__m128i v)
+{
+    const __m128i mask = AvmSimdInRange(v, 'A', 'Z');
+    return _mm_or_si128(v, _mm_and_si128(mask, _mm_set1_epi8(0x20)));
+}
+#endif
+
+static bool AvmAsciiEqualsIgnoreCase(str a, str b, uint length)
+{
+    uint i = 0;
+
+#ifdef AVM_HAVE_SSE2
+    for (; i + 16 <= length; i += 16)
+    {
+        const __m128i x = AvmSimdToLower(_mm_loadu_si128((__m128i*)(a + i)));
+        const __m128i y = AvmSimdToLower(_mm_loadu_si128((__m128i*)(b + i)));
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xFFFF)
+        {
+            return false;
+        }
+    }
+#endif
+
+    for (; i < length; i++)
+    {
+        if (AvmAsciiToLower(a[i]) != AvmAsciiToLower(b[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Compares two runs of characters, ignoring the case of ASCII letters if
+// ignoreCase is true.
+static inline bool AvmAsciiEquals(str a, str b, uint length, bool ignoreCase)
+{
+    return ignoreCase ? AvmAsciiEqualsIgnoreCase(a, b, length)
+                      : memcmp(a, b, length) == 0;
+}
+
+// Returns the index of the first occurrence of pattern in text, or
+// AvmInvalid, ignoring the case of ASCII letters if ignoreCase is true.
+static uint AvmAsciiFind(str text,
+                         uint length,
+                         str pattern,
+                         uint patternLength,
+                         bool ignoreCase)
+{
+    if (patternLength == 0)
+    {
+        return 0;
+    }
+
+    if (patternLength > length)
+    {
+        return AvmInvalid;
+    }
+
+    // The last index where a match may start.
+    const uint last = length - patternLength;
+    char first = pattern[0];
+    char final = pattern[patternLength - 1];
+    uint i = 0;
+
+    if (ignoreCase)
+    {
+        first = AvmAsciiToLower(first);
+        final = AvmAsciiToLower(final);
+    }
+
+#ifdef AVM_HAVE_SSE2
+    // Filter candidates by comparing the first and last pattern characters
+    // for 16 positions at once, then verify each candidate.
+    const __m128i vfirst = _mm_set1_epi8(first);
+    const __m128i vfinal = _mm_set1_epi8(final);
+
+    for (; i + 16 <= last + 1; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((__m128i*)(text + i));
+        __m128i b = _mm_loadu_si128((__m128i*)(text + i + patternLength - 1));
+
+        if (ignoreCase)
+        {
+            a = AvmSimdToLower(a);
+            b = AvmSimdToLower(b);
+        }
+
+        uint mask = (uint)_mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(a, vfirst), _mm_cmpeq_epi8(b, vfinal)));
+
+        while (mask != 0)
+        {
+            const uint index = i + AvmBitScanForward(mask);
+
+            if (AvmAsciiEquals(text + index + 1,
+                               pattern + 1,
+                               patternLength - 1,
+                               ignoreCase))
+            {
+                return index;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i <= last; i++)
+    {
+        const char c = ignoreCase ? AvmAsciiToLower(text[i]) : text[i];
+
+        if (c == first &&
+            AvmAsciiEquals(text + i, pattern, patternLength, ignoreCase))
+        {
+            return i;
+        }
+    }
+
+    return AvmInvalid;
+}
+
 uint AvmStringFind(const AvmString* self, str substring)
 {
     pre
@@ -741,14 +921,33 @@ uint AvmStringFind(const AvmString* self, str substring)
         assert(substring != NULL);
     }
 
-    char* c = strstr(self->_buffer, substring);
+    return AvmAsciiFind(
+        self->_buffer, self->_length, substring, strlen(substring), false);
+}
 
-    if (c == NULL)
+uint AvmStringFindChars(const AvmString* self,
+                        uint start,
+                        uint length,
+                        str substring)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(substring != NULL || length == 0);
+    }
+
+    if (start > self->_length)
     {
         return AvmInvalid;
     }
 
-    return (uint)(c - self->_buffer);
+    const uint index = AvmAsciiFind(self->_buffer + start,
+                                    self->_length - start,
+                                    substring,
+                                    length,
+                                    false);
+
+    return index == AvmInvalid ? AvmInvalid : start + index;
 }
 
 uint AvmStringFindLast(const AvmString* self, str substring)
@@ -918,14 +1117,137 @@ void AvmStringReverse(const AvmString* self)
     }
 }
 
+//
+// ASCII case conversion.
+//
+
+// Flips the case bit of all bytes in the range [low, high].
+static void AvmAsciiFlipCase(char* buffer, uint length, char low, char high)
+{
+    uint i = 0;
+
+#ifdef AVM_HAVE_SSE2
+    const __m128i bit = _mm_set1_epi8(0x20);
+
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i* const p = (__m128i*)(buffer + i);
+        const __m128i v = _mm_loadu_si128(p);
+        const __m128i mask = AvmSimdInRange(v, low, high);
+        _mm_storeu_si128(p, _mm_xor_si128(v, _mm_and_si128(mask, bit)));
+    }
+#endif
+
+    for (; i < length; i++)
+    {
+        if (buffer[i] >= low && buffer[i] <= high)
+        {
+            buffer[i] ^= 0x20;
+        }
+    }
+}
+
 void AvmStringToUpper(const AvmString* self)
 {
-    AvmStringMapCompat(self, toupper);
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmAsciiFlipCase(self->_buffer, self->_length, 'a', 'z');
 }
 
 void AvmStringToLower(const AvmString* self)
 {
-    AvmStringMapCompat(self, tolower);
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    AvmAsciiFlipCase(self->_buffer, self->_length, 'A', 'Z');
+}
+
+bool AvmStringEqualsIgnoreCase(const AvmString* self, const AvmString* other)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(other != NULL);
+    }
+
+    return AvmStringEqualsCharsIgnoreCase(
+        self, other->_length, other->_buffer);
+}
+
+bool AvmStringEqualsCharsIgnoreCase(const AvmString* self,
+                                    uint length,
+                                    str contents)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(contents != NULL || length == 0);
+    }
+
+    if (self->_length != length)
+    {
+        return false;
+    }
+
+    return AvmAsciiEqualsIgnoreCase(self->_buffer, contents, length);
+}
+
+bool AvmStringEqualsStrIgnoreCase(const AvmString* self, str contents)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(contents != NULL);
+    }
+
+    return AvmStringEqualsCharsIgnoreCase(self, strlen(contents), contents);
+}
+
+bool AvmStringStartsWithCharsIgnoreCase(const AvmString* self,
+                                        uint length,
+                                        str contents)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(contents != NULL || length == 0);
+    }
+
+    if (self->_length < length)
+    {
+        return false;
+    }
+
+    return AvmAsciiEqualsIgnoreCase(self->_buffer, contents, length);
+}
+
+bool AvmStringStartsWithStrIgnoreCase(const AvmString* self, str contents)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(contents != NULL);
+    }
+
+    return AvmStringStartsWithCharsIgnoreCase(
+        self, strlen(contents), contents);
+}
+
+uint AvmStringFindIgnoreCase(const AvmString* self, str substring)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(substring != NULL);
+    }
+
+    return AvmAsciiFind(
+        self->_buffer, self->_length, substring, strlen(substring), true);
 }
 
 void AvmStringClear(AvmString* self)
@@ -8,6 +8,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef AVM_MSVC
+#include <intrin.h>
+#endif
+
 object __AvmRuntimeCastFail(object value, const AvmType* type)
 {
     AvmErrorf("Tried to cast object [%x] of type %T to type %s.\n",
@@ -44,7 +48,8 @@ AvmFunction AvmTypeGetFunction(const AvmType* self, uint index)
         assert(self != NULL);
     }
 
-    if (index < self->_vSize)
+    // _vSize is the size of the VFT in bytes.
+    if (index < self->_vSize / sizeof(AvmFunction))
     {
         return self->_vPtr[index];
     }
@@ -52,6 +57,21 @@ AvmFunction AvmTypeGetFunction(const AvmType* self, uint index)
     throw(AvmErrorNew(VirtualFuncError));
 }
 
+AvmFunction AvmTypeTryGetFunction(const AvmType* self, uint index)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    if (index < self->_vSize / sizeof(AvmFunction))
+    {
+        return self->_vPtr[index];
+    }
+
+    return NULL;
+}
+
 const AvmType* AvmTypeGetBase(const AvmType* self)
 {
     pre
@@ -130,74 +150,295 @@ uint AvmEnumGetSize(const AvmEnum* self)
     return self->_size;
 }
 
-bool AvmEnumIsDefined(const AvmEnum* self, _long value)
+#define INDEX_MISSING  0
+#define INDEX_BUILDING 1
+#define INDEX_BUILT    2
+
+static inline uint AvmAtomicLoad(volatile uint* value)
 {
-    pre
+#ifdef AVM_MSVC
+    return (uint)_InterlockedCompareExchange((volatile long*)value, 0, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void AvmAtomicStore(volatile uint* value, uint desired)
+{
+#ifdef AVM_MSVC
+    _InterlockedExchange((volatile long*)value, (long)desired);
+#else
+    __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+#endif
+}
+
+static inline bool AvmAtomicCompareExchange(volatile uint* value,
+                                            uint expected,
+                                            uint desired)
+{
+#ifdef AVM_MSVC
+    return (uint)_InterlockedCompareExchange(
+               (volatile long*)value, (long)desired, (long)expected) ==
+           expected;
+#else
+    return __atomic_compare_exchange_n(value,
+                                       &expected,
+                                       desired,
+                                       false,
+                                       __ATOMIC_ACQ_REL,
+                                       __ATOMIC_ACQUIRE);
+#endif
+}
+
+// FNV-1a, with its high bits mixed into the low ones that index the table.
+static inline uint AvmEnumHashName(str name)
+{
+    ulong hash = 0xCBF29CE484222325ull;
+
+    for (; *name != '\0'; name++)
     {
-        assert(self != NULL);
+        hash = (hash ^ (byte)*name) * 0x100000001B3ull;
     }
 
-    for (uint i = 0; true; i++)
+    return (uint)(hash ^ (hash >> 32));
+}
+
+static inline uint AvmEnumHashValue(_long value)
+{
+    const ulong hash = (ulong)value * 0x9E3779B97F4A7C15ull;
+    return (uint)(hash >> 32);
+}
+
+// Returns the number of members of an enum, which end at the first one
+// without a name.
+static uint AvmEnumGetLength(const AvmEnum* self)
+{
+    uint length = 0;
+
+    while (length < AVM_MAX_ENUM_MEMBERS &&
+           self->_members[length]._name != NULL)
     {
-        if (self->_members[i]._value == 0 && self->_members[i]._name == NULL)
+        length++;
+    }
+
+    return length;
+}
+
+static void AvmEnumBuildIndex(const AvmEnum* self, AvmEnumIndex* index)
+{
+    const uint length = AvmEnumGetLength(self);
+    uint size = 2;
+
+    while (size < length * 2)
+    {
+        size *= 2;
+    }
+
+    index->_length = length;
+    index->_mask = size - 1;
+    memset(index->_byName, 0, sizeof(index->_byName));
+    memset(index->_byValue, 0, sizeof(index->_byValue));
+
+    for (uint i = 0; i < length; i++)
+    {
+        uint slot = AvmEnumHashName(self->_members[i]._name) & index->_mask;
+
+        while (index->_byName[slot] != 0)
         {
-            break;
+            slot = (slot + 1) & index->_mask;
         }
 
-        if (self->_members[i]._value == value)
+        index->_byName[slot] = (byte)(i + 1);
+    }
+
+    // Values that span a small range, as most enums do, index a table
+    // directly. When several members have a value, the first one is kept.
+    _long minimum = length == 0 ? 0 : self->_members[0]._value;
+    _long maximum = minimum;
+
+    for (uint i = 1; i < length; i++)
+    {
+        const _long value = self->_members[i]._value;
+        minimum = value < minimum ? value : minimum;
+        maximum = value > maximum ? value : maximum;
+    }
+
+    index->_minimum = minimum;
+    index->_dense =
+        (ulong)maximum - (ulong)minimum < sizeof(index->_byValue);
+
+    for (uint i = 0; i < length; i++)
+    {
+        const _long value = self->_members[i]._value;
+        uint slot = index->_dense
+                        ? (uint)((ulong)value - (ulong)minimum)
+                        : AvmEnumHashValue(value) & index->_mask;
+
+        while (index->_byValue[slot] != 0 &&
+               self->_members[index->_byValue[slot] - 1]._value != value)
         {
-            return true;
+            slot = (slot + 1) & index->_mask;
+        }
+
+        if (index->_byValue[slot] == 0)
+        {
+            index->_byValue[slot] = (byte)(i + 1);
         }
     }
+}
 
-    return false;
+// Returns the index of an enum, building it if this is its first use, or
+// NULL if the enum has no index.
+static const AvmEnumIndex* AvmEnumGetIndex(const AvmEnum* self)
+{
+    AvmEnumIndex* index = self->_index;
+
+    if (index == NULL || AvmAtomicLoad(&index->_state) == INDEX_BUILT)
+    {
+        return index;
+    }
+
+    if (AvmAtomicCompareExchange(
+            &index->_state, INDEX_MISSING, INDEX_BUILDING))
+    {
+        AvmEnumBuildIndex(self, index);
+        AvmAtomicStore(&index->_state, INDEX_BUILT);
+        return index;
+    }
+
+    // Another thread is building it, which takes a few microseconds.
+    while (AvmAtomicLoad(&index->_state) != INDEX_BUILT)
+    {
+    }
+
+    return index;
 }
 
-str AvmEnumGetNameOf(const AvmEnum* self, _long value)
+// Returns the position of the first member with a value, or AvmInvalid.
+static uint AvmEnumFindValue(const AvmEnum* self, _long value)
 {
-    pre
+    const AvmEnumIndex* index = AvmEnumGetIndex(self);
+
+    if (index == NULL)
     {
-        assert(self != NULL);
+        const uint length = AvmEnumGetLength(self);
+
+        for (uint i = 0; i < length; i++)
+        {
+            if (self->_members[i]._value == value)
+            {
+                return i;
+            }
+        }
+
+        return AvmInvalid;
     }
 
-    for (uint i = 0; true; i++)
+    if (index->_dense)
     {
-        if (self->_members[i]._value == 0 && self->_members[i]._name == NULL)
+        const ulong offset = (ulong)value - (ulong)index->_minimum;
+
+        if (offset >= sizeof(index->_byValue) || index->_byValue[offset] == 0)
         {
-            break;
+            return AvmInvalid;
         }
 
+        return index->_byValue[offset] - 1u;
+    }
+
+    for (uint slot = AvmEnumHashValue(value) & index->_mask;
+         index->_byValue[slot] != 0;
+         slot = (slot + 1) & index->_mask)
+    {
+        const uint i = index->_byValue[slot] - 1u;
+
         if (self->_members[i]._value == value)
         {
-            return self->_members[i]._name;
+            return i;
         }
     }
 
-    throw(AvmErrorNew(EnumConstantNotPresentError));
+    return AvmInvalid;
 }
 
-_long AvmEnumGetValueOf(const AvmEnum* self, str name)
+// Returns the position of the member with a name, or AvmInvalid.
+static uint AvmEnumFindName(const AvmEnum* self, str name)
 {
-    pre
-    {
-        assert(self != NULL);
-        assert(name != NULL);
-    }
+    const AvmEnumIndex* index = AvmEnumGetIndex(self);
 
-    for (uint i = 0; true; i++)
+    if (index == NULL)
     {
-        if (self->_members[i]._value == 0 && self->_members[i]._name == NULL)
+        const uint length = AvmEnumGetLength(self);
+
+        for (uint i = 0; i < length; i++)
         {
-            break;
+            if (strcmp(self->_members[i]._name, name) == 0)
+            {
+                return i;
+            }
         }
 
+        return AvmInvalid;
+    }
+
+    for (uint slot = AvmEnumHashName(name) & index->_mask;
+         index->_byName[slot] != 0;
+         slot = (slot + 1) & index->_mask)
+    {
+        const uint i = index->_byName[slot] - 1u;
+
         if (strcmp(self->_members[i]._name, name) == 0)
         {
-            return self->_members[i]._value;
+            return i;
         }
     }
 
-    throw(AvmErrorNew(EnumConstantNotPresentError));
+    return AvmInvalid;
+}
+
+bool AvmEnumIsDefined(const AvmEnum* self, _long value)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return AvmEnumFindValue(self, value) != AvmInvalid;
+}
+
+str AvmEnumGetNameOf(const AvmEnum* self, _long value)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const uint i = AvmEnumFindValue(self, value);
+
+    if (i == AvmInvalid)
+    {
+        throw(AvmErrorNew(EnumConstantNotPresentError));
+    }
+
+    return self->_members[i]._name;
+}
+
+_long AvmEnumGetValueOf(const AvmEnum* self, str name)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(name != NULL);
+    }
+
+    const uint i = AvmEnumFindName(self, name);
+
+    if (i == AvmInvalid)
+    {
+        throw(AvmErrorNew(EnumConstantNotPresentError));
+    }
+
+    return self->_members[i]._value;
 }
 
 static AvmString AvmEnumToString(AvmEnum* self)
@@ -1,5 +1,6 @@
 #include "avium/types.h"
 
+#include "avium/hash.h"
 #include "avium/string.h"
 #include "avium/testing.h"
 #include "avium/typeinfo.h"
@@ -27,7 +28,7 @@ bool AvmObjectEquals(object self, object other)
     }
 
     const AvmType* type = AvmObjectGetType(self);
-    AvmFunction fn = AvmTypeGetFunction(type, FnEntryEquals);
+    AvmFunction fn = AvmTypeTryGetFunction(type, FnEntryEquals);
     uint size = type->_size;
 
     if (fn == NULL)
@@ -38,6 +39,45 @@ bool AvmObjectEquals(object self, object other)
     return ((bool (*)(object, object))fn)(self, other);
 }
 
+ulong AvmObjectHash(object self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    const AvmType* type = AvmObjectGetType(self);
+    AvmFunction fn = AvmTypeTryGetFunction(type, FnEntryHash);
+
+    // This must agree with the byte-by-byte comparison in AvmObjectEquals.
+    if (fn == NULL)
+    {
+        return AvmHashBytes(type->_size, self);
+    }
+
+    return ((ulong(*)(object))fn)(self);
+}
+
+int AvmObjectCompare(object self, object other)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(other != NULL);
+    }
+
+    const AvmType* type = AvmObjectGetType(self);
+    AvmFunction fn = AvmTypeTryGetFunction(type, FnEntryCompare);
+
+    // This must agree with the byte-by-byte comparison in AvmObjectEquals.
+    if (fn == NULL)
+    {
+        return memcmp(self, other, type->_size);
+    }
+
+    return ((int (*)(object, object))fn)(self, other);
+}
+
 void AvmObjectDestroy(object self)
 {
     pre
@@ -45,7 +85,8 @@ void AvmObjectDestroy(object self)
         assert(self != NULL);
     }
 
-    AvmFunction fn = AvmTypeGetFunction(AvmObjectGetType(self), FnEntryDtor);
+    AvmFunction fn =
+        AvmTypeTryGetFunction(AvmObjectGetType(self), FnEntryDtor);
 
     if (fn != NULL)
     {
@@ -60,7 +101,8 @@ object AvmObjectClone(object self)
         assert(self != NULL);
     }
 
-    AvmFunction fn = AvmTypeGetFunction(AvmObjectGetType(self), FnEntryClone);
+    AvmFunction fn =
+        AvmTypeTryGetFunction(AvmObjectGetType(self), FnEntryClone);
 
     if (fn == NULL)
     {
@@ -81,7 +123,7 @@ AvmString AvmObjectToString(object self)
     }
 
     AvmFunction fn =
-        AvmTypeGetFunction(AvmObjectGetType(self), FnEntryToString);
+        AvmTypeTryGetFunction(AvmObjectGetType(self), FnEntryToString);
 
     if (fn == NULL)
     {
@@ -92,15 +134,107 @@ AvmString AvmObjectToString(object self)
     return ((AvmString(*)(object))fn)(self);
 }
 
+// Primitive values have no type header, so the following entries receive a
+// pointer to the value itself.
+
+static ulong AvmPrimitiveHash1(const void* self)
+{
+    return AvmHashBytes(1, self);
+}
+
+static ulong AvmPrimitiveHash2(const void* self)
+{
+    return AvmHashBytes(2, self);
+}
+
+static ulong AvmPrimitiveHash4(const void* self)
+{
+    return AvmHashBytes(4, self);
+}
+
+static ulong AvmPrimitiveHash8(const void* self)
+{
+    return AvmHashBytes(8, self);
+}
+
+#define AVM_PRIMITIVE_COMPARE(T)                                               \
+    static int AVM_CONCAT(AvmPrimitiveCompare, T)(const T* self,               \
+                                                  const T* other)              \
+    {                                                                          \
+        return (*self > *other) - (*self < *other);                            \
+    }
+
+AVM_PRIMITIVE_COMPARE(_long)
+AVM_PRIMITIVE_COMPARE(ulong)
+AVM_PRIMITIVE_COMPARE(int)
+AVM_PRIMITIVE_COMPARE(uint)
+AVM_PRIMITIVE_COMPARE(short)
+AVM_PRIMITIVE_COMPARE(ushort)
+AVM_PRIMITIVE_COMPARE(char)
+AVM_PRIMITIVE_COMPARE(byte)
+AVM_PRIMITIVE_COMPARE(float)
+AVM_PRIMITIVE_COMPARE(double)
+
+static bool AvmStrEquals(const str* self, const str* other)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(other != NULL);
+    }
+
+    return strcmp(*self, *other) == 0;
+}
+
+static ulong AvmStrHash(const str* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return AvmHashBytes(strlen(*self), *self);
+}
+
+static int AvmStrCompare(const str* self, const str* other)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(other != NULL);
+    }
+
+    return strcmp(*self, *other);
+}
+
+#define AVM_PRIMITIVE_TYPE(T, S)                                               \
+    AVM_TYPE(T,                                                                \
+             object,                                                           \
+             {                                                                 \
+                 [FnEntryDtor] = NULL,                                         \
+                 [FnEntryHash] = (AvmFunction)AVM_CONCAT(AvmPrimitiveHash, S), \
+                 [FnEntryCompare] =                                            \
+                     (AvmFunction)AVM_CONCAT(AvmPrimitiveCompare, T),          \
+             })
+
 AVM_TYPE(object, object, {[FnEntryDtor] = NULL});
-AVM_TYPE(_long, object, {[FnEntryDtor] = NULL});
-AVM_TYPE(ulong, object, {[FnEntryDtor] = NULL});
-AVM_TYPE(int, object, {[FnEntryDtor] = NULL});
-AVM_TYPE(uint, object, {[FnEntryDtor] = NULL});
-AVM_TYPE(short, object, {[FnEntryDtor] = NULL});
-AVM_TYPE(ushort, object, {[FnEntryDtor] = NULL});
-AVM_TYPE(char, object, {[FnEntryDtor] = NULL});
-AVM_TYPE(byte, object, {[FnEntryDtor] = NULL});
-AVM_TYPE(str, object, {[FnEntryDtor] = NULL});
-AVM_TYPE(float, object, {[FnEntryDtor] = NULL});
-AVM_TYPE(double, object, {[FnEntryDtor] = NULL});
+AVM_PRIMITIVE_TYPE(_long, 8);
+AVM_PRIMITIVE_TYPE(ulong, 8);
+AVM_PRIMITIVE_TYPE(int, 4);
+AVM_PRIMITIVE_TYPE(uint, 4);
+AVM_PRIMITIVE_TYPE(short, 2);
+AVM_PRIMITIVE_TYPE(ushort, 2);
+AVM_PRIMITIVE_TYPE(char, 1);
+AVM_PRIMITIVE_TYPE(byte, 1);
+AVM_PRIMITIVE_TYPE(float, 4);
+AVM_PRIMITIVE_TYPE(double, 8);
+
+// Strings are compared by their contents.
+AVM_TYPE(str,
+         object,
+         {
+             [FnEntryDtor] = NULL,
+             [FnEntryEquals] = (AvmFunction)AvmStrEquals,
+             [FnEntryHash] = (AvmFunction)AvmStrHash,
+             [FnEntryCompare] = (AvmFunction)AvmStrCompare,
+         });
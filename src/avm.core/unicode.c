@@ -0,0 +1,784 @@
+#include "avium/unicode.h"
+
+#include "avium/private/simd.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+AVM_TYPE(AvmUtf8Iterator, object, {[FnEntryDtor] = NULL});
+
+//
+// Scalar helpers.
+//
+
+// Decodes one code point and returns its encoded length, or 0 if the sequence
+// is not valid UTF-8 (see table 3-7 of the Unicode standard).
+static uint AvmUtf8Decode(const byte* p, uint length, uint* codepoint)
+{
+    const byte b0 = p[0];
+
+    if (b0 < 0x80)
+    {
+        *codepoint = b0;
+        return 1;
+    }
+
+    if (b0 < 0xC2)
+    {
+        return 0;
+    }
+
+    if (b0 < 0xE0)
+    {
+        if (length < 2 || (p[1] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+
+        *codepoint = ((uint)(b0 & 0x1F) << 6) | (p[1] & 0x3F);
+        return 2;
+    }
+
+    if (b0 < 0xF0)
+    {
+        const byte low = b0 == 0xE0 ? 0xA0 : 0x80;
+        const byte high = b0 == 0xED ? 0x9F : 0xBF;
+
+        if (length < 3 || p[1] < low || p[1] > high || (p[2] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+
+        *codepoint = ((uint)(b0 & 0x0F) << 12) | ((uint)(p[1] & 0x3F) << 6) |
+                     (p[2] & 0x3F);
+        return 3;
+    }
+
+    if (b0 < 0xF5)
+    {
+        const byte low = b0 == 0xF0 ? 0x90 : 0x80;
+        const byte high = b0 == 0xF4 ? 0x8F : 0xBF;
+
+        if (length < 4 || p[1] < low || p[1] > high ||
+            (p[2] & 0xC0) != 0x80 || (p[3] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+
+        *codepoint = ((uint)(b0 & 0x07) << 18) | ((uint)(p[1] & 0x3F) << 12) |
+                     ((uint)(p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+        return 4;
+    }
+
+    return 0;
+}
+
+// Encodes a valid code point and returns its encoded length.
+static uint AvmUtf8Encode(uint codepoint, byte* p)
+{
+    if (codepoint < 0x80)
+    {
+        p[0] = (byte)codepoint;
+        return 1;
+    }
+
+    if (codepoint < 0x800)
+    {
+        p[0] = (byte)(0xC0 | (codepoint >> 6));
+        p[1] = (byte)(0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+
+    if (codepoint < 0x10000)
+    {
+        p[0] = (byte)(0xE0 | (codepoint >> 12));
+        p[1] = (byte)(0x80 | ((codepoint >> 6) & 0x3F));
+        p[2] = (byte)(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+
+    p[0] = (byte)(0xF0 | (codepoint >> 18));
+    p[1] = (byte)(0x80 | ((codepoint >> 12) & 0x3F));
+    p[2] = (byte)(0x80 | ((codepoint >> 6) & 0x3F));
+    p[3] = (byte)(0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+static uint AvmUtf8EncodedLength(uint codepoint)
+{
+    if (codepoint < 0x80)
+    {
+        return 1;
+    }
+
+    if (codepoint < 0x800)
+    {
+        return 2;
+    }
+
+    return codepoint < 0x10000 ? 3 : 4;
+}
+
+static bool AvmUtf8ValidateScalar(const byte* p, uint length)
+{
+    uint i = 0;
+    uint codepoint = 0;
+
+    while (i < length)
+    {
+#ifdef AVM_HAVE_SSE2
+        // Skip runs of ASCII 16 bytes at a time.
+        if (i + 16 <= length &&
+            _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(p + i))) == 0)
+        {
+            i += 16;
+            continue;
+        }
+#endif
+
+        if (p[i] < 0x80)
+        {
+            i++;
+            continue;
+        }
+
+        const uint n = AvmUtf8Decode(p + i, length - i, &codepoint);
+
+        if (n == 0)
+        {
+            return false;
+        }
+
+        i += n;
+    }
+
+    return true;
+}
+
+//
+// Lookup table validation.
+//
+// This is the algorithm from "Validating UTF-8 In Less Than One Instruction
+// Per Byte" by John Keiser and Daniel Lemire, as used by simdjson/simdutf.
+// Every error is detected by looking at the high and low nibbles of a byte and
+// the high nibble of the next byte, with the exception of missing or extra
+// continuation bytes for 3 and 4 byte sequences, which are checked separately.
+//
+
+#ifdef AVM_HAVE_SSSE3
+
+#define TOO_SHORT      (1 << 0)
+#define TOO_LONG       (1 << 1)
+#define OVERLONG_3     (1 << 2)
+#define TOO_LARGE      (1 << 3)
+#define SURROGATE      (1 << 4)
+#define OVERLONG_2     (1 << 5)
+#define TOO_LARGE_1000 (1 << 6)
+#define OVERLONG_4     (1 << 6)
+#define TWO_CONTS      (1 << 7)
+#define CARRY          (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+AVM_SSSE3 static __m128i AvmUtf8CheckBlock(__m128i input, __m128i previous)
+{
+    const __m128i byte1HighTable = _mm_setr_epi8(
+        TOO_LONG,
+        TOO_LONG,
+        TOO_LONG,
+        TOO_LONG,
+        TOO_LONG,
+        TOO_LONG,
+        TOO_LONG,
+        TOO_LONG,
+        (char)TWO_CONTS,
+        (char)TWO_CONTS,
+        (char)TWO_CONTS,
+        (char)TWO_CONTS,
+        TOO_SHORT | OVERLONG_2,
+        TOO_SHORT,
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+
+    const __m128i byte1LowTable = _mm_setr_epi8(
+        (char)(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4),
+        (char)(CARRY | OVERLONG_2),
+        (char)CARRY,
+        (char)CARRY,
+        (char)(CARRY | TOO_LARGE),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000),
+        (char)(CARRY | TOO_LARGE | TOO_LARGE_1000));
+
+    const __m128i byte2HighTable = _mm_setr_epi8(
+        TOO_SHORT,
+        TOO_SHORT,
+        TOO_SHORT,
+        TOO_SHORT,
+        TOO_SHORT,
+        TOO_SHORT,
+        TOO_SHORT,
+        TOO_SHORT,
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 |
+               OVERLONG_4),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+        (char)(TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE),
+        TOO_SHORT,
+        TOO_SHORT,
+        TOO_SHORT,
+        TOO_SHORT);
+
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+
+    const __m128i byte1High = _mm_shuffle_epi8(
+        byte1HighTable, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+    const __m128i byte1Low =
+        _mm_shuffle_epi8(byte1LowTable, _mm_and_si128(prev1, nibble));
+    const __m128i byte2High = _mm_shuffle_epi8(
+        byte2HighTable, _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+
+    const __m128i special =
+        _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+    // Bytes two or three positions after a 3 or 4 byte lead must be
+    // continuation bytes. The tables above flag these as TWO_CONTS, so the
+    // two must cancel out.
+    const __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+    const __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+    const __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+    const __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80));
+    const __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth),
+                                         _mm_set1_epi8((char)0x80));
+
+    return _mm_xor_si128(must23, special);
+}
+
+AVM_SSSE3 static bool AvmUtf8ValidateSsse3(const byte* p, uint length)
+{
+    // A block is incomplete if one of its last 3 bytes starts a sequence that
+    // does not fit in the block.
+    const __m128i maxValue = _mm_setr_epi8(-1,
+                                           -1,
+                                           -1,
+                                           -1,
+                                           -1,
+                                           -1,
+                                           -1,
+                                           -1,
+                                           -1,
+                                           -1,
+                                           -1,
+                                           -1,
+                                           -1,
+                                           (char)(0xF0 - 1),
+                                           (char)(0xE0 - 1),
+                                           (char)(0xC0 - 1));
+
+    __m128i error = _mm_setzero_si128();
+    __m128i previous = _mm_setzero_si128();
+    __m128i incomplete = _mm_setzero_si128();
+    byte tail[16] = {0};
+
+    for (uint i = 0; i < length; i += 16)
+    {
+        __m128i input;
+
+        if (i + 16 <= length)
+        {
+            input = _mm_loadu_si128((const __m128i*)(p + i));
+        }
+        else
+        {
+            // Pad the last block with zeroes, which are valid ASCII.
+            memcpy(tail, p + i, length - i);
+            input = _mm_loadu_si128((const __m128i*)tail);
+        }
+
+        if (_mm_movemask_epi8(input) == 0)
+        {
+            error = _mm_or_si128(error, incomplete);
+            incomplete = _mm_setzero_si128();
+        }
+        else
+        {
+            error = _mm_or_si128(error, AvmUtf8CheckBlock(input, previous));
+            incomplete = _mm_subs_epu8(input, maxValue);
+        }
+
+        previous = input;
+    }
+
+    error = _mm_or_si128(error, incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) ==
+           0xFFFF;
+}
+
+#endif // AVM_HAVE_SSSE3
+
+static bool AvmUtf8Validate(const byte* p, uint length)
+{
+#ifdef AVM_HAVE_SSSE3
+    if (AvmCpuHasSsse3())
+    {
+        return AvmUtf8ValidateSsse3(p, length);
+    }
+#endif
+
+    return AvmUtf8ValidateScalar(p, length);
+}
+
+bool AvmUtf8IsValid(uint length, str contents)
+{
+    pre
+    {
+        assert(contents != NULL || length == 0);
+    }
+
+    return AvmUtf8Validate((const byte*)contents, length);
+}
+
+bool AvmStringIsValidUtf8(const AvmString* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return AvmUtf8Validate((const byte*)self->_buffer, self->_length);
+}
+
+//
+// Counting.
+//
+
+// Counts the continuation bytes (10xxxxxx). These are the only bytes below
+// -64 when compared as signed.
+static uint AvmUtf8CountContinuations(const byte* p, uint length)
+{
+    uint count = 0;
+    uint i = 0;
+
+#ifdef AVM_HAVE_SSE2
+    const __m128i limit = _mm_set1_epi8(-64);
+
+    for (; i + 16 <= length; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+        const __m128i mask = _mm_cmplt_epi8(v, limit);
+        count += AvmPopCount((uint)_mm_movemask_epi8(mask));
+    }
+#endif
+
+    for (; i < length; i++)
+    {
+        count += (p[i] & 0xC0) == 0x80;
+    }
+
+    return count;
+}
+
+// Counts the lead bytes of 4 byte sequences (11110xxx).
+static uint AvmUtf8CountLongLeads(const byte* p, uint length)
+{
+    uint count = 0;
+    uint i = 0;
+
+#ifdef AVM_HAVE_SSE2
+    // Flipping the sign bit turns the unsigned comparison into a signed one.
+    const __m128i sign = _mm_set1_epi8((char)0x80);
+    const __m128i limit = _mm_set1_epi8(0xEF ^ 0x80);
+
+    for (; i + 16 <= length; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+        const __m128i mask = _mm_cmpgt_epi8(_mm_xor_si128(v, sign), limit);
+        count += AvmPopCount((uint)_mm_movemask_epi8(mask));
+    }
+#endif
+
+    for (; i < length; i++)
+    {
+        count += p[i] >= 0xF0;
+    }
+
+    return count;
+}
+
+uint AvmUtf8CountCodepoints(uint length, str contents)
+{
+    pre
+    {
+        assert(contents != NULL || length == 0);
+    }
+
+    return length - AvmUtf8CountContinuations((const byte*)contents, length);
+}
+
+uint AvmStringCountCodepoints(const AvmString* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return AvmUtf8CountCodepoints(self->_length, self->_buffer);
+}
+
+//
+// Iteration.
+//
+
+AvmUtf8Iterator AvmUtf8IteratorNew(const AvmString* string)
+{
+    pre
+    {
+        assert(string != NULL);
+    }
+
+    return (AvmUtf8Iterator){
+        ._type = typeid(AvmUtf8Iterator),
+        ._string = string,
+        ._index = 0,
+    };
+}
+
+bool AvmUtf8IteratorNext(AvmUtf8Iterator* self, uint* codepoint)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(codepoint != NULL);
+    }
+
+    const uint length = self->_string->_length;
+
+    if (self->_index >= length)
+    {
+        return false;
+    }
+
+    const byte* p = (const byte*)self->_string->_buffer + self->_index;
+    const uint n = AvmUtf8Decode(p, length - self->_index, codepoint);
+
+    if (n == 0)
+    {
+        *codepoint = AVM_REPLACEMENT_CHARACTER;
+        self->_index++;
+    }
+    else
+    {
+        self->_index += n;
+    }
+
+    return true;
+}
+
+uint AvmUtf8IteratorGetIndex(const AvmUtf8Iterator* self)
+{
+    pre
+    {
+        assert(self != NULL);
+    }
+
+    return self->_index;
+}
+
+//
+// Transcoding.
+//
+
+static void AvmStore16(byte* p, ushort value)
+{
+    memcpy(p, &value, sizeof(ushort));
+}
+
+static void AvmStore32(byte* p, uint value)
+{
+    memcpy(p, &value, sizeof(uint));
+}
+
+static ushort AvmLoad16(const byte* p)
+{
+    ushort value;
+    memcpy(&value, p, sizeof(ushort));
+    return value;
+}
+
+static uint AvmLoad32(const byte* p)
+{
+    uint value;
+    memcpy(&value, p, sizeof(uint));
+    return value;
+}
+
+bool AvmUtf8ToUtf16(const AvmString* source, AvmString* destination)
+{
+    pre
+    {
+        assert(source != NULL);
+        assert(destination != NULL);
+    }
+
+    const byte* const p = (const byte*)source->_buffer;
+    const uint length = source->_length;
+
+    if (!AvmUtf8Validate(p, length))
+    {
+        return false;
+    }
+
+    // Every code point needs one unit, and those encoded with 4 bytes (lead
+    // bytes 0xF0 and above) need a second one for the surrogate pair.
+    const uint units = length - AvmUtf8CountContinuations(p, length) +
+                       AvmUtf8CountLongLeads(p, length);
+
+    AvmStringEnsureCapacity(destination, units * 2);
+
+    byte* out = (byte*)destination->_buffer + destination->_length;
+    uint i = 0;
+    uint codepoint = 0;
+
+    while (i < length)
+    {
+#ifdef AVM_HAVE_SSE2
+        if (i + 16 <= length)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+
+            if (_mm_movemask_epi8(v) == 0)
+            {
+                const __m128i zero = _mm_setzero_si128();
+                _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi8(v, zero));
+                _mm_storeu_si128((__m128i*)(out + 16),
+                                 _mm_unpackhi_epi8(v, zero));
+                out += 32;
+                i += 16;
+                continue;
+            }
+        }
+#endif
+
+        i += AvmUtf8Decode(p + i, length - i, &codepoint);
+
+        if (codepoint >= 0x10000)
+        {
+            codepoint -= 0x10000;
+            AvmStore16(out, (ushort)(0xD800 | (codepoint >> 10)));
+            AvmStore16(out + 2, (ushort)(0xDC00 | (codepoint & 0x3FF)));
+            out += 4;
+        }
+        else
+        {
+            AvmStore16(out, (ushort)codepoint);
+            out += 2;
+        }
+    }
+
+    destination->_length += units * 2;
+    return true;
+}
+
+bool AvmUtf8ToUtf32(const AvmString* source, AvmString* destination)
+{
+    pre
+    {
+        assert(source != NULL);
+        assert(destination != NULL);
+    }
+
+    const byte* const p = (const byte*)source->_buffer;
+    const uint length = source->_length;
+
+    if (!AvmUtf8Validate(p, length))
+    {
+        return false;
+    }
+
+    const uint units = length - AvmUtf8CountContinuations(p, length);
+
+    AvmStringEnsureCapacity(destination, units * 4);
+
+    byte* out = (byte*)destination->_buffer + destination->_length;
+    uint i = 0;
+    uint codepoint = 0;
+
+    while (i < length)
+    {
+#ifdef AVM_HAVE_SSE2
+        if (i + 16 <= length)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+
+            if (_mm_movemask_epi8(v) == 0)
+            {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i low = _mm_unpacklo_epi8(v, zero);
+                const __m128i high = _mm_unpackhi_epi8(v, zero);
+                _mm_storeu_si128((__m128i*)out, _mm_unpacklo_epi16(low, zero));
+                _mm_storeu_si128((__m128i*)(out + 16),
+                                 _mm_unpackhi_epi16(low, zero));
+                _mm_storeu_si128((__m128i*)(out + 32),
+                                 _mm_unpacklo_epi16(high, zero));
+                _mm_storeu_si128((__m128i*)(out + 48),
+                                 _mm_unpackhi_epi16(high, zero));
+                out += 64;
+                i += 16;
+                continue;
+            }
+        }
+#endif
+
+        i += AvmUtf8Decode(p + i, length - i, &codepoint);
+        AvmStore32(out, codepoint);
+        out += 4;
+    }
+
+    destination->_length += units * 4;
+    return true;
+}
+
+bool AvmUtf16ToUtf8(const AvmString* source, AvmString* destination)
+{
+    pre
+    {
+        assert(source != NULL);
+        assert(destination != NULL);
+    }
+
+    const byte* const p = (const byte*)source->_buffer;
+    const uint length = source->_length;
+
+    if (length % 2 != 0)
+    {
+        return false;
+    }
+
+    // First pass: validate and compute the exact output length.
+    uint required = 0;
+
+    for (uint i = 0; i < length; i += 2)
+    {
+        const ushort unit = AvmLoad16(p + i);
+
+        if (unit >= 0xDC00 && unit <= 0xDFFF)
+        {
+            return false;
+        }
+
+        if (unit >= 0xD800 && unit <= 0xDBFF)
+        {
+            if (i + 4 > length)
+            {
+                return false;
+            }
+
+            const ushort next = AvmLoad16(p + i + 2);
+
+            if (next < 0xDC00 || next > 0xDFFF)
+            {
+                return false;
+            }
+
+            required += 4;
+            i += 2;
+            continue;
+        }
+
+        required += AvmUtf8EncodedLength(unit);
+    }
+
+    AvmStringEnsureCapacity(destination, required);
+
+    // Second pass: encode.
+    byte* out = (byte*)destination->_buffer + destination->_length;
+    uint i = 0;
+
+    while (i < length)
+    {
+#ifdef AVM_HAVE_SSE2
+        if (i + 16 <= length)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+            const __m128i nonAscii =
+                _mm_and_si128(v, _mm_set1_epi16((short)0xFF80));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(
+                    nonAscii, _mm_setzero_si128())) == 0xFFFF)
+            {
+                _mm_storel_epi64((__m128i*)out, _mm_packus_epi16(v, v));
+                out += 8;
+                i += 16;
+                continue;
+            }
+        }
+#endif
+
+        uint codepoint = AvmLoad16(p + i);
+        i += 2;
+
+        if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+        {
+            const uint low = AvmLoad16(p + i);
+            codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+            i += 2;
+        }
+
+        out += AvmUtf8Encode(codepoint, out);
+    }
+
+    destination->_length += required;
+    return true;
+}
+
+bool AvmUtf32ToUtf8(const AvmString* source, AvmString* destination)
+{
+    pre
+    {
+        assert(source != NULL);
+        assert(destination != NULL);
+    }
+
+    const byte* const p = (const byte*)source->_buffer;
+    const uint length = source->_length;
+
+    if (length % 4 != 0)
+    {
+        return false;
+    }
+
+    uint required = 0;
+
+    for (uint i = 0; i < length; i += 4)
+    {
+        const uint codepoint = AvmLoad32(p + i);
+
+        if (codepoint > 0x10FFFF ||
+            (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+        {
+            return false;
+        }
+
+        required += AvmUtf8EncodedLength(codepoint);
+    }
+
+    AvmStringEnsureCapacity(destination, required);
+
+    byte* out = (byte*)destination->_buffer + destination->_length;
+
+    for (uint i = 0; i < length; i += 4)
+    {
+        out += AvmUtf8Encode(AvmLoad32(p + i), out);
+    }
+
+    destination->_length += required;
+    return true;
+}
@@ -1,5 +1,6 @@
 #include "avium/io.h"
 
+#include "avium/private/errors.h"
 #include "avium/private/resources.h"
 #include "avium/string.h"
 #include "avium/testing.h"
@@ -7,6 +8,9 @@
 
 typedef AvmError* (*ReadWriteFunc)(AvmStream*, size_t, byte[]);
 
+// Encodes or decodes a chunk, which is the last one if `last` is true.
+typedef bool (*CodecFunc)(AvmString*, uint, const byte*, bool, int);
+
 AvmError* AvmStreamFlush(AvmStream* self)
 {
     pre
@@ -180,3 +184,200 @@ AvmError* AvmStreamWriteLine(AvmStream* self, AvmString* string)
 
     return AvmStreamWriteChar(self, '\n');
 }
+
+static bool AvmEncodeBase64Chunk(AvmString* out,
+                                 uint length,
+                                 const byte* chunk,
+                                 bool last,
+                                 int variant)
+{
+    (void)last;
+    AvmBase64Encode(out, length, chunk, (AvmBase64Variant)variant);
+    return true;
+}
+
+static bool AvmDecodeBase64Chunk(AvmString* out,
+                                 uint length,
+                                 const byte* chunk,
+                                 bool last,
+                                 int variant)
+{
+    // Padding is only allowed at the end of the last chunk.
+    if (!last && chunk[length - 1] == '=')
+    {
+        return false;
+    }
+
+    return AvmBase64Decode(out, length, (str)chunk, (AvmBase64Variant)variant);
+}
+
+static bool AvmEncodeHexChunk(AvmString* out,
+                              uint length,
+                              const byte* chunk,
+                              bool last,
+                              int variant)
+{
+    (void)last;
+    (void)variant;
+    AvmHexEncode(out, length, chunk);
+    return true;
+}
+
+static bool AvmDecodeHexChunk(AvmString* out,
+                              uint length,
+                              const byte* chunk,
+                              bool last,
+                              int variant)
+{
+    (void)last;
+    (void)variant;
+    return AvmHexDecode(out, length, (str)chunk);
+}
+
+static AvmError* AvmStreamTranscode(AvmStream* self,
+                                    AvmStream* destination,
+                                    size_t length,
+                                    uint chunkSize,
+                                    CodecFunc codec,
+                                    int variant)
+{
+    byte chunk[DECODE_CHUNK_SIZE];
+    AvmString out = AvmStringNew(chunkSize * 2);
+    AvmError* error = NULL;
+
+    while (length != 0)
+    {
+        const uint count = length < chunkSize ? (uint)length : chunkSize;
+        length -= count;
+
+        error = AvmStreamRead(self, count, chunk);
+        if (error != NULL)
+        {
+            break;
+        }
+
+        AvmStringClear(&out);
+        if (!codec(&out, count, chunk, length == 0, variant))
+        {
+            error = AvmErrorNew(FormatError);
+            break;
+        }
+
+        error = AvmStreamWrite(destination,
+                               AvmStringGetLength(&out),
+                               (byte*)AvmStringGetBuffer(&out));
+        if (error != NULL)
+        {
+            break;
+        }
+    }
+
+    AvmObjectDestroy(&out);
+    return error;
+}
+
+AvmError* AvmStreamEncodeBase64(AvmStream* self,
+                                AvmStream* destination,
+                                size_t length,
+                                AvmBase64Variant variant)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(destination != NULL);
+    }
+
+    return AvmStreamTranscode(self,
+                              destination,
+                              length,
+                              ENCODE_CHUNK_SIZE,
+                              AvmEncodeBase64Chunk,
+                              (int)variant);
+}
+
+AvmError* AvmStreamDecodeBase64(AvmStream* self,
+                                AvmStream* destination,
+                                size_t length,
+                                AvmBase64Variant variant)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(destination != NULL);
+    }
+
+    return AvmStreamTranscode(self,
+                              destination,
+                              length,
+                              DECODE_CHUNK_SIZE,
+                              AvmDecodeBase64Chunk,
+                              (int)variant);
+}
+
+AvmError* AvmStreamEncodeHex(AvmStream* self,
+                             AvmStream* destination,
+                             size_t length)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(destination != NULL);
+    }
+
+    return AvmStreamTranscode(
+        self, destination, length, ENCODE_CHUNK_SIZE, AvmEncodeHexChunk, 0);
+}
+
+AvmError* AvmStreamDecodeHex(AvmStream* self,
+                             AvmStream* destination,
+                             size_t length)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(destination != NULL);
+    }
+
+    return AvmStreamTranscode(
+        self, destination, length, DECODE_CHUNK_SIZE, AvmDecodeHexChunk, 0);
+}
+
+AvmError* AvmStreamReadItems(AvmStream* self,
+                             AvmList* destination,
+                             uint count)
+{
+    pre
+    {
+        assert(self != NULL);
+        assert(destination != NULL);
+    }
+
+    if (count == 0)
+    {
+        return NULL;
+    }
+
+    const uint size = AvmTypeGetSize(AvmListGetItemType(destination));
+    const uint chunkCount =
+        size >= READ_ITEMS_CHUNK_SIZE ? 1 : READ_ITEMS_CHUNK_SIZE / size;
+    byte* const chunk =
+        AvmAlloc((size_t)(count < chunkCount ? count : chunkCount) * size);
+    AvmError* error = NULL;
+
+    while (count != 0)
+    {
+        const uint n = count < chunkCount ? count : chunkCount;
+        count -= n;
+
+        error = AvmStreamRead(self, (size_t)n * size, chunk);
+        if (error != NULL)
+        {
+            break;
+        }
+
+        AvmListAddRange(destination, n, chunk);
+    }
+
+    AvmDealloc(chunk);
+    return error;
+}
@@ -36,11 +36,8 @@ static AvmError* AvmMemoryStreamWrite(AvmMemoryStream* self,
                                       size_t length,
                                       byte bytes[])
 {
-    for (size_t i = 0; i < length; i++)
-    {
-        AvmListPush(&self->_list, bytes + i);
-        self->_position++;
-    }
+    AvmListAddRange(&self->_list, (uint)length, bytes);
+    self->_position += length;
 
     return NULL;
 }
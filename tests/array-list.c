@@ -2,9 +2,26 @@
 #include "avium/collections/list.h"
 
 #include "avium/core.h"
+#include "avium/io.h"
+#include "avium/string.h"
 #include "avium/testing.h"
 #include "avium/typeinfo.h"
 
+AVM_ARRAY_LIST_OF(int);
+AVM_ARRAY_LIST_OF(double);
+
+AVM_CLASS(Record, object, {
+    int key;
+    uint order;
+});
+
+AVM_TYPE(Record, object, {[FnEntryDtor] = NULL});
+
+static int RecordCompareKeys(const Record* self, const Record* other)
+{
+    return (self->key > other->key) - (self->key < other->key);
+}
+
 void TestListPush()
 {
     const uint expectedLength = 20;
@@ -26,7 +43,387 @@ void TestListPush()
     assert(AvmListGetItemType(&arrayList) == expectedType);
 }
 
+void TestListInsert()
+{
+    AvmArrayList arrayList = AvmArrayListNew(typeid(int), 0);
+
+    for (int i = 0; i < 5; i++)
+    {
+        AvmListPush(&arrayList, &i);
+    }
+
+    // Inserting in the middle must shift every following item.
+    int value = 10;
+    AvmListInsert(&arrayList, 1, &value);
+
+    const int expected[] = {0, 10, 1, 2, 3, 4};
+    assert(AvmListGetLength(&arrayList) == 6);
+    for (uint i = 0; i < 6; i++)
+    {
+        assert(*(int*)AvmListItemAt(&arrayList, i) == expected[i]);
+    }
+
+    AvmListClear(&arrayList);
+    assert(AvmListGetLength(&arrayList) == 0);
+}
+
+void TestListRanges()
+{
+    const int items[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    AvmArrayList arrayList = AvmArrayListNew(typeid(int), 0);
+
+    AvmListAddRange(&arrayList, 10, items);
+    AvmListInsertRange(&arrayList, 2, 3, items + 7);
+    AvmListInsertRange(&arrayList, 0, 0, NULL);
+
+    const int inserted[] = {0, 1, 7, 8, 9, 2, 3, 4, 5, 6, 7, 8, 9};
+    assert(AvmListGetLength(&arrayList) == 13);
+    for (uint i = 0; i < 13; i++)
+    {
+        assert(*(int*)AvmListItemAt(&arrayList, i) == inserted[i]);
+    }
+
+    AvmListRemoveRange(&arrayList, 2, 3);
+    AvmListTruncate(&arrayList, 6);
+    AvmListTruncate(&arrayList, 100);
+
+    assert(AvmListGetLength(&arrayList) == 6);
+    for (uint i = 0; i < 6; i++)
+    {
+        assert(*(int*)AvmListItemAt(&arrayList, i) == items[i]);
+    }
+
+    // Appending a list to itself copies the items before growing.
+    AvmListAddList(&arrayList, &arrayList);
+    AvmListInsertRange(&arrayList, 1, 2, AvmListItemAt(&arrayList, 4));
+
+    const int doubled[] = {0, 4, 5, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5};
+    assert(AvmListGetLength(&arrayList) == 14);
+    for (uint i = 0; i < 14; i++)
+    {
+        assert(*(int*)AvmListItemAt(&arrayList, i) == doubled[i]);
+    }
+}
+
+#ifdef AVM_USE_IO
+void TestStreamReadItems()
+{
+    const uint count = 3000;
+    AvmStream* stream = AvmStreamFromMemory(0);
+
+    for (uint i = 0; i < count; i++)
+    {
+        AvmStreamWrite(stream, sizeof(uint), (byte*)&i);
+    }
+
+    AvmStreamSeek(stream, 0, SeekOriginBegin);
+
+    AvmArrayList arrayList = AvmArrayListNew(typeid(uint), 0);
+    assert(AvmStreamReadItems(stream, &arrayList, count) == NULL);
+    assert(AvmListGetLength(&arrayList) == count);
+
+    for (uint i = 0; i < count; i++)
+    {
+        assert(*(uint*)AvmListItemAt(&arrayList, i) == i);
+    }
+
+    AvmObjectDestroy(stream);
+}
+#endif
+
+void TestTypedList()
+{
+    AvmArrayListOf(int) ints = AvmArrayListOf_int_New(0);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        AvmArrayListOf_int_Push(&ints, i);
+    }
+
+    _long sum = 0;
+    for (uint i = 0; i < AvmArrayListOf_int_GetLength(&ints); i++)
+    {
+        sum += AvmArrayListOf_int_Get(&ints, i);
+    }
+    assert(sum == 999 * 1000 / 2);
+
+    // The typed list can be used through the generic interface.
+    AvmList* list = AvmArrayListOf_int_AsList(&ints);
+    assert(AvmListGetLength(list) == 1000);
+    assert(AvmListGetItemType(list) == typeid(int));
+    assert(*(int*)AvmListItemAt(list, 10) == 10);
+
+    int value = -1;
+    AvmListPush(list, &value);
+    assert(AvmArrayListOf_int_Pop(&ints) == -1);
+    assert(AvmArrayListOf_int_Pop(&ints) == 999);
+    assert(AvmListGetLength(list) == 999);
+
+    AvmArrayListOf(double) doubles = AvmArrayListOf_double_New(4);
+    AvmArrayListOf_double_Push(&doubles, 0.5);
+    AvmArrayListOf_double_Push(&doubles, 1.5);
+    AvmArrayListOf_double_Set(&doubles, 0, 2.5);
+    *AvmArrayListOf_double_ItemAt(&doubles, 1) += 1.0;
+
+    assert(AvmArrayListOf_double_Get(&doubles, 0) == 2.5);
+    assert(AvmArrayListOf_double_Get(&doubles, 1) == 2.5);
+}
+
+void TestListSort()
+{
+    AvmArrayListOf(int) ints = AvmArrayListOf_int_New(0);
+    AvmArrayListOf(double) doubles = AvmArrayListOf_double_New(0);
+
+    // Enough items to take the radix sort path.
+    for (int i = 0; i < 1000; i++)
+    {
+        AvmArrayListOf_int_Push(&ints, (i * 7919) % 1000 - 500);
+        AvmArrayListOf_double_Push(&doubles, ((i * 31) % 100 - 50) / 4.0);
+    }
+
+    AvmListSort(AvmArrayListOf_int_AsList(&ints));
+    AvmListSort(AvmArrayListOf_double_AsList(&doubles));
+
+    for (uint i = 0; i < 1000; i++)
+    {
+        assert(AvmArrayListOf_int_Get(&ints, i) == (int)i - 500);
+    }
+
+    for (uint i = 1; i < 1000; i++)
+    {
+        assert(AvmArrayListOf_double_Get(&doubles, i - 1) <=
+               AvmArrayListOf_double_Get(&doubles, i));
+    }
+
+    // Few enough items for the sorting network.
+    AvmArrayListOf(int) small = AvmArrayListOf_int_New(0);
+    const int values[] = {5, -3, 9, 0, -3, 7, 1};
+    AvmListAddRange(AvmArrayListOf_int_AsList(&small), 7, values);
+    AvmListSort(AvmArrayListOf_int_AsList(&small));
+
+    const int sorted[] = {-3, -3, 0, 1, 5, 7, 9};
+    for (uint i = 0; i < 7; i++)
+    {
+        assert(AvmArrayListOf_int_Get(&small, i) == sorted[i]);
+    }
+
+    AvmArrayList strings = AvmArrayListNew(typeid(AvmString), 0);
+    const str words[] = {"pear", "apple", "fig", "apples", "banana"};
+    for (uint i = 0; i < 5; i++)
+    {
+        AvmString word = AvmStringFrom(words[i]);
+        AvmListPush(&strings, &word);
+    }
+
+    AvmListSort(&strings);
+
+    const str sortedWords[] = {"apple", "apples", "banana", "fig", "pear"};
+    for (uint i = 0; i < 5; i++)
+    {
+        AvmString expected = AvmStringFrom(sortedWords[i]);
+        assert(AvmObjectEquals(AvmListItemAt(&strings, i), &expected));
+    }
+}
+
+void TestListStableSort()
+{
+    AvmArrayList records = AvmArrayListNew(typeid(Record), 0);
+
+    for (uint i = 0; i < 500; i++)
+    {
+        Record record = {
+            ._type = typeid(Record),
+            .key = (int)((i * 37) % 10),
+            .order = i,
+        };
+        AvmListPush(&records, &record);
+    }
+
+    AvmListStableSortBy(&records, (AvmComparer)RecordCompareKeys);
+
+    for (uint i = 1; i < 500; i++)
+    {
+        const Record* previous = AvmListItemAt(&records, i - 1);
+        const Record* current = AvmListItemAt(&records, i);
+
+        assert(previous->key <= current->key);
+        assert(previous->key < current->key ||
+               previous->order < current->order);
+    }
+
+    AvmListSortBy(&records, (AvmComparer)RecordCompareKeys);
+
+    for (uint i = 1; i < 500; i++)
+    {
+        const Record* previous = AvmListItemAt(&records, i - 1);
+        const Record* current = AvmListItemAt(&records, i);
+        assert(previous->key <= current->key);
+    }
+}
+
+// A list without an FnEntryGetIterator entry.
+AVM_CLASS(Digits, object, {
+    uint length;
+    uint items[10];
+});
+
+static uint DigitsGetLength(const Digits* self)
+{
+    return self->length;
+}
+
+static const AvmType* DigitsGetItemType(const Digits* self)
+{
+    (void)self;
+    return typeid(uint);
+}
+
+static object DigitsItemAt(Digits* self, uint index)
+{
+    return &self->items[index];
+}
+
+AVM_TYPE(Digits,
+         object,
+         {
+             [FnEntryDtor] = NULL,
+             [FnEntryGetLength] = (AvmFunction)DigitsGetLength,
+             [FnEntryGetItemType] = (AvmFunction)DigitsGetItemType,
+             [FnEntryItemAt] = (AvmFunction)DigitsItemAt,
+         });
+
+void TestListIterator()
+{
+    AvmArrayList list = AvmArrayListNew(typeid(uint), 0);
+    for (uint i = 0; i < 100; i++)
+    {
+        AvmListPush(&list, &i);
+    }
+
+    // The items of an AvmArrayList are a single span.
+    AvmIterator iterator = AvmListGetIterator(&list);
+    assert(AvmIteratorGetItemType(&iterator) == typeid(uint));
+    assert(AvmIteratorNext(&iterator));
+    assert(AvmIteratorGetIndex(&iterator) == 0);
+    assert(AvmIteratorGetLength(&iterator) == 100);
+    assert(AvmIteratorGetItems(&iterator) == AvmListItemAt(&list, 0));
+    assert(!AvmIteratorNext(&iterator));
+    assert(!AvmIteratorNext(&iterator));
+
+    Digits digits = {._type = typeid(Digits), .length = 10};
+    for (uint i = 0; i < 10; i++)
+    {
+        digits.items[i] = 9 - i;
+    }
+
+    // Other lists are iterated one item at a time.
+    uint count = 0;
+    iterator = AvmListGetIterator(&digits);
+    while (AvmIteratorNext(&iterator))
+    {
+        assert(AvmIteratorGetIndex(&iterator) == count);
+        assert(AvmIteratorGetLength(&iterator) == 1);
+        assert(*(uint*)AvmIteratorGetItems(&iterator) == 9 - count);
+        count++;
+    }
+
+    assert(count == 10);
+
+    AvmListSort(&digits);
+    AvmListAddList(&list, &digits);
+    AvmListAddList(&list, &list);
+    assert(AvmListGetLength(&list) == 220);
+
+    for (uint i = 0; i < 10; i++)
+    {
+        assert(digits.items[i] == i);
+        assert(*(uint*)AvmListItemAt(&list, 100 + i) == i);
+        assert(*(uint*)AvmListItemAt(&list, 210 + i) == i);
+    }
+
+    const uint array[] = {1, 2, 3};
+    iterator = AvmIteratorFromArray(typeid(uint), 3, (object)array);
+    assert(AvmIteratorNext(&iterator));
+    assert(AvmIteratorGetItems(&iterator) == array);
+    assert(AvmIteratorGetLength(&iterator) == 3);
+    assert(!AvmIteratorNext(&iterator));
+
+    iterator = AvmIteratorFromArray(typeid(uint), 0, NULL);
+    assert(!AvmIteratorNext(&iterator));
+}
+
+#define TEST_INDEX_OF(T)                                                       \
+    {                                                                          \
+        AvmArrayList list = AvmArrayListNew(typeid(T), 0);                     \
+        for (uint i = 0; i < 300; i++)                                         \
+        {                                                                      \
+            T value = (T)(i % 100 + 1);                                        \
+            AvmListPush(&list, &value);                                        \
+        }                                                                      \
+                                                                               \
+        for (uint i = 0; i < 100; i++)                                         \
+        {                                                                      \
+            T value = (T)(i + 1);                                              \
+            assert(AvmListIndexOf(&list, &value) == i);                        \
+        }                                                                      \
+                                                                               \
+        T missing = 0;                                                         \
+        assert(!AvmListContains(&list, &missing));                             \
+                                                                               \
+        /* Matches in the unaligned tail are found too. */                     \
+        AvmListPush(&list, &missing);                                          \
+        assert(AvmListIndexOf(&list, &missing) == 300);                        \
+    }
+
+void TestListIndexOf()
+{
+    TEST_INDEX_OF(byte);
+    TEST_INDEX_OF(short);
+    TEST_INDEX_OF(int);
+    TEST_INDEX_OF(_long);
+    TEST_INDEX_OF(float);
+    TEST_INDEX_OF(double);
+
+    AvmArrayList strs = AvmArrayListNew(typeid(str), 0);
+    char buffer[] = "world";
+    str values[] = {"hello", "world"};
+    AvmListAddRange(&strs, 2, values);
+
+    // Strings are compared by their contents.
+    str value = buffer;
+    assert(AvmListIndexOf(&strs, &value) == 1);
+
+    AvmArrayList strings = AvmArrayListNew(typeid(AvmString), 0);
+    for (uint i = 0; i < 10; i++)
+    {
+        AvmString s = AvmStringFormat("%u", i);
+        AvmListPush(&strings, &s);
+    }
+
+    AvmString s = AvmStringFrom("7");
+    assert(AvmListIndexOf(&strings, &s) == 7);
+
+    Digits digits = {._type = typeid(Digits), .length = 10};
+    for (uint i = 0; i < 10; i++)
+    {
+        digits.items[i] = i * i;
+    }
+
+    uint square = 49;
+    assert(AvmListIndexOf(&digits, &square) == 7);
+}
+
 void main()
 {
     TestListPush();
+    TestListInsert();
+    TestListRanges();
+#ifdef AVM_USE_IO
+    TestStreamReadItems();
+#endif
+    TestTypedList();
+    TestListSort();
+    TestListStableSort();
+    TestListIterator();
+    TestListIndexOf();
 }
@@ -0,0 +1,215 @@
+#include "avium/collections/bit-set.h"
+#include "avium/collections/list.h"
+
+#include "avium/core.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#define LENGTH 1000
+
+void TestBitSetGetSet()
+{
+    AvmBitSet set = AvmBitSetNew(LENGTH);
+
+    assert(AvmListGetLength(&set) == LENGTH);
+    assert(AvmBitSetCount(&set) == 0);
+    assert(AvmBitSetNextSet(&set, 0) == AvmInvalid);
+
+    for (uint i = 0; i < LENGTH; i += 3)
+    {
+        AvmBitSetSet(&set, i, true);
+    }
+
+    for (uint i = 0; i < LENGTH; i++)
+    {
+        assert(AvmBitSetGet(&set, i) == (i % 3 == 0));
+    }
+
+    assert(AvmBitSetCount(&set) == (LENGTH + 2) / 3);
+
+    uint count = 0;
+    for (uint i = AvmBitSetNextSet(&set, 0); i != AvmInvalid;
+         i = AvmBitSetNextSet(&set, i + 1))
+    {
+        assert(i == count * 3);
+        count++;
+    }
+
+    assert(count == (LENGTH + 2) / 3);
+    assert(AvmBitSetNextSet(&set, LENGTH) == AvmInvalid);
+
+    AvmBitSetSet(&set, 3, false);
+    assert(!AvmBitSetGet(&set, 3));
+    assert(AvmBitSetNextSet(&set, 1) == 6);
+
+    AvmBitSetFill(&set, true);
+    assert(AvmBitSetCount(&set) == LENGTH);
+
+    // Shrinking and growing again does not bring back the bits.
+    AvmBitSetResize(&set, 10);
+    AvmBitSetResize(&set, 2 * LENGTH);
+    assert(AvmBitSetCount(&set) == 10);
+    assert(AvmBitSetNextSet(&set, 10) == AvmInvalid);
+
+    AvmBitSet small = AvmBitSetNew(70);
+    AvmBitSetSet(&small, 1, true);
+    AvmBitSetSet(&small, 69, true);
+    AvmString s = AvmObjectToString(&small);
+    AvmString expected = AvmStringFrom("{ 1, 69 }");
+    assert(AvmObjectEquals(&s, &expected));
+}
+
+void TestBitSetOperations()
+{
+    AvmBitSet a = AvmBitSetNew(LENGTH);
+    AvmBitSet b = AvmBitSetNew(LENGTH);
+
+    for (uint i = 0; i < LENGTH; i++)
+    {
+        AvmBitSetSet(&a, i, i % 2 == 0);
+        AvmBitSetSet(&b, i, i % 3 == 0);
+    }
+
+    AvmBitSet result = AvmBitSetNew(LENGTH);
+
+    AvmBitSetOr(&result, &a);
+    AvmBitSetAnd(&result, &b);
+    for (uint i = 0; i < LENGTH; i++)
+    {
+        assert(AvmBitSetGet(&result, i) == (i % 6 == 0));
+    }
+
+    AvmBitSetOr(&result, &b);
+    AvmBitSetOr(&result, &a);
+    for (uint i = 0; i < LENGTH; i++)
+    {
+        assert(AvmBitSetGet(&result, i) == (i % 2 == 0 || i % 3 == 0));
+    }
+
+    AvmBitSetAndNot(&result, &b);
+    for (uint i = 0; i < LENGTH; i++)
+    {
+        assert(AvmBitSetGet(&result, i) == (i % 2 == 0 && i % 3 != 0));
+    }
+
+    AvmBitSetXor(&result, &a);
+    for (uint i = 0; i < LENGTH; i++)
+    {
+        assert(AvmBitSetGet(&result, i) == (i % 6 == 0));
+    }
+
+    AvmBitSetAnd(&a, &b);
+    assert(AvmObjectEquals(&a, &result));
+    assert(AvmObjectHash(&a) == AvmObjectHash(&result));
+}
+
+void TestSparseBitSetGetSet()
+{
+    AvmSparseBitSet set = AvmSparseBitSetNew();
+
+    assert(AvmSparseBitSetNextSet(&set, 0) == AvmInvalid);
+
+    // A few values far apart, and a dense run that needs a bitmap group.
+    AvmSparseBitSetSet(&set, 5, true);
+    AvmSparseBitSetSet(&set, 4000000000u, true);
+    for (uint i = 0; i < 10000; i++)
+    {
+        AvmSparseBitSetSet(&set, 100000 + i, true);
+    }
+
+    assert(AvmSparseBitSetCount(&set) == 10002);
+    assert(AvmListGetLength(&set) == 10002);
+    assert(AvmSparseBitSetGet(&set, 5));
+    assert(!AvmSparseBitSetGet(&set, 6));
+    assert(AvmSparseBitSetGet(&set, 4000000000u));
+    assert(AvmSparseBitSetNextSet(&set, 6) == 100000);
+    assert(AvmSparseBitSetNextSet(&set, 110000) == 4000000000u);
+    assert(AvmSparseBitSetNextSet(&set, 4000000001u) == AvmInvalid);
+
+    uint count = 0;
+    for (uint i = AvmSparseBitSetNextSet(&set, 0); i != AvmInvalid;
+         i = AvmSparseBitSetNextSet(&set, i + 1))
+    {
+        count++;
+    }
+
+    assert(count == 10002);
+
+    // Removing most of the run turns its groups back into arrays.
+    for (uint i = 0; i < 10000; i += 2)
+    {
+        AvmSparseBitSetSet(&set, 100000 + i, false);
+    }
+
+    assert(AvmSparseBitSetCount(&set) == 5002);
+    for (uint i = 0; i < 10000; i++)
+    {
+        assert(AvmSparseBitSetGet(&set, 100000 + i) == (i % 2 == 1));
+    }
+
+    AvmSparseBitSetSet(&set, 5, false);
+    AvmSparseBitSetSet(&set, 5, false);
+    assert(AvmSparseBitSetCount(&set) == 5001);
+
+    AvmSparseBitSetXor(&set, &set);
+    assert(AvmSparseBitSetCount(&set) == 0);
+
+    AvmSparseBitSetSet(&set, 1, true);
+    AvmSparseBitSetSet(&set, 70000, true);
+    AvmString s = AvmObjectToString(&set);
+    AvmString expected = AvmStringFrom("{ 1, 70000 }");
+    assert(AvmObjectEquals(&s, &expected));
+}
+
+void TestSparseBitSetOperations()
+{
+    AvmSparseBitSet a = AvmSparseBitSetNew();
+    AvmSparseBitSet b = AvmSparseBitSetNew();
+    AvmSparseBitSet expected = AvmSparseBitSetNew();
+
+    // Sparse and dense groups on both sides.
+    for (uint i = 0; i < 300000; i += 2)
+    {
+        AvmSparseBitSetSet(&a, i, true);
+    }
+
+    for (uint i = 0; i < 300000; i += 3)
+    {
+        AvmSparseBitSetSet(&b, i < 150000 ? i : i * 50, true);
+    }
+
+    AvmSparseBitSetOr(&expected, &a);
+    assert(AvmObjectEquals(&expected, &a));
+    assert(AvmObjectHash(&expected) == AvmObjectHash(&a));
+
+    AvmSparseBitSetAnd(&expected, &b);
+    for (uint i = 0; i < 300000; i++)
+    {
+        assert(AvmSparseBitSetGet(&expected, i) ==
+               (AvmSparseBitSetGet(&a, i) && AvmSparseBitSetGet(&b, i)));
+    }
+
+    AvmSparseBitSetXor(&expected, &a);
+    for (uint i = 0; i < 300000; i++)
+    {
+        assert(AvmSparseBitSetGet(&expected, i) ==
+               (AvmSparseBitSetGet(&a, i) && !AvmSparseBitSetGet(&b, i)));
+    }
+
+    AvmSparseBitSetOr(&expected, &b);
+    AvmSparseBitSetAndNot(&expected, &a);
+    assert(AvmSparseBitSetCount(&expected) ==
+           AvmSparseBitSetCount(&b) - 25000);
+
+    AvmSparseBitSetXor(&expected, &expected);
+    assert(AvmSparseBitSetCount(&expected) == 0);
+}
+
+void main()
+{
+    TestBitSetGetSet();
+    TestBitSetOperations();
+    TestSparseBitSetGetSet();
+    TestSparseBitSetOperations();
+}
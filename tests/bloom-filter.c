@@ -0,0 +1,117 @@
+#include "avium/collections/bloom-filter.h"
+#include "avium/collections/list.h"
+
+#include "avium/core.h"
+#include "avium/io.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#define COUNT 100000
+
+// Counts the false positives among COUNT items that were never added.
+static uint CountFalsePositives(const AvmBloomFilter* filter)
+{
+    uint count = 0;
+
+    for (uint i = COUNT; i < 2 * COUNT; i++)
+    {
+        count += AvmBloomFilterContains(filter, &i);
+    }
+
+    return count;
+}
+
+void TestBloomFilterContains()
+{
+    AvmBloomFilter filter = AvmBloomFilterNew(typeid(uint), COUNT, 0.01);
+
+    assert(AvmListGetItemType(&filter) == typeid(uint));
+    assert(CountFalsePositives(&filter) == 0);
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        AvmBloomFilterAdd(&filter, &i);
+    }
+
+    assert(AvmListGetLength(&filter) == COUNT);
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        assert(AvmBloomFilterContains(&filter, &i));
+    }
+
+    assert(CountFalsePositives(&filter) < COUNT / 100 * 3 / 2);
+
+    AvmBloomFilter precise = AvmBloomFilterNew(typeid(uint), COUNT, 0.0001);
+    for (uint i = 0; i < COUNT; i++)
+    {
+        AvmBloomFilterAdd(&precise, &i);
+    }
+
+    assert(CountFalsePositives(&precise) < COUNT / 10000 * 3 / 2);
+}
+
+void TestBloomFilterStrings()
+{
+    AvmBloomFilter filter = AvmBloomFilterNew(typeid(AvmString), 100, 0.01);
+
+    for (uint i = 0; i < 100; i++)
+    {
+        AvmString s = AvmStringFormat("key-%u", i);
+        AvmBloomFilterAdd(&filter, &s);
+    }
+
+    // Strings are hashed by their contents.
+    for (uint i = 0; i < 100; i++)
+    {
+        AvmString s = AvmStringFormat("key-%u", i);
+        assert(AvmBloomFilterContains(&filter, &s));
+    }
+}
+
+#ifdef AVM_USE_IO
+void TestBloomFilterStream()
+{
+    AvmBloomFilter filter = AvmBloomFilterNew(typeid(uint), COUNT, 0.01);
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        AvmBloomFilterAdd(&filter, &i);
+    }
+
+    AvmStream* stream = AvmStreamFromMemory(0);
+    assert(AvmBloomFilterWrite(&filter, stream) == NULL);
+    AvmStreamSeek(stream, 0, SeekOriginBegin);
+
+    AvmBloomFilter loaded = AvmBloomFilterNew(typeid(uint), 0, 0.5);
+    assert(AvmBloomFilterRead(&loaded, stream) == NULL);
+    assert(AvmListGetLength(&loaded) == COUNT);
+    assert(AvmListGetCapacity(&loaded) == COUNT);
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        assert(AvmBloomFilterContains(&loaded, &i));
+    }
+
+    assert(CountFalsePositives(&loaded) == CountFalsePositives(&filter));
+
+    // The item size must match, and the stream must hold a whole filter.
+    AvmBloomFilter other = AvmBloomFilterNew(typeid(ulong), 0, 0.5);
+    AvmStreamSeek(stream, 0, SeekOriginBegin);
+    assert(AvmBloomFilterRead(&other, stream) != NULL);
+    assert(AvmBloomFilterRead(&loaded, stream) != NULL);
+    assert(AvmListGetLength(&loaded) == COUNT);
+
+    AvmObjectDestroy(stream);
+}
+#endif
+
+void main()
+{
+    TestBloomFilterContains();
+    TestBloomFilterStrings();
+#ifdef AVM_USE_IO
+    TestBloomFilterStream();
+#endif
+}
@@ -0,0 +1,273 @@
+#include "avium/collections/cache.h"
+#include "avium/collections/array-list.h"
+#include "avium/collections/list.h"
+#include "avium/collections/map.h"
+#include "avium/collections/parallel.h"
+
+#include "avium/core.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#define COUNT 100000
+
+void TestCacheEviction()
+{
+    AvmCache cache = AvmCacheNew(typeid(int), typeid(int), 100);
+
+    assert(AvmMapGetCapacity(&cache) == 100);
+    assert(AvmMapGetKeyType(&cache) == typeid(int));
+    assert(AvmMapGetValueType(&cache) == typeid(int));
+
+    for (int i = 0; i < 100; i++)
+    {
+        int value = i * 2;
+        AvmMapInsert(&cache, &i, &value);
+    }
+
+    // Keys that were used survive the next sweep of the hand.
+    for (int i = 0; i < 100; i += 2)
+    {
+        assert(*(int*)AvmMapGet(&cache, &i) == i * 2);
+    }
+
+    for (int i = 100; i < 150; i++)
+    {
+        AvmMapInsert(&cache, &i, &i);
+    }
+
+    assert(AvmMapGetLength(&cache) == 100);
+    for (int i = 0; i < 100; i++)
+    {
+        assert(AvmMapContainsKey(&cache, &i) == (i % 2 == 0));
+    }
+
+    for (int i = 100; i < 150; i++)
+    {
+        assert(*(int*)AvmMapGet(&cache, &i) == i);
+    }
+
+    const AvmCacheStatistics statistics = AvmCacheGetStatistics(&cache);
+    assert(statistics.Hits == 50 + 50 + 50);
+    assert(statistics.Misses == 50);
+    assert(statistics.Evictions == 50);
+
+    // Replacing a value keeps the entry, and removals free slots.
+    int key = 0;
+    int value = -1;
+    AvmMapInsert(&cache, &key, &value);
+    assert(*(int*)AvmMapGet(&cache, &key) == -1);
+    assert(AvmMapRemove(&cache, &key));
+    assert(!AvmMapRemove(&cache, &key));
+    assert(AvmMapGetLength(&cache) == 99);
+
+    AvmMapClear(&cache);
+    assert(AvmMapGetLength(&cache) == 0);
+
+    AvmCache small = AvmCacheNew(typeid(int), typeid(int), 2);
+    key = 1;
+    AvmMapInsert(&small, &key, &key);
+    AvmString s = AvmObjectToString(&small);
+    AvmString expected = AvmStringFrom("{ 1: 1 }");
+    assert(AvmObjectEquals(&s, &expected));
+}
+
+void TestCacheChurn()
+{
+    AvmCache cache = AvmCacheNew(typeid(uint), typeid(uint), 1000);
+
+    // Every key must stay findable while entries are evicted and removed,
+    // which checks that the index is kept consistent.
+    for (uint i = 0; i < COUNT; i++)
+    {
+        AvmMapInsert(&cache, &i, &i);
+
+        if (i % 3 == 0 && i != 0)
+        {
+            uint old = i / 2;
+            AvmMapRemove(&cache, &old);
+        }
+
+        assert(*(uint*)AvmMapGet(&cache, &i) == i);
+    }
+
+    uint found = 0;
+    for (uint i = 0; i < COUNT; i++)
+    {
+        const uint* value = AvmMapGet(&cache, &i);
+
+        if (value != NULL)
+        {
+            assert(*value == i);
+            found++;
+        }
+    }
+
+    assert(found == AvmMapGetLength(&cache));
+    assert(found > 900);
+}
+
+static ulong WeighString(object key, object value)
+{
+    (void)key;
+    return AvmStringGetLength(value);
+}
+
+void TestCacheWeighted()
+{
+    AvmCache cache = AvmCacheNewWeighted(
+        typeid(int), typeid(AvmString), 1000, 100, WeighString);
+
+    for (int i = 0; i < 100; i++)
+    {
+        AvmString value = AvmStringRepeat("a", 10);
+        AvmMapInsert(&cache, &i, &value);
+    }
+
+    // Only 10 strings of 10 characters fit.
+    assert(AvmMapGetLength(&cache) == 10);
+    assert(AvmCacheGetStatistics(&cache).Evictions == 90);
+
+    for (int i = 90; i < 100; i++)
+    {
+        assert(AvmStringGetLength(AvmMapGet(&cache, &i)) == 10);
+    }
+
+    // An entry larger than the budget is not kept.
+    int key = 1000;
+    AvmString huge = AvmStringRepeat("a", 101);
+    AvmMapInsert(&cache, &key, &huge);
+    assert(!AvmMapContainsKey(&cache, &key));
+    assert(AvmMapGetLength(&cache) == 10);
+
+    // A replacement that grows evicts others.
+    key = 99;
+    AvmString large = AvmStringRepeat("a", 50);
+    AvmMapInsert(&cache, &key, &large);
+    assert(AvmStringGetLength(AvmMapGet(&cache, &key)) == 50);
+    assert(AvmMapGetLength(&cache) <= 6);
+}
+
+static AvmShardedCache SharedCache;
+
+static void LookUp(object item, object result)
+{
+    const uint key = *(uint*)item % 5000;
+    uint value;
+
+    if (!AvmShardedCacheGet(&SharedCache, (object)&key, &value))
+    {
+        value = key * 3;
+        AvmShardedCacheInsert(&SharedCache, (object)&key, &value);
+    }
+
+    *(byte*)result = value == key * 3;
+}
+
+void TestShardedCache()
+{
+    SharedCache = AvmShardedCacheNew(typeid(uint), typeid(uint), 4096, 8);
+    assert(AvmMapGetCapacity(&SharedCache) == 4096);
+
+    AvmArrayList keys = AvmArrayListNew(typeid(uint), COUNT);
+    for (uint i = 0; i < COUNT; i++)
+    {
+        AvmListPush(&keys, &i);
+    }
+
+    // Large enough to run on several threads.
+    AvmArrayList results =
+        AvmArrayListParallelMap(&keys, typeid(byte), LookUp);
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        assert(*(byte*)AvmListItemAt(&results, i));
+    }
+
+    const AvmCacheStatistics statistics =
+        AvmShardedCacheGetStatistics(&SharedCache);
+    assert(statistics.Hits + statistics.Misses == COUNT);
+    assert(AvmMapGetLength(&SharedCache) <= 4096);
+
+    uint key = 7;
+    uint value = 0;
+    AvmShardedCacheInsert(&SharedCache, &key, &key);
+    assert(AvmShardedCacheGet(&SharedCache, &key, &value) && value == 7);
+    assert(AvmShardedCacheRemove(&SharedCache, &key));
+    assert(!AvmShardedCacheGet(&SharedCache, &key, &value));
+
+    AvmShardedCacheClear(&SharedCache);
+    assert(AvmMapGetLength(&SharedCache) == 0);
+}
+
+static AvmShardedCache StringCache;
+
+static void InsertString(uint key)
+{
+    AvmString value = AvmStringFormat("value-%u-of-the-cache", key);
+
+    // The cache owns the value from here on.
+    AvmShardedCacheInsert(&StringCache, (object)&key, &value);
+}
+
+// Keys far outnumber the slots, so entries are evicted, by this thread and
+// by others, while a copy of their value is still in use.
+static void LookUpString(object item, object result)
+{
+    const uint key = *(uint*)item % 32;
+    AvmString expected = AvmStringFormat("value-%u-of-the-cache", key);
+    AvmString value;
+
+    bool equal = true;
+
+    if (AvmShardedCacheGet(&StringCache, (object)&key, &value))
+    {
+        for (uint i = 1; i <= 16; i++)
+        {
+            InsertString(1000 + (key * 16 + i) % 512);
+        }
+
+        equal = AvmObjectEquals(&value, &expected);
+        AvmObjectDestroy(&value);
+        AvmObjectDestroy(&expected);
+    }
+    else
+    {
+        InsertString(key);
+        AvmObjectDestroy(&expected);
+    }
+
+    *(byte*)result = equal;
+}
+
+void TestShardedCacheStrings()
+{
+    StringCache = AvmShardedCacheNew(typeid(uint), typeid(AvmString), 64, 8);
+
+    AvmArrayList keys = AvmArrayListNew(typeid(uint), COUNT);
+    for (uint i = 0; i < COUNT; i++)
+    {
+        AvmListPush(&keys, &i);
+    }
+
+    AvmArrayList results =
+        AvmArrayListParallelMap(&keys, typeid(byte), LookUpString);
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        assert(*(byte*)AvmListItemAt(&results, i));
+    }
+
+    const AvmCacheStatistics statistics =
+        AvmShardedCacheGetStatistics(&StringCache);
+    assert(statistics.Evictions > 0);
+}
+
+void main()
+{
+    TestCacheEviction();
+    TestCacheChurn();
+    TestCacheWeighted();
+    TestShardedCache();
+    TestShardedCacheStrings();
+}
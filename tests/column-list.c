@@ -0,0 +1,132 @@
+#include "avium/collections/column-list.h"
+#include "avium/collections/list.h"
+
+#include "avium/core.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#define COUNT 1000
+
+AVM_CLASS(Particle, object, {
+    double x;
+    float mass;
+    char tag;
+    int id;
+});
+
+AVM_TYPE(Particle, object, {[FnEntryDtor] = NULL});
+
+static AvmColumnList NewParticles(uint capacity)
+{
+    const AvmColumnField fields[] = {
+        AvmColumnFieldOf(Particle, id, int),
+        AvmColumnFieldOf(Particle, x, double),
+        AvmColumnFieldOf(Particle, mass, float),
+        AvmColumnFieldOf(Particle, tag, char),
+    };
+
+    return AvmColumnListNew(typeid(Particle), 4, fields, capacity);
+}
+
+static Particle MakeParticle(int i)
+{
+    return (Particle){
+        ._type = typeid(Particle),
+        .x = i * 0.5,
+        .mass = (float)i,
+        .tag = (char)('a' + i % 26),
+        .id = i,
+    };
+}
+
+void TestColumnListColumns()
+{
+    AvmColumnList list = NewParticles(0);
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        Particle p = MakeParticle(i);
+        AvmColumnListPush(&list, &p);
+    }
+
+    assert(AvmListGetLength(&list) == COUNT);
+    assert(AvmListGetCapacity(&list) >= COUNT);
+
+    // Each field is a plain array.
+    const int* ids = AvmColumnListGetColumn(&list, 0);
+    const double* xs = AvmColumnListGetColumn(&list, 1);
+    const char* tags = AvmColumnListGetColumn(&list, 3);
+    double sum = 0;
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        assert(ids[i] == i);
+        assert(tags[i] == 'a' + i % 26);
+        sum += xs[i];
+    }
+
+    assert(sum == COUNT * (COUNT - 1) / 4.0);
+
+    AvmIterator iterator = AvmColumnListGetColumnIterator(&list, 2);
+    uint seen = 0;
+
+    while (AvmIteratorNext(&iterator))
+    {
+        const float* masses = AvmIteratorGetItems(&iterator);
+
+        for (uint i = 0; i < AvmIteratorGetLength(&iterator); i++)
+        {
+            assert(masses[i] == (float)(seen + i));
+        }
+
+        seen += AvmIteratorGetLength(&iterator);
+    }
+
+    assert(seen == COUNT);
+}
+
+void TestColumnListRows()
+{
+    AvmColumnList list = NewParticles(4);
+
+    Particle rows[COUNT];
+    for (int i = 0; i < COUNT; i++)
+    {
+        rows[i] = MakeParticle(i);
+    }
+
+    AvmColumnListAddRows(&list, COUNT, rows);
+    assert(AvmListGetLength(&list) == COUNT);
+
+    Particle gathered[10];
+    AvmColumnListGetRows(&list, 500, 10, gathered);
+    for (int i = 0; i < 10; i++)
+    {
+        assert(gathered[i].id == 500 + i);
+        assert(gathered[i].x == (500 + i) * 0.5);
+        assert(gathered[i].mass == (float)(500 + i));
+        assert(gathered[i].tag == 'a' + (500 + i) % 26);
+    }
+
+    Particle p = MakeParticle(-1);
+    AvmColumnListSetRow(&list, 3, &p);
+    AvmColumnListGetRow(&list, 3, &p);
+    assert(p.id == -1 && p.x == -0.5);
+
+    AvmColumnListRemove(&list, 3);
+    AvmColumnListGetRow(&list, 3, &p);
+    assert(p.id == 4 && p.mass == 4.0f);
+    assert(AvmListGetLength(&list) == COUNT - 1);
+
+    AvmColumnListTruncate(&list, 10);
+    assert(AvmListGetLength(&list) == 10);
+    AvmColumnListGetRow(&list, 9, &p);
+    assert(p.id == 10);
+}
+
+void main()
+{
+    TestColumnListColumns();
+    TestColumnListRows();
+}
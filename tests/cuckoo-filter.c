@@ -0,0 +1,158 @@
+#include "avium/collections/cuckoo-filter.h"
+#include "avium/collections/list.h"
+
+#include "avium/core.h"
+#include "avium/io.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#define COUNT 100000
+
+// Counts the false positives among COUNT items that were never added.
+static uint CountFalsePositives(const AvmCuckooFilter* filter)
+{
+    uint count = 0;
+
+    for (uint i = COUNT; i < 2 * COUNT; i++)
+    {
+        count += AvmCuckooFilterContains(filter, &i);
+    }
+
+    return count;
+}
+
+void TestCuckooFilterContains()
+{
+    AvmCuckooFilter filter = AvmCuckooFilterNew(typeid(uint), COUNT);
+
+    assert(AvmListGetCapacity(&filter) >= COUNT);
+    assert(CountFalsePositives(&filter) == 0);
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        assert(AvmCuckooFilterAdd(&filter, &i));
+    }
+
+    assert(AvmListGetLength(&filter) == COUNT);
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        assert(AvmCuckooFilterContains(&filter, &i));
+    }
+
+    assert(CountFalsePositives(&filter) < COUNT / 1000);
+}
+
+void TestCuckooFilterRemove()
+{
+    AvmCuckooFilter filter = AvmCuckooFilterNew(typeid(uint), COUNT);
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        AvmCuckooFilterAdd(&filter, &i);
+    }
+
+    for (uint i = 0; i < COUNT; i += 2)
+    {
+        assert(AvmCuckooFilterRemove(&filter, &i));
+    }
+
+    assert(AvmListGetLength(&filter) == COUNT / 2);
+
+    uint present = 0;
+    for (uint i = 0; i < COUNT; i++)
+    {
+        if (i % 2 == 1)
+        {
+            assert(AvmCuckooFilterContains(&filter, &i));
+        }
+        else
+        {
+            present += AvmCuckooFilterContains(&filter, &i);
+        }
+    }
+
+    assert(present < COUNT / 1000);
+
+    // Items added twice are removed twice.
+    uint item = 1;
+    AvmCuckooFilterAdd(&filter, &item);
+    assert(AvmCuckooFilterRemove(&filter, &item));
+    assert(AvmCuckooFilterRemove(&filter, &item));
+    assert(!AvmCuckooFilterContains(&filter, &item));
+}
+
+void TestCuckooFilterFull()
+{
+    AvmCuckooFilter filter = AvmCuckooFilterNew(typeid(uint), 1000);
+    const uint capacity = AvmListGetCapacity(&filter);
+    uint added = 0;
+
+    while (AvmCuckooFilterAdd(&filter, &added))
+    {
+        added++;
+    }
+
+    // Nothing is lost when the filter fills up.
+    assert(added > capacity * 9 / 10 && added <= capacity);
+    for (uint i = 0; i < added; i++)
+    {
+        assert(AvmCuckooFilterContains(&filter, &i));
+    }
+
+    // Removing items makes room again.
+    for (uint i = 0; i < added; i += 2)
+    {
+        assert(AvmCuckooFilterRemove(&filter, &i));
+    }
+
+    assert(AvmCuckooFilterAdd(&filter, &added));
+    assert(AvmCuckooFilterContains(&filter, &added));
+}
+
+#ifdef AVM_USE_IO
+void TestCuckooFilterStream()
+{
+    AvmCuckooFilter filter = AvmCuckooFilterNew(typeid(uint), COUNT);
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        AvmCuckooFilterAdd(&filter, &i);
+    }
+
+    AvmStream* stream = AvmStreamFromMemory(0);
+    assert(AvmCuckooFilterWrite(&filter, stream) == NULL);
+    AvmStreamSeek(stream, 0, SeekOriginBegin);
+
+    AvmCuckooFilter loaded = AvmCuckooFilterNew(typeid(uint), 0);
+    assert(AvmCuckooFilterRead(&loaded, stream) == NULL);
+    assert(AvmListGetLength(&loaded) == COUNT);
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        assert(AvmCuckooFilterContains(&loaded, &i));
+    }
+
+    assert(CountFalsePositives(&loaded) == CountFalsePositives(&filter));
+
+    uint item = 0;
+    assert(AvmCuckooFilterRemove(&loaded, &item));
+    assert(AvmCuckooFilterContains(&filter, &item));
+
+    AvmCuckooFilter other = AvmCuckooFilterNew(typeid(ulong), 0);
+    AvmStreamSeek(stream, 0, SeekOriginBegin);
+    assert(AvmCuckooFilterRead(&other, stream) != NULL);
+
+    AvmObjectDestroy(stream);
+}
+#endif
+
+void main()
+{
+    TestCuckooFilterContains();
+    TestCuckooFilterRemove();
+    TestCuckooFilterFull();
+#ifdef AVM_USE_IO
+    TestCuckooFilterStream();
+#endif
+}
@@ -0,0 +1,213 @@
+#include "avium/collections/array-list.h"
+#include "avium/collections/deque.h"
+#include "avium/collections/list.h"
+
+#include "avium/core.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+void TestDequeEnds()
+{
+    AvmDeque deque = AvmDequeNew(typeid(int), 0);
+    assert(AvmListGetLength(&deque) == 0);
+
+    for (int i = 0; i < 100; i++)
+    {
+        AvmDequePushBack(&deque, &i);
+        int negative = -i - 1;
+        AvmDequePushFront(&deque, &negative);
+    }
+
+    assert(AvmListGetLength(&deque) == 200);
+    assert(*(int*)AvmDequePeekFront(&deque) == -100);
+    assert(*(int*)AvmDequePeekBack(&deque) == 99);
+
+    for (int i = 0; i < 200; i++)
+    {
+        assert(*(int*)AvmListItemAt(&deque, i) == i - 100);
+    }
+
+    int value;
+    for (int i = 0; i < 100; i++)
+    {
+        AvmDequePopFront(&deque, &value);
+        assert(value == i - 100);
+        AvmDequePopBack(&deque, &value);
+        assert(value == 99 - i);
+    }
+
+    assert(AvmListGetLength(&deque) == 0);
+
+    // Used as a queue, the deque wraps around without growing.
+    const uint capacity = AvmListGetCapacity(&deque);
+    for (int i = 0; i < 10000; i++)
+    {
+        AvmDequePushBack(&deque, &i);
+        AvmDequePopFront(&deque, &value);
+        assert(value == i);
+    }
+
+    assert(AvmListGetCapacity(&deque) == capacity);
+}
+
+void TestDequeMany()
+{
+    AvmDeque deque = AvmDequeNew(typeid(uint), 16);
+    assert(AvmListGetCapacity(&deque) == 16);
+
+    uint items[12];
+    uint next = 0;
+    uint expected = 0;
+
+    // Batches of 12 items wrap around a buffer of 16.
+    for (uint round = 0; round < 50; round++)
+    {
+        for (uint i = 0; i < 12; i++)
+        {
+            items[i] = next++;
+        }
+
+        AvmDequePushMany(&deque, 12, items);
+        assert(AvmDequePopMany(&deque, 12, items) == 12);
+
+        for (uint i = 0; i < 12; i++)
+        {
+            assert(items[i] == expected++);
+        }
+    }
+
+    assert(AvmListGetCapacity(&deque) == 16);
+
+    AvmDequePushMany(&deque, 5, items);
+    assert(AvmDequePopMany(&deque, 12, items) == 5);
+    assert(AvmDequePopMany(&deque, 12, items) == 0);
+
+    uint* range = AvmAlloc(1000 * sizeof(uint));
+    for (uint i = 0; i < 1000; i++)
+    {
+        range[i] = i;
+    }
+
+    AvmDequePushMany(&deque, 1000, range);
+    assert(AvmListGetLength(&deque) == 1000);
+    assert(AvmDequePopMany(&deque, 10, NULL) == 10);
+    assert(*(uint*)AvmDequePeekFront(&deque) == 10);
+}
+
+void TestDequeList()
+{
+    AvmDeque deque = AvmDequeNew(typeid(int), 0);
+    AvmArrayList list = AvmArrayListNew(typeid(int), 0);
+    uint state = 1;
+
+    // Every operation is mirrored on an AvmArrayList.
+    for (uint i = 0; i < 5000; i++)
+    {
+        state = state * 1103515245 + 12345;
+        const uint length = AvmListGetLength(&list);
+        const uint index = (state >> 8) % (length + 1);
+        int values[3] = {(int)i, (int)i + 1, (int)i + 2};
+
+        switch ((state >> 4) % 5)
+        {
+        case 0:
+        case 1:
+            AvmListInsert(&deque, index, values);
+            AvmListInsert(&list, index, values);
+            break;
+        case 2:
+            AvmListInsertRange(&deque, index, 3, values);
+            AvmListInsertRange(&list, index, 3, values);
+            break;
+        case 3:
+            if (index < length)
+            {
+                AvmListRemove(&deque, index);
+                AvmListRemove(&list, index);
+            }
+            break;
+        default: {
+            const uint count = (length - index) / 2;
+            AvmListRemoveRange(&deque, index, count);
+            AvmListRemoveRange(&list, index, count);
+            break;
+        }
+        }
+
+        assert(AvmListGetLength(&deque) == AvmListGetLength(&list));
+    }
+
+    for (uint i = 0; i < AvmListGetLength(&list); i++)
+    {
+        assert(*(int*)AvmListItemAt(&deque, i) ==
+               *(int*)AvmListItemAt(&list, i));
+    }
+
+    // A wrapped deque is iterated in two spans.
+    AvmDeque wrapped = AvmDequeNew(typeid(int), 8);
+    for (int i = 0; i < 8; i++)
+    {
+        AvmDequePushBack(&wrapped, &i);
+    }
+
+    AvmDequePopMany(&wrapped, 5, NULL);
+    for (int i = 8; i < 12; i++)
+    {
+        AvmDequePushBack(&wrapped, &i);
+    }
+
+    uint spans = 0;
+    AvmIterator iterator = AvmListGetIterator(&wrapped);
+    while (AvmIteratorNext(&iterator))
+    {
+        const int* items = AvmIteratorGetItems(&iterator);
+        for (uint i = 0; i < AvmIteratorGetLength(&iterator); i++)
+        {
+            assert(items[i] == 5 + (int)(AvmIteratorGetIndex(&iterator) + i));
+        }
+
+        spans++;
+    }
+
+    assert(spans == 2);
+
+    int value = 10;
+    assert(AvmListIndexOf(&wrapped, &value) == 5);
+
+    value = -1;
+    AvmDequePushBack(&wrapped, &value);
+    AvmListSort(&wrapped);
+
+    for (int i = 0; i < 8; i++)
+    {
+        assert(*(int*)AvmListItemAt(&wrapped, i) == (i == 0 ? -1 : 4 + i));
+    }
+}
+
+void TestDequeStrings()
+{
+    AvmDeque deque = AvmDequeNew(typeid(AvmString), 0);
+
+    for (uint i = 0; i < 20; i++)
+    {
+        AvmString s = AvmStringFormat("%u", i);
+        AvmDequePushFront(&deque, &s);
+    }
+
+    AvmListTruncate(&deque, 10);
+    AvmListRemoveRange(&deque, 2, 3);
+    AvmDequePopFront(&deque, NULL);
+
+    AvmString s = AvmObjectToString(&deque);
+    AvmString expected = AvmStringFrom("[ 18, 14, 13, 12, 11, 10 ]");
+    assert(AvmObjectEquals(&s, &expected));
+}
+
+void main()
+{
+    TestDequeEnds();
+    TestDequeMany();
+    TestDequeList();
+    TestDequeStrings();
+}
@@ -0,0 +1,161 @@
+#include "avium/encoding.h"
+#include "avium/io.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+
+#include <string.h> // For memcmp
+
+static bool Equals(const AvmString* s, uint length, str expected)
+{
+    return AvmStringGetLength(s) == length &&
+           (length == 0 ||
+            memcmp(AvmStringGetBuffer(s), expected, length) == 0);
+}
+
+static void AssertEncodes(str bytes, str expected, AvmBase64Variant variant)
+{
+    const uint length = (uint)strlen(bytes);
+    AvmString encoded = AvmStringNew(0);
+    AvmString decoded = AvmStringNew(0);
+
+    AvmBase64Encode(&encoded, length, (const byte*)bytes, variant);
+    assert(Equals(&encoded, (uint)strlen(expected), expected));
+    assert_eq(AvmStringGetLength(&encoded),
+              AvmBase64GetEncodedLength(length, variant));
+
+    assert(AvmBase64Decode(&decoded,
+                           AvmStringGetLength(&encoded),
+                           AvmStringGetBuffer(&encoded),
+                           variant));
+    assert(Equals(&decoded, length, bytes));
+
+    AvmObjectDestroy(&decoded);
+    AvmObjectDestroy(&encoded);
+}
+
+void TestBase64()
+{
+    // Test vectors from RFC 4648.
+    AssertEncodes("", "", Base64Standard);
+    AssertEncodes("f", "Zg==", Base64Standard);
+    AssertEncodes("fo", "Zm8=", Base64Standard);
+    AssertEncodes("foo", "Zm9v", Base64Standard);
+    AssertEncodes("foob", "Zm9vYg==", Base64Standard);
+    AssertEncodes("fooba", "Zm9vYmE=", Base64Standard);
+    AssertEncodes("foobar", "Zm9vYmFy", Base64Standard);
+    AssertEncodes("foob", "Zm9vYg", Base64UrlSafe);
+    AssertEncodes("\xFB\xFF\xBF", "+/+/", Base64Standard);
+    AssertEncodes("\xFB\xFF\xBF", "-_-_", Base64UrlSafe);
+
+    AvmString s = AvmStringNew(0);
+    assert(AvmBase64Decode(&s, 6, "Zm9vYg", Base64Standard));
+    assert(!AvmBase64Decode(&s, 5, "Zm9vY", Base64Standard));
+    assert(AvmBase64Decode(&s, 4, "Zm8=", Base64UrlSafe));
+    assert(!AvmBase64Decode(&s, 8, "Zg==Zm8=", Base64Standard));
+    assert(!AvmBase64Decode(&s, 4, "-_-_", Base64Standard));
+    assert(!AvmBase64Decode(&s, 4, "+/+/", Base64UrlSafe));
+    assert(Equals(&s, 6, "foobfo"));
+    AvmObjectDestroy(&s);
+}
+
+void TestHex()
+{
+    AvmString s = AvmStringNew(0);
+
+    AvmHexEncode(&s, 4, (const byte*)"\x00\x7F\xAB\xFF");
+    assert(Equals(&s, 8, "007fabff"));
+
+    AvmStringClear(&s);
+    assert(AvmHexDecode(&s, 8, "007FabFF"));
+    assert(Equals(&s, 4, "\x00\x7F\xAB\xFF"));
+
+    assert(!AvmHexDecode(&s, 3, "abc"));
+    assert(!AvmHexDecode(&s, 2, "g0"));
+    assert(!AvmHexDecode(&s, 32, "00112233445566778899aabbccddeeXf"));
+    assert_eq(AvmStringGetLength(&s), 4);
+    AvmObjectDestroy(&s);
+}
+
+void TestLongRoundTrip()
+{
+    byte bytes[1000];
+    for (uint i = 0; i < sizeof(bytes); i++)
+    {
+        bytes[i] = (byte)(i * 7);
+    }
+
+    for (uint length = 0; length < sizeof(bytes); length += 37)
+    {
+        AvmString base64 = AvmStringNew(0);
+        AvmString hex = AvmStringNew(0);
+        AvmString decoded = AvmStringNew(0);
+
+        AvmBase64Encode(&base64, length, bytes, Base64UrlSafe);
+        assert(AvmBase64Decode(&decoded,
+                               AvmStringGetLength(&base64),
+                               AvmStringGetBuffer(&base64),
+                               Base64UrlSafe));
+        assert_eq(AvmStringGetLength(&decoded), length);
+        assert(length == 0 ||
+               memcmp(AvmStringGetBuffer(&decoded), bytes, length) == 0);
+
+        AvmStringClear(&decoded);
+        AvmHexEncode(&hex, length, bytes);
+        assert(AvmHexDecode(
+            &decoded, AvmStringGetLength(&hex), AvmStringGetBuffer(&hex)));
+        assert(length == 0 ||
+               memcmp(AvmStringGetBuffer(&decoded), bytes, length) == 0);
+
+        AvmObjectDestroy(&decoded);
+        AvmObjectDestroy(&hex);
+        AvmObjectDestroy(&base64);
+    }
+}
+
+#ifdef AVM_USE_IO
+void TestStream()
+{
+    // Large enough to be split into multiple chunks.
+    const size_t length = 10000;
+
+    AvmStream* source = AvmStreamFromMemory(length);
+    AvmStream* encoded = AvmStreamFromMemory(0);
+    AvmStream* decoded = AvmStreamFromMemory(0);
+
+    for (size_t i = 0; i < length; i++)
+    {
+        AvmStreamWriteByte(source, (byte)(i * 13));
+    }
+
+    AvmStreamSeek(source, 0, SeekOriginBegin);
+    assert(AvmStreamEncodeBase64(source, encoded, length, Base64Standard) ==
+           NULL);
+
+    AvmStreamSeek(encoded, 0, SeekOriginBegin);
+    assert(AvmStreamDecodeBase64(encoded,
+                                 decoded,
+                                 AvmBase64GetEncodedLength(length,
+                                                           Base64Standard),
+                                 Base64Standard) == NULL);
+
+    AvmStreamSeek(decoded, 0, SeekOriginBegin);
+    for (size_t i = 0; i < length; i++)
+    {
+        assert_eq(AvmStreamReadByte(decoded, NULL), (byte)(i * 13));
+    }
+
+    AvmObjectDestroy(decoded);
+    AvmObjectDestroy(encoded);
+    AvmObjectDestroy(source);
+}
+#endif
+
+void main()
+{
+    TestBase64();
+    TestHex();
+    TestLongRoundTrip();
+#ifdef AVM_USE_IO
+    TestStream();
+#endif
+}
@@ -0,0 +1,58 @@
+#include "avium/collections/free-list.h"
+#include "avium/collections/list.h"
+
+#include "avium/core.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#define COUNT 64
+
+// A slot of a pool, whose hook shares its storage while it is free.
+typedef union
+{
+    AvmFreeLink link;
+    struct
+    {
+        int key;
+        int value;
+    } entry;
+} Slot;
+
+void TestFreeListPool()
+{
+    Slot slots[COUNT];
+    AvmFreeList pool = AvmFreeListNew();
+
+    assert(AvmFreeListPop(&pool) == NULL);
+    assert(AvmFreeListPeek(&pool) == NULL);
+
+    AvmFreeListPushArray(&pool, COUNT, sizeof(Slot), &slots[0].link);
+    assert(AvmListGetLength(&pool) == COUNT);
+
+    // Slots come out in address order.
+    Slot* taken[COUNT];
+    for (int i = 0; i < COUNT; i++)
+    {
+        taken[i] = containerof(AvmFreeListPop(&pool), Slot, link);
+        assert(taken[i] == &slots[i]);
+        taken[i]->entry.key = i;
+        taken[i]->entry.value = i * i;
+    }
+
+    assert(AvmFreeListPop(&pool) == NULL);
+    assert(slots[10].entry.value == 100);
+
+    // The last slot released is reused first.
+    AvmFreeListPush(&pool, &taken[5]->link);
+    AvmFreeListPush(&pool, &taken[9]->link);
+    assert(AvmListGetLength(&pool) == 2);
+    assert(AvmFreeListPeek(&pool) == &slots[9].link);
+    assert(AvmFreeListPop(&pool) == &slots[9].link);
+    assert(AvmFreeListPop(&pool) == &slots[5].link);
+    assert(AvmListGetLength(&pool) == 0);
+}
+
+void main()
+{
+    TestFreeListPool();
+}
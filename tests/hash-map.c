@@ -0,0 +1,134 @@
+#include "avium/collections/hash-map.h"
+#include "avium/collections/map.h"
+
+#include "avium/core.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+void TestMapInsert()
+{
+    AvmHashMap map = AvmHashMapNew(typeid(int), typeid(_long), 0);
+
+    assert(AvmMapGetLength(&map) == 0);
+    assert(AvmMapGetKeyType(&map) == typeid(int));
+    assert(AvmMapGetValueType(&map) == typeid(_long));
+
+    for (int i = 0; i < 10000; i++)
+    {
+        _long value = (_long)i * i;
+        AvmMapInsert(&map, &i, &value);
+    }
+
+    assert(AvmMapGetLength(&map) == 10000);
+    assert(AvmMapGetCapacity(&map) >= 10000);
+
+    for (int i = 0; i < 10000; i++)
+    {
+        _long* value = AvmMapGet(&map, &i);
+        assert(value != NULL);
+        assert(*value == (_long)i * i);
+    }
+
+    int missing = -1;
+    assert(!AvmMapContainsKey(&map, &missing));
+
+    // Inserting an existing key replaces the value.
+    int key = 42;
+    _long value = -42;
+    AvmMapInsert(&map, &key, &value);
+    assert(AvmMapGetLength(&map) == 10000);
+    assert(*(_long*)AvmMapGet(&map, &key) == -42);
+}
+
+void TestMapRemove()
+{
+    AvmHashMap map = AvmHashMapNew(typeid(uint), typeid(uint), 16);
+    const uint capacity = AvmMapGetCapacity(&map);
+
+    // Removing and reinserting keys must reuse deleted slots instead of
+    // growing the table.
+    for (uint round = 0; round < 100; round++)
+    {
+        for (uint i = 0; i < capacity; i++)
+        {
+            uint key = round * capacity + i;
+            AvmMapInsert(&map, &key, &i);
+        }
+
+        for (uint i = 0; i < capacity; i++)
+        {
+            uint key = round * capacity + i;
+            assert(*(uint*)AvmMapGet(&map, &key) == i);
+            assert(AvmMapRemove(&map, &key));
+            assert(!AvmMapRemove(&map, &key));
+        }
+    }
+
+    assert(AvmMapGetLength(&map) == 0);
+    assert(AvmMapGetCapacity(&map) == capacity);
+
+    for (uint i = 0; i < 1000; i++)
+    {
+        AvmMapInsert(&map, &i, &i);
+    }
+
+    for (uint i = 0; i < 1000; i += 2)
+    {
+        assert(AvmMapRemove(&map, &i));
+    }
+
+    for (uint i = 0; i < 1000; i++)
+    {
+        assert(AvmMapContainsKey(&map, &i) == (i % 2 == 1));
+    }
+
+    AvmMapClear(&map);
+    assert(AvmMapGetLength(&map) == 0);
+
+    for (uint i = 0; i < 1000; i++)
+    {
+        assert(!AvmMapContainsKey(&map, &i));
+    }
+}
+
+void TestMapStringKeys()
+{
+    AvmHashMap map = AvmHashMapNew(typeid(AvmString), typeid(uint), 0);
+
+    for (uint i = 0; i < 500; i++)
+    {
+        AvmString key = AvmStringFormat("key-%u", i);
+        AvmMapInsert(&map, &key, &i);
+    }
+
+    for (uint i = 0; i < 500; i++)
+    {
+        // Keys are compared by their contents, not their buffers.
+        AvmString key = AvmStringFormat("key-%u", i);
+        uint* value = AvmMapGet(&map, &key);
+        assert(value != NULL);
+        assert(*value == i);
+    }
+
+    AvmString missing = AvmStringFrom("key-500");
+    assert(!AvmMapContainsKey(&map, &missing));
+
+    AvmHashMap strMap = AvmHashMapNew(typeid(str), typeid(int), 0);
+    str key = "hello";
+    int value = 1;
+    AvmMapInsert(&strMap, &key, &value);
+
+    char buffer[] = "hello";
+    str other = buffer;
+    assert(*(int*)AvmMapGet(&strMap, &other) == 1);
+
+    AvmPrintf("%v\n", &strMap);
+}
+
+void main()
+{
+    TestMapInsert();
+    TestMapRemove();
+    TestMapStringKeys();
+}
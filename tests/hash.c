@@ -0,0 +1,74 @@
+#include <avium/hash.h>
+#include <avium/string.h>
+#include <avium/testing.h>
+#include <avium/typeinfo.h>
+
+static void TestHashBytes()
+{
+    const char text[] = "The quick brown fox jumps over the lazy dog";
+
+    for (uint i = 0; i < sizeof(text); i++)
+    {
+        assert_eq(AvmHashBytes(i, text), AvmHashBytes(i, text));
+    }
+
+    assert_ne(AvmHashBytes(3, "abc"), AvmHashBytes(3, "abd"));
+    assert_ne(AvmHashBytesSeeded(3, "abc", 1), AvmHashBytesSeeded(3, "abc", 2));
+}
+
+static void TestHashBytesKeyed()
+{
+    // Reference vector from the SipHash paper.
+    byte message[15];
+    for (uint i = 0; i < sizeof(message); i++)
+    {
+        message[i] = (byte)i;
+    }
+
+    const ulong hash = AvmHashBytesKeyed(
+        sizeof(message), message, 0x0706050403020100ull, 0x0f0e0d0c0b0a0908ull);
+
+    assert_eq(hash, 0xa129ca6149be45e5ull);
+}
+
+static void TestObjectHash()
+{
+    AvmString a = AvmStringFrom("Hello");
+    AvmString b = AvmStringNew(32);
+    AvmStringPushStr(&b, "Hello");
+
+    assert(AvmObjectEquals(&a, &b));
+    assert_eq(AvmObjectHash(&a), AvmObjectHash(&b));
+
+    AvmVersion v1 = AvmVersionFrom(1, 2, 3);
+    AvmVersion v2 = AvmVersionFrom(1, 2, 3);
+    assert(AvmObjectEquals(&v1, &v2));
+    assert_eq(AvmObjectHash(&v1), AvmObjectHash(&v2));
+
+    AvmObjectDestroy(&a);
+    AvmObjectDestroy(&b);
+}
+
+static void TestPrimitiveHash()
+{
+    typedef ulong (*HashFn)(const void*);
+
+    int x = 42;
+    int y = 42;
+    HashFn hash = (HashFn)AvmTypeGetFunction(typeid(int), FnEntryHash);
+    assert_eq(hash(&x), hash(&y));
+
+    char buffer[] = "key";
+    str s1 = "key";
+    str s2 = buffer;
+    hash = (HashFn)AvmTypeGetFunction(typeid(str), FnEntryHash);
+    assert_eq(hash(&s1), hash(&s2));
+}
+
+void main()
+{
+    TestHashBytes();
+    TestHashBytesKeyed();
+    TestObjectHash();
+    TestPrimitiveHash();
+}
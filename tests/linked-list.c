@@ -0,0 +1,111 @@
+#include "avium/collections/linked-list.h"
+
+#include "avium/core.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+AVM_CLASS(Task, object, {
+    int id;
+    AvmLink link;
+});
+
+AVM_CLASS(TimedTask, Task, {
+    uint deadline;
+    AvmLink timerLink;
+});
+
+AVM_TYPE(Task, object, {[FnEntryDtor] = NULL});
+AVM_TYPE(TimedTask, Task, {[FnEntryDtor] = NULL});
+
+static int IdOf(AvmLink* link)
+{
+    return link == NULL ? -1 : containerof(link, Task, link)->id;
+}
+
+void TestLinkedListOrder()
+{
+    AvmLinkedList list = AvmLinkedListNew();
+    Task tasks[5];
+
+    assert(AvmLinkedListGetFirst(&list) == NULL);
+    assert(AvmLinkedListPopFront(&list) == NULL);
+
+    for (int i = 0; i < 5; i++)
+    {
+        tasks[i] = (Task){._type = typeid(Task), .id = i};
+        AvmLinkedListPushBack(&list, &tasks[i].link);
+    }
+
+    // 4 0 1 2 3
+    AvmLinkedListMoveToFront(&list, &tasks[4].link);
+    assert(IdOf(AvmLinkedListGetFirst(&list)) == 4);
+    assert(IdOf(AvmLinkedListGetLast(&list)) == 3);
+
+    // 4 1 2 3
+    AvmLinkedListRemove(&list, &tasks[0].link);
+    assert(AvmObjectGetType(&list) == typeid(AvmLinkedList));
+
+    // 4 1 0 2 3
+    AvmLinkedListInsertBefore(&list, &tasks[2].link, &tasks[0].link);
+
+    const int expected[] = {4, 1, 0, 2, 3};
+    int i = 0;
+    for (AvmLink* link = AvmLinkedListGetFirst(&list); link != NULL;
+         link = AvmLinkGetNext(link))
+    {
+        assert(IdOf(link) == expected[i++]);
+    }
+    assert(i == 5);
+
+    i = 4;
+    for (AvmLink* link = AvmLinkedListGetLast(&list); link != NULL;
+         link = AvmLinkGetPrevious(link))
+    {
+        assert(IdOf(link) == expected[i--]);
+    }
+    assert(i == -1);
+
+    assert(IdOf(AvmLinkedListPopBack(&list)) == 3);
+    assert(IdOf(AvmLinkedListPopFront(&list)) == 4);
+    assert(IdOf(AvmLinkedListPopFront(&list)) == 1);
+    assert(IdOf(AvmLinkedListPopFront(&list)) == 0);
+    assert(IdOf(AvmLinkedListPopFront(&list)) == 2);
+    assert(AvmLinkedListPopBack(&list) == NULL);
+    assert(AvmLinkedListGetLast(&list) == NULL);
+}
+
+void TestLinkedListBase()
+{
+    AvmLinkedList all = AvmLinkedListNew();
+    AvmLinkedList timers = AvmLinkedListNew();
+    TimedTask tasks[3];
+
+    // One object in two lists, with one of its hooks in its base.
+    for (int i = 0; i < 3; i++)
+    {
+        tasks[i]._base = (Task){._type = typeid(TimedTask), .id = i};
+        tasks[i].deadline = 100 - i;
+        AvmLinkedListPushBack(&all, &tasks[i]._base.link);
+        AvmLinkedListPushFront(&timers, &tasks[i].timerLink);
+    }
+
+    TimedTask* first = containerof(
+        AvmLinkedListGetFirst(&all), TimedTask, _base.link);
+    assert(first == &tasks[0]);
+    assert(first->deadline == 100);
+
+    TimedTask* soonest =
+        containerof(AvmLinkedListGetFirst(&timers), TimedTask, timerLink);
+    assert(soonest == &tasks[2]);
+    assert(soonest->_base.id == 2);
+
+    AvmLinkedListRemove(&timers, &tasks[1].timerLink);
+    assert(AvmLinkGetNext(&tasks[2].timerLink) == &tasks[0].timerLink);
+    assert(AvmLinkGetNext(&tasks[0]._base.link) == &tasks[1]._base.link);
+}
+
+void main()
+{
+    TestLinkedListOrder();
+    TestLinkedListBase();
+}
@@ -0,0 +1,197 @@
+#include "avium/collections/list.h"
+#include "avium/collections/mapped-array-list.h"
+
+#include "avium/core.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <stdio.h>
+
+#ifndef AVM_WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#define PATH "mapped-array-list.bin"
+
+void TestMappedArrayListReopen()
+{
+    remove(PATH);
+
+    AvmMappedArrayList list = AvmMappedArrayListOpen(PATH, typeid(int));
+    assert(AvmListGetLength(&list) == 0);
+    assert(AvmListGetItemType(&list) == typeid(int));
+
+    for (int i = 0; i < 1000; i++)
+    {
+        AvmListPush(&list, &i);
+    }
+
+    assert(AvmListGetCapacity(&list) >= 1000);
+
+    // 0 1 ... 998 999 -> -1 0 2 ... 998
+    int item = -1;
+    AvmListInsert(&list, 0, &item);
+    AvmListRemove(&list, 2);
+    AvmListTruncate(&list, 999);
+    AvmMappedArrayListClose(&list);
+
+    // The file is shrunk to the items on close.
+    list = AvmMappedArrayListOpen(PATH, typeid(int));
+    assert(AvmListGetLength(&list) == 999);
+    assert(AvmListGetCapacity(&list) == 999);
+    assert(*(int*)AvmListItemAt(&list, 0) == -1);
+    assert(*(int*)AvmListItemAt(&list, 1) == 0);
+    assert(*(int*)AvmListItemAt(&list, 2) == 2);
+    assert(*(int*)AvmListItemAt(&list, 998) == 998);
+
+    // Items inserted from the list itself survive it growing.
+    AvmListInsertRange(&list, 0, 999, AvmListItemAt(&list, 0));
+    assert(AvmListGetLength(&list) == 1998);
+    assert(*(int*)AvmListItemAt(&list, 999) == -1);
+    assert(*(int*)AvmListItemAt(&list, 1997) == 998);
+
+    AvmListRemoveRange(&list, 0, 999);
+    AvmMappedArrayListClose(&list);
+
+    list = AvmMappedArrayListOpen(PATH, typeid(int));
+    assert(AvmListGetLength(&list) == 999);
+    assert(*(int*)AvmListItemAt(&list, 998) == 998);
+    AvmMappedArrayListClose(&list);
+
+    remove(PATH);
+}
+
+void TestMappedArrayListSync()
+{
+    remove(PATH);
+
+    AvmMappedArrayList list = AvmMappedArrayListOpen(PATH, typeid(ulong));
+    AvmMappedArrayListReserve(&list, 100000);
+    assert(AvmListGetCapacity(&list) == 100000);
+
+    for (ulong i = 0; i < 100000; i++)
+    {
+        AvmListPush(&list, &i);
+    }
+
+    assert(AvmListGetCapacity(&list) == 100000);
+    AvmMappedArrayListSync(&list);
+
+    ulong sum = 0;
+    AvmIterator iterator = AvmListGetIterator(&list);
+    while (AvmIteratorNext(&iterator))
+    {
+        const ulong* items = AvmIteratorGetItems(&iterator);
+
+        for (uint i = 0; i < AvmIteratorGetLength(&iterator); i++)
+        {
+            sum += items[i];
+        }
+    }
+    assert(sum == 99999ull * 100000 / 2);
+
+    AvmMappedArrayListClose(&list);
+
+    list = AvmMappedArrayListOpen(PATH, typeid(ulong));
+    assert(AvmListGetLength(&list) == 100000);
+    assert(*(ulong*)AvmListItemAt(&list, 54321) == 54321);
+    AvmMappedArrayListClose(&list);
+
+    remove(PATH);
+}
+
+#ifndef AVM_WIN32
+// Changes a synced list of 0 to 9 in a child process, which then exits
+// without syncing or closing, and reopens the list.
+static AvmMappedArrayList CrashAfter(void (*change)(AvmMappedArrayList*))
+{
+    remove(PATH);
+
+    const pid_t child = fork();
+
+    if (child == 0)
+    {
+        AvmMappedArrayList list = AvmMappedArrayListOpen(PATH, typeid(int));
+
+        for (int i = 0; i < 10; i++)
+        {
+            AvmListPush(&list, &i);
+        }
+
+        AvmMappedArrayListSync(&list);
+        change(&list);
+        _exit(0);
+    }
+
+    int status;
+    assert(waitpid(child, &status, 0) == child);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    return AvmMappedArrayListOpen(PATH, typeid(int));
+}
+
+static void Append(AvmMappedArrayList* list)
+{
+    int item = -1;
+    AvmListPush(list, &item);
+}
+
+static void RemoveFifth(AvmMappedArrayList* list)
+{
+    AvmListRemove(list, 5);
+}
+
+static void SetThird(AvmMappedArrayList* list)
+{
+    int item = -1;
+    AvmMappedArrayListSet(list, 3, &item);
+}
+
+static void TruncateAndAppend(AvmMappedArrayList* list)
+{
+    AvmListTruncate(list, 7);
+    Append(list);
+    Append(list);
+}
+
+// Checks that a reopened list holds 0 to length - 1, and closes it.
+static void AssertPrefix(AvmMappedArrayList* list, uint length)
+{
+    assert(AvmListGetLength(list) == length);
+
+    for (uint i = 0; i < length; i++)
+    {
+        assert(*(int*)AvmListItemAt(list, i) == (int)i);
+    }
+
+    AvmMappedArrayListClose(list);
+    remove(PATH);
+}
+
+void TestMappedArrayListCrash()
+{
+    // Appended items wait for the next checkpoint.
+    AvmMappedArrayList list = CrashAfter(Append);
+    AssertPrefix(&list, 10);
+
+    // Items changed in place, and the items after them, leave the file first.
+    list = CrashAfter(RemoveFifth);
+    AssertPrefix(&list, 5);
+
+    list = CrashAfter(SetThird);
+    AssertPrefix(&list, 3);
+
+    list = CrashAfter(TruncateAndAppend);
+    AssertPrefix(&list, 7);
+}
+#endif
+
+void main()
+{
+    TestMappedArrayListReopen();
+    TestMappedArrayListSync();
+#ifndef AVM_WIN32
+    TestMappedArrayListCrash();
+#endif
+}
@@ -0,0 +1,163 @@
+#include "avium/collections/array-list.h"
+#include "avium/collections/list.h"
+#include "avium/collections/parallel.h"
+
+#include "avium/core.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+// Large enough to run on several threads.
+#define LENGTH (4 * AVM_PARALLEL_CUTOFF + 7)
+
+AVM_ARRAY_LIST_OF(int);
+AVM_ARRAY_LIST_OF(_long);
+
+static AvmArrayListOf(int) RandomList(uint length)
+{
+    AvmArrayListOf(int) list = AvmArrayListOf_int_New(length);
+    uint state = 12345;
+
+    for (uint i = 0; i < length; i++)
+    {
+        state = state * 1103515245 + 12345;
+        AvmArrayListOf_int_Push(&list, (int)(state >> 8) - (1 << 23));
+    }
+
+    return list;
+}
+
+static int CompareDescending(object a, object b)
+{
+    const int x = *(int*)a;
+    const int y = *(int*)b;
+    return (x < y) - (x > y);
+}
+
+void TestParallelSort()
+{
+    const uint lengths[] = {0, 1, 1000, LENGTH};
+
+    for (uint i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+    {
+        AvmArrayListOf(int) list = RandomList(lengths[i]);
+        AvmArrayListOf(int) copy = RandomList(lengths[i]);
+
+        AvmArrayListParallelSort(&list._list);
+        AvmListSort(AvmArrayListOf_int_AsList(&copy));
+
+        for (uint j = 0; j < lengths[i]; j++)
+        {
+            assert(AvmArrayListOf_int_Get(&list, j) ==
+                   AvmArrayListOf_int_Get(&copy, j));
+        }
+
+        AvmArrayListParallelSortBy(&list._list, CompareDescending);
+
+        for (uint j = 1; j < lengths[i]; j++)
+        {
+            assert(AvmArrayListOf_int_Get(&list, j - 1) >=
+                   AvmArrayListOf_int_Get(&list, j));
+        }
+    }
+
+    // Strings are sorted through their FnEntryCompare entry.
+    AvmArrayList strings = AvmArrayListNew(typeid(AvmString), 0);
+    for (uint i = 0; i < LENGTH; i++)
+    {
+        AvmString s = AvmStringFormat("%u", (i * 7919) % LENGTH);
+        AvmListInsert((AvmList*)&strings, i, &s);
+    }
+
+    AvmArrayListParallelSort(&strings);
+
+    for (uint i = 1; i < LENGTH; i++)
+    {
+        assert(AvmObjectCompare(AvmListItemAt((AvmList*)&strings, i - 1),
+                                AvmListItemAt((AvmList*)&strings, i)) <= 0);
+    }
+}
+
+void TestParallelIndexOf()
+{
+    AvmArrayListOf(int) list = AvmArrayListOf_int_New(LENGTH);
+    for (uint i = 0; i < LENGTH; i++)
+    {
+        AvmArrayListOf_int_Push(&list, (int)(i % 1000));
+    }
+
+    // The first occurrence is found even when later chunks also match.
+    int value = 999;
+    assert(AvmArrayListParallelIndexOf(&list._list, &value) == 999);
+
+    AvmArrayListOf_int_Set(&list, LENGTH - 1, -1);
+    value = -1;
+    assert(AvmArrayListParallelIndexOf(&list._list, &value) == LENGTH - 1);
+    assert(AvmArrayListParallelContains(&list._list, &value));
+
+    value = 1000;
+    assert(AvmArrayListParallelIndexOf(&list._list, &value) == AvmInvalid);
+    assert(!AvmArrayListParallelContains(&list._list, &value));
+}
+
+static void Square(object item, object result)
+{
+    const int x = *(int*)item;
+    *(_long*)result = (_long)x * x;
+}
+
+static bool IsEven(object item)
+{
+    return *(int*)item % 2 == 0;
+}
+
+static void Add(object accumulator, object item)
+{
+    *(_long*)accumulator += *(_long*)item;
+}
+
+void TestParallelMapFilterReduce()
+{
+    AvmArrayListOf(int) list = AvmArrayListOf_int_New(LENGTH);
+    for (uint i = 0; i < LENGTH; i++)
+    {
+        AvmArrayListOf_int_Push(&list, (int)i);
+    }
+
+    AvmArrayListOf(_long) squares;
+    squares._list =
+        AvmArrayListParallelMap(&list._list, typeid(_long), Square);
+
+    assert(AvmArrayListOf__long_GetLength(&squares) == LENGTH);
+    for (uint i = 0; i < LENGTH; i++)
+    {
+        assert(AvmArrayListOf__long_Get(&squares, i) == (_long)i * i);
+    }
+
+    AvmArrayListOf(int) evens;
+    evens._list = AvmArrayListParallelFilter(&list._list, IsEven);
+
+    assert(AvmArrayListOf_int_GetLength(&evens) == (LENGTH + 1) / 2);
+    for (uint i = 0; i < (LENGTH + 1) / 2; i++)
+    {
+        assert(AvmArrayListOf_int_Get(&evens, i) == (int)(2 * i));
+    }
+
+    _long sum = 0;
+    AvmArrayListParallelReduce(&squares._list, &sum, Add);
+
+    _long expected = 0;
+    for (uint i = 0; i < LENGTH; i++)
+    {
+        expected += (_long)i * i;
+    }
+
+    assert(sum == expected);
+}
+
+void main()
+{
+    TestParallelSort();
+    TestParallelIndexOf();
+    TestParallelMapFilterReduce();
+}
@@ -0,0 +1,171 @@
+#include "avium/collections/priority-queue.h"
+#include "avium/collections/list.h"
+
+#include "avium/core.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+// Visits 0 to 10006 in a scrambled order, since 10007 is prime.
+#define COUNT       10007
+#define SCRAMBLE(i) ((int)(((_long)(i) * 7919) % COUNT))
+
+// Pops every item and checks that they come out in order.
+static void CheckDrain(AvmPriorityQueue* queue, int from, int count)
+{
+    assert(AvmListGetLength(queue) == (uint)count);
+
+    for (int i = 0; i < count; i++)
+    {
+        int item = -1;
+        assert(*(int*)AvmPriorityQueuePeek(queue) == from + i);
+        AvmPriorityQueuePop(queue, &item);
+        assert(item == from + i);
+    }
+
+    assert(AvmListGetLength(queue) == 0);
+}
+
+void TestPriorityQueuePush()
+{
+    AvmPriorityQueue queue = AvmPriorityQueueNew(typeid(int), NULL, 0);
+
+    assert(AvmListGetItemType(&queue) == typeid(int));
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        int item = SCRAMBLE(i);
+        assert(AvmPriorityQueuePush(&queue, &item) != AvmInvalid);
+    }
+
+    assert(AvmListGetCapacity(&queue) >= COUNT);
+    CheckDrain(&queue, 0, COUNT);
+
+    // Equal items all come out.
+    for (int i = 0; i < 100; i++)
+    {
+        int item = i % 3;
+        AvmPriorityQueuePush(&queue, &item);
+    }
+
+    for (int i = 0; i < 100; i++)
+    {
+        int item;
+        AvmPriorityQueuePop(&queue, &item);
+        assert(item == (i < 34 ? 0 : i < 67 ? 1 : 2));
+    }
+
+    AvmPrintf("%v\n", &queue);
+}
+
+void TestPriorityQueuePushMany()
+{
+    int* items = AvmAlloc(COUNT * sizeof(int));
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        items[i] = SCRAMBLE(i);
+    }
+
+    // Into an empty queue, which is heapified.
+    AvmPriorityQueue queue = AvmPriorityQueueNew(typeid(int), NULL, 0);
+    AvmPriorityQueuePushMany(&queue, COUNT, items);
+    CheckDrain(&queue, 0, COUNT);
+
+    // A few items at a time into a larger queue, which are sifted up.
+    for (int i = 0; i < COUNT; i += 7)
+    {
+        const int count = COUNT - i < 7 ? COUNT - i : 7;
+        AvmPriorityQueuePushMany(&queue, count, items + i);
+    }
+
+    CheckDrain(&queue, 0, COUNT);
+    AvmDealloc(items);
+}
+
+void TestPriorityQueueDecreaseKey()
+{
+    AvmPriorityQueue queue = AvmPriorityQueueNew(typeid(int), NULL, 0);
+    uint handles[1000];
+
+    for (int i = 0; i < 1000; i++)
+    {
+        int item = SCRAMBLE(i) + 1000;
+        handles[i] = AvmPriorityQueuePush(&queue, &item);
+    }
+
+    for (int i = 0; i < 1000; i++)
+    {
+        assert(*(int*)AvmPriorityQueueGet(&queue, handles[i]) ==
+               SCRAMBLE(i) + 1000);
+    }
+
+    // Every other item moves to the front, in reverse order of handles.
+    for (int i = 0; i < 1000; i += 2)
+    {
+        int item = 999 - i;
+        AvmPriorityQueueDecreaseKey(&queue, handles[i], &item);
+        assert(*(int*)AvmPriorityQueueGet(&queue, handles[i]) == item);
+    }
+
+    for (int i = 998; i >= 0; i -= 2)
+    {
+        int item;
+        AvmPriorityQueuePop(&queue, &item);
+        assert(item == 999 - i);
+
+        // The handle of a removed item no longer refers to it.
+        assert(AvmPriorityQueueGet(&queue, handles[i]) == NULL);
+    }
+
+    for (int i = 1; i < 1000; i += 2)
+    {
+        assert(*(int*)AvmPriorityQueueGet(&queue, handles[i]) ==
+               SCRAMBLE(i) + 1000);
+    }
+}
+
+void TestPriorityQueueBounded()
+{
+    AvmPriorityQueue queue = AvmPriorityQueueNewBounded(typeid(int), NULL, 10);
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        int item = SCRAMBLE(i);
+        const uint handle = AvmPriorityQueuePush(&queue, &item);
+
+        if (handle != AvmInvalid)
+        {
+            assert(*(int*)AvmPriorityQueueGet(&queue, handle) == item);
+        }
+    }
+
+    assert(AvmListGetCapacity(&queue) == 10);
+    CheckDrain(&queue, COUNT - 10, 10);
+
+    int* items = AvmAlloc(COUNT * sizeof(int));
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        items[i] = SCRAMBLE(i);
+    }
+
+    AvmPriorityQueuePushMany(&queue, COUNT, items);
+    assert(AvmListGetCapacity(&queue) == 10);
+    CheckDrain(&queue, COUNT - 10, 10);
+
+    int item = 0;
+    AvmPriorityQueue empty = AvmPriorityQueueNewBounded(typeid(int), NULL, 0);
+    assert(AvmPriorityQueuePush(&empty, &item) == AvmInvalid);
+    assert(AvmListGetLength(&empty) == 0);
+
+    AvmDealloc(items);
+}
+
+void main()
+{
+    TestPriorityQueuePush();
+    TestPriorityQueuePushMany();
+    TestPriorityQueueDecreaseKey();
+    TestPriorityQueueBounded();
+}
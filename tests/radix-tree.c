@@ -0,0 +1,242 @@
+#include "avium/collections/radix-tree.h"
+#include "avium/collections/map.h"
+
+#include "avium/core.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+#define COUNT 20000
+
+// Builds a key with a long shared prefix, so nodes keep prefixes longer than
+// they can store.
+static uint MakeKey(char buffer[64], uint i)
+{
+    AvmString s = AvmStringFrom("/usr/share/documentation/");
+    AvmStringPushUint(&s, (ulong)i * 2654435761u % 1000003, NumericBaseHex);
+
+    if (i % 5 == 0)
+    {
+        AvmStringPushStr(&s, "/index");
+    }
+
+    const uint length = AvmStringGetLength(&s);
+    memcpy(buffer, AvmStringGetBuffer(&s), length);
+    AvmObjectDestroy(&s);
+    return length;
+}
+
+void TestRadixTreeBasic()
+{
+    AvmRadixTree tree = AvmRadixTreeNew(typeid(int));
+
+    str keys[] = {"", "a", "ab", "abc", "abd", "b", "abcdefghijklmnop"};
+    for (int i = 0; i < 7; i++)
+    {
+        AvmRadixTreeInsert(&tree, (uint)strlen(keys[i]), keys[i], &i);
+    }
+
+    assert(AvmMapGetLength(&tree) == 7);
+    for (int i = 0; i < 7; i++)
+    {
+        const int* value =
+            AvmRadixTreeGet(&tree, (uint)strlen(keys[i]), keys[i]);
+        assert(*value == i);
+    }
+
+    assert(AvmRadixTreeGet(&tree, 2, "ac") == NULL);
+    assert(AvmRadixTreeGet(&tree, 10, "abcdefghij") == NULL);
+    assert(AvmRadixTreeGet(&tree, 16, "abcdefghijklmnoq") == NULL);
+
+    // Replacing keeps the length.
+    int value = 100;
+    AvmRadixTreeInsert(&tree, 2, "ab", &value);
+    assert(*(int*)AvmRadixTreeGet(&tree, 2, "ab") == 100);
+    assert(AvmMapGetLength(&tree) == 7);
+
+    AvmString s = AvmObjectToString(&tree);
+    AvmString expected = AvmStringFrom(
+        "{ : 0, a: 1, ab: 100, abc: 3, abcdefghijklmnop: 6, abd: 4, b: 5 }");
+    assert(AvmObjectEquals(&s, &expected));
+
+    assert(AvmRadixTreeRemove(&tree, 2, "ab"));
+    assert(!AvmRadixTreeRemove(&tree, 2, "ab"));
+    assert(AvmRadixTreeRemove(&tree, 0, ""));
+    assert(AvmRadixTreeRemove(&tree, 3, "abc"));
+    assert(*(int*)AvmRadixTreeGet(&tree, 16, "abcdefghijklmnop") == 6);
+    assert(*(int*)AvmRadixTreeGet(&tree, 3, "abd") == 4);
+    assert(AvmMapGetLength(&tree) == 4);
+
+    AvmMapClear(&tree);
+    assert(AvmMapGetLength(&tree) == 0);
+    assert(AvmRadixTreeGet(&tree, 1, "a") == NULL);
+}
+
+void TestRadixTreeMap()
+{
+    AvmRadixTree tree = AvmRadixTreeNew(typeid(int));
+    assert(AvmMapGetKeyType(&tree) == typeid(AvmString));
+    assert(AvmMapGetValueType(&tree) == typeid(int));
+
+    AvmString key = AvmStringFrom("hello");
+    int value = 5;
+    AvmMapInsert(&tree, &key, &value);
+    assert(AvmMapContainsKey(&tree, &key));
+    assert(*(int*)AvmMapGet(&tree, &key) == 5);
+    assert(AvmMapRemove(&tree, &key));
+    assert(!AvmMapContainsKey(&tree, &key));
+}
+
+void TestRadixTreeNodes()
+{
+    AvmRadixTree tree = AvmRadixTreeNew(typeid(uint));
+
+    // Every byte after a shared prefix, so the node grows to all its sizes.
+    char key[3] = {'x', 'y', 0};
+    for (uint i = 0; i < 256; i++)
+    {
+        key[2] = (char)i;
+        AvmRadixTreeInsert(&tree, 3, key, &i);
+
+        for (uint j = 0; j <= i; j++)
+        {
+            key[2] = (char)j;
+            assert(*(uint*)AvmRadixTreeGet(&tree, 3, key) == j);
+        }
+    }
+
+    assert(AvmRadixTreeGet(&tree, 2, "xy") == NULL);
+
+    // And shrinks back.
+    for (uint i = 0; i < 256; i += 2)
+    {
+        key[2] = (char)i;
+        assert(AvmRadixTreeRemove(&tree, 3, key));
+    }
+
+    for (uint i = 0; i < 256; i++)
+    {
+        key[2] = (char)i;
+        assert(AvmRadixTreeRemove(&tree, 3, key) == (i % 2 == 1));
+        assert(AvmMapGetLength(&tree) == 128 - (i + 1) / 2);
+    }
+
+    assert(tree._root == NULL);
+}
+
+void TestRadixTreeMany()
+{
+    AvmRadixTree tree = AvmRadixTreeNew(typeid(uint));
+    char key[64];
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        const uint length = MakeKey(key, i);
+        AvmRadixTreeInsert(&tree, length, key, &i);
+    }
+
+    assert(AvmMapGetLength(&tree) == COUNT);
+    for (uint i = 0; i < COUNT; i++)
+    {
+        const uint length = MakeKey(key, i);
+        assert(*(uint*)AvmRadixTreeGet(&tree, length, key) == i);
+    }
+
+    for (uint i = 0; i < COUNT; i += 3)
+    {
+        const uint length = MakeKey(key, i);
+        assert(AvmRadixTreeRemove(&tree, length, key));
+    }
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        const uint length = MakeKey(key, i);
+        const uint* value = AvmRadixTreeGet(&tree, length, key);
+        assert(i % 3 == 0 ? value == NULL : *value == i);
+    }
+
+    for (uint i = 0; i < COUNT; i++)
+    {
+        const uint length = MakeKey(key, i);
+        assert(AvmRadixTreeRemove(&tree, length, key) == (i % 3 != 0));
+    }
+
+    assert(AvmMapGetLength(&tree) == 0);
+    assert(tree._root == NULL);
+}
+
+void TestRadixTreeMatchLongest()
+{
+    AvmRadixTree tree = AvmRadixTreeNew(typeid(int));
+
+    str routes[] = {"/", "/api/", "/api/v1/users/", "/api/v1/users/admin"};
+    for (int i = 0; i < 4; i++)
+    {
+        AvmRadixTreeInsert(&tree, (uint)strlen(routes[i]), routes[i], &i);
+    }
+
+    uint length = 0;
+    assert(*(int*)AvmRadixTreeMatchLongest(
+               &tree, 13, "/api/v1/posts", &length) == 1);
+    assert(length == 5);
+
+    assert(*(int*)AvmRadixTreeMatchLongest(
+               &tree, 17, "/api/v1/users/bob", &length) == 2);
+    assert(length == 14);
+
+    assert(*(int*)AvmRadixTreeMatchLongest(
+               &tree, 19, "/api/v1/users/admin", &length) == 3);
+    assert(length == 19);
+
+    assert(*(int*)AvmRadixTreeMatchLongest(&tree, 5, "/home", NULL) == 0);
+    assert(AvmRadixTreeMatchLongest(&tree, 4, "home", NULL) == NULL);
+    assert(AvmRadixTreeMatchLongest(&tree, 0, "", NULL) == NULL);
+}
+
+static void CollectKey(uint length, str key, object value, object context)
+{
+    (void)value;
+    AvmString* s = context;
+    AvmStringPushChars(s, length, key);
+    AvmStringPushChar(s, ' ');
+}
+
+void TestRadixTreeForEachWithPrefix()
+{
+    AvmRadixTree tree = AvmRadixTreeNew(typeid(int));
+
+    str keys[] = {"car", "cart", "carton", "cat", "dog", "ca", "carbon"};
+    for (int i = 0; i < 7; i++)
+    {
+        AvmRadixTreeInsert(&tree, (uint)strlen(keys[i]), keys[i], &i);
+    }
+
+    AvmString s = AvmStringNew(0);
+    AvmRadixTreeForEachWithPrefix(&tree, 3, "car", CollectKey, &s);
+    AvmString expected = AvmStringFrom("car carbon cart carton ");
+    assert(AvmObjectEquals(&s, &expected));
+
+    AvmStringClear(&s);
+    AvmRadixTreeForEachWithPrefix(&tree, 1, "c", CollectKey, &s);
+    expected = AvmStringFrom("ca car carbon cart carton cat ");
+    assert(AvmObjectEquals(&s, &expected));
+
+    AvmStringClear(&s);
+    AvmRadixTreeForEachWithPrefix(&tree, 4, "cars", CollectKey, &s);
+    AvmRadixTreeForEachWithPrefix(&tree, 2, "do", CollectKey, &s);
+    AvmRadixTreeForEachWithPrefix(&tree, 5, "dogma", CollectKey, &s);
+    expected = AvmStringFrom("dog ");
+    assert(AvmObjectEquals(&s, &expected));
+}
+
+void main()
+{
+    TestRadixTreeBasic();
+    TestRadixTreeMap();
+    TestRadixTreeNodes();
+    TestRadixTreeMany();
+    TestRadixTreeMatchLongest();
+    TestRadixTreeForEachWithPrefix();
+}
@@ -0,0 +1,166 @@
+#include <avium/regex.h>
+#include <avium/string.h>
+#include <avium/testing.h>
+
+#include <string.h> // For memcmp
+
+static bool Equals(const AvmString* s, str expected)
+{
+    const uint length = (uint)strlen(expected);
+
+    return AvmStringGetLength(s) == length &&
+           (length == 0 ||
+            memcmp(AvmStringGetBuffer(s), expected, length) == 0);
+}
+
+// Finds the first match and compares its text.
+static bool FindText(str pattern, str text, str expected)
+{
+    AvmRegex regex = AvmRegexNew(pattern);
+    AvmString s = AvmStringFrom(text);
+    AvmRegexMatch match;
+
+    const bool found = AvmRegexFind(&regex, &s, 0, &match);
+    assert_eq(found, AvmRegexIsMatch(&regex, &s));
+
+    bool result = expected == NULL;
+
+    if (found && expected != NULL)
+    {
+        const uint length = (uint)strlen(expected);
+
+        result = AvmRegexMatchGetLength(&match) == length &&
+                 (length == 0 ||
+                  memcmp(AvmStringGetBuffer(&s) +
+                             AvmRegexMatchGetStart(&match),
+                         expected,
+                         length) == 0);
+    }
+    else if (found)
+    {
+        result = false;
+    }
+
+    AvmObjectDestroy(&s);
+    AvmObjectDestroy(&regex);
+    return result;
+}
+
+void TestFind()
+{
+    assert(FindText("abc", "xxabcxx", "abc"));
+    assert(FindText("a.c", "xxabcxx", "abc"));
+    assert(FindText("a.c", "a\nc", NULL));
+    assert(FindText("^abc", "xxabc", NULL));
+    assert(FindText("abc$", "abcxx", NULL));
+    assert(FindText("^$", "", ""));
+    assert(FindText("x*", "abc", ""));
+    assert(FindText("[0-9]+", "abc 1234 5", "1234"));
+    assert(FindText("[^a-c]+", "abcdefabc", "def"));
+    assert(FindText("\\d+\\.\\d+", "pi is 3.14", "3.14"));
+    assert(FindText("\\w+@\\w+\\.com", "mail me@host.com now", "me@host.com"));
+    assert(FindText("\\x41+", "xAAy", "AA"));
+    assert(FindText("a{2,3}", "aaaa", "aaa"));
+    assert(FindText("a{2,3}?", "aaaa", "aa"));
+    assert(FindText("a{2}", "a aa", "aa"));
+    assert(FindText("a{2,}", "aaaaa", "aaaaa"));
+    assert(FindText("x{", "ax{", "x{"));
+    assert(FindText("a+?", "aaa", "a"));
+    assert(FindText("<.*>", "<a><b>", "<a><b>"));
+    assert(FindText("<.*?>", "<a><b>", "<a>"));
+
+    // Leftmost-first, like a backtracking engine.
+    assert(FindText("a|ab", "ab", "a"));
+    assert(FindText("ab|a", "ab", "ab"));
+    assert(FindText("(a|ab)(c|bcd)", "abcd", "abcd"));
+}
+
+void TestGroups()
+{
+    AvmRegex regex = AvmRegexNew("(\\w+)=(\\d+)?(?:;|$)");
+    AvmString s = AvmStringFrom("a=; key=42");
+    AvmRegexMatch groups[3];
+
+    assert_eq(AvmRegexGetGroupCount(&regex), 2);
+
+    assert(AvmRegexFindGroups(&regex, &s, 0, 3, groups));
+    assert_eq(AvmRegexMatchGetStart(&groups[0]), 0);
+    assert_eq(AvmRegexMatchGetLength(&groups[1]), 1);
+    assert_eq(AvmRegexMatchGetStart(&groups[2]), AvmInvalid);
+
+    assert(AvmRegexFindGroups(&regex, &s, 1, 3, groups));
+    assert_eq(AvmRegexMatchGetStart(&groups[1]), 4);
+    assert_eq(AvmRegexMatchGetLength(&groups[1]), 3);
+    assert_eq(AvmRegexMatchGetStart(&groups[2]), 8);
+    assert_eq(AvmRegexMatchGetLength(&groups[2]), 2);
+
+    AvmObjectDestroy(&s);
+    AvmObjectDestroy(&regex);
+}
+
+void TestIterator()
+{
+    AvmRegex regex = AvmRegexNew("a*");
+    AvmString s = AvmStringFrom("baaac");
+    AvmRegexIterator it = AvmRegexIteratorNew(&regex, &s);
+    AvmRegexMatch match;
+
+    // Empty at 0, "aaa" at 1, and empty at 5. The empty match at 4 directly
+    // follows the previous match.
+    const uint starts[] = {0, 1, 5};
+    const uint lengths[] = {0, 3, 0};
+
+    for (uint i = 0; i < 3; i++)
+    {
+        assert(AvmRegexIteratorNext(&it, &match));
+        assert_eq(AvmRegexMatchGetStart(&match), starts[i]);
+        assert_eq(AvmRegexMatchGetLength(&match), lengths[i]);
+    }
+
+    assert(!AvmRegexIteratorNext(&it, &match));
+
+    AvmObjectDestroy(&s);
+    AvmObjectDestroy(&regex);
+}
+
+void TestReplace()
+{
+    AvmRegex regex = AvmRegexNew("(\\w+)@(\\w+)");
+    AvmString s = AvmStringFrom("alice@home, bob@work");
+    AvmString result = AvmStringNew(0);
+
+    assert_eq(AvmRegexReplace(&regex, &s, "$2:$1 ($$)", &result), 2);
+    assert(Equals(&result, "home:alice ($), work:bob ($)"));
+
+    AvmObjectDestroy(&result);
+    AvmObjectDestroy(&s);
+    AvmObjectDestroy(&regex);
+}
+
+void TestLinearTime()
+{
+    // Catastrophic for backtracking engines.
+    AvmRegex regex = AvmRegexNew("(a*)*(a|b)*c");
+    AvmString s = AvmStringRepeat("a", 20000);
+
+    assert(!AvmRegexIsMatch(&regex, &s));
+
+    AvmRegexMatch match;
+    assert(!AvmRegexFind(&regex, &s, 0, &match));
+
+    AvmStringPushChar(&s, 'c');
+    assert(AvmRegexFind(&regex, &s, 0, &match));
+    assert_eq(AvmRegexMatchGetLength(&match), 20001);
+
+    AvmObjectDestroy(&s);
+    AvmObjectDestroy(&regex);
+}
+
+void main()
+{
+    TestFind();
+    TestGroups();
+    TestIterator();
+    TestReplace();
+    TestLinearTime();
+}
@@ -0,0 +1,149 @@
+#include "avium/collections/array-list.h"
+#include "avium/collections/list.h"
+#include "avium/collections/segmented-list.h"
+
+#include "avium/core.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+void TestSegmentedListPush()
+{
+    AvmSegmentedList list = AvmSegmentedListNew(typeid(uint), 0);
+    uint* pointers[1000];
+
+    for (uint i = 0; i < 1000; i++)
+    {
+        pointers[i] = AvmSegmentedListPush(&list, &i);
+    }
+
+    assert(AvmListGetLength(&list) == 1000);
+    assert(AvmListGetCapacity(&list) >= 1000);
+
+    // Growing never moves items.
+    for (uint i = 0; i < 1000; i++)
+    {
+        assert(AvmListItemAt(&list, i) == pointers[i]);
+        assert(*pointers[i] == i);
+    }
+
+    // Segments are iterated as spans of increasing length.
+    uint spans = 0;
+    AvmIterator iterator = AvmListGetIterator(&list);
+    while (AvmIteratorNext(&iterator))
+    {
+        const uint* items = AvmIteratorGetItems(&iterator);
+        for (uint i = 0; i < AvmIteratorGetLength(&iterator); i++)
+        {
+            assert(items[i] == AvmIteratorGetIndex(&iterator) + i);
+        }
+
+        spans++;
+    }
+
+    assert(spans == 6);
+
+    uint value = 777;
+    assert(AvmListIndexOf(&list, &value) == 777);
+}
+
+void TestSegmentedListRanges()
+{
+    AvmSegmentedList list = AvmSegmentedListNew(typeid(int), 10);
+    AvmArrayList expected = AvmArrayListNew(typeid(int), 0);
+    uint state = 7;
+
+    // Every operation is mirrored on an AvmArrayList.
+    for (uint i = 0; i < 3000; i++)
+    {
+        state = state * 1103515245 + 12345;
+        const uint length = AvmListGetLength(&expected);
+        const uint index = (state >> 8) % (length + 1);
+        int values[40];
+
+        for (uint j = 0; j < 40; j++)
+        {
+            values[j] = (int)(i * 40 + j);
+        }
+
+        switch ((state >> 4) % 4)
+        {
+        case 0:
+            AvmListInsert(&list, index, values);
+            AvmListInsert(&expected, index, values);
+            break;
+        case 1:
+            AvmListInsertRange(&list, index, 40, values);
+            AvmListInsertRange(&expected, index, 40, values);
+            break;
+        case 2:
+            if (index < length)
+            {
+                AvmListRemove(&list, index);
+                AvmListRemove(&expected, index);
+            }
+            break;
+        default: {
+            const uint count = (length - index) / 3;
+            AvmListRemoveRange(&list, index, count);
+            AvmListRemoveRange(&expected, index, count);
+            break;
+        }
+        }
+    }
+
+    assert(AvmListGetLength(&list) == AvmListGetLength(&expected));
+
+    for (uint i = 0; i < AvmListGetLength(&expected); i++)
+    {
+        assert(*(int*)AvmListItemAt(&list, i) ==
+               *(int*)AvmListItemAt(&expected, i));
+    }
+
+    // Items can be inserted from the list itself.
+    const uint length = AvmListGetLength(&list);
+    AvmListAddList(&list, &list);
+    assert(AvmListGetLength(&list) == 2 * length);
+
+    for (uint i = 0; i < length; i++)
+    {
+        assert(*(int*)AvmListItemAt(&list, i) ==
+               *(int*)AvmListItemAt(&list, length + i));
+    }
+
+    AvmListSort(&list);
+
+    for (uint i = 1; i < AvmListGetLength(&list); i++)
+    {
+        assert(*(int*)AvmListItemAt(&list, i - 1) <=
+               *(int*)AvmListItemAt(&list, i));
+    }
+}
+
+void TestSegmentedListStrings()
+{
+    AvmSegmentedList list = AvmSegmentedListNew(typeid(AvmString), 0);
+
+    for (uint i = 0; i < 40; i++)
+    {
+        AvmString s = AvmStringFormat("%u", i);
+        AvmListPush(&list, &s);
+    }
+
+    AvmListRemoveRange(&list, 5, 30);
+    AvmListTruncate(&list, 8);
+
+    AvmString s = AvmObjectToString(&list);
+    AvmString expected = AvmStringFrom("[ 0, 1, 2, 3, 4, 35, 36, 37 ]");
+    assert(AvmObjectEquals(&s, &expected));
+
+    AvmListClear(&list);
+    assert(AvmListGetLength(&list) == 0);
+}
+
+void main()
+{
+    TestSegmentedListPush();
+    TestSegmentedListRanges();
+    TestSegmentedListStrings();
+}
@@ -0,0 +1,86 @@
+#include "avium/collections/list.h"
+#include "avium/collections/small-list.h"
+
+#include "avium/core.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+AVM_SMALL_LIST_OF(int, 8);
+AVM_SMALL_LIST_OF(AvmString, 2);
+
+void TestSmallListInline()
+{
+    AvmSmallListOf(int, 8) list = AvmSmallListOf_int_8_New();
+    AvmList* l = AvmSmallListOf_int_8_AsList(&list);
+
+    assert(AvmListGetLength(l) == 0);
+    assert(AvmListGetCapacity(l) == 8);
+    assert(AvmListGetItemType(l) == typeid(int));
+
+    for (int i = 0; i < 8; i++)
+    {
+        AvmListInsert(l, 0, &i);
+    }
+
+    // The items are stored in the list itself.
+    assert(AvmSmallListIsInline(&list._list));
+    assert(AvmListItemAt(l, 0) == &list._inline[0]);
+
+    int value = 3;
+    assert(AvmListIndexOf(l, &value) == 4);
+
+    AvmListSort(l);
+    for (int i = 0; i < 8; i++)
+    {
+        assert(list._inline[i] == i);
+    }
+
+    // A copy has its own items.
+    AvmSmallListOf(int, 8) copy = list;
+    AvmListRemove(AvmSmallListOf_int_8_AsList(&copy), 0);
+    assert(*(int*)AvmListItemAt(l, 0) == 0);
+    assert(*(int*)AvmListItemAt(&copy, 0) == 1);
+
+    // Growing past the inline capacity moves the items to the heap.
+    AvmListAddList(l, l);
+    assert(!AvmSmallListIsInline(&list._list));
+    assert(AvmListGetLength(l) == 16);
+
+    for (int i = 0; i < 16; i++)
+    {
+        assert(*(int*)AvmListItemAt(l, i) == i % 8);
+    }
+
+    AvmListRemoveRange(l, 2, 12);
+    AvmListTruncate(l, 3);
+
+    AvmString s = AvmObjectToString(l);
+    AvmString expected = AvmStringFrom("[ 0, 1, 6 ]");
+    assert(AvmObjectEquals(&s, &expected));
+}
+
+void TestSmallListStrings()
+{
+    AvmSmallListOf(AvmString, 2) list = AvmSmallListOf_AvmString_2_New();
+
+    for (uint i = 0; i < 10; i++)
+    {
+        AvmString s = AvmStringFormat("%u", i);
+        AvmListPush(&list, &s);
+    }
+
+    assert(AvmListGetLength(&list) == 10);
+
+    AvmString s = AvmStringFrom("9");
+    assert(AvmListIndexOf(&list, &s) == 9);
+
+    AvmListClear(&list);
+    assert(AvmListGetLength(&list) == 0);
+}
+
+void main()
+{
+    TestSmallListInline();
+    TestSmallListStrings();
+}
@@ -15,7 +15,46 @@ static void TestFrom()
     AvmObjectDestroy(&s);
 }
 
+static void TestCase()
+{
+    AvmString s = AvmStringFrom("Content-Type: Text/HTML; charset=UTF-8 \xC3\x89");
+
+    AvmStringToLower(&s);
+    assert_eq(strncmp(AvmStringGetBuffer(&s),
+                      "content-type: text/html; charset=utf-8 \xC3\x89",
+                      AvmStringGetLength(&s)),
+              0);
+
+    AvmStringToUpper(&s);
+    assert_eq(strncmp(AvmStringGetBuffer(&s),
+                      "CONTENT-TYPE: TEXT/HTML; CHARSET=UTF-8 \xC3\x89",
+                      AvmStringGetLength(&s)),
+              0);
+
+    AvmObjectDestroy(&s);
+}
+
+static void TestIgnoreCase()
+{
+    AvmString s = AvmStringFrom("Content-Type: Text/HTML; charset=UTF-8");
+
+    assert(AvmStringStartsWithStrIgnoreCase(&s, "content-type"));
+    assert(!AvmStringStartsWithStrIgnoreCase(&s, "content-length"));
+    assert(AvmStringEqualsStrIgnoreCase(
+        &s, "CONTENT-TYPE: TEXT/HTML; CHARSET=UTF-8"));
+    assert(!AvmStringEqualsStrIgnoreCase(&s, "content-type"));
+
+    assert_eq(AvmStringFindIgnoreCase(&s, "CHARSET"), 25);
+    assert_eq(AvmStringFindIgnoreCase(&s, "utf-8"), 33);
+    assert_eq(AvmStringFindIgnoreCase(&s, "c"), 0);
+    assert_eq(AvmStringFindIgnoreCase(&s, "utf-16"), AvmInvalid);
+
+    AvmObjectDestroy(&s);
+}
+
 void main()
 {
     TestFrom();
+    TestCase();
+    TestIgnoreCase();
 }
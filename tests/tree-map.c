@@ -0,0 +1,264 @@
+#include "avium/collections/tree-map.h"
+#include "avium/collections/list.h"
+#include "avium/collections/map.h"
+
+#include "avium/core.h"
+#include "avium/string.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+// Visits 0 to 10006 in a scrambled order, since 10007 is prime.
+#define COUNT          10007
+#define SCRAMBLE(i)    ((int)(((_long)(i) * 7919) % COUNT))
+
+// Checks that a range yields count keys from, from + step, ... with values
+// that are their negation.
+static void CheckRange(AvmTreeMapRange range, int from, int count, int step)
+{
+    int expected = from;
+
+    while (AvmTreeMapRangeNext(&range))
+    {
+        const int* keys = AvmTreeMapRangeGetKeys(&range);
+        const _long* values = AvmTreeMapRangeGetValues(&range);
+        const uint length = AvmTreeMapRangeGetLength(&range);
+
+        assert(length != 0);
+
+        for (uint i = 0; i < length; i++, expected += step)
+        {
+            assert(keys[i] == expected);
+            assert(values[i] == -expected);
+        }
+    }
+
+    assert(expected == from + count * step);
+    assert(AvmTreeMapRangeGetLength(&range) == 0);
+}
+
+void TestTreeMapInsert()
+{
+    AvmTreeMap map = AvmTreeMapNew(typeid(int), typeid(_long), NULL);
+
+    assert(AvmMapGetLength(&map) == 0);
+    assert(AvmMapGetKeyType(&map) == typeid(int));
+    assert(AvmMapGetValueType(&map) == typeid(_long));
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        int key = SCRAMBLE(i);
+        _long value = -key;
+        AvmMapInsert(&map, &key, &value);
+    }
+
+    assert(AvmMapGetLength(&map) == COUNT);
+    assert(AvmMapGetCapacity(&map) >= COUNT);
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        _long* value = AvmMapGet(&map, &i);
+        assert(value != NULL);
+        assert(*value == -i);
+    }
+
+    int missing = COUNT;
+    assert(!AvmMapContainsKey(&map, &missing));
+
+    CheckRange(AvmTreeMapGetRange(&map, NULL, NULL), 0, COUNT, 1);
+
+    // Inserting an existing key replaces the value.
+    int key = 42;
+    _long value = 1;
+    AvmMapInsert(&map, &key, &value);
+    assert(AvmMapGetLength(&map) == COUNT);
+    assert(*(_long*)AvmMapGet(&map, &key) == 1);
+}
+
+void TestTreeMapRemove()
+{
+    AvmTreeMap map = AvmTreeMapNew(typeid(int), typeid(_long), NULL);
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        _long value = -i;
+        AvmMapInsert(&map, &i, &value);
+    }
+
+    // Removing every odd key in a scrambled order merges and refills nodes
+    // all over the tree.
+    for (int i = 0; i < COUNT; i++)
+    {
+        int key = SCRAMBLE(i);
+
+        if (key % 2 == 1)
+        {
+            assert(AvmMapRemove(&map, &key));
+            assert(!AvmMapRemove(&map, &key));
+        }
+    }
+
+    assert(AvmMapGetLength(&map) == COUNT / 2 + 1);
+    CheckRange(AvmTreeMapGetRange(&map, NULL, NULL), 0, COUNT / 2 + 1, 2);
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        assert(AvmMapContainsKey(&map, &i) == (i % 2 == 0));
+    }
+
+    for (int i = COUNT - 1; i >= 0; i -= 2)
+    {
+        assert(AvmMapRemove(&map, &i));
+    }
+
+    assert(AvmMapGetLength(&map) == 0);
+    assert(AvmMapGetCapacity(&map) == 0);
+
+    int key = 7;
+    _long value = -7;
+    AvmMapInsert(&map, &key, &value);
+    assert(*(_long*)AvmMapGet(&map, &key) == -7);
+
+    AvmMapClear(&map);
+    assert(AvmMapGetLength(&map) == 0);
+    assert(!AvmMapContainsKey(&map, &key));
+}
+
+void TestTreeMapRange()
+{
+    AvmTreeMap map = AvmTreeMapNew(typeid(int), typeid(_long), NULL);
+
+    CheckRange(AvmTreeMapGetRange(&map, NULL, NULL), 0, 0, 1);
+
+    for (int i = 0; i < 1000; i += 2)
+    {
+        _long value = -i;
+        AvmMapInsert(&map, &i, &value);
+    }
+
+    int low = 101;
+    int high = 301;
+    CheckRange(AvmTreeMapGetRange(&map, &low, &high), 102, 100, 2);
+
+    low = 100;
+    high = 300;
+    CheckRange(AvmTreeMapGetRange(&map, &low, &high), 100, 100, 2);
+    CheckRange(AvmTreeMapGetRange(&map, &low, NULL), 100, 450, 2);
+    CheckRange(AvmTreeMapGetRange(&map, NULL, &high), 0, 150, 2);
+
+    low = 1000;
+    CheckRange(AvmTreeMapGetRange(&map, &low, NULL), 1000, 0, 2);
+
+    low = 500;
+    high = 500;
+    CheckRange(AvmTreeMapGetRange(&map, &low, &high), 500, 0, 2);
+}
+
+void TestTreeMapFromSorted()
+{
+    AvmArrayList keys = AvmArrayListNew(typeid(int), 0);
+    AvmArrayList values = AvmArrayListNew(typeid(_long), 0);
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        _long value = -3 * i;
+        int key = 3 * i;
+        AvmListPush(&keys, &key);
+        AvmListPush(&values, &value);
+    }
+
+    // Every size up to a few leaves, then one of several levels.
+    for (uint length = 0; length < 200; length++)
+    {
+        keys._length = length;
+        values._length = length;
+
+        AvmTreeMap map = AvmTreeMapFromSorted(&keys, &values, NULL);
+        assert(AvmMapGetLength(&map) == length);
+        CheckRange(AvmTreeMapGetRange(&map, NULL, NULL), 0, length, 3);
+        AvmMapClear(&map);
+    }
+
+    keys._length = COUNT;
+    values._length = COUNT;
+
+    AvmTreeMap map = AvmTreeMapFromSorted(&keys, &values, NULL);
+    CheckRange(AvmTreeMapGetRange(&map, NULL, NULL), 0, COUNT, 3);
+
+    // The built tree supports updates like one built by insertion.
+    for (int i = 0; i < 3 * COUNT; i++)
+    {
+        if (i % 3 == 0)
+        {
+            assert(AvmMapRemove(&map, &i));
+        }
+        else
+        {
+            _long value = -i;
+            AvmMapInsert(&map, &i, &value);
+        }
+    }
+
+    assert(AvmMapGetLength(&map) == 2 * COUNT);
+
+    for (int i = 0; i < 3 * COUNT; i++)
+    {
+        assert(AvmMapContainsKey(&map, &i) == (i % 3 != 0));
+    }
+}
+
+static int CompareDescending(object a, object b)
+{
+    return *(int*)b - *(int*)a;
+}
+
+void TestTreeMapComparer()
+{
+    AvmTreeMap map =
+        AvmTreeMapNew(typeid(int), typeid(_long), CompareDescending);
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        int key = SCRAMBLE(i);
+        _long value = -key;
+        AvmMapInsert(&map, &key, &value);
+    }
+
+    CheckRange(AvmTreeMapGetRange(&map, NULL, NULL), COUNT - 1, COUNT, -1);
+
+    AvmTreeMap strings = AvmTreeMapNew(typeid(AvmString), typeid(uint), NULL);
+
+    for (uint i = 0; i < 500; i++)
+    {
+        AvmString key = AvmStringFormat("key-%u", i * 7 % 500);
+        AvmMapInsert(&strings, &key, &i);
+    }
+
+    for (uint i = 0; i < 500; i += 2)
+    {
+        AvmString key = AvmStringFormat("key-%u", i);
+        assert(AvmMapRemove(&strings, &key));
+        AvmObjectDestroy(&key);
+    }
+
+    assert(AvmMapGetLength(&strings) == 250);
+
+    for (uint i = 0; i < 500; i++)
+    {
+        // Keys are compared by their contents, not their buffers.
+        AvmString key = AvmStringFormat("key-%u", i);
+        assert(AvmMapContainsKey(&strings, &key) == (i % 2 == 1));
+        AvmObjectDestroy(&key);
+    }
+
+    AvmPrintf("%v\n", &strings);
+    AvmMapClear(&strings);
+}
+
+void main()
+{
+    TestTreeMapInsert();
+    TestTreeMapRemove();
+    TestTreeMapRange();
+    TestTreeMapFromSorted();
+    TestTreeMapComparer();
+}
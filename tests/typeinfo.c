@@ -0,0 +1,78 @@
+#include "avium/core.h"
+#include "avium/testing.h"
+#include "avium/typeinfo.h"
+
+#include <string.h>
+
+AVM_ENUM(Color, {
+    ColorRed = 1,
+    ColorNone = 0,
+    ColorGreen = 2,
+    ColorBlue = 4,
+    ColorDefault = 1,
+});
+
+AVM_ENUM_TYPE(Color,
+              {
+                  AVM_ENUM_MEMBER(ColorRed),
+                  AVM_ENUM_MEMBER(ColorNone),
+                  AVM_ENUM_MEMBER(ColorGreen),
+                  AVM_ENUM_MEMBER(ColorBlue),
+                  AVM_ENUM_MEMBER(ColorDefault),
+              });
+
+AVM_ENUM(Code, {
+    CodeLow = -2000000000,
+    CodeZero = 0,
+    CodeHigh = 2000000000,
+    CodeOdd = 7,
+});
+
+AVM_ENUM_TYPE(Code,
+              {
+                  AVM_ENUM_MEMBER(CodeLow),
+                  AVM_ENUM_MEMBER(CodeZero),
+                  AVM_ENUM_MEMBER(CodeHigh),
+                  AVM_ENUM_MEMBER(CodeOdd),
+              });
+
+void TestEnumDense()
+{
+    assert(strcmp(AvmEnumGetName(typeid(Color)), "Color") == 0);
+    assert(AvmEnumGetSize(typeid(Color)) == sizeof(Color));
+
+    // A member with value 0 does not end the members.
+    assert(AvmEnumIsDefined(typeid(Color), ColorNone));
+    assert(AvmEnumIsDefined(typeid(Color), ColorBlue));
+    assert(!AvmEnumIsDefined(typeid(Color), 3));
+    assert(!AvmEnumIsDefined(typeid(Color), -1));
+    assert(!AvmEnumIsDefined(typeid(Color), 1000));
+
+    assert(strcmp(AvmEnumGetNameOf(typeid(Color), 0), "ColorNone") == 0);
+    assert(strcmp(AvmEnumGetNameOf(typeid(Color), 4), "ColorBlue") == 0);
+
+    // The first member with a value names it.
+    assert(strcmp(AvmEnumGetNameOf(typeid(Color), 1), "ColorRed") == 0);
+
+    assert(AvmEnumGetValueOf(typeid(Color), "ColorGreen") == ColorGreen);
+    assert(AvmEnumGetValueOf(typeid(Color), "ColorDefault") == ColorDefault);
+    assert(AvmEnumGetValueOf(typeid(Color), "ColorNone") == ColorNone);
+}
+
+void TestEnumSparse()
+{
+    assert(AvmEnumIsDefined(typeid(Code), CodeLow));
+    assert(AvmEnumIsDefined(typeid(Code), CodeHigh));
+    assert(AvmEnumIsDefined(typeid(Code), CodeZero));
+    assert(!AvmEnumIsDefined(typeid(Code), 1));
+
+    assert(strcmp(AvmEnumGetNameOf(typeid(Code), CodeHigh), "CodeHigh") == 0);
+    assert(strcmp(AvmEnumGetNameOf(typeid(Code), 7), "CodeOdd") == 0);
+    assert(AvmEnumGetValueOf(typeid(Code), "CodeLow") == CodeLow);
+}
+
+void main()
+{
+    TestEnumDense();
+    TestEnumSparse();
+}
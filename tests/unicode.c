@@ -0,0 +1,100 @@
+#include <avium/string.h>
+#include <avium/testing.h>
+#include <avium/unicode.h>
+
+#include <string.h> // For memcmp
+
+// Latin-1, CJK and emoji characters followed by enough ASCII to exercise the
+// vector paths.
+static const char Text[] = "Gr\xC3\xBC\xC3\x9F"
+                           "e, \xE4\xB8\x96\xE7\x95\x8C! \xF0\x9F\x8E\x89"
+                           " and some more plain ASCII text";
+
+static void TestValidate()
+{
+    assert(AvmUtf8IsValid(sizeof(Text) - 1, Text));
+    assert(AvmUtf8IsValid(0, ""));
+
+    assert(!AvmUtf8IsValid(2, "\xC0\xAF"));         // Overlong.
+    assert(!AvmUtf8IsValid(3, "\xED\xA0\x80"));     // Surrogate.
+    assert(!AvmUtf8IsValid(4, "\xF4\x90\x80\x80")); // Above U+10FFFF.
+    assert(!AvmUtf8IsValid(2, "\xE4\xB8"));         // Truncated.
+    assert(!AvmUtf8IsValid(1, "\x80"));             // Lone continuation.
+
+    // Errors after the first 16 bytes and at the very end.
+    char buffer[40];
+    memset(buffer, 'a', sizeof(buffer));
+    assert(AvmUtf8IsValid(sizeof(buffer), buffer));
+    buffer[20] = (char)0xFF;
+    assert(!AvmUtf8IsValid(sizeof(buffer), buffer));
+    buffer[20] = 'a';
+    buffer[39] = (char)0xE4;
+    assert(!AvmUtf8IsValid(sizeof(buffer), buffer));
+}
+
+static void TestCountAndIterate()
+{
+    AvmString s = AvmStringFrom(Text);
+    const uint expected[] = {
+        'G', 'r', 0xFC, 0xDF, 'e', ',', ' ', 0x4E16, 0x754C, '!', ' ', 0x1F389,
+    };
+
+    assert_eq(AvmStringCountCodepoints(&s), 12 + 31);
+
+    AvmUtf8Iterator it = AvmUtf8IteratorNew(&s);
+    uint codepoint = 0;
+
+    for (uint i = 0; i < sizeof(expected) / sizeof(uint); i++)
+    {
+        assert(AvmUtf8IteratorNext(&it, &codepoint));
+        assert_eq(codepoint, expected[i]);
+    }
+
+    while (AvmUtf8IteratorNext(&it, &codepoint))
+    {
+    }
+
+    assert_eq(AvmUtf8IteratorGetIndex(&it), AvmStringGetLength(&s));
+    AvmObjectDestroy(&s);
+}
+
+static void TestTranscode()
+{
+    AvmString s = AvmStringFrom(Text);
+    AvmString utf16 = AvmStringNew(0);
+    AvmString utf32 = AvmStringNew(0);
+    AvmString back = AvmStringNew(0);
+
+    assert(AvmUtf8ToUtf16(&s, &utf16));
+    assert_eq(AvmStringGetLength(&utf16), (12 + 31 + 1) * 2);
+
+    assert(AvmUtf8ToUtf32(&s, &utf32));
+    assert_eq(AvmStringGetLength(&utf32), (12 + 31) * 4);
+
+    assert(AvmUtf16ToUtf8(&utf16, &back));
+    assert(AvmObjectEquals(&s, &back));
+
+    AvmStringClear(&back);
+    assert(AvmUtf32ToUtf8(&utf32, &back));
+    assert(AvmObjectEquals(&s, &back));
+
+    // A lone surrogate is rejected.
+    const ushort invalid[] = {'a', 0xD800, 'b'};
+    AvmString bad = AvmStringFromChars(sizeof(invalid), (str)invalid);
+    AvmStringClear(&back);
+    assert(!AvmUtf16ToUtf8(&bad, &back));
+    assert_eq(AvmStringGetLength(&back), 0);
+
+    AvmObjectDestroy(&bad);
+    AvmObjectDestroy(&back);
+    AvmObjectDestroy(&utf32);
+    AvmObjectDestroy(&utf16);
+    AvmObjectDestroy(&s);
+}
+
+void main()
+{
+    TestValidate();
+    TestCountAndIterate();
+    TestTranscode();
+}